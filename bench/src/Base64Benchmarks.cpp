@@ -0,0 +1,98 @@
+/**
+ * @file Base64Benchmarks.cpp
+ *
+ * This module contains the benchmarks of the Base64 encoder and decoder
+ * built into the Sasl library, compared with the Base64 library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Benchmark.hpp"
+
+#include <Base64/Base64.hpp>
+#include <Sasl/Base64.hpp>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * Measure encoding and decoding messages of the given length,
+     * with the Base64 library and with each implementation built into
+     * the Sasl library.
+     *
+     * @param[in] length
+     *     This is the number of octets in each message.
+     *
+     * @param[in] lengthName
+     *     This is how to show the length in the names of the benchmarks.
+     */
+    void BenchmarkLength(size_t length, const std::string& lengthName) {
+        std::string message;
+        for (size_t i = 0; i < length; ++i) {
+            message.push_back((char)(i * 167 + 13));
+        }
+        const auto encoded = Base64::Encode(message);
+        Benchmark::Run(
+            "Base64 encode " + lengthName + " (Base64::Encode)",
+            [&]{ (void)Base64::Encode(message); }
+        );
+        Benchmark::Run(
+            "Base64 decode " + lengthName + " (Base64::Decode)",
+            [&]{ (void)Base64::Decode(encoded); }
+        );
+        std::vector< char > encodeBuffer(Sasl::Base64::EncodedLength(length));
+        std::vector< char > decodeBuffer(Sasl::Base64::MaxDecodedLength(encoded.length()));
+        const struct {
+            Sasl::Base64::Implementation implementation;
+            const char* name;
+            bool available;
+        } implementations[] = {
+            {Sasl::Base64::Implementation::Portable, "portable", true},
+            {Sasl::Base64::Implementation::Sse41, "SSE4.1", Sasl::Base64::IsSse41Available()},
+            {Sasl::Base64::Implementation::Avx2, "AVX2", Sasl::Base64::IsAvx2Available()},
+        };
+        for (const auto& implementation: implementations) {
+            if (!implementation.available) {
+                continue;
+            }
+            Benchmark::Run(
+                "Base64 encode " + lengthName + " (" + implementation.name + ")",
+                [&]{
+                    (void)Sasl::Base64::Encode(
+                        message.data(),
+                        message.length(),
+                        encodeBuffer.data(),
+                        implementation.implementation
+                    );
+                }
+            );
+            Benchmark::Run(
+                "Base64 decode " + lengthName + " (" + implementation.name + ")",
+                [&]{
+                    size_t decodedLength;
+                    (void)Sasl::Base64::Decode(
+                        encoded.data(),
+                        encoded.length(),
+                        decodeBuffer.data(),
+                        decodedLength,
+                        implementation.implementation
+                    );
+                }
+            );
+        }
+    }
+
+}
+
+void RunBase64Benchmarks() {
+    (void)printf(
+        "Base64 SSE4.1 available: %s, AVX2 available: %s\n",
+        Sasl::Base64::IsSse41Available() ? "yes" : "no",
+        Sasl::Base64::IsAvx2Available() ? "yes" : "no"
+    );
+    BenchmarkLength(32, "32 B");
+    BenchmarkLength(4096, "4 KiB");
+}
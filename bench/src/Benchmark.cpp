@@ -0,0 +1,41 @@
+/**
+ * @file Benchmark.cpp
+ *
+ * This module contains the implementation of the functions used to run
+ * and report the Sasl benchmarks.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Benchmark.hpp"
+
+#include <chrono>
+#include <stdio.h>
+
+namespace Benchmark {
+
+    void Run(
+        const std::string& name,
+        std::function< void() > operation,
+        double minSeconds
+    ) {
+        operation();
+        const auto start = std::chrono::steady_clock::now();
+        size_t runs = 0;
+        double elapsed = 0.0;
+        do {
+            operation();
+            ++runs;
+            elapsed = std::chrono::duration< double >(
+                std::chrono::steady_clock::now() - start
+            ).count();
+        } while (elapsed < minSeconds);
+        (void)printf(
+            "%-48s %12.3f us/op %12.1f op/s\n",
+            name.c_str(),
+            elapsed * 1e6 / runs,
+            runs / elapsed
+        );
+    }
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file Benchmark.hpp
+ *
+ * This module declares the functions used to run and report
+ * the Sasl benchmarks.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <functional>
+#include <stddef.h>
+#include <string>
+
+namespace Benchmark {
+
+    /**
+     * Run the given operation repeatedly, for at least the given
+     * amount of time, and report how long each run of the operation
+     * took on average.
+     *
+     * @param[in] name
+     *     This is the name of the benchmark to report.
+     *
+     * @param[in] operation
+     *     This is the operation to measure.
+     *
+     * @param[in] minSeconds
+     *     This is the minimum amount of time, in seconds, for which to
+     *     run the operation.
+     */
+    void Run(
+        const std::string& name,
+        std::function< void() > operation,
+        double minSeconds = 0.5
+    );
+
+}
+
+/**
+ * Run the benchmarks of the Base64 encoder and decoder.
+ */
+void RunBase64Benchmarks();
+
+/**
+ * Run the benchmarks of the SHA hash functions and the Scram class.
+ */
+void RunScramBenchmarks();
+
+/**
+ * Run the benchmarks of the MD5 hash function and the CramMd5 class.
+ */
+void RunCramMd5Benchmarks();
+
+/**
+ * Run the benchmarks of the Multiplexer class.
+ */
+void RunMultiplexerBenchmarks();
+
+/**
+ * Run the benchmarks of the server side of the mechanisms.
+ */
+void RunServerBenchmarks();
@@ -0,0 +1,60 @@
+/**
+ * @file CramMd5Benchmarks.cpp
+ *
+ * This module contains the benchmarks of the MD5 hash function
+ * and the Sasl::Client::CramMd5 class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Benchmark.hpp"
+
+#include <Sasl/Client/CramMd5.hpp>
+#include <Sasl/Md5.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the challenge the simulated server sends in the
+     * CRAM-MD5 exchanges.
+     */
+    const std::string CHALLENGE = "<1896.697170952@postoffice.reston.mci.net>";
+
+}
+
+void RunCramMd5Benchmarks() {
+    {
+        const std::vector< uint8_t > message(1 << 20, 'x');
+        uint8_t digest[Sasl::MD5_DIGEST_SIZE / 8];
+        Benchmark::Run(
+            "MD5 1 MiB",
+            [&]{
+                const auto context = Sasl::MakeMd5Context();
+                context->Update(message.data(), message.size());
+                context->Final(digest);
+            }
+        );
+    }
+    {
+        Sasl::Client::CramMd5 mech;
+        mech.SetCredentials("tanstaaftanstaaf", "tim");
+        Benchmark::Run(
+            "CRAM-MD5 response (keyed states kept)",
+            [&]{
+                mech.Reset();
+                (void)mech.Proceed(CHALLENGE);
+            }
+        );
+    }
+    Benchmark::Run(
+        "CRAM-MD5 exchange (new mechanism)",
+        [&]{
+            Sasl::Client::CramMd5 mech;
+            mech.SetCredentials("tanstaaftanstaaf", "tim");
+            (void)mech.Proceed(CHALLENGE);
+        }
+    );
+}
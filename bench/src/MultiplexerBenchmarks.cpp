@@ -0,0 +1,72 @@
+/**
+ * @file MultiplexerBenchmarks.cpp
+ *
+ * This module contains the benchmarks of the
+ * Sasl::Client::Multiplexer class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Benchmark.hpp"
+
+#include <memory>
+#include <Sasl/Client/Login.hpp>
+#include <Sasl/Client/Multiplexer.hpp>
+#include <Sasl/Client/PasswordCredentials.hpp>
+#include <stdio.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of exchanges the multiplexer drives at once
+     * in the benchmarks.
+     */
+    constexpr size_t NUM_EXCHANGES = 10000;
+
+}
+
+void RunMultiplexerBenchmarks() {
+    const auto credentials = Sasl::Client::PasswordCredentials::Create("hunter2", "bob");
+    Sasl::Client::Multiplexer multiplexer;
+    multiplexer.Reserve(NUM_EXCHANGES);
+    std::vector< Sasl::Client::Multiplexer::Message > inbound(NUM_EXCHANGES);
+    std::vector< Sasl::Client::Multiplexer::Message > outbound;
+    std::vector< Sasl::Client::Multiplexer::Completion > completions;
+    outbound.reserve(NUM_EXCHANGES);
+    completions.reserve(NUM_EXCHANGES);
+    std::vector< std::unique_ptr< Sasl::Client::Mechanism > > mechanisms;
+    for (size_t i = 0; i < NUM_EXCHANGES; ++i) {
+        std::unique_ptr< Sasl::Client::Login > mech(new Sasl::Client::Login());
+        mech->SetSharedCredentials(credentials);
+        mechanisms.push_back(std::move(mech));
+        inbound[i].connectionId = i;
+    }
+    Benchmark::Run(
+        "Multiplexer 10000 LOGIN exchanges",
+        [&]{
+            std::string initialResponse;
+            for (size_t i = 0; i < NUM_EXCHANGES; ++i) {
+                mechanisms[i]->Reset();
+                (void)multiplexer.Add(i, std::move(mechanisms[i]), initialResponse);
+            }
+            for (const auto challenge: {"Username:", "Password:", ""}) {
+                for (auto& message: inbound) {
+                    message.text = challenge;
+                }
+                outbound.clear();
+                multiplexer.Process(inbound, outbound, completions);
+            }
+            for (auto& completion: completions) {
+                mechanisms[completion.connectionId] = std::move(completion.mechanism);
+            }
+            completions.clear();
+        }
+    );
+    const auto statistics = multiplexer.GetStatistics();
+    (void)printf(
+        "%-48s %12.1f exchanges/s\n",
+        "Multiplexer throughput",
+        statistics.exchangesPerSecond
+    );
+}
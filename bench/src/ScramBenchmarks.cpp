@@ -0,0 +1,161 @@
+/**
+ * @file ScramBenchmarks.cpp
+ *
+ * This module contains the benchmarks of the SHA hash functions
+ * and the Sasl::Client::Scram class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Benchmark.hpp"
+
+#include <functional>
+#include <Hash/Sha1.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <Sasl/Sha.hpp>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of iterations the simulated server asks the
+     * client to use in the SCRAM exchanges.
+     */
+    constexpr size_t NUM_ITERATIONS = 4096;
+
+    /**
+     * Measure SCRAM exchanges, up to the point where the client
+     * computes its proof, using a new mechanism for each exchange.
+     *
+     * @param[in] name
+     *     This is the name of the benchmark to report.
+     *
+     * @param[in] setUpHashFunction
+     *     This is the function to call to set up the hash function
+     *     of each new mechanism.
+     */
+    void BenchmarkScramExchange(
+        const std::string& name,
+        std::function< void(Sasl::Client::Scram& mech) > setUpHashFunction
+    ) {
+        Benchmark::Run(
+            name,
+            [&]{
+                Sasl::Client::Scram mech;
+                setUpHashFunction(mech);
+                mech.SetCredentials("pencil", "user");
+                const auto clientFirstMessage = mech.Proceed("");
+                const auto clientNonce = clientFirstMessage.substr(
+                    clientFirstMessage.find(",r=") + 3
+                );
+                (void)mech.Proceed(
+                    "r=" + clientNonce + "3rfcNHYJY1ZVvWVs7j"
+                    + ",s=QSXCR+Q6sek8bf92,i=" + std::to_string(NUM_ITERATIONS)
+                );
+            }
+        );
+    }
+
+    /**
+     * Measure hashing a 1 MiB message with the given context factory.
+     *
+     * @param[in] name
+     *     This is the name of the benchmark to report.
+     *
+     * @param[in] hashContextFactory
+     *     This is used to make the hash context to measure.
+     *
+     * @param[in] digestLength
+     *     This is the length, in bytes, of the digest.
+     */
+    void BenchmarkHashContext(
+        const std::string& name,
+        Sasl::HashContextFactory hashContextFactory,
+        size_t digestLength
+    ) {
+        const std::vector< uint8_t > message(1 << 20, 'x');
+        std::vector< uint8_t > digest(digestLength);
+        Benchmark::Run(
+            name,
+            [&]{
+                const auto context = hashContextFactory();
+                context->Update(message.data(), message.size());
+                context->Final(digest.data());
+            }
+        );
+    }
+
+}
+
+void RunScramBenchmarks() {
+    (void)printf(
+        "SHA Extensions available: %s\n",
+        Sasl::IsShaExtensionsAvailable() ? "yes" : "no"
+    );
+    const std::vector< uint8_t > message(1 << 20, 'x');
+    Benchmark::Run(
+        "SHA-1 1 MiB (Hash::Sha1)",
+        [&]{ (void)Hash::Sha1(message); }
+    );
+    BenchmarkHashContext(
+        "SHA-1 1 MiB (portable)",
+        []{ return Sasl::MakeSha1Context(Sasl::ShaImplementation::Portable); },
+        Sasl::SHA1_DIGEST_SIZE / 8
+    );
+    BenchmarkHashContext(
+        "SHA-1 1 MiB (SHA Extensions)",
+        []{ return Sasl::MakeSha1Context(Sasl::ShaImplementation::ShaExtensions); },
+        Sasl::SHA1_DIGEST_SIZE / 8
+    );
+    BenchmarkHashContext(
+        "SHA-256 1 MiB (portable)",
+        []{ return Sasl::MakeSha256Context(Sasl::ShaImplementation::Portable); },
+        Sasl::SHA256_DIGEST_SIZE / 8
+    );
+    BenchmarkHashContext(
+        "SHA-256 1 MiB (SHA Extensions)",
+        []{ return Sasl::MakeSha256Context(Sasl::ShaImplementation::ShaExtensions); },
+        Sasl::SHA256_DIGEST_SIZE / 8
+    );
+    BenchmarkScramExchange(
+        "SCRAM-SHA-1 proof (SetHashFunction Hash::Sha1)",
+        [](Sasl::Client::Scram& mech){
+            mech.SetHashFunction(Hash::Sha1, Hash::SHA1_BLOCK_SIZE, 160);
+        }
+    );
+    BenchmarkScramExchange(
+        "SCRAM-SHA-1 proof (portable)",
+        [](Sasl::Client::Scram& mech){
+            mech.SetHashContextFactory(
+                []{ return Sasl::MakeSha1Context(Sasl::ShaImplementation::Portable); },
+                Sasl::SHA1_BLOCK_SIZE,
+                Sasl::SHA1_DIGEST_SIZE
+            );
+        }
+    );
+    BenchmarkScramExchange(
+        "SCRAM-SHA-1 proof (automatic)",
+        [](Sasl::Client::Scram& mech){
+            mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+        }
+    );
+    BenchmarkScramExchange(
+        "SCRAM-SHA-256 proof (portable)",
+        [](Sasl::Client::Scram& mech){
+            mech.SetHashContextFactory(
+                []{ return Sasl::MakeSha256Context(Sasl::ShaImplementation::Portable); },
+                Sasl::SHA256_BLOCK_SIZE,
+                Sasl::SHA256_DIGEST_SIZE
+            );
+        }
+    );
+    BenchmarkScramExchange(
+        "SCRAM-SHA-256 proof (automatic)",
+        [](Sasl::Client::Scram& mech){
+            mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha256);
+        }
+    );
+}
@@ -0,0 +1,78 @@
+/**
+ * @file ServerBenchmarks.cpp
+ *
+ * This module contains the benchmarks of the server side of the
+ * mechanisms which pass passwords, and of the
+ * Sasl::Server::PasswordVerifier class they use.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Benchmark.hpp"
+
+#include <chrono>
+#include <memory>
+#include <Sasl/Server/Plain.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of iterations used to derive the stored key
+     * in the benchmarks.
+     */
+    constexpr size_t NUM_ITERATIONS = 4096;
+
+    /**
+     * Measure PLAIN exchanges on the server side, all for the same
+     * user, as from a connection pool, using the given verifier.
+     *
+     * @param[in] name
+     *     This is the name of the benchmark to report.
+     *
+     * @param[in] verifier
+     *     This is the verifier to use.
+     */
+    void BenchmarkPlainExchange(
+        const std::string& name,
+        std::shared_ptr< Sasl::Server::PasswordVerifier > verifier
+    ) {
+        Sasl::Server::Plain mech(verifier);
+        const std::string message("\0bob\0hunter2", 12);
+        Benchmark::Run(
+            name,
+            [&]{
+                mech.Reset();
+                (void)mech.Proceed(message);
+            }
+        );
+    }
+
+}
+
+void RunServerBenchmarks() {
+    const auto record = Sasl::Server::PasswordRecord::Derive(
+        "hunter2",
+        std::vector< uint8_t >{'s', 'a', 'l', 't'},
+        NUM_ITERATIONS
+    );
+    const auto lookup = [record](
+        const std::string& authenticationIdentity,
+        Sasl::Server::PasswordRecord& recordFound
+    ){
+        recordFound = record;
+        return true;
+    };
+    BenchmarkPlainExchange(
+        "Server PLAIN (4096 iterations)",
+        std::make_shared< Sasl::Server::PasswordVerifier >(lookup)
+    );
+    const auto cachingVerifier = std::make_shared< Sasl::Server::PasswordVerifier >(lookup);
+    cachingVerifier->EnableCache(1024, std::chrono::minutes(5));
+    BenchmarkPlainExchange(
+        "Server PLAIN (4096 iterations, cached)",
+        cachingVerifier
+    );
+}
@@ -0,0 +1,28 @@
+/**
+ * @file main.cpp
+ *
+ * This module holds the main() function, which is the entrypoint
+ * to the Sasl benchmarks program.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Benchmark.hpp"
+
+/**
+ * This function is the entrypoint of the program.
+ *
+ * @param[in] argc
+ *     This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *     This is the array of command-line arguments given to the program.
+ */
+int main(int argc, char* argv[]) {
+    RunBase64Benchmarks();
+    RunScramBenchmarks();
+    RunCramMd5Benchmarks();
+    RunMultiplexerBenchmarks();
+    RunServerBenchmarks();
+    return 0;
+}
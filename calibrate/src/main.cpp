@@ -0,0 +1,273 @@
+/**
+ * @file main.cpp
+ *
+ * This module holds the main() function, which is the entrypoint
+ * to the SCRAM calibration program.  It measures how fast this host
+ * derives SCRAM salted passwords, and recommends the iteration counts
+ * to give servers so that logins meet a latency target.  The results
+ * are printed as JSON.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <Sasl/Client/ScramCalibration.hpp>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This holds the options given to the program on the command line.
+     */
+    struct Options {
+        /**
+         * These are the names of the SCRAM mechanisms to calibrate.
+         */
+        std::vector< std::string > mechanisms;
+
+        /**
+         * This is the longest time 99 percent of derivations should take.
+         */
+        double latencyMilliseconds = 100.0;
+
+        /**
+         * This is the number of derivations expected to run at once.
+         */
+        size_t concurrency = 1;
+
+        /**
+         * This is the iteration count used for the measured derivations.
+         */
+        size_t probeIterations = Sasl::Client::SCRAM_MINIMUM_ITERATIONS;
+
+        /**
+         * This is the number of derivations each thread measures.
+         */
+        size_t samples = 20;
+    };
+
+    /**
+     * Print the usage of the program to the standard error stream.
+     */
+    void PrintUsage() {
+        (void)fprintf(
+            stderr,
+            (
+                "Usage: SaslCalibrate [options]\n"
+                "\n"
+                "Options:\n"
+                "  --mechanism NAME        SCRAM-SHA-1 or SCRAM-SHA-256 (may repeat;\n"
+                "                          default: both)\n"
+                "  --latency-ms N          target p99 derivation latency (default: 100)\n"
+                "  --concurrency N         derivations expected at once (default: 1)\n"
+                "  --probe-iterations N    iteration count measured (default: 4096)\n"
+                "  --samples N             derivations measured per thread (default: 20)\n"
+            )
+        );
+    }
+
+    /**
+     * Parse the given command-line arguments.
+     *
+     * @param[in] argc
+     *     This is the number of command-line arguments.
+     *
+     * @param[in] argv
+     *     This is the array of command-line arguments.
+     *
+     * @param[out] options
+     *     This is where to store the options parsed.
+     *
+     * @return
+     *     An indication of whether or not the arguments were valid
+     *     is returned.
+     */
+    bool ParseArguments(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const char* const name = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const char* const value = argv[++i];
+            char* end = nullptr;
+            if (strcmp(name, "--mechanism") == 0) {
+                options.mechanisms.push_back(value);
+            } else if (strcmp(name, "--latency-ms") == 0) {
+                options.latencyMilliseconds = strtod(value, &end);
+                if ((*end != '\0') || (options.latencyMilliseconds <= 0.0)) {
+                    return false;
+                }
+            } else {
+                const auto number = (size_t)strtoul(value, &end, 10);
+                if ((*end != '\0') || (number == 0)) {
+                    return false;
+                }
+                if (strcmp(name, "--concurrency") == 0) {
+                    options.concurrency = number;
+                } else if (strcmp(name, "--probe-iterations") == 0) {
+                    options.probeIterations = number;
+                } else if (strcmp(name, "--samples") == 0) {
+                    options.samples = number;
+                } else {
+                    return false;
+                }
+            }
+        }
+        if (options.mechanisms.empty()) {
+            options.mechanisms = {"SCRAM-SHA-1", "SCRAM-SHA-256"};
+        }
+        return true;
+    }
+
+    /**
+     * Return the SCRAM profile with the given mechanism name.
+     *
+     * @param[in] mechanism
+     *     This is the name of the mechanism.
+     *
+     * @return
+     *     The profile of the mechanism is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the mechanism isn't a built-in
+     *     variant of SCRAM.
+     */
+    std::shared_ptr< const Sasl::Client::ScramProfile > GetProfile(
+        const std::string& mechanism
+    ) {
+        if (mechanism == "SCRAM-SHA-1") {
+            return Sasl::Client::ScramProfile::Sha1();
+        } else if (mechanism == "SCRAM-SHA-256") {
+            return Sasl::Client::ScramProfile::Sha256();
+        } else {
+            return nullptr;
+        }
+    }
+
+    /**
+     * Print the given sample as a JSON object.
+     *
+     * @param[in] sample
+     *     This is the sample to print.
+     *
+     * @param[in] last
+     *     This indicates whether or not the sample is the last
+     *     in its array.
+     */
+    void PrintSample(
+        const Sasl::Client::ScramCalibrationSample& sample,
+        bool last
+    ) {
+        (void)printf(
+            (
+                "        {\"threads\": %zu, \"derivations\": %zu,"
+                " \"p50Ms\": %.3f, \"p99Ms\": %.3f,"
+                " \"iterationsPerSecond\": %.0f}%s\n"
+            ),
+            sample.threads,
+            sample.derivations,
+            sample.p50Latency.count() / 1e6,
+            sample.p99Latency.count() / 1e6,
+            sample.iterationsPerSecond,
+            (last ? "" : ",")
+        );
+    }
+
+}
+
+/**
+ * This function is the entrypoint of the program.
+ *
+ * @param[in] argc
+ *     This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *     This is the array of command-line arguments given to the program.
+ */
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+    std::vector< std::shared_ptr< const Sasl::Client::ScramProfile > > profiles;
+    for (const auto& mechanism: options.mechanisms) {
+        const auto profile = GetProfile(mechanism);
+        if (profile == nullptr) {
+            (void)fprintf(stderr, "Unknown mechanism: %s\n", mechanism.c_str());
+            return EXIT_FAILURE;
+        }
+        profiles.push_back(profile);
+    }
+
+    // Measure with 1, 2, 4, ... threads, up to the number of hardware
+    // threads, and with the concurrency given, so that the report shows
+    // how throughput scales on this host.
+    const size_t hardwareThreads = std::max(
+        (size_t)std::thread::hardware_concurrency(),
+        (size_t)1
+    );
+    std::vector< size_t > threadCounts;
+    for (size_t threads = 1; threads < hardwareThreads; threads *= 2) {
+        if (threads != options.concurrency) {
+            threadCounts.push_back(threads);
+        }
+    }
+    if (hardwareThreads != options.concurrency) {
+        threadCounts.push_back(hardwareThreads);
+    }
+    threadCounts.push_back(options.concurrency);
+    std::sort(threadCounts.begin(), threadCounts.end());
+
+    const auto target = std::chrono::nanoseconds(
+        (std::chrono::nanoseconds::rep)(options.latencyMilliseconds * 1e6)
+    );
+    (void)printf("{\n");
+    (void)printf("  \"hardwareThreads\": %zu,\n", hardwareThreads);
+    (void)printf("  \"targetP99Ms\": %.3f,\n", options.latencyMilliseconds);
+    (void)printf("  \"concurrency\": %zu,\n", options.concurrency);
+    (void)printf("  \"probeIterations\": %zu,\n", options.probeIterations);
+    (void)printf("  \"minimumIterations\": %zu,\n", Sasl::Client::SCRAM_MINIMUM_ITERATIONS);
+    (void)printf("  \"mechanisms\": [\n");
+    for (size_t i = 0; i < profiles.size(); ++i) {
+        const auto& profile = *profiles[i];
+        (void)printf("    {\n");
+        (void)printf("      \"name\": \"%s\",\n", profile.GetMechanismName().c_str());
+        (void)printf("      \"measurements\": [\n");
+        Sasl::Client::ScramCalibrationSample targetSample;
+        for (size_t j = 0; j < threadCounts.size(); ++j) {
+            const auto sample = Sasl::Client::MeasureScramDerivation(
+                profile,
+                threadCounts[j],
+                options.probeIterations,
+                options.samples
+            );
+            if (sample.threads == options.concurrency) {
+                targetSample = sample;
+            }
+            PrintSample(sample, j + 1 == threadCounts.size());
+        }
+        (void)printf("      ],\n");
+        const auto recommended = Sasl::Client::RecommendScramIterations(
+            targetSample,
+            target
+        );
+        (void)printf("      \"recommendedIterations\": %zu,\n", recommended);
+        (void)printf(
+            "      \"meetsMinimum\": %s\n",
+            ((recommended >= Sasl::Client::SCRAM_MINIMUM_ITERATIONS) ? "true" : "false")
+        );
+        (void)printf("    }%s\n", ((i + 1 == profiles.size()) ? "" : ","));
+    }
+    (void)printf("  ]\n");
+    (void)printf("}\n");
+    return EXIT_SUCCESS;
+}
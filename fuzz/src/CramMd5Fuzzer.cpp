@@ -0,0 +1,34 @@
+/**
+ * @file CramMd5Fuzzer.cpp
+ *
+ * This module contains the fuzz target which feeds messages from the
+ * server to the CRAM-MD5 client mechanism.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "FuzzTarget.hpp"
+
+#include <Sasl/Client/CramMd5.hpp>
+
+namespace {
+
+    /**
+     * Make the mechanism exercised by every run of the fuzz target.
+     *
+     * @return
+     *     The mechanism is returned.
+     */
+    Sasl::Client::CramMd5* MakeMechanism() {
+        const auto mech = new Sasl::Client::CramMd5();
+        mech->SetCredentials("tanstaaftanstaaf", "tim");
+        return mech;
+    }
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static const auto mech = MakeMechanism();
+    Fuzz::RunExchange(*mech, data, size);
+    return 0;
+}
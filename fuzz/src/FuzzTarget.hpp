@@ -0,0 +1,116 @@
+#pragma once
+
+/**
+ * @file FuzzTarget.hpp
+ *
+ * This module declares the entry point which every fuzz target defines,
+ * following the libFuzzer convention (also used by AFL++ and others),
+ * and the helpers the targets share.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+#include <Sasl/Client/Mechanism.hpp>
+#include <Sasl/Client/ScramProfile.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * Run the fuzz target once with the given input.
+ *
+ * @param[in] data
+ *     This is the input.
+ *
+ * @param[in] size
+ *     This is the size of the input, in bytes.
+ *
+ * @return
+ *     Zero is returned, as libFuzzer requires.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace Fuzz {
+
+    /**
+     * Split the given input into messages from the server, at each
+     * line feed, and hand each message to the given function in turn,
+     * so that one input can drive every step of an exchange.
+     *
+     * @param[in] data
+     *     This is the input.
+     *
+     * @param[in] size
+     *     This is the size of the input, in bytes.
+     *
+     * @param[in] handler
+     *     This is the function to call with each message.
+     */
+    template< typename Handler > void ForEachMessage(
+        const uint8_t* data,
+        size_t size,
+        Handler handler
+    ) {
+        std::string message;
+        const auto end = data + size;
+        for (auto next = data; next <= end; ++next) {
+            if (
+                (next == end)
+                || (*next == '\n')
+            ) {
+                message.assign((const char*)data, next - data);
+                handler(message);
+                data = next + 1;
+            }
+        }
+    }
+
+    /**
+     * Carry out one exchange with the given mechanism, taking the
+     * messages from the server out of the given input.  The exchange
+     * stops early if the mechanism finishes (succeeding or faulting)
+     * before the input runs out.
+     *
+     * @param[in,out] mech
+     *     This is the mechanism to exercise.  It should already have
+     *     its credentials.
+     *
+     * @param[in] data
+     *     This is the input.
+     *
+     * @param[in] size
+     *     This is the size of the input, in bytes.
+     */
+    inline void RunExchange(
+        Sasl::Client::Mechanism& mech,
+        const uint8_t* data,
+        size_t size
+    ) {
+        mech.Reset();
+        (void)mech.GetInitialResponse();
+        ForEachMessage(
+            data,
+            size,
+            [&mech](const std::string& message){
+                if (
+                    !mech.Succeeded()
+                    && !mech.Faulted()
+                ) {
+                    (void)mech.Proceed(message);
+                }
+            }
+        );
+    }
+
+    /**
+     * Return a SCRAM-SHA-1 profile whose key derivation is replaced by
+     * a cheap, deterministic stand-in, so that fuzzing isn't held up by
+     * PBKDF2, however large an iteration count the input asks for.
+     *
+     * @return
+     *     The profile with the stand-in key derivation is returned.
+     */
+    std::shared_ptr< const Sasl::Client::ScramProfile > GetStubKeyDerivationProfile();
+
+}
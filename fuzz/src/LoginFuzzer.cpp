@@ -0,0 +1,34 @@
+/**
+ * @file LoginFuzzer.cpp
+ *
+ * This module contains the fuzz target which feeds messages from the
+ * server to the LOGIN client mechanism.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "FuzzTarget.hpp"
+
+#include <Sasl/Client/Login.hpp>
+
+namespace {
+
+    /**
+     * Make the mechanism exercised by every run of the fuzz target.
+     *
+     * @return
+     *     The mechanism is returned.
+     */
+    Sasl::Client::Login* MakeMechanism() {
+        const auto mech = new Sasl::Client::Login();
+        mech->SetCredentials("hunter2", "bob");
+        return mech;
+    }
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static const auto mech = MakeMechanism();
+    Fuzz::RunExchange(*mech, data, size);
+    return 0;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file OAuthBearerFuzzer.cpp
+ *
+ * This module contains the fuzz target which feeds messages from the
+ * server to the OAUTHBEARER client mechanism.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "FuzzTarget.hpp"
+
+#include <Sasl/Client/OAuthBearer.hpp>
+
+namespace {
+
+    /**
+     * Make the mechanism exercised by every run of the fuzz target.
+     *
+     * @return
+     *     The mechanism is returned.
+     */
+    Sasl::Client::OAuthBearer* MakeMechanism() {
+        const auto mech = new Sasl::Client::OAuthBearer();
+        mech->SetCredentials("vF9dft4qmTc2Nvb3RlckBhbHRhdmlzdGEuY29tCg==", "user@example.com");
+        return mech;
+    }
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static const auto mech = MakeMechanism();
+    Fuzz::RunExchange(*mech, data, size);
+    return 0;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file PlainFuzzer.cpp
+ *
+ * This module contains the fuzz target which feeds messages from the
+ * server to the PLAIN client mechanism.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "FuzzTarget.hpp"
+
+#include <Sasl/Client/Plain.hpp>
+
+namespace {
+
+    /**
+     * Make the mechanism exercised by every run of the fuzz target.
+     *
+     * @return
+     *     The mechanism is returned.
+     */
+    Sasl::Client::Plain* MakeMechanism() {
+        const auto mech = new Sasl::Client::Plain();
+        mech->SetCredentials("hunter2", "bob");
+        return mech;
+    }
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static const auto mech = MakeMechanism();
+    Fuzz::RunExchange(*mech, data, size);
+    return 0;
+}
@@ -0,0 +1,253 @@
+/**
+ * @file ReplayMain.cpp
+ *
+ * This module contains the entry point of the fuzz targets when they
+ * aren't linked with libFuzzer.  It runs the target over each input
+ * named on the command line (files, or directories of files, such as
+ * a corpus), and reports how quickly the inputs were parsed.
+ *
+ * Because it runs a file named on the command line, it's also suitable
+ * for running the targets under AFL++ in its file input mode ("@@").
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "FuzzTarget.hpp"
+
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+    /**
+     * This contains variables set through the operating system environment
+     * or the command-line arguments.
+     */
+    struct Environment {
+        /**
+         * These are the paths of the inputs, or directories of inputs,
+         * to run.
+         */
+        std::vector< std::string > paths;
+
+        /**
+         * This is the number of times to run each input.
+         */
+        size_t rounds = 1;
+    };
+
+    /**
+     * Print to the standard error stream information about how to use
+     * this program.
+     */
+    void PrintUsageInformation() {
+        fprintf(
+            stderr,
+            (
+                "Usage: SaslFuzz<Target> [-rounds=N] PATH...\n"
+                "\n"
+                "Run the fuzz target over the given inputs, where each PATH\n"
+                "is a file holding one input or a directory of such files\n"
+                "(such as a corpus), and report the throughput.\n"
+                "\n"
+                "  -rounds=N   Run every input N times (default: 1).\n"
+            )
+        );
+    }
+
+    /**
+     * Parse the command-line arguments given to the program.
+     *
+     * @param[in] argc
+     *     This is the number of command-line arguments given to the program.
+     *
+     * @param[in] argv
+     *     This is the array of command-line arguments given to the program.
+     *
+     * @param[out] environment
+     *     This is where to store the settings given by the
+     *     command-line arguments.
+     *
+     * @return
+     *     An indication of whether or not the command-line arguments
+     *     were parsed successfully is returned.
+     */
+    bool ProcessCommandLineArguments(
+        int argc,
+        char* argv[],
+        Environment& environment
+    ) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg(argv[i]);
+            if (arg.compare(0, 8, "-rounds=") == 0) {
+                environment.rounds = (size_t)strtoul(arg.c_str() + 8, nullptr, 10);
+                if (environment.rounds == 0) {
+                    fprintf(stderr, "invalid number of rounds: %s\n", arg.c_str() + 8);
+                    return false;
+                }
+            } else if (
+                (arg.length() > 1)
+                && (arg[0] == '-')
+            ) {
+                fprintf(stderr, "unrecognized option: %s\n", arg.c_str());
+                return false;
+            } else {
+                environment.paths.push_back(arg);
+            }
+        }
+        return !environment.paths.empty();
+    }
+
+    /**
+     * Read the whole of the given file.
+     *
+     * @param[in] path
+     *     This is the path of the file to read.
+     *
+     * @param[out] contents
+     *     This is where to store the contents of the file.
+     *
+     * @return
+     *     An indication of whether or not the file was read is returned.
+     */
+    bool ReadFile(
+        const std::string& path,
+        std::vector< uint8_t >& contents
+    ) {
+        const auto file = fopen(path.c_str(), "rb");
+        if (file == NULL) {
+            return false;
+        }
+        contents.clear();
+        uint8_t buffer[4096];
+        for (;;) {
+            const auto amountRead = fread(buffer, 1, sizeof(buffer), file);
+            if (amountRead == 0) {
+                break;
+            }
+            (void)contents.insert(contents.end(), buffer, buffer + amountRead);
+        }
+        (void)fclose(file);
+        return true;
+    }
+
+    /**
+     * List the paths of the files in the given directory.
+     *
+     * @param[in] directory
+     *     This is the path of the directory.
+     *
+     * @param[out] files
+     *     This is where to add the paths of the files.
+     *
+     * @return
+     *     An indication of whether or not the path named a directory
+     *     is returned.
+     */
+    bool ListDirectory(
+        const std::string& directory,
+        std::vector< std::string >& files
+    ) {
+#ifdef _WIN32
+        WIN32_FIND_DATAA findData;
+        const auto search = FindFirstFileA((directory + "\\*").c_str(), &findData);
+        if (search == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        do {
+            if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+                files.push_back(directory + "\\" + findData.cFileName);
+            }
+        } while (FindNextFileA(search, &findData) != 0);
+        (void)FindClose(search);
+#else
+        const auto dir = opendir(directory.c_str());
+        if (dir == NULL) {
+            return false;
+        }
+        while (const auto entry = readdir(dir)) {
+            const auto path = directory + "/" + entry->d_name;
+            struct stat info;
+            if (
+                (stat(path.c_str(), &info) == 0)
+                && S_ISREG(info.st_mode)
+            ) {
+                files.push_back(path);
+            }
+        }
+        (void)closedir(dir);
+#endif
+        return true;
+    }
+
+}
+
+/**
+ * This function is the entrypoint of the program.
+ *
+ * @param[in] argc
+ *     This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *     This is the array of command-line arguments given to the program.
+ */
+int main(int argc, char* argv[]) {
+    Environment environment;
+    if (!ProcessCommandLineArguments(argc, argv, environment)) {
+        PrintUsageInformation();
+        return EXIT_FAILURE;
+    }
+
+    // Load every input up front, so that only the target is timed.
+    std::vector< std::vector< uint8_t > > inputs;
+    for (const auto& path: environment.paths) {
+        std::vector< std::string > files;
+        if (!ListDirectory(path, files)) {
+            files.push_back(path);
+        }
+        for (const auto& file: files) {
+            std::vector< uint8_t > input;
+            if (!ReadFile(file, input)) {
+                fprintf(stderr, "unable to read input: %s\n", file.c_str());
+                return EXIT_FAILURE;
+            }
+            inputs.push_back(std::move(input));
+        }
+    }
+
+    // Run the target over every input, the given number of rounds.
+    size_t execs = 0;
+    size_t bytes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < environment.rounds; ++round) {
+        for (const auto& input: inputs) {
+            (void)LLVMFuzzerTestOneInput(input.data(), input.size());
+            ++execs;
+            bytes += input.size();
+        }
+    }
+    const auto seconds = std::chrono::duration< double >(
+        std::chrono::steady_clock::now() - start
+    ).count();
+    printf(
+        "inputs: %zu, execs: %zu, seconds: %.3f, execs/s: %.0f, MB/s: %.2f\n",
+        inputs.size(),
+        execs,
+        seconds,
+        (seconds > 0.0) ? (double)execs / seconds : 0.0,
+        (seconds > 0.0) ? (double)bytes / seconds / 1e6 : 0.0
+    );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file ScramFuzzer.cpp
+ *
+ * This module contains the fuzz target which feeds messages from the
+ * server to the SCRAM client mechanism.  Each input is a
+ * server-first-message and, after a line feed, a server-final-message.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "FuzzTarget.hpp"
+
+#include <Sasl/Client/Scram.hpp>
+
+namespace {
+
+    /**
+     * Make the mechanism exercised by every run of the fuzz target.
+     *
+     * @return
+     *     The mechanism is returned.
+     */
+    Sasl::Client::Scram* MakeMechanism() {
+        const auto mech = new Sasl::Client::Scram();
+        mech->SetProfile(Fuzz::GetStubKeyDerivationProfile());
+        mech->SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+        mech->SetCredentials("pencil", "user");
+        return mech;
+    }
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static const auto mech = MakeMechanism();
+    Fuzz::RunExchange(*mech, data, size);
+    return 0;
+}
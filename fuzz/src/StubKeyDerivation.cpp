@@ -0,0 +1,44 @@
+/**
+ * @file StubKeyDerivation.cpp
+ *
+ * This module contains the implementation of the SCRAM profile with
+ * a stand-in key derivation used by the fuzz targets.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "FuzzTarget.hpp"
+
+#include <functional>
+
+namespace Fuzz {
+
+    std::shared_ptr< const Sasl::Client::ScramProfile > GetStubKeyDerivationProfile() {
+        static const auto digestLength = Sasl::Client::ScramProfile::Sha1()->GetDigestLength();
+        static const auto profile = Sasl::Client::ScramProfile::Sha1()->WithKeyDerivation(
+            [](
+                const uint8_t* password,
+                size_t passwordLength,
+                const uint8_t* salt,
+                size_t saltLength,
+                size_t iterations,
+                uint8_t* saltedPassword,
+                const std::function< bool() >& keepGoing
+            ){
+                // The stand-in derivation is too quick to be worth
+                // cancelling.
+                (void)keepGoing;
+                for (size_t i = 0; i < digestLength; ++i) {
+                    saltedPassword[i] = (uint8_t)(
+                        ((passwordLength == 0) ? 0 : password[i % passwordLength])
+                        ^ ((saltLength == 0) ? 0 : salt[i % saltLength])
+                        ^ (uint8_t)(iterations >> (8 * (i % sizeof(size_t))))
+                    );
+                }
+                return true;
+            }
+        );
+        return profile;
+    }
+
+}
@@ -0,0 +1,34 @@
+/**
+ * @file XOAuth2Fuzzer.cpp
+ *
+ * This module contains the fuzz target which feeds messages from the
+ * server to the XOAUTH2 client mechanism.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "FuzzTarget.hpp"
+
+#include <Sasl/Client/XOAuth2.hpp>
+
+namespace {
+
+    /**
+     * Make the mechanism exercised by every run of the fuzz target.
+     *
+     * @return
+     *     The mechanism is returned.
+     */
+    Sasl::Client::XOAuth2* MakeMechanism() {
+        const auto mech = new Sasl::Client::XOAuth2();
+        mech->SetCredentials("vF9dft4qmTc2Nvb3RlckBhbHRhdmlzdGEuY29tCg==", "someuser@example.com");
+        return mech;
+    }
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static const auto mech = MakeMechanism();
+    Fuzz::RunExchange(*mech, data, size);
+    return 0;
+}
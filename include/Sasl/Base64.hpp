@@ -0,0 +1,191 @@
+#pragma once
+
+/**
+ * @file Base64.hpp
+ *
+ * This module declares the Base64 encoder and decoder
+ * ([RFC 4648](https://tools.ietf.org/html/rfc4648)) built into the library,
+ * used by the mechanisms and by the framing of protocols which carry SASL
+ * messages in Base64.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <string>
+
+namespace Sasl {
+namespace Base64 {
+
+    /**
+     * This identifies the implementations available for the Base64
+     * encoder and decoder.
+     */
+    enum class Implementation {
+        /**
+         * Use the fastest implementation supported by the processor
+         * on which the program is running.
+         */
+        Automatic,
+
+        /**
+         * Use the implementation written in portable C++.
+         */
+        Portable,
+
+        /**
+         * Use the implementation based on the SSSE3 and SSE4.1 processor
+         * instructions.  If these aren't supported, the portable
+         * implementation is used instead.
+         */
+        Sse41,
+
+        /**
+         * Use the implementation based on the AVX2 processor
+         * instructions.  If these aren't supported, the portable
+         * implementation is used instead.
+         */
+        Avx2,
+    };
+
+    /**
+     * Return the number of characters in the Base64 encoding
+     * of the given number of octets, including padding.
+     *
+     * @param[in] length
+     *     This is the number of octets to encode.
+     *
+     * @return
+     *     The number of characters in the encoding is returned.
+     */
+    constexpr size_t EncodedLength(size_t length) {
+        return ((length + 2) / 3) * 4;
+    }
+
+    /**
+     * Return the largest number of octets which a Base64 encoding
+     * of the given number of characters may decode to.
+     *
+     * @param[in] length
+     *     This is the number of characters to decode.
+     *
+     * @return
+     *     The largest number of octets the encoding may decode
+     *     to is returned.
+     */
+    constexpr size_t MaxDecodedLength(size_t length) {
+        return (length / 4) * 3;
+    }
+
+    /**
+     * Return an indication of whether or not the processor on which
+     * the program is running supports the SSSE3 and SSE4.1 instructions,
+     * and the library was built with the implementation which uses them.
+     *
+     * @return
+     *     An indication of whether or not the SSE4.1 implementation
+     *     is available is returned.
+     */
+    bool IsSse41Available();
+
+    /**
+     * Return an indication of whether or not the processor on which
+     * the program is running supports the AVX2 instructions,
+     * and the library was built with the implementation which uses them.
+     *
+     * @return
+     *     An indication of whether or not the AVX2 implementation
+     *     is available is returned.
+     */
+    bool IsAvx2Available();
+
+    /**
+     * Encode the given octets in Base64, with padding.
+     *
+     * @param[in] data
+     *     This points to the octets to encode.
+     *
+     * @param[in] length
+     *     This is the number of octets to encode.
+     *
+     * @param[out] output
+     *     This is where to store the encoding.  It must have room
+     *     for at least EncodedLength(length) characters.  No null
+     *     terminator is stored.
+     *
+     * @param[in] implementation
+     *     This selects which implementation of the encoder to use.
+     *
+     * @return
+     *     The number of characters stored is returned.
+     */
+    size_t Encode(
+        const void* data,
+        size_t length,
+        char* output,
+        Implementation implementation = Implementation::Automatic
+    );
+
+    /**
+     * Decode the given padded Base64 encoding.
+     *
+     * @param[in] encoded
+     *     This points to the encoding to decode.
+     *
+     * @param[in] length
+     *     This is the number of characters to decode.
+     *
+     * @param[out] output
+     *     This is where to store the decoded octets.  It must have room
+     *     for at least MaxDecodedLength(length) octets.  If the encoding
+     *     isn't valid, some octets may be stored anyway.  It may point
+     *     to the encoding itself, to decode in place.
+     *
+     * @param[out] decodedLength
+     *     This is where to store the number of decoded octets.
+     *
+     * @param[in] implementation
+     *     This selects which implementation of the decoder to use.
+     *
+     * @return
+     *     An indication of whether or not the encoding is valid is
+     *     returned.  It isn't valid if its length isn't a multiple of four,
+     *     it contains characters outside the Base64 alphabet, or it's
+     *     padded anywhere but at the end.
+     */
+    bool Decode(
+        const char* encoded,
+        size_t length,
+        void* output,
+        size_t& decodedLength,
+        Implementation implementation = Implementation::Automatic
+    );
+
+    /**
+     * Encode the given string in Base64, with padding.
+     *
+     * @param[in] data
+     *     This is the string to encode.
+     *
+     * @return
+     *     The encoding is returned.
+     */
+    std::string Encode(const std::string& data);
+
+    /**
+     * Decode the given padded Base64 encoding.
+     *
+     * @param[in] encoded
+     *     This is the encoding to decode.
+     *
+     * @param[out] decoded
+     *     This is where to store the decoded octets.
+     *
+     * @return
+     *     An indication of whether or not the encoding is valid
+     *     is returned.
+     */
+    bool Decode(const std::string& encoded, std::string& decoded);
+
+}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * @file CancellationToken.hpp
+ *
+ * This module declares the Sasl::CancellationToken class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+
+namespace Sasl {
+
+    /**
+     * This is used to ask for work in progress, such as an authentication
+     * exchange, to be abandoned.  Copies of a token share the same state,
+     * so that one thread can cancel the work another thread is doing
+     * with a copy of the token.
+     *
+     * A default-constructed token can never be cancelled, and doesn't
+     * allocate any memory.
+     */
+    class CancellationToken {
+        // Public methods
+    public:
+        /**
+         * Make a new token which can be cancelled.
+         *
+         * @return
+         *     The new token is returned.
+         */
+        static CancellationToken Create();
+
+        /**
+         * Ask for the work using this token (or any copy of it)
+         * to be abandoned.
+         */
+        void Cancel();
+
+        /**
+         * Return an indication of whether or not the token
+         * (or any copy of it) has been cancelled.
+         *
+         * @return
+         *     An indication of whether or not the token
+         *     has been cancelled is returned.
+         */
+        bool IsCancelled() const;
+
+        /**
+         * Return an indication of whether or not the token
+         * is able to be cancelled.
+         *
+         * @return
+         *     An indication of whether or not the token
+         *     is able to be cancelled is returned.
+         */
+        bool CanBeCancelled() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the state
+         * shared by all copies of a token.
+         */
+        struct State;
+
+        /**
+         * This contains the state shared by all copies of the token.
+         */
+        std::shared_ptr< State > state_;
+    };
+
+}
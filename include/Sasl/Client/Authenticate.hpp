@@ -0,0 +1,559 @@
+#pragma once
+
+/**
+ * @file Authenticate.hpp
+ *
+ * This module declares the Sasl::Client::Authenticate coroutine and
+ * the types it uses.  It is only available when compiled as C++20
+ * (or later) with coroutine support; otherwise it declares nothing.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_concepts) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define SASL_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef SASL_HAS_COROUTINES
+
+#include "Mechanism.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <new>
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This represents the common interface to anything which provides
+     * the memory for coroutine frames, such as a pool.
+     */
+    class FrameAllocator {
+        // Lifecycle management
+    public:
+        virtual ~FrameAllocator() = default;
+
+        // Methods
+    public:
+        /**
+         * Return the allocator which uses the global operator new
+         * and operator delete.
+         *
+         * @return
+         *     The allocator which uses the global operator new
+         *     and operator delete is returned.
+         */
+        static FrameAllocator& Default();
+
+        /**
+         * Provide memory for a coroutine frame.
+         *
+         * @param[in] size
+         *     This is the number of bytes needed.
+         *
+         * @return
+         *     The memory, aligned suitably for any fundamental type,
+         *     is returned.
+         */
+        virtual void* Allocate(size_t size) = 0;
+
+        /**
+         * Take back memory provided for a coroutine frame.
+         *
+         * @param[in] memory
+         *     This is the memory which was provided for the frame.
+         *
+         * @param[in] size
+         *     This is the number of bytes which were asked for.
+         */
+        virtual void Deallocate(void* memory, size_t size) = 0;
+    };
+
+    /**
+     * This is the allocator which uses the global operator new
+     * and operator delete.
+     */
+    class GlobalFrameAllocator
+        : public FrameAllocator
+    {
+        // FrameAllocator
+    public:
+        virtual void* Allocate(size_t size) override {
+            return ::operator new(size);
+        }
+
+        virtual void Deallocate(void* memory, size_t size) override {
+            ::operator delete(memory, size);
+        }
+    };
+
+    inline FrameAllocator& FrameAllocator::Default() {
+        static GlobalFrameAllocator allocator;
+        return allocator;
+    }
+
+    /**
+     * This is the base of coroutine promise types whose frames
+     * are provided by a FrameAllocator.  The allocator is given to the
+     * coroutine as a pair of leading arguments,
+     * (std::allocator_arg, allocator); otherwise the default allocator
+     * is used.  A pointer to the allocator is kept at the end of the
+     * frame so that the frame can be given back to it.
+     */
+    class FrameAllocation {
+        // Public methods
+    public:
+        static void* operator new(size_t size) {
+            return Allocate(size, FrameAllocator::Default());
+        }
+
+        template< typename... Args > static void* operator new(
+            size_t size,
+            std::allocator_arg_t,
+            FrameAllocator& allocator,
+            Args&&...
+        ) {
+            return Allocate(size, allocator);
+        }
+
+        static void operator delete(void* frame, size_t size) {
+            const auto allocatorOffset = AllocatorOffset(size);
+            FrameAllocator* allocator;
+            (void)memcpy(&allocator, (char*)frame + allocatorOffset, sizeof(allocator));
+            allocator->Deallocate(frame, allocatorOffset + sizeof(allocator));
+        }
+
+        // Private methods
+    private:
+        /**
+         * Return where, in a frame of the given size, to keep the pointer
+         * to the frame's allocator.
+         *
+         * @param[in] size
+         *     This is the size of the frame, not counting the pointer
+         *     to the allocator.
+         *
+         * @return
+         *     The offset, in bytes, from the start of the frame to
+         *     the pointer to the frame's allocator is returned.
+         */
+        static size_t AllocatorOffset(size_t size) {
+            constexpr auto alignment = alignof(FrameAllocator*);
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        /**
+         * Get memory for a frame of the given size from the given
+         * allocator, and keep a pointer to the allocator at the end
+         * of the frame.
+         *
+         * @param[in] size
+         *     This is the size of the frame.
+         *
+         * @param[in] allocator
+         *     This is the allocator from which to get the memory.
+         *
+         * @return
+         *     The memory for the frame is returned.
+         */
+        static void* Allocate(size_t size, FrameAllocator& allocator) {
+            const auto allocatorOffset = AllocatorOffset(size);
+            const auto frame = allocator.Allocate(allocatorOffset + sizeof(FrameAllocator*));
+            const auto allocatorAddress = &allocator;
+            (void)memcpy((char*)frame + allocatorOffset, &allocatorAddress, sizeof(allocatorAddress));
+            return frame;
+        }
+    };
+
+    /**
+     * This is the type of coroutine which computes a value of the given
+     * type.  It doesn't start running until it's awaited or started.
+     *
+     * @tparam T
+     *     This is the type of value computed by the coroutine.
+     */
+    template< typename T > class Task {
+        // Types
+    public:
+        /**
+         * This is the promise type of the coroutine.
+         */
+        struct promise_type
+            : public FrameAllocation
+        {
+            // Properties
+
+            /**
+             * This is the value computed by the coroutine.
+             */
+            T value;
+
+            /**
+             * If the coroutine ended with an exception,
+             * this holds the exception.
+             */
+            std::exception_ptr exception;
+
+            /**
+             * This is the coroutine to resume when the coroutine ends.
+             */
+            std::coroutine_handle<> continuation;
+
+            // Methods
+
+            /**
+             * This awaits the end of the coroutine, continuing with
+             * whatever coroutine awaited it.
+             */
+            struct FinalAwaiter {
+                bool await_ready() noexcept {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(
+                    std::coroutine_handle< promise_type > handle
+                ) noexcept {
+                    const auto continuation = handle.promise().continuation;
+                    if (continuation) {
+                        return continuation;
+                    } else {
+                        return std::noop_coroutine();
+                    }
+                }
+
+                void await_resume() noexcept {
+                }
+            };
+
+            Task get_return_object() {
+                return Task(std::coroutine_handle< promise_type >::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept {
+                return {};
+            }
+
+            FinalAwaiter final_suspend() noexcept {
+                return {};
+            }
+
+            void return_value(T newValue) {
+                value = std::move(newValue);
+            }
+
+            void unhandled_exception() {
+                exception = std::current_exception();
+            }
+        };
+
+        /**
+         * This awaits the end of the coroutine, starting it first.
+         */
+        struct Awaiter {
+            std::coroutine_handle< promise_type > handle;
+
+            bool await_ready() noexcept {
+                return handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<> awaitingCoroutine
+            ) noexcept {
+                handle.promise().continuation = awaitingCoroutine;
+                return handle;
+            }
+
+            T await_resume() {
+                if (handle.promise().exception) {
+                    std::rethrow_exception(handle.promise().exception);
+                }
+                return std::move(handle.promise().value);
+            }
+        };
+
+        // Lifecycle management
+    public:
+        ~Task() noexcept {
+            if (handle_) {
+                handle_.destroy();
+            }
+        }
+        Task(const Task&) = delete;
+        Task(Task&& other) noexcept
+            : handle_(std::exchange(other.handle_, nullptr))
+        {
+        }
+        Task& operator=(const Task&) = delete;
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (handle_) {
+                    handle_.destroy();
+                }
+                handle_ = std::exchange(other.handle_, nullptr);
+            }
+            return *this;
+        }
+
+        // Public methods
+    public:
+        /**
+         * Await the end of the coroutine, starting it first.
+         *
+         * @return
+         *     An object which awaits the end of the coroutine is returned.
+         */
+        Awaiter operator co_await() && noexcept {
+            return Awaiter{handle_};
+        }
+
+        /**
+         * Start the coroutine without awaiting it.  This is for callers
+         * which aren't coroutines themselves.  The coroutine runs until
+         * it first suspends (or ends).
+         */
+        void Start() {
+            if (
+                handle_
+                && !handle_.done()
+            ) {
+                handle_.resume();
+            }
+        }
+
+        /**
+         * Return an indication of whether or not the coroutine has ended.
+         *
+         * @return
+         *     An indication of whether or not the coroutine has ended
+         *     is returned.
+         */
+        bool IsDone() const {
+            return (
+                handle_
+                && handle_.done()
+            );
+        }
+
+        /**
+         * Return the value computed by the coroutine, which must have
+         * ended.  If the coroutine ended with an exception, the
+         * exception is thrown instead.
+         *
+         * @return
+         *     The value computed by the coroutine is returned.
+         */
+        T GetResult() {
+            return Awaiter{handle_}.await_resume();
+        }
+
+        // Private methods
+    private:
+        /**
+         * This constructor is used by the promise to make the task
+         * which refers to the coroutine.
+         *
+         * @param[in] handle
+         *     This refers to the coroutine.
+         */
+        explicit Task(std::coroutine_handle< promise_type > handle)
+            : handle_(handle)
+        {
+        }
+
+        // Private properties
+    private:
+        /**
+         * This refers to the coroutine.
+         */
+        std::coroutine_handle< promise_type > handle_;
+    };
+
+    /**
+     * This is the requirement for a transport over which the Authenticate
+     * coroutine carries out an exchange.  The transport is responsible for
+     * any framing used by the application protocol.
+     *
+     * - transport.Send(message) returns an awaitable which sends the given
+     *   message to the server.  The first message sent is the initial
+     *   response, which is empty if the mechanism doesn't send one.
+     * - transport.Receive(message) returns an awaitable which stores the
+     *   next message from the server in the given string, and results
+     *   in true, or results in false if the server ended the exchange.
+     */
+    template< typename T > concept Transport = requires(
+        T& transport,
+        const std::string& messageToSend,
+        std::string& messageReceived
+    ) {
+        transport.Send(messageToSend);
+        transport.Receive(messageReceived);
+    };
+
+    /**
+     * This is the requirement for an executor on which the Authenticate
+     * coroutine may call Mechanism::Proceed, which for some mechanisms
+     * (such as SCRAM) is expensive.  The executor is called with the
+     * coroutine to resume, and it arranges for it to be resumed, for
+     * example on a worker thread.
+     */
+    template< typename T > concept Executor = requires(
+        T& executor,
+        std::coroutine_handle<> coroutine
+    ) {
+        executor(coroutine);
+    };
+
+    /**
+     * This is the executor which resumes coroutines where they are,
+     * without suspending them.
+     */
+    struct InlineExecutor {
+        void operator()(std::coroutine_handle<> coroutine) const {
+            coroutine.resume();
+        }
+    };
+
+    /**
+     * This holds the outcome of an authentication exchange.
+     */
+    struct AuthenticationOutcome {
+        /**
+         * This indicates whether or not the mechanism determined
+         * that the exchange succeeded.
+         */
+        bool succeeded = false;
+
+        /**
+         * This indicates whether or not the mechanism determined
+         * that the server gave an unexpected response/challenge.
+         */
+        bool faulted = false;
+    };
+
+    /**
+     * Carry out a complete authentication exchange with the given
+     * mechanism over the given transport, with the coroutine frame
+     * provided by the given allocator.
+     *
+     * @param[in] allocator
+     *     This provides the memory for the coroutine frame.
+     *
+     * @param[in,out] mechanism
+     *     This is the mechanism to use, which should already have
+     *     its credentials set.
+     *
+     * @param[in,out] transport
+     *     This is used to send messages to, and receive messages from,
+     *     the server.
+     *
+     * @param[in] executor
+     *     This is used to resume the coroutine before each call to
+     *     Mechanism::Proceed, so that expensive steps can be carried out
+     *     elsewhere, such as on a worker thread.  The coroutine then
+     *     continues wherever it was resumed, until the transport
+     *     resumes it.
+     *
+     * @return
+     *     The outcome of the exchange is returned.
+     */
+    template<
+        Transport TransportType,
+        Executor ExecutorType = InlineExecutor
+    > Task< AuthenticationOutcome > Authenticate(
+        std::allocator_arg_t,
+        FrameAllocator& allocator,
+        Mechanism& mechanism,
+        TransportType& transport,
+        ExecutorType executor = ExecutorType()
+    ) {
+        struct ResumeOnExecutor {
+            ExecutorType& executor;
+
+            bool await_ready() noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> coroutine) {
+                executor(coroutine);
+            }
+
+            void await_resume() noexcept {
+            }
+        };
+        // The allocator is only used by the promise type,
+        // to provide the coroutine frame.
+        (void)allocator;
+        co_await transport.Send(mechanism.GetInitialResponse());
+        std::string challenge;
+        while (co_await transport.Receive(challenge)) {
+            if constexpr (!std::is_same< ExecutorType, InlineExecutor >::value) {
+                co_await ResumeOnExecutor{executor};
+            }
+            const auto response = mechanism.Proceed(challenge);
+            if (
+                (
+                    response.empty()
+                    && !mechanism.ResponsePending()
+                )
+                || mechanism.Faulted()
+            ) {
+                break;
+            }
+            co_await transport.Send(response);
+        }
+        AuthenticationOutcome outcome;
+        outcome.succeeded = mechanism.Succeeded();
+        outcome.faulted = mechanism.Faulted();
+        co_return outcome;
+    }
+
+    /**
+     * Carry out a complete authentication exchange with the given
+     * mechanism over the given transport.
+     *
+     * @param[in,out] mechanism
+     *     This is the mechanism to use, which should already have
+     *     its credentials set.
+     *
+     * @param[in,out] transport
+     *     This is used to send messages to, and receive messages from,
+     *     the server.
+     *
+     * @param[in] executor
+     *     This is used to resume the coroutine before each call to
+     *     Mechanism::Proceed, so that expensive steps can be carried out
+     *     elsewhere, such as on a worker thread.
+     *
+     * @return
+     *     The outcome of the exchange is returned.
+     */
+    template<
+        Transport TransportType,
+        Executor ExecutorType = InlineExecutor
+    > Task< AuthenticationOutcome > Authenticate(
+        Mechanism& mechanism,
+        TransportType& transport,
+        ExecutorType executor = ExecutorType()
+    ) {
+        return Authenticate(
+            std::allocator_arg,
+            FrameAllocator::Default(),
+            mechanism,
+            transport,
+            std::move(executor)
+        );
+    }
+
+}
+}
+
+#endif /* SASL_HAS_COROUTINES */
@@ -0,0 +1,185 @@
+#pragma once
+
+/**
+ * @file BearerCredentials.hpp
+ *
+ * This module declares the Sasl::Client::BearerCredentials class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This holds an OAuth 2.0 bearer token along with the identity to use
+     * with it, and the messages built from them which are sent by the
+     * OAUTHBEARER and XOAUTH2 mechanisms.
+     *
+     * The messages are built only when the token is set, and published
+     * together as one immutable snapshot, so one set of credentials may
+     * be shared by any number of mechanism instances, on any number of
+     * threads.  Refreshing the token swaps in a new snapshot atomically;
+     * each mechanism picks up the latest snapshot when it starts an
+     * exchange, and keeps using the one it picked up until the exchange
+     * is over.
+     *
+     * Publishing and picking up a snapshot aren't lock-free: both lock
+     * a mutex, held only long enough to replace or copy the pointer to
+     * the snapshot (and so adjust its reference count).  The messages
+     * are built, and old snapshots let go, without the mutex held.
+     */
+    class BearerCredentials {
+        // Types
+    public:
+        /**
+         * This is one snapshot of the messages built from the credentials.
+         */
+        struct Payloads {
+            /**
+             * This is the message which passes the token to the server
+             * in the OAUTHBEARER mechanism
+             * ([RFC 7628](https://tools.ietf.org/html/rfc7628)).
+             */
+            std::string oauthBearerMessage;
+
+            /**
+             * This is the line to publish to diagnostics when the
+             * OAUTHBEARER mechanism passes the token to the server.
+             * The token is masked.
+             */
+            std::string oauthBearerDiagnosticMessage;
+
+            /**
+             * This is the message which passes the token to the server
+             * in the XOAUTH2 mechanism.
+             */
+            std::string xoauth2Message;
+
+            /**
+             * This is the line to publish to diagnostics when the
+             * XOAUTH2 mechanism passes the token to the server.
+             * The token is masked.
+             */
+            std::string xoauth2DiagnosticMessage;
+
+            /**
+             * This counts the tokens set in the credentials, starting
+             * with 1 for the token given when they were made.
+             */
+            uint64_t generation = 0;
+
+            // Lifecycle management
+
+            /**
+             * This wipes the messages which pass the token to the server,
+             * so that the token doesn't linger in memory once the last
+             * holder of the snapshot lets it go, whether it's replaced
+             * by a newer snapshot, released by a mechanism, or thrown
+             * away by a snapshot restore which failed.
+             */
+            ~Payloads() noexcept;
+            Payloads() = default;
+            Payloads(const Payloads&) = default;
+            Payloads(Payloads&&) = default;
+            Payloads& operator=(const Payloads&) = default;
+            Payloads& operator=(Payloads&&) = default;
+        };
+
+        // Lifecycle management
+    public:
+        ~BearerCredentials() noexcept;
+        BearerCredentials(const BearerCredentials&) = delete;
+        BearerCredentials(BearerCredentials&&) = delete;
+        BearerCredentials& operator=(const BearerCredentials&) = delete;
+        BearerCredentials& operator=(BearerCredentials&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * Make a new set of credentials.
+         *
+         * @param[in] token
+         *     This is the bearer token to use in the authentication.
+         *
+         * @param[in] user
+         *     This is the identity of the user on whose behalf the token
+         *     was issued.
+         *
+         * @param[in] host
+         *     This is the name of the server, which OAUTHBEARER passes
+         *     along, if not empty.
+         *
+         * @param[in] port
+         *     This is the port of the server, which OAUTHBEARER passes
+         *     along, if not zero.
+         *
+         * @return
+         *     The new credentials are returned.
+         */
+        static std::shared_ptr< BearerCredentials > Create(
+            const std::string& token,
+            const std::string& user,
+            const std::string& host = "",
+            uint16_t port = 0
+        );
+
+        /**
+         * Replace the token, building and publishing a new snapshot of
+         * the messages.  This may be called while other threads are
+         * using the credentials, or refreshing them too, in which case
+         * the token of the last call to begin is the one kept.
+         *
+         * @param[in] token
+         *     This is the new bearer token to use in the authentication.
+         */
+        void Refresh(const std::string& token);
+
+        /**
+         * Return the latest snapshot of the messages built from the
+         * credentials.
+         *
+         * @return
+         *     The latest snapshot of the messages built from the
+         *     credentials is returned.
+         */
+        std::shared_ptr< const Payloads > GetPayloads() const;
+
+        /**
+         * Return the identity of the user on whose behalf the token
+         * was issued.
+         *
+         * @return
+         *     The identity of the user on whose behalf the token
+         *     was issued is returned.
+         */
+        const std::string& GetUser() const;
+
+        // Private methods
+    private:
+        /**
+         * This is the default constructor, used only by Create.
+         */
+        BearerCredentials();
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
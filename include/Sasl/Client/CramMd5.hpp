@@ -0,0 +1,113 @@
+#pragma once
+
+/**
+ * @file CramMd5.hpp
+ *
+ * This module declares the Sasl::Client::CramMd5 class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Mechanism.hpp"
+
+#include <cstddef>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This class implements the CRAM-MD5 SASL
+     * ([RFC 2195](https://tools.ietf.org/html/rfc2195))
+     * mechanism, for servers which offer nothing better.
+     *
+     * The HMAC-MD5 states after absorbing the inner and outer padded
+     * passwords are computed once, when the credentials are set, so
+     * answering a challenge costs only the compressions of the challenge
+     * and of the inner digest.  The password itself isn't kept.
+     *
+     * The mechanism has no way to convey an authorization identity,
+     * so any given with the credentials is ignored.
+     */
+    class CramMd5
+        : public Mechanism
+    {
+        // Lifecycle management
+    public:
+        ~CramMd5() noexcept;
+        CramMd5(const CramMd5&) = delete;
+        CramMd5(CramMd5&&) noexcept;
+        CramMd5& operator=(const CramMd5&) = delete;
+        CramMd5& operator=(CramMd5&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the default constructor.
+         */
+        CramMd5();
+
+        // Mechanism
+    public:
+        virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
+            SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+            size_t minLevel = 0
+        ) override;
+        virtual void Reset() override;
+        virtual void SetInitialResponseMode(
+            InitialResponseMode initialResponseMode
+        ) override;
+        virtual RoundTripProfile GetRoundTripProfile() override;
+        virtual void SetCancellationToken(
+            const CancellationToken& cancellationToken
+        ) override;
+        virtual void SetDeadline(
+            std::chrono::steady_clock::time_point deadline
+        ) override;
+        virtual void SetCredentials(
+            const std::string& credentials,
+            const std::string& authenticationIdentity,
+            const std::string& authorizationIdentity = ""
+        ) override;
+        virtual std::string GetInitialResponse() override;
+        virtual std::string Proceed(const std::string& message) override;
+        virtual bool Succeeded() override;
+        virtual bool Faulted() override;
+        virtual bool Snapshot(
+            std::string& snapshot,
+            SnapshotCredentials credentials = SnapshotCredentials::Exclude
+        ) override;
+        virtual bool Restore(const std::string& snapshot) override;
+        virtual void Release() override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This is the number of bytes reserved inside each instance
+         * to store its private properties.  It's fixed here, rather than
+         * derived from the structure, so that the structure may change
+         * without changing the size of instances.
+         */
+        static constexpr size_t IMPL_STORAGE_SIZE = 192;
+
+        /**
+         * This is where the private properties of the instance are stored,
+         * so that making or moving an instance doesn't allocate memory.
+         */
+        alignas(std::max_align_t) unsigned char implStorage_[IMPL_STORAGE_SIZE];
+
+        /**
+         * This points to the private properties of the instance,
+         * which are stored in implStorage_.
+         */
+        Impl* impl_;
+    };
+
+}
+}
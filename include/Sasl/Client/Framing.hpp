@@ -0,0 +1,203 @@
+#pragma once
+
+/**
+ * @file Framing.hpp
+ *
+ * This module declares the Sasl::Client::Framing class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Mechanism.hpp"
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This class carries a client-side authentication exchange over
+     * an application protocol, taking care of the protocol's framing
+     * and Base64 encoding of the mechanism's messages.  Server lines are
+     * decoded in place, in the buffer in which they were received, and
+     * client lines are encoded straight into the buffer from which they
+     * will be sent.
+     *
+     * The following protocols are supported:
+     * - SMTP ([RFC 4954](https://tools.ietf.org/html/rfc4954)):
+     *   "AUTH" command, "334" challenges, "235" success.
+     * - IMAP ([RFC 3501](https://tools.ietf.org/html/rfc3501)
+     *   and [RFC 4959](https://tools.ietf.org/html/rfc4959)):
+     *   "AUTHENTICATE" command, "+" challenges, tagged "OK" success.
+     * - XMPP ([RFC 6120](https://tools.ietf.org/html/rfc6120)):
+     *   "auth", "challenge", "response", and "success" elements.
+     */
+    class Framing {
+        // Types
+    public:
+        /**
+         * This identifies the application protocol over which
+         * the exchange is carried.
+         */
+        enum class Protocol {
+            Smtp,
+            Imap,
+            Xmpp,
+        };
+
+        /**
+         * This is the result of giving the adapter a line from the server.
+         */
+        enum class Status {
+            /**
+             * The line was a challenge, and the client's response
+             * has been written, to be sent to the server.
+             */
+            Continue,
+
+            /**
+             * The server reported that authentication succeeded.
+             * Mechanisms which authenticate the server (such as SCRAM)
+             * also report this through Mechanism::Succeeded.
+             */
+            Succeeded,
+
+            /**
+             * The server reported that authentication failed.
+             */
+            Failed,
+
+            /**
+             * The mechanism faulted, or the server reported success
+             * without the mechanism having verified the server (see
+             * RoundTripProfile::verifiesServer).  If the exchange wasn't
+             * over, a message cancelling it has been written, to be sent
+             * to the server.
+             */
+            Faulted,
+
+            /**
+             * The line wasn't understood, or its payload wasn't valid
+             * Base64.  A message cancelling the exchange has been written,
+             * to be sent to the server.
+             */
+            Malformed,
+
+            /**
+             * The line didn't concern the exchange (such as an untagged
+             * IMAP response or a continued SMTP reply), or the exchange
+             * was already over, so nothing was done.
+             */
+            Ignored,
+        };
+
+        // Lifecycle management
+    public:
+        ~Framing() noexcept;
+        Framing(const Framing&) = delete;
+        Framing(Framing&&) noexcept;
+        Framing& operator=(const Framing&) = delete;
+        Framing& operator=(Framing&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructor sets up the adapter for the given protocol.
+         *
+         * @param[in] protocol
+         *     This is the application protocol over which
+         *     the exchange is carried.
+         */
+        explicit Framing(Protocol protocol);
+
+        /**
+         * Set the tag which the client uses for the IMAP "AUTHENTICATE"
+         * command, and which identifies the server's completion of it.
+         * The default is "A1".  This is only used for IMAP.
+         *
+         * @param[in] tag
+         *     This is the tag to use for the command.
+         */
+        void SetImapTag(const std::string& tag);
+
+        /**
+         * Set whether or not the server supports initial responses.
+         * They're supported by default.  For IMAP, servers only support
+         * them if they advertise the "SASL-IR" capability.  If they're not
+         * supported, the mechanism is set to InitialResponseMode::Never
+         * when the exchange begins.
+         *
+         * @param[in] supported
+         *     This indicates whether or not the server supports
+         *     initial responses.
+         */
+        void SetInitialResponseSupported(bool supported);
+
+        /**
+         * Begin an exchange using the given mechanism, which should
+         * already have its credentials set, by writing the command which
+         * requests authentication, along with any initial response.
+         *
+         * @param[in,out] mechanism
+         *     This is the mechanism to use in the exchange.  It must
+         *     remain valid until the exchange is over.
+         *
+         * @param[in] mechanismName
+         *     This is the name of the mechanism, as advertised
+         *     by the server.
+         *
+         * @param[in,out] output
+         *     This is the buffer of data to send to the server.
+         *     The command is appended to it.
+         */
+        void Begin(
+            Mechanism& mechanism,
+            const std::string& mechanismName,
+            std::string& output
+        );
+
+        /**
+         * Give the adapter the next line (or, for XMPP, element) received
+         * from the server, advancing the exchange, and write any message
+         * to send back.
+         *
+         * @param[in,out] line
+         *     This points to the line received from the server, with or
+         *     without its line ending.  Its payload is decoded in place,
+         *     so its contents are overwritten.
+         *
+         * @param[in] length
+         *     This is the number of characters in the line.
+         *
+         * @param[in,out] output
+         *     This is the buffer of data to send to the server.
+         *     Any message to send is appended to it.
+         *
+         * @return
+         *     What came of the line is returned.
+         */
+        Status Receive(
+            char* line,
+            size_t length,
+            std::string& output
+        );
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+/**
+ * @file KeyCacheClient.hpp
+ *
+ * This module declares the Sasl::Client::KeyCacheClient class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "ScramProfile.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This is how long a key cache client waits for the daemon to answer
+     * before giving up on it and deriving the key itself.
+     */
+    constexpr std::chrono::milliseconds KEY_CACHE_TIMEOUT(100);
+
+    /**
+     * This is how long a key cache client waits, after failing to reach
+     * the daemon, before trying again.  Until then, keys are derived
+     * without asking the daemon.
+     */
+    constexpr std::chrono::milliseconds KEY_CACHE_RETRY_INTERVAL(1000);
+
+    /**
+     * This is the greatest number of lookups a key cache client sends
+     * to the daemon in one request.
+     */
+    constexpr size_t KEY_CACHE_MAX_BATCH = 64;
+
+    /**
+     * This is the greatest number of derived keys a key cache client
+     * holds while waiting to send them to the daemon.  Beyond these,
+     * derived keys aren't sent.
+     */
+    constexpr size_t KEY_CACHE_MAX_PENDING_STORES = 256;
+
+    /**
+     * This is the number of bytes in the secret which keys the
+     * fingerprints of passwords sent to the key cache daemon.
+     * A key cache client given a shorter secret doesn't use the daemon.
+     */
+    constexpr size_t KEY_CACHE_SECRET_LENGTH = 32;
+
+    /**
+     * This is the name of the file in the user's runtime directory
+     * which normally holds the key cache secret.
+     */
+    constexpr const char* KEY_CACHE_SECRET_NAME = "SaslKeyCache.key";
+
+    /**
+     * Read the secret which keys the fingerprints of passwords sent to
+     * the key cache daemon from the file at the given path, first making
+     * the file, with a new random secret, if there isn't one.
+     *
+     * The processes sharing salted passwords through the daemon must
+     * share this secret, and the daemon must not have it, so that what
+     * the daemon holds can't be used to check guesses of the passwords.
+     * The file must belong to the user running the process, and be
+     * closed to everyone else.
+     *
+     * @param[in] path
+     *     This is the path of the file holding the secret.
+     *
+     * @param[out] secret
+     *     This is where to store the secret, which has
+     *     KEY_CACHE_SECRET_LENGTH bytes.
+     *
+     * @return
+     *     An indication of whether or not the secret was read is
+     *     returned.  It's always false on platforms without
+     *     Unix-domain sockets.
+     */
+    bool ReadKeyCacheSecret(const std::string& path, std::string& secret);
+
+    /**
+     * This connects SCRAM key derivation to the key cache daemon
+     * (Sasl::KeyCache::Daemon) shared by the processes on a host, over
+     * a Unix-domain socket.  Before deriving a salted password, the
+     * derivation asks the daemon for it, by the mechanism, salt,
+     * iteration count, and a fingerprint of the password, and after
+     * deriving one, passes it along to the daemon for other processes
+     * to use.  The fingerprint is keyed with a secret which the daemon
+     * doesn't have (see ReadKeyCacheSecret), so that the keys held by
+     * the daemon can't be used to check guesses of passwords.  The
+     * salted passwords themselves are as good as the passwords for
+     * authenticating with SCRAM, so the client only sends them to a
+     * daemon running as the same user.
+     *
+     * Lookups made by many threads at once are sent to the daemon
+     * together, in one request.  If the daemon can't be reached, doesn't
+     * run as the same user as the client, or doesn't answer in time,
+     * keys are derived locally as they would be without the cache, and
+     * the daemon isn't asked again for a while.
+     */
+    class KeyCacheClient {
+        // Types
+    public:
+        /**
+         * This holds statistics about the use of a key cache client.
+         */
+        struct Stats {
+            /**
+             * This is the number of salted passwords found in the cache.
+             */
+            uint64_t hits = 0;
+
+            /**
+             * This is the number of salted passwords not found in the
+             * cache, and so derived locally.
+             */
+            uint64_t misses = 0;
+
+            /**
+             * This is the number of salted passwords derived locally
+             * because the daemon couldn't be reached.
+             */
+            uint64_t unavailable = 0;
+
+            /**
+             * This is the number of salted passwords passed along
+             * to the daemon.
+             */
+            uint64_t stores = 0;
+        };
+
+        // Lifecycle management
+    public:
+        ~KeyCacheClient() noexcept;
+        KeyCacheClient(const KeyCacheClient&) = delete;
+        KeyCacheClient(KeyCacheClient&&) noexcept;
+        KeyCacheClient& operator=(const KeyCacheClient&) = delete;
+        KeyCacheClient& operator=(KeyCacheClient&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructor sets up the client to use the daemon serving
+         * the given socket.  The daemon isn't contacted until the first
+         * key is derived.
+         *
+         * @param[in] socketPath
+         *     This is the path of the Unix-domain socket on which the
+         *     daemon serves clients, normally the one returned by
+         *     Sasl::KeyCache::GetDefaultSocketPath.
+         *
+         * @param[in] secret
+         *     This is the secret with which to key the fingerprints
+         *     of passwords, shared by the processes using the daemon
+         *     but not given to the daemon.  If it's shorter than
+         *     KEY_CACHE_SECRET_LENGTH, the daemon isn't used.
+         *
+         * @param[in] timeout
+         *     This is how long to wait for the daemon to answer before
+         *     giving up on it.
+         */
+        KeyCacheClient(
+            const std::string& socketPath,
+            const std::string& secret,
+            std::chrono::milliseconds timeout = KEY_CACHE_TIMEOUT
+        );
+
+        /**
+         * Make a new profile which is the same as the given one, except
+         * that salted passwords are looked up in the cache before they're
+         * derived, and passed along to the cache after.  The profile
+         * keeps the client's connection to the daemon open for as long
+         * as it's in use.
+         *
+         * @param[in] profile
+         *     This is the profile to which to attach the cache.  If it
+         *     has its own key derivation, it's used for salted passwords
+         *     not found in the cache.
+         *
+         * @return
+         *     The new profile is returned.
+         */
+        std::shared_ptr< const ScramProfile > Attach(
+            std::shared_ptr< const ScramProfile > profile
+        ) const;
+
+        /**
+         * Return statistics about the use of the client.
+         *
+         * @return
+         *     Statistics about the use of the client are returned.
+         */
+        Stats GetStats() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.  They're
+         * shared with the key derivations of the profiles to which the
+         * client is attached.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
+}
@@ -8,6 +8,9 @@
  * © 2019 by Richard Walters
  */
 
+#include "../CancellationToken.hpp"
+
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
@@ -16,11 +19,96 @@
 namespace Sasl {
 namespace Client {
 
+    /**
+     * This selects whether or not a mechanism sends its first message
+     * as an initial response in the authentication request
+     * ([RFC 4422](https://tools.ietf.org/html/rfc4422) section 3.3),
+     * saving a round trip.
+     */
+    enum class InitialResponseMode {
+        /**
+         * The mechanism sends an initial response if the mechanism's
+         * specification provides for one.  This is the default.
+         */
+        Auto,
+
+        /**
+         * The mechanism always sends an initial response, even if the
+         * mechanism's specification doesn't provide for one (e.g. LOGIN
+         * sends the username up front, which many servers accept).
+         */
+        Always,
+
+        /**
+         * The mechanism never sends an initial response, and instead
+         * sends its first message in reply to the server's first
+         * (empty) challenge.
+         */
+        Never,
+    };
+
+    /**
+     * This describes how many messages an authentication exchange takes
+     * with a mechanism, so that protocol drivers can plan for the fewest
+     * round trips.
+     */
+    struct RoundTripProfile {
+        /**
+         * This indicates whether or not the mechanism will send an
+         * initial response in the authentication request.
+         */
+        bool sendsInitialResponse = false;
+
+        /**
+         * This is the number of messages the client sends, including
+         * the authentication request, if the exchange succeeds.  Each
+         * is answered by the server, so this is also the number of
+         * round trips, assuming the server's final message (if any)
+         * comes along with its outcome.
+         */
+        unsigned int roundTrips = 0;
+
+        /**
+         * This indicates whether or not the mechanism verifies the
+         * server, from the server's final message, before reporting
+         * success (as SCRAM does).  A server reporting success without
+         * having sent that message hasn't been verified.
+         */
+        bool verifiesServer = false;
+    };
+
+    /**
+     * This selects whether or not a snapshot of a mechanism's exchange
+     * state includes the credentials (or the secrets derived from them)
+     * the mechanism holds.
+     */
+    enum class SnapshotCredentials {
+        /**
+         * The snapshot holds no credentials, so it can't be used to
+         * authenticate.  The mechanism into which it's restored uses the
+         * credentials already set on it, if it still needs any.  This is
+         * the default.
+         */
+        Exclude,
+
+        /**
+         * The snapshot holds the credentials (or the secrets derived from
+         * them), so the mechanism into which it's restored needs none of
+         * its own.  Such snapshots must be guarded as carefully as the
+         * credentials themselves.
+         */
+        Include,
+    };
+
     /**
      * This represents the common interface to all client side
      * [SASL](https://tools.ietf.org/html/rfc4422) mechanisms.
      */
     class Mechanism {
+        // Lifecycle management
+    public:
+        virtual ~Mechanism() = default;
+
         // Methods
     public:
         /**
@@ -46,9 +134,62 @@ namespace Client {
 
         /**
          * Reset the mechanism for use in a new authentication exchange.
+         * This also removes any cancellation token and deadline set
+         * for the previous exchange.
          */
         virtual void Reset() = 0;
 
+        /**
+         * Select whether or not the mechanism sends its first message
+         * as an initial response in the authentication request.
+         *
+         * @param[in] initialResponseMode
+         *     This selects whether or not the mechanism sends its first
+         *     message as an initial response.
+         */
+        virtual void SetInitialResponseMode(
+            InitialResponseMode initialResponseMode
+        ) = 0;
+
+        /**
+         * Return how many messages an authentication exchange takes
+         * with the mechanism, as currently set up.
+         *
+         * @return
+         *     How many messages an authentication exchange takes
+         *     with the mechanism is returned.
+         */
+        virtual RoundTripProfile GetRoundTripProfile() = 0;
+
+        /**
+         * Set the token which may be used to cancel the authentication
+         * exchange in progress, even from another thread.  Once the token
+         * is cancelled, the mechanism faults at the next opportunity,
+         * which for long computations (such as deriving keys from a
+         * password) is within a bounded amount of work.
+         *
+         * @param[in] cancellationToken
+         *     This is the token which may be used to cancel the
+         *     authentication exchange.
+         */
+        virtual void SetCancellationToken(
+            const CancellationToken& cancellationToken
+        ) = 0;
+
+        /**
+         * Set the time by which the authentication exchange must be
+         * complete.  Once the deadline passes, the mechanism faults at
+         * the next opportunity, in the same way as if the exchange
+         * were cancelled.
+         *
+         * @param[in] deadline
+         *     This is the time by which the authentication exchange
+         *     must be complete.
+         */
+        virtual void SetDeadline(
+            std::chrono::steady_clock::time_point deadline
+        ) = 0;
+
         /**
          * Set the identities and credentials to use in the authentication.
          *
@@ -74,7 +215,9 @@ namespace Client {
 
         /**
          * Return the initial response the client should send in the
-         * authentication request.
+         * authentication request.  If the mechanism returns an initial
+         * response, it considers its first message sent, so the next
+         * message given to Proceed should be the server's reply to it.
          *
          * @return
          *     The initial response the client should send in the
@@ -98,10 +241,27 @@ namespace Client {
          *
          * @return
          *     The next line of text to send to the server is returned.
-         *     If empty, the authentication operation is complete.
+         *     If empty, the authentication operation is complete, unless
+         *     ResponsePending says the empty message is to be sent.
          */
         virtual std::string Proceed(const std::string& message) = 0;
 
+        /**
+         * Return an indication of whether or not the message returned by
+         * the latest call to Proceed is to be sent to the server, even
+         * though it's empty.  This tells an empty response apart from the
+         * end of the exchange.  Mechanisms whose responses are never
+         * empty needn't override this.
+         *
+         * @return
+         *     An indication of whether or not the message returned by the
+         *     latest call to Proceed is to be sent to the server
+         *     is returned.
+         */
+        virtual bool ResponsePending() {
+            return false;
+        }
+
         /**
          * Return an indication of whether or not the mechanism has determined
          * that the authentication procedure has succeeded.
@@ -124,6 +284,61 @@ namespace Client {
          *     is returned.
          */
         virtual bool Faulted() = 0;
+
+        /**
+         * Take a snapshot of the state of the exchange in progress, in a
+         * compact, versioned binary form, so that the exchange may be
+         * carried on by another instance of the same mechanism (for
+         * example, in another worker thread or process) by restoring the
+         * snapshot into it.
+         *
+         * Only the state of the exchange is taken; diagnostics
+         * subscriptions, the cancellation token, and the deadline
+         * belong to the instance, and aren't part of the snapshot.
+         *
+         * @param[out] snapshot
+         *     This is where to store the snapshot.
+         *
+         * @param[in] credentials
+         *     This selects whether or not the snapshot includes the
+         *     credentials.
+         *
+         * @return
+         *     An indication of whether or not the snapshot was taken
+         *     is returned.
+         */
+        virtual bool Snapshot(
+            std::string& snapshot,
+            SnapshotCredentials credentials = SnapshotCredentials::Exclude
+        ) = 0;
+
+        /**
+         * Carry on the exchange whose state is in the given snapshot,
+         * taken from another instance of the same mechanism.  If the
+         * snapshot doesn't include the credentials, those already set
+         * on this instance are used.
+         *
+         * @param[in] snapshot
+         *     This is the snapshot to restore.
+         *
+         * @return
+         *     An indication of whether or not the snapshot was restored
+         *     is returned.  If it wasn't (because it's malformed, or was
+         *     taken of a different mechanism or with a different version
+         *     of the library), the instance is left unchanged.
+         */
+        virtual bool Restore(const std::string& snapshot) = 0;
+
+        /**
+         * Wipe and free everything the mechanism holds for the exchange
+         * and the credentials, so that a mechanism kept for the life of
+         * a long connection, once the exchange is over, holds no secrets
+         * and no memory beyond its own footprint.  Whether the exchange
+         * succeeded or faulted is still reported.  Credentials must be
+         * set again before the mechanism is reset and used for another
+         * exchange.
+         */
+        virtual void Release() = 0;
     };
 
 }
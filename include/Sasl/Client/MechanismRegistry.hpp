@@ -0,0 +1,346 @@
+#pragma once
+
+/**
+ * @file MechanismRegistry.hpp
+ *
+ * This module declares the Sasl::Client::MechanismRegistry class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Mechanism.hpp"
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This class holds a fixed table of the mechanisms a client is able to
+     * use, and selects the best of them from the list a server advertises.
+     * The table is normally a constexpr array, so that it's built when
+     * the program is compiled rather than on every connection.
+     */
+    class MechanismRegistry {
+        // Types
+    public:
+        /**
+         * This is the type of function which makes a new mechanism.
+         */
+        typedef std::unique_ptr< Mechanism > (*Factory)();
+
+        /**
+         * This describes one mechanism in the table.
+         */
+        struct Entry {
+            /**
+             * This is the name of the mechanism, as advertised by servers.
+             */
+            const char* name;
+
+            /**
+             * This is the hash of the name of the mechanism,
+             * as computed by HashName.
+             */
+            uint32_t nameHash;
+
+            /**
+             * This is the function to call to make the mechanism.
+             */
+            Factory factory;
+
+            /**
+             * This rates how well the mechanism protects the client's
+             * credentials.  Higher is better.
+             */
+            unsigned int security;
+
+            /**
+             * This is the number of round trips the mechanism
+             * is expected to take.
+             */
+            unsigned int roundTrips;
+
+            /**
+             * This rates how much processor time the mechanism takes
+             * on the client.  Higher is more expensive.
+             */
+            unsigned int cpuCost;
+        };
+
+        /**
+         * This holds what the client wants from the selected mechanism.
+         * Each advertised mechanism is scored as:
+         *
+         *     security * securityWeight
+         *     - roundTrips * roundTripWeight
+         *     - cpuCost * cpuCostWeight
+         *
+         * and the mechanism with the highest score is selected.  Ties go
+         * to the mechanism the server advertised first.
+         */
+        struct Preferences {
+            /**
+             * This is the lowest security rating acceptable.
+             */
+            unsigned int minSecurity = 0;
+
+            /**
+             * This is how much each point of security rating is worth.
+             */
+            unsigned int securityWeight = 1000;
+
+            /**
+             * This is how much each expected round trip costs.
+             */
+            unsigned int roundTripWeight = 10;
+
+            /**
+             * This is how much each point of processor cost costs.
+             */
+            unsigned int cpuCostWeight = 1;
+
+            /**
+             * If not empty, this is called to find out if the client
+             * already has credentials prepared for a mechanism (such as
+             * SCRAM keys cached from an earlier exchange), in which case
+             * the mechanism's processor cost isn't counted.
+             */
+            std::function< bool(const Entry& entry) > hasPreparedCredentials;
+        };
+
+        // Public methods
+    public:
+        /**
+         * Compute the hash of the given mechanism name.
+         *
+         * @param[in] name
+         *     This is the mechanism name to hash.
+         *
+         * @param[in] hash
+         *     This is the hash of any characters before the given name.
+         *
+         * @return
+         *     The hash of the given mechanism name is returned.
+         */
+        static constexpr uint32_t HashName(
+            const char* name,
+            uint32_t hash = 2166136261u
+        ) {
+            return (
+                (*name == '\0')
+                ? hash
+                : HashName(name + 1, (hash ^ (uint8_t)*name) * 16777619u)
+            );
+        }
+
+        /**
+         * Make a table entry for a mechanism.
+         *
+         * @param[in] name
+         *     This is the name of the mechanism, as advertised by servers.
+         *
+         * @param[in] factory
+         *     This is the function to call to make the mechanism.
+         *
+         * @param[in] security
+         *     This rates how well the mechanism protects the client's
+         *     credentials.  Higher is better.
+         *
+         * @param[in] roundTrips
+         *     This is the number of round trips the mechanism
+         *     is expected to take.
+         *
+         * @param[in] cpuCost
+         *     This rates how much processor time the mechanism takes
+         *     on the client.  Higher is more expensive.
+         *
+         * @return
+         *     The table entry is returned.
+         */
+        static constexpr Entry MakeEntry(
+            const char* name,
+            Factory factory,
+            unsigned int security,
+            unsigned int roundTrips,
+            unsigned int cpuCost
+        ) {
+            return Entry{name, HashName(name), factory, security, roundTrips, cpuCost};
+        }
+
+        /**
+         * Return the registry of the mechanisms built into the library:
+         * SCRAM-SHA-256, SCRAM-SHA-1, PLAIN, CRAM-MD5, and LOGIN.
+         *
+         * @return
+         *     The registry of the mechanisms built into the library
+         *     is returned.
+         */
+        static const MechanismRegistry& BuiltIn();
+
+        /**
+         * This constructor sets up the registry to use the given table.
+         *
+         * @param[in] entries
+         *     This is the table of mechanisms.  It must remain valid
+         *     for the lifetime of the registry.
+         */
+        template< size_t N > constexpr MechanismRegistry(const Entry (&entries)[N])
+            : entries_(entries)
+            , numEntries_(N)
+        {
+        }
+
+        /**
+         * Return the number of mechanisms in the registry.
+         *
+         * @return
+         *     The number of mechanisms in the registry is returned.
+         */
+        constexpr size_t GetNumEntries() const {
+            return numEntries_;
+        }
+
+        /**
+         * Return the entry of the mechanism with the given name.
+         *
+         * @param[in] name
+         *     This is the name of the mechanism to find.
+         *
+         * @return
+         *     The entry of the mechanism with the given name is returned.
+         *
+         * @retval nullptr
+         *     This is returned if the mechanism isn't in the registry.
+         */
+        const Entry* Find(const std::string& name) const;
+
+        /**
+         * Select the best mechanism in the registry from the given list,
+         * which is what a server advertises (names separated by spaces
+         * or commas).
+         *
+         * @param[in] advertised
+         *     This is the list of mechanisms the server advertises.
+         *
+         * @param[in] preferences
+         *     This holds what the client wants from the mechanism.
+         *
+         * @return
+         *     The entry of the selected mechanism is returned.
+         *
+         * @retval nullptr
+         *     This is returned if no acceptable mechanism in the
+         *     registry is advertised.
+         */
+        const Entry* Select(
+            const std::string& advertised,
+            const Preferences& preferences
+        ) const;
+
+        /**
+         * Select the best mechanism in the registry from the given list,
+         * which is what a server advertises, using the default
+         * preferences.
+         *
+         * @param[in] advertised
+         *     This is the list of mechanisms the server advertises.
+         *
+         * @return
+         *     The entry of the selected mechanism is returned.
+         *
+         * @retval nullptr
+         *     This is returned if no mechanism in the registry
+         *     is advertised.
+         */
+        const Entry* Select(const std::string& advertised) const;
+
+        /**
+         * Select the best mechanism in the registry from the given list,
+         * which is what a server advertises, and make it.
+         *
+         * @param[in] advertised
+         *     This is the list of mechanisms the server advertises.
+         *
+         * @param[out] name
+         *     This is where to store the name of the selected mechanism,
+         *     which the client normally sends to the server to begin
+         *     the exchange.
+         *
+         * @param[in] preferences
+         *     This holds what the client wants from the mechanism.
+         *
+         * @return
+         *     The new mechanism is returned.
+         *
+         * @retval nullptr
+         *     This is returned if no acceptable mechanism in the
+         *     registry is advertised.
+         */
+        std::unique_ptr< Mechanism > Create(
+            const std::string& advertised,
+            std::string& name,
+            const Preferences& preferences
+        ) const;
+
+        /**
+         * Select the best mechanism in the registry from the given list,
+         * which is what a server advertises, using the default
+         * preferences, and make it.
+         *
+         * @param[in] advertised
+         *     This is the list of mechanisms the server advertises.
+         *
+         * @param[out] name
+         *     This is where to store the name of the selected mechanism.
+         *
+         * @return
+         *     The new mechanism is returned.
+         *
+         * @retval nullptr
+         *     This is returned if no mechanism in the registry
+         *     is advertised.
+         */
+        std::unique_ptr< Mechanism > Create(
+            const std::string& advertised,
+            std::string& name
+        ) const;
+
+        // Private methods
+    private:
+        /**
+         * Return the entry of the mechanism with the given name.
+         *
+         * @param[in] name
+         *     This points to the name of the mechanism to find.
+         *
+         * @param[in] length
+         *     This is the number of characters in the name.
+         *
+         * @return
+         *     The entry of the mechanism with the given name is returned.
+         *
+         * @retval nullptr
+         *     This is returned if the mechanism isn't in the registry.
+         */
+        const Entry* Find(const char* name, size_t length) const;
+
+        // Private properties
+    private:
+        /**
+         * This is the table of mechanisms.
+         */
+        const Entry* entries_;
+
+        /**
+         * This is the number of mechanisms in the table.
+         */
+        size_t numEntries_;
+    };
+
+}
+}
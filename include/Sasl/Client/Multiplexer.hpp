@@ -0,0 +1,255 @@
+#pragma once
+
+/**
+ * @file Multiplexer.hpp
+ *
+ * This module declares the Sasl::Client::Multiplexer class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Mechanism.hpp"
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This class drives many client-side authentication exchanges at once,
+     * each identified by the connection on which it takes place.  Messages
+     * from servers are given to it in batches, and messages to send
+     * to servers are returned in batches, so that one thread can advance
+     * all exchanges with little overhead per message.
+     */
+    class Multiplexer {
+        // Types
+    public:
+        /**
+         * This is the type of value used to identify the connection
+         * on which an exchange takes place.
+         */
+        typedef uint64_t ConnectionId;
+
+        /**
+         * This is a message received from, or to send to, the server
+         * on a connection.
+         */
+        struct Message {
+            /**
+             * This identifies the connection on which the message
+             * was received or is to be sent.
+             */
+            ConnectionId connectionId;
+
+            /**
+             * This is the text of the message, decoded from (or not yet
+             * encoded into) any framing used by the application protocol.
+             */
+            std::string text;
+        };
+
+        /**
+         * This describes an exchange which is complete, either because
+         * the mechanism has nothing more to send, or because it
+         * succeeded or faulted.  The exchange is no longer in the
+         * multiplexer once it's complete.
+         */
+        struct Completion {
+            /**
+             * This identifies the connection on which the exchange
+             * took place.
+             */
+            ConnectionId connectionId = 0;
+
+            /**
+             * This indicates whether or not the mechanism determined
+             * that the exchange succeeded.
+             */
+            bool succeeded = false;
+
+            /**
+             * This indicates whether or not the mechanism determined
+             * that the server gave an unexpected response/challenge.
+             */
+            bool faulted = false;
+
+            /**
+             * This is the mechanism which carried out the exchange,
+             * handed back so that it may be reset and reused.
+             */
+            std::unique_ptr< Mechanism > mechanism;
+        };
+
+        /**
+         * This holds measurements of the work done by the multiplexer.
+         */
+        struct Statistics {
+            /**
+             * This is the number of exchanges added to the multiplexer.
+             */
+            size_t exchangesStarted = 0;
+
+            /**
+             * This is the number of exchanges which completed.
+             */
+            size_t exchangesCompleted = 0;
+
+            /**
+             * This is the number of server messages given to mechanisms.
+             */
+            size_t messagesProcessed = 0;
+
+            /**
+             * This is the number of server messages dropped because
+             * no exchange was taking place on their connections.
+             */
+            size_t messagesDropped = 0;
+
+            /**
+             * This is the time, in seconds, since the statistics
+             * were last reset.
+             */
+            double elapsedSeconds = 0.0;
+
+            /**
+             * This is the rate at which exchanges completed,
+             * since the statistics were last reset.
+             */
+            double exchangesPerSecond = 0.0;
+        };
+
+        // Lifecycle management
+    public:
+        ~Multiplexer() noexcept;
+        Multiplexer(const Multiplexer&) = delete;
+        Multiplexer(Multiplexer&&) noexcept;
+        Multiplexer& operator=(const Multiplexer&) = delete;
+        Multiplexer& operator=(Multiplexer&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the default constructor.
+         */
+        Multiplexer();
+
+        /**
+         * Set aside room for the given number of exchanges, so that
+         * adding up to that many doesn't need to grow any storage.
+         *
+         * @param[in] numExchanges
+         *     This is the number of exchanges for which to set aside room.
+         */
+        void Reserve(size_t numExchanges);
+
+        /**
+         * Begin a new exchange on the given connection, using the given
+         * mechanism, which should already have its credentials set.
+         *
+         * @param[in] connectionId
+         *     This identifies the connection on which the exchange
+         *     takes place.
+         *
+         * @param[in] mechanism
+         *     This is the mechanism to use in the exchange.
+         *
+         * @param[out] initialResponse
+         *     This is where to store the initial response the client
+         *     should send in the authentication request.  It's empty if
+         *     the mechanism doesn't send an initial response.
+         *
+         * @return
+         *     An indication of whether or not the exchange was added
+         *     is returned.  It isn't added if an exchange is already
+         *     taking place on the same connection, or if no
+         *     mechanism is given.
+         */
+        bool Add(
+            ConnectionId connectionId,
+            std::unique_ptr< Mechanism > mechanism,
+            std::string& initialResponse
+        );
+
+        /**
+         * Abandon the exchange taking place on the given connection.
+         *
+         * @param[in] connectionId
+         *     This identifies the connection on which the exchange
+         *     takes place.
+         *
+         * @return
+         *     The mechanism which was used in the exchange is returned.
+         *
+         * @retval nullptr
+         *     This is returned if no exchange was taking place
+         *     on the given connection.
+         */
+        std::unique_ptr< Mechanism > Remove(ConnectionId connectionId);
+
+        /**
+         * Return the number of exchanges taking place.
+         *
+         * @return
+         *     The number of exchanges taking place is returned.
+         */
+        size_t GetExchangeCount() const;
+
+        /**
+         * Give the multiplexer a batch of messages received from servers,
+         * advancing the exchanges on their connections, and collect the
+         * messages to send back and the exchanges which completed.
+         * Messages for the same connection are processed in the order
+         * they appear in the batch.
+         *
+         * @param[in] inbound
+         *     These are the messages received from servers.
+         *
+         * @param[out] outbound
+         *     This is where to append the messages to send to servers.
+         *
+         * @param[out] completions
+         *     This is where to append the exchanges which completed.
+         */
+        void Process(
+            const std::vector< Message >& inbound,
+            std::vector< Message >& outbound,
+            std::vector< Completion >& completions
+        );
+
+        /**
+         * Return measurements of the work done by the multiplexer.
+         *
+         * @return
+         *     Measurements of the work done by the multiplexer
+         *     are returned.
+         */
+        Statistics GetStatistics() const;
+
+        /**
+         * Zero the counters and restart the clock used
+         * to compute rates.
+         */
+        void ResetStatistics();
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
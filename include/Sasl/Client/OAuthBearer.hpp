@@ -0,0 +1,145 @@
+#pragma once
+
+/**
+ * @file OAuthBearer.hpp
+ *
+ * This module declares the Sasl::Client::OAuthBearer class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "BearerCredentials.hpp"
+#include "Mechanism.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This class implements the OAUTHBEARER SASL
+     * ([RFC 7628](https://tools.ietf.org/html/rfc7628))
+     * mechanism, which passes an OAuth 2.0 bearer token to the server.
+     *
+     * If the server rejects the token, it sends an error challenge,
+     * which the mechanism acknowledges as the specification requires,
+     * and which may be retrieved with GetErrorChallenge.
+     *
+     * When credentials are set with SetCredentials, the credentials
+     * string is the token, and the authorization identity is passed
+     * to the server if given, otherwise the authentication identity.
+     */
+    class OAuthBearer
+        : public Mechanism
+    {
+        // Lifecycle management
+    public:
+        ~OAuthBearer() noexcept;
+        OAuthBearer(const OAuthBearer&) = delete;
+        OAuthBearer(OAuthBearer&&) noexcept;
+        OAuthBearer& operator=(const OAuthBearer&) = delete;
+        OAuthBearer& operator=(OAuthBearer&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the default constructor.
+         */
+        OAuthBearer();
+
+        /**
+         * Set the credentials to use in the authentication, sharing them
+         * rather than copying them.  This is the cheapest way to give many
+         * instances the same credentials, because the messages built from
+         * the credentials are built only once, when the token is set,
+         * and a refreshed token is picked up by every instance when it
+         * starts its next exchange.
+         *
+         * @param[in] credentials
+         *     These are the credentials to use in the authentication.
+         */
+        void SetSharedCredentials(
+            std::shared_ptr< const BearerCredentials > credentials
+        );
+
+        /**
+         * Return the error challenge the server sent in the exchange,
+         * if any.  This is the JSON object described in
+         * [RFC 7628](https://tools.ietf.org/html/rfc7628) section 3.2.2,
+         * which says why the token was rejected.
+         *
+         * @return
+         *     The error challenge the server sent is returned, or an
+         *     empty string if the server didn't send one.
+         */
+        const std::string& GetErrorChallenge() const;
+
+        // Mechanism
+    public:
+        virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
+            SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+            size_t minLevel = 0
+        ) override;
+        virtual void Reset() override;
+        virtual void SetInitialResponseMode(
+            InitialResponseMode initialResponseMode
+        ) override;
+        virtual RoundTripProfile GetRoundTripProfile() override;
+        virtual void SetCancellationToken(
+            const CancellationToken& cancellationToken
+        ) override;
+        virtual void SetDeadline(
+            std::chrono::steady_clock::time_point deadline
+        ) override;
+        virtual void SetCredentials(
+            const std::string& credentials,
+            const std::string& authenticationIdentity,
+            const std::string& authorizationIdentity = ""
+        ) override;
+        virtual std::string GetInitialResponse() override;
+        virtual std::string Proceed(const std::string& message) override;
+        virtual bool ResponsePending() override;
+        virtual bool Succeeded() override;
+        virtual bool Faulted() override;
+        virtual bool Snapshot(
+            std::string& snapshot,
+            SnapshotCredentials credentials = SnapshotCredentials::Exclude
+        ) override;
+        virtual bool Restore(const std::string& snapshot) override;
+        virtual void Release() override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This is the number of bytes reserved inside each instance
+         * to store its private properties.  It's fixed here, rather than
+         * derived from the structure, so that the structure may change
+         * without changing the size of instances.
+         */
+        static constexpr size_t IMPL_STORAGE_SIZE = 192;
+
+        /**
+         * This is where the private properties of the instance are stored,
+         * so that making or moving an instance doesn't allocate memory.
+         */
+        alignas(std::max_align_t) unsigned char implStorage_[IMPL_STORAGE_SIZE];
+
+        /**
+         * This points to the private properties of the instance,
+         * which are stored in implStorage_.
+         */
+        Impl* impl_;
+    };
+
+}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+/**
+ * @file PasswordCredentials.hpp
+ *
+ * This module declares the Sasl::Client::PasswordCredentials class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This holds a password along with the identities to use with it,
+     * and the messages built from them which are sent by the mechanisms
+     * that pass the password to the server, such as PLAIN and LOGIN.
+     *
+     * Credentials are immutable once made, so the messages are built
+     * only once, and one set of credentials may be shared by any number
+     * of mechanism instances, on any number of threads.
+     */
+    class PasswordCredentials {
+        // Lifecycle management
+    public:
+        ~PasswordCredentials() noexcept;
+        PasswordCredentials(const PasswordCredentials&) = delete;
+        PasswordCredentials(PasswordCredentials&&) = delete;
+        PasswordCredentials& operator=(const PasswordCredentials&) = delete;
+        PasswordCredentials& operator=(PasswordCredentials&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * Make a new set of credentials.
+         *
+         * @param[in] password
+         *     This is the password to use in the authentication.
+         *
+         * @param[in] authenticationIdentity
+         *     This is the identity to to associate with the password
+         *     in the authentication.
+         *
+         * @param[in] authorizationIdentity
+         *     This is the identity to "act as" in the authentication.
+         *     If empty, the client is requesting to act as the identity the
+         *     server associates with the client's password.
+         *
+         * @return
+         *     The new credentials are returned.
+         */
+        static std::shared_ptr< const PasswordCredentials > Create(
+            const std::string& password,
+            const std::string& authenticationIdentity,
+            const std::string& authorizationIdentity = ""
+        );
+
+        /**
+         * Return the password.
+         *
+         * @return
+         *     The password is returned.
+         */
+        const std::string& GetPassword() const;
+
+        /**
+         * Return the identity to associate with the password.
+         *
+         * @return
+         *     The identity to associate with the password is returned.
+         */
+        const std::string& GetAuthenticationIdentity() const;
+
+        /**
+         * Return the identity to "act as" in the authentication.
+         *
+         * @return
+         *     The identity to "act as" in the authentication is returned.
+         */
+        const std::string& GetAuthorizationIdentity() const;
+
+        /**
+         * Return the message which passes the credentials to the server
+         * in the PLAIN mechanism
+         * ([RFC 4616](https://tools.ietf.org/html/rfc4616)).
+         *
+         * @return
+         *     The message which passes the credentials to the server
+         *     in the PLAIN mechanism is returned.
+         */
+        const std::string& GetPlainMessage() const;
+
+        /**
+         * Return the line to publish to diagnostics when the PLAIN
+         * mechanism passes the credentials to the server.  The password
+         * is masked.
+         *
+         * @return
+         *     The line to publish to diagnostics when the PLAIN
+         *     mechanism passes the credentials to the server is returned.
+         */
+        const std::string& GetPlainDiagnosticMessage() const;
+
+        // Private methods
+    private:
+        /**
+         * This is the default constructor, used only by Create.
+         */
+        PasswordCredentials();
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
@@ -9,7 +9,9 @@
  */
 
 #include "Mechanism.hpp"
+#include "PasswordCredentials.hpp"
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 
@@ -39,6 +41,19 @@ namespace Client {
          */
         Plain();
 
+        /**
+         * Set the credentials to use in the authentication, sharing them
+         * rather than copying them.  This is the cheapest way to give many
+         * instances the same credentials, because the messages built from
+         * the credentials are built only once, when they're made.
+         *
+         * @param[in] credentials
+         *     These are the credentials to use in the authentication.
+         */
+        void SetSharedCredentials(
+            std::shared_ptr< const PasswordCredentials > credentials
+        );
+
         // Mechanism
     public:
         virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
@@ -46,6 +61,16 @@ namespace Client {
             size_t minLevel = 0
         ) override;
         virtual void Reset() override;
+        virtual void SetInitialResponseMode(
+            InitialResponseMode initialResponseMode
+        ) override;
+        virtual RoundTripProfile GetRoundTripProfile() override;
+        virtual void SetCancellationToken(
+            const CancellationToken& cancellationToken
+        ) override;
+        virtual void SetDeadline(
+            std::chrono::steady_clock::time_point deadline
+        ) override;
         virtual void SetCredentials(
             const std::string& credentials,
             const std::string& authenticationIdentity,
@@ -55,6 +80,12 @@ namespace Client {
         virtual std::string Proceed(const std::string& message) override;
         virtual bool Succeeded() override;
         virtual bool Faulted() override;
+        virtual bool Snapshot(
+            std::string& snapshot,
+            SnapshotCredentials credentials = SnapshotCredentials::Exclude
+        ) override;
+        virtual bool Restore(const std::string& snapshot) override;
+        virtual void Release() override;
 
         // Private properties
     private:
@@ -66,9 +97,24 @@ namespace Client {
         struct Impl;
 
         /**
-         * This contains the private properties of the instance.
+         * This is the number of bytes reserved inside each instance
+         * to store its private properties.  It's fixed here, rather than
+         * derived from the structure, so that the structure may change
+         * without changing the size of instances.
+         */
+        static constexpr size_t IMPL_STORAGE_SIZE = 128;
+
+        /**
+         * This is where the private properties of the instance are stored,
+         * so that making or moving an instance doesn't allocate memory.
+         */
+        alignas(std::max_align_t) unsigned char implStorage_[IMPL_STORAGE_SIZE];
+
+        /**
+         * This points to the private properties of the instance,
+         * which are stored in implStorage_.
          */
-        std::unique_ptr< Impl > impl_;
+        Impl* impl_;
     };
 
 }
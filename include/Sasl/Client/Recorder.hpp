@@ -0,0 +1,135 @@
+#pragma once
+
+/**
+ * @file Recorder.hpp
+ *
+ * This module declares the Sasl::Client::Recorder class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Mechanism.hpp"
+#include "Transcript.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This is a mechanism which records the exchanges carried out by
+     * another mechanism, for replay later.  It passes everything through
+     * to the other mechanism, timing each step, and hands each exchange
+     * to a delegate once it's complete (or abandoned).
+     *
+     * Nothing the client sends is recorded other than its length, and
+     * values in server messages from which the credentials could be
+     * attacked offline (such as the SCRAM server signature) are replaced
+     * with placeholders of the same length.  A replay therefore uses
+     * test credentials, and doesn't expect the exchanges to succeed,
+     * but does the same work in each step as the recorded exchange.
+     */
+    class Recorder
+        : public Mechanism
+    {
+        // Types
+    public:
+        /**
+         * This is the type of function called with each recorded exchange.
+         *
+         * @param[in] exchange
+         *     This is the recorded exchange.
+         */
+        typedef std::function< void(const TranscriptExchange& exchange) > ExchangeDelegate;
+
+        // Lifecycle management
+    public:
+        ~Recorder() noexcept;
+        Recorder(const Recorder&) = delete;
+        Recorder(Recorder&&) noexcept;
+        Recorder& operator=(const Recorder&) = delete;
+        Recorder& operator=(Recorder&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * Construct a recorder for the given mechanism.
+         *
+         * @param[in] mechanism
+         *     This is the mechanism whose exchanges to record.
+         *
+         * @param[in] mechanismName
+         *     This is the name of the mechanism (e.g. "SCRAM-SHA-256"),
+         *     which selects what is redacted from the server messages.
+         *
+         * @param[in] exchangeDelegate
+         *     This is the function to call with each recorded exchange,
+         *     such as one writing it with a TranscriptWriter.
+         */
+        Recorder(
+            std::unique_ptr< Mechanism > mechanism,
+            const std::string& mechanismName,
+            ExchangeDelegate exchangeDelegate
+        );
+
+        /**
+         * Return the mechanism whose exchanges are recorded.
+         *
+         * @return
+         *     The mechanism whose exchanges are recorded is returned.
+         */
+        Mechanism& GetMechanism() const;
+
+        // Mechanism
+    public:
+        virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
+            SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+            size_t minLevel = 0
+        ) override;
+        virtual void Reset() override;
+        virtual void SetInitialResponseMode(
+            InitialResponseMode initialResponseMode
+        ) override;
+        virtual RoundTripProfile GetRoundTripProfile() override;
+        virtual void SetCancellationToken(
+            const CancellationToken& cancellationToken
+        ) override;
+        virtual void SetDeadline(
+            std::chrono::steady_clock::time_point deadline
+        ) override;
+        virtual void SetCredentials(
+            const std::string& credentials,
+            const std::string& authenticationIdentity,
+            const std::string& authorizationIdentity = ""
+        ) override;
+        virtual std::string GetInitialResponse() override;
+        virtual std::string Proceed(const std::string& message) override;
+        virtual bool ResponsePending() override;
+        virtual bool Succeeded() override;
+        virtual bool Faulted() override;
+        virtual bool Snapshot(
+            std::string& snapshot,
+            SnapshotCredentials credentials = SnapshotCredentials::Exclude
+        ) override;
+        virtual bool Restore(const std::string& snapshot) override;
+        virtual void Release() override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
@@ -8,10 +8,15 @@
  * © 2019 by Richard Walters
  */
 
+#include "../HashContext.hpp"
 #include "Mechanism.hpp"
+#include "ScramProfile.hpp"
 
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <stdint.h>
+#include <vector>
 
 namespace Sasl {
 namespace Client {
@@ -42,6 +47,118 @@ namespace Client {
             )
         >;
 
+        /**
+         * This identifies the hash functions built into the library
+         * which may be selected for use in the SCRAM algorithm.
+         */
+        enum class HashAlgorithm {
+            /**
+             * This selects SHA-1, for the SCRAM-SHA-1 mechanism
+             * ([RFC 5802](https://tools.ietf.org/html/rfc5802)).
+             */
+            Sha1,
+
+            /**
+             * This selects SHA-256, for the SCRAM-SHA-256 mechanism
+             * ([RFC 7677](https://tools.ietf.org/html/rfc7677)).
+             */
+            Sha256,
+        };
+
+        /**
+         * This identifies the reasons why the mechanism may determine
+         * that the server has given an unexpected response/challenge.
+         */
+        enum class FaultReason {
+            /**
+             * This indicates the mechanism has not faulted.
+             */
+            None,
+
+            /**
+             * This indicates no usable hash function was set up before
+             * the server challenge was received.
+             */
+            NoUsableHashFunction,
+
+            /**
+             * This indicates the server's message did not follow
+             * the syntax given in RFC 5802.
+             */
+            MalformedMessage,
+
+            /**
+             * This indicates the server's challenge included a mandatory
+             * extension ("m="), none of which are supported.
+             */
+            MandatoryExtension,
+
+            /**
+             * This indicates the server's nonce does not start with
+             * the client's nonce, or adds nothing to it.
+             */
+            NonceMismatch,
+
+            /**
+             * This indicates the salt in the server's challenge is empty
+             * or isn't valid Base64.
+             */
+            InvalidSalt,
+
+            /**
+             * This indicates the iteration count in the server's challenge
+             * isn't a positive decimal number.
+             */
+            InvalidIterationCount,
+
+            /**
+             * This indicates the iteration count in the server's challenge
+             * is less than the minimum allowed by the profile's policy.
+             */
+            TooFewIterations,
+
+            /**
+             * This indicates the iteration count in the server's challenge
+             * is greater than the maximum allowed by the profile's policy.
+             */
+            TooManyIterations,
+
+            /**
+             * This indicates deriving the salted password took longer than
+             * the time limit set by the profile's policy.
+             */
+            DerivationTimeLimitExceeded,
+
+            /**
+             * This indicates the exchange was cancelled through its
+             * cancellation token.
+             */
+            Cancelled,
+
+            /**
+             * This indicates the deadline of the exchange passed.
+             */
+            DeadlineExceeded,
+
+            /**
+             * This indicates the server sent an error ("e=") rather than
+             * its signature.
+             */
+            ServerError,
+
+            /**
+             * This indicates the server's signature is not the one
+             * the client computed, so the server can't be trusted.
+             */
+            ServerSignatureMismatch,
+
+            /**
+             * This indicates the key derivation function set in the
+             * profile failed to derive the salted password.
+             */
+            KeyDerivationFailed,
+        };
+
         // Lifecycle management
     public:
         ~Scram() noexcept;
@@ -57,9 +174,24 @@ namespace Client {
          */
         Scram();
 
+        /**
+         * Set up the given profile, which selects the hash function and
+         * related configuration, to be used in the SCRAM algorithm.
+         * The profile is shared, not copied, so this is the cheapest way
+         * to configure many instances the same way.
+         *
+         * @param[in] profile
+         *     This is the profile to use in the SCRAM algorithm.
+         */
+        void SetProfile(std::shared_ptr< const ScramProfile > profile);
+
         /**
          * Set up the given hash function to be used in the SCRAM algorithm.
          *
+         * @note
+         *     This makes a new profile for the instance.  Consider using
+         *     SetProfile instead, to share one profile among instances.
+         *
          * @param[in] hashFunction
          *     This is the hash function to use in the SCRAM algorithm.
          *
@@ -76,6 +208,71 @@ namespace Client {
             size_t digestSize
         );
 
+        /**
+         * Set up the given incremental hash function to be used in the SCRAM
+         * algorithm.  This is preferred over SetHashFunction, because it
+         * allows the messages signed by the algorithm to be fed to the hash
+         * function piece by piece, rather than first concatenating them
+         * into temporary buffers.
+         *
+         * @note
+         *     This makes a new profile for the instance.  Consider using
+         *     SetProfile instead, to share one profile among instances.
+         *
+         * @param[in] hashContextFactory
+         *     This is the function to call to make new contexts for
+         *     the hash function to use in the SCRAM algorithm.
+         *
+         * @param[in] blockSize
+         *     This is the block size, in bytes, of the given hash function.
+         *
+         * @param[in] digestSize
+         *     This is the size, in bits, of the digest produced by the given
+         *     hash function.  It must not exceed 8 * MAX_DIGEST_LENGTH.
+         */
+        void SetHashContextFactory(
+            HashContextFactory hashContextFactory,
+            size_t blockSize,
+            size_t digestSize
+        );
+
+        /**
+         * Set up the given hash function built into the library to be used
+         * in the SCRAM algorithm.  The fastest implementation of the hash
+         * function supported by the processor is selected automatically.
+         * This is equivalent to calling SetProfile with the profile
+         * ScramProfile::Sha1() or ScramProfile::Sha256().
+         *
+         * @param[in] hashAlgorithm
+         *     This identifies the hash function to use in the SCRAM
+         *     algorithm.
+         */
+        void SetHashAlgorithm(HashAlgorithm hashAlgorithm);
+
+        /**
+         * Use the given client nonce, rather than a randomly generated one,
+         * in authentication exchanges which start after credentials are
+         * next set.  This is intended only for reproducing known exchanges,
+         * such as the examples given in the RFCs.
+         *
+         * @param[in] clientNonce
+         *     This is the client nonce to use.  If empty, client nonces
+         *     are once again generated randomly.
+         */
+        void SetClientNonce(const std::string& clientNonce);
+
+        /**
+         * Return the reason why the mechanism determined that the server
+         * has given an unexpected response/challenge.
+         *
+         * @return
+         *     The reason why the mechanism faulted is returned.
+         *
+         * @retval FaultReason::None
+         *     This is returned if the mechanism has not faulted.
+         */
+        FaultReason GetFaultReason() const;
+
         // Mechanism
     public:
         virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
@@ -83,6 +280,16 @@ namespace Client {
             size_t minLevel = 0
         ) override;
         virtual void Reset() override;
+        virtual void SetInitialResponseMode(
+            InitialResponseMode initialResponseMode
+        ) override;
+        virtual RoundTripProfile GetRoundTripProfile() override;
+        virtual void SetCancellationToken(
+            const CancellationToken& cancellationToken
+        ) override;
+        virtual void SetDeadline(
+            std::chrono::steady_clock::time_point deadline
+        ) override;
         virtual void SetCredentials(
             const std::string& credentials,
             const std::string& authenticationIdentity,
@@ -92,6 +299,12 @@ namespace Client {
         virtual std::string Proceed(const std::string& message) override;
         virtual bool Succeeded() override;
         virtual bool Faulted() override;
+        virtual bool Snapshot(
+            std::string& snapshot,
+            SnapshotCredentials credentials = SnapshotCredentials::Exclude
+        ) override;
+        virtual bool Restore(const std::string& snapshot) override;
+        virtual void Release() override;
 
         // Private properties
     private:
@@ -103,9 +316,24 @@ namespace Client {
         struct Impl;
 
         /**
-         * This contains the private properties of the instance.
+         * This is the number of bytes reserved inside each instance
+         * to store its private properties.  It's fixed here, rather than
+         * derived from the structure, so that the structure may change
+         * without changing the size of instances.
+         */
+        static constexpr size_t IMPL_STORAGE_SIZE = 384;
+
+        /**
+         * This is where the private properties of the instance are stored,
+         * so that making or moving an instance doesn't allocate memory.
+         */
+        alignas(std::max_align_t) unsigned char implStorage_[IMPL_STORAGE_SIZE];
+
+        /**
+         * This points to the private properties of the instance,
+         * which are stored in implStorage_.
          */
-        std::unique_ptr< Impl > impl_;
+        Impl* impl_;
     };
 
 }
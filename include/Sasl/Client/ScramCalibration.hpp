@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * @file ScramCalibration.hpp
+ *
+ * This module declares the functions used to calibrate the iteration
+ * counts of the SCRAM mechanism to the host on which the program
+ * is running.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "ScramProfile.hpp"
+
+#include <chrono>
+#include <stddef.h>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This is the smallest iteration count recommended for the SCRAM
+     * mechanism ([RFC 5802](https://tools.ietf.org/html/rfc5802)
+     * section 5.1, [RFC 7677](https://tools.ietf.org/html/rfc7677)
+     * section 4).
+     */
+    constexpr size_t SCRAM_MINIMUM_ITERATIONS = 4096;
+
+    /**
+     * This holds the results of measuring how long SCRAM takes to derive
+     * salted passwords on the host, with a number of threads deriving
+     * at once.
+     */
+    struct ScramCalibrationSample {
+        /**
+         * This is the number of threads which derived salted passwords
+         * at once.
+         */
+        size_t threads = 0;
+
+        /**
+         * This is the iteration count used for each derivation.
+         */
+        size_t probeIterations = 0;
+
+        /**
+         * This is the total number of derivations measured.
+         */
+        size_t derivations = 0;
+
+        /**
+         * This is the median time taken by one derivation.
+         */
+        std::chrono::nanoseconds p50Latency = std::chrono::nanoseconds(0);
+
+        /**
+         * This is the 99th percentile of the time taken by one derivation.
+         */
+        std::chrono::nanoseconds p99Latency = std::chrono::nanoseconds(0);
+
+        /**
+         * This is the number of iterations completed per second,
+         * across all the threads.
+         */
+        double iterationsPerSecond = 0.0;
+    };
+
+    /**
+     * Measure how long the given variant of SCRAM takes to derive salted
+     * passwords on the host, using the same derivation as
+     * Scram::Proceed, with the given number of threads deriving at once.
+     *
+     * @param[in] profile
+     *     This selects the variant of SCRAM to measure.
+     *
+     * @param[in] threads
+     *     This is the number of threads to derive salted passwords
+     *     at once.
+     *
+     * @param[in] probeIterations
+     *     This is the iteration count to use for each derivation.
+     *
+     * @param[in] derivationsPerThread
+     *     This is the number of derivations each thread measures.
+     *
+     * @return
+     *     The results of the measurement are returned.
+     */
+    ScramCalibrationSample MeasureScramDerivation(
+        const ScramProfile& profile,
+        size_t threads,
+        size_t probeIterations = SCRAM_MINIMUM_ITERATIONS,
+        size_t derivationsPerThread = 20
+    );
+
+    /**
+     * Return the largest iteration count whose derivations would
+     * complete within the given latency 99 percent of the time, under
+     * the conditions measured in the given sample.  The time taken is
+     * assumed to be proportional to the iteration count.  The count is
+     * rounded down to a multiple of 1024.
+     *
+     * @param[in] sample
+     *     This holds the results of measuring the derivations.
+     *
+     * @param[in] targetP99Latency
+     *     This is the longest time that 99 percent of derivations
+     *     should take.
+     *
+     * @return
+     *     The recommended iteration count is returned.  It may be less
+     *     than SCRAM_MINIMUM_ITERATIONS, or zero, if the host is too slow
+     *     to meet the target at all.
+     */
+    size_t RecommendScramIterations(
+        const ScramCalibrationSample& sample,
+        std::chrono::nanoseconds targetP99Latency
+    );
+
+}
+}
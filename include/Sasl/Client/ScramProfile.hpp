@@ -0,0 +1,306 @@
+#pragma once
+
+/**
+ * @file ScramProfile.hpp
+ *
+ * This module declares the Sasl::Client::ScramProfile class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../HashContext.hpp"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This holds the configuration of a variant of the SCRAM mechanism,
+     * such as SCRAM-SHA-1 or SCRAM-SHA-256: the hash function on which
+     * the digests and Hash-based Message Authentication Codes (HMAC) of
+     * the algorithm are based, along with its sizes, and the policy which
+     * limits how much work the client does on behalf of the server.
+     *
+     * Profiles are immutable once made, so one profile may be shared
+     * by any number of Scram instances, on any number of threads.
+     */
+    class ScramProfile {
+        // Types
+    public:
+        /**
+         * This holds the limits the client places on the work it does
+         * on behalf of the server, so that a misconfigured or hostile
+         * server can't tie up the client for an unreasonable time.
+         */
+        struct Policy {
+            /**
+             * This is the smallest iteration count the client accepts
+             * from the server.
+             */
+            size_t minIterations = 1;
+
+            /**
+             * This is the largest iteration count the client accepts
+             * from the server.
+             */
+            size_t maxIterations = 1000000;
+
+            /**
+             * This is the longest time the client spends deriving the
+             * salted password from the password.  If zero, there is
+             * no limit.
+             */
+            std::chrono::milliseconds derivationTimeLimit = std::chrono::milliseconds(0);
+        };
+
+        /**
+         * This is the type of function which derives the salted password
+         * from the normalized password, the salt, and the iteration count
+         * given by the server:
+         *
+         *     SaltedPassword := Hi(Normalize(password), salt, i)
+         *
+         * The function is given the normalized password and its length,
+         * the salt and its length, the iteration count, where to store
+         * the salted password (which has the digest length of the
+         * profile), and a function which, if set, returns false when the
+         * derivation should be given up.  It returns an indication of
+         * whether or not the salted password was derived.
+         */
+        using KeyDerivation = std::function<
+            bool(
+                const uint8_t* password,
+                size_t passwordLength,
+                const uint8_t* salt,
+                size_t saltLength,
+                size_t iterations,
+                uint8_t* saltedPassword,
+                const std::function< bool() >& keepGoing
+            )
+        >;
+
+        // Lifecycle management
+    public:
+        ~ScramProfile() noexcept;
+        ScramProfile(const ScramProfile&) = delete;
+        ScramProfile(ScramProfile&&) = delete;
+        ScramProfile& operator=(const ScramProfile&) = delete;
+        ScramProfile& operator=(ScramProfile&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * Make a new profile with the given configuration.
+         *
+         * @param[in] mechanismName
+         *     This is the name of the SASL mechanism the profile
+         *     configures, such as "SCRAM-SHA-1".
+         *
+         * @param[in] hashContextFactory
+         *     This is the function to call to make new contexts for
+         *     the hash function to use in the SCRAM algorithm.
+         *
+         * @param[in] blockSize
+         *     This is the block size, in bytes, of the given hash function.
+         *
+         * @param[in] digestSize
+         *     This is the size, in bits, of the digest produced by the given
+         *     hash function.  It must not exceed 8 * MAX_DIGEST_LENGTH.
+         *
+         * @param[in] policy
+         *     This is the policy which limits how much work the client
+         *     does on behalf of the server.
+         *
+         * @return
+         *     The new profile is returned.
+         */
+        static std::shared_ptr< const ScramProfile > Create(
+            const std::string& mechanismName,
+            HashContextFactory hashContextFactory,
+            size_t blockSize,
+            size_t digestSize,
+            const Policy& policy
+        );
+
+        /**
+         * Make a new profile with the given configuration and
+         * the default policy.
+         *
+         * @param[in] mechanismName
+         *     This is the name of the SASL mechanism the profile
+         *     configures, such as "SCRAM-SHA-1".
+         *
+         * @param[in] hashContextFactory
+         *     This is the function to call to make new contexts for
+         *     the hash function to use in the SCRAM algorithm.
+         *
+         * @param[in] blockSize
+         *     This is the block size, in bytes, of the given hash function.
+         *
+         * @param[in] digestSize
+         *     This is the size, in bits, of the digest produced by the given
+         *     hash function.  It must not exceed 8 * MAX_DIGEST_LENGTH.
+         *
+         * @return
+         *     The new profile is returned.
+         */
+        static std::shared_ptr< const ScramProfile > Create(
+            const std::string& mechanismName,
+            HashContextFactory hashContextFactory,
+            size_t blockSize,
+            size_t digestSize
+        );
+
+        /**
+         * Return the profile of the SCRAM-SHA-1 mechanism
+         * ([RFC 5802](https://tools.ietf.org/html/rfc5802)), which uses
+         * the SHA-1 hash function built into the library.  The same
+         * profile is returned every time.
+         *
+         * @return
+         *     The profile of the SCRAM-SHA-1 mechanism is returned.
+         */
+        static std::shared_ptr< const ScramProfile > Sha1();
+
+        /**
+         * Return the profile of the SCRAM-SHA-256 mechanism
+         * ([RFC 7677](https://tools.ietf.org/html/rfc7677)), which uses
+         * the SHA-256 hash function built into the library.  The same
+         * profile is returned every time.
+         *
+         * @return
+         *     The profile of the SCRAM-SHA-256 mechanism is returned.
+         */
+        static std::shared_ptr< const ScramProfile > Sha256();
+
+        /**
+         * Make a new profile which is the same as this one, except
+         * with the given policy.
+         *
+         * @param[in] policy
+         *     This is the policy which limits how much work the client
+         *     does on behalf of the server.
+         *
+         * @return
+         *     The new profile is returned.
+         */
+        std::shared_ptr< const ScramProfile > WithPolicy(
+            const Policy& policy
+        ) const;
+
+        /**
+         * Make a new profile which is the same as this one, except that
+         * salted passwords are derived with the given function rather
+         * than the PBKDF2 built into the library.  This is for deriving
+         * them elsewhere (such as in a shared cache or a hardware module),
+         * or for replacing the derivation with a cheap stand-in when
+         * testing the rest of the exchange.
+         *
+         * @param[in] keyDerivation
+         *     This is the function to call to derive salted passwords.
+         *     If empty, the built-in derivation is used.
+         *
+         * @return
+         *     The new profile is returned.
+         */
+        std::shared_ptr< const ScramProfile > WithKeyDerivation(
+            KeyDerivation keyDerivation
+        ) const;
+
+        /**
+         * Return the name of the SASL mechanism the profile configures.
+         *
+         * @return
+         *     The name of the SASL mechanism the profile configures
+         *     is returned.
+         */
+        const std::string& GetMechanismName() const;
+
+        /**
+         * Make a new context for the hash function of the profile.
+         *
+         * @return
+         *     The new hash context is returned.
+         */
+        std::unique_ptr< HashContext > MakeHashContext() const;
+
+        /**
+         * Return the function which makes new contexts for the hash
+         * function of the profile.
+         *
+         * @return
+         *     The function which makes new contexts for the hash
+         *     function of the profile is returned.
+         */
+        const HashContextFactory& GetHashContextFactory() const;
+
+        /**
+         * Return the block size, in bytes, of the hash function
+         * of the profile.
+         *
+         * @return
+         *     The block size, in bytes, of the hash function
+         *     of the profile is returned.
+         */
+        size_t GetBlockSize() const;
+
+        /**
+         * Return the size, in bytes, of the digests produced by the hash
+         * function of the profile.
+         *
+         * @return
+         *     The size, in bytes, of the digests produced by the hash
+         *     function of the profile is returned.
+         */
+        size_t GetDigestLength() const;
+
+        /**
+         * Return the policy which limits how much work the client
+         * does on behalf of the server.
+         *
+         * @return
+         *     The policy which limits how much work the client does
+         *     on behalf of the server is returned.
+         */
+        const Policy& GetPolicy() const;
+
+        /**
+         * Return the function which derives salted passwords for the
+         * profile, if one was set with WithKeyDerivation.
+         *
+         * @return
+         *     The function which derives salted passwords is returned.
+         *     It's empty if the built-in derivation is used.
+         */
+        const KeyDerivation& GetKeyDerivation() const;
+
+        // Private methods
+    private:
+        /**
+         * This is the default constructor, used only by Create.
+         */
+        ScramProfile();
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
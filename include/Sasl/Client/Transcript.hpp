@@ -0,0 +1,214 @@
+#pragma once
+
+/**
+ * @file Transcript.hpp
+ *
+ * This module declares the types and functions used to store recorded
+ * authentication exchanges (transcripts), so that they may be replayed
+ * later, for example to reproduce the performance of exchanges seen
+ * in production.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This is one step of a recorded exchange: either getting the
+     * initial response, or proceeding with a message from the server.
+     */
+    struct TranscriptStep {
+        /**
+         * This indicates whether the step got the initial response
+         * (rather than proceeding with a message from the server).
+         */
+        bool initialResponse = false;
+
+        /**
+         * This is the message received from the server, if any, with
+         * any values from which secrets could be recovered redacted.
+         */
+        std::string serverMessage;
+
+        /**
+         * This is the length, in bytes, of the message the client sent
+         * in reply.  The message itself isn't recorded, since it may
+         * hold credentials.
+         */
+        size_t clientMessageLength = 0;
+
+        /**
+         * This is how long the step took, in nanoseconds.
+         */
+        uint64_t nanoseconds = 0;
+    };
+
+    /**
+     * This is a recorded exchange.
+     */
+    struct TranscriptExchange {
+        /**
+         * This is the name of the mechanism used in the exchange.
+         */
+        std::string mechanism;
+
+        /**
+         * This is the nonce the client made for the exchange, if the
+         * mechanism uses one (e.g. SCRAM), so that a replay can reuse it
+         * and have the recorded server messages still apply.
+         */
+        std::string clientNonce;
+
+        /**
+         * These are the steps of the exchange, in order.
+         */
+        std::vector< TranscriptStep > steps;
+
+        /**
+         * This indicates whether or not the exchange succeeded.
+         */
+        bool succeeded = false;
+
+        /**
+         * This indicates whether or not the exchange faulted.
+         */
+        bool faulted = false;
+    };
+
+    /**
+     * These are the bytes at the start of every transcript file.
+     */
+    constexpr char TRANSCRIPT_FILE_SIGNATURE[] = "SASLTRN1";
+
+    /**
+     * Encode the given exchange and append it to the given buffer.
+     * Lengths, numbers, and times are encoded as variable-length integers,
+     * so that most exchanges take little more room than the
+     * server messages in them.
+     *
+     * @param[in] exchange
+     *     This is the exchange to encode.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer to which to append the encoded exchange.
+     */
+    void EncodeTranscriptExchange(
+        const TranscriptExchange& exchange,
+        std::string& buffer
+    );
+
+    /**
+     * Decode the exchange at the given position in the given buffer.
+     *
+     * @param[in] buffer
+     *     This is the buffer holding the encoded exchange.
+     *
+     * @param[in,out] offset
+     *     This is the position of the encoded exchange in the buffer.
+     *     On success, it's moved past the exchange.
+     *
+     * @param[out] exchange
+     *     This is where to store the decoded exchange.
+     *
+     * @return
+     *     An indication of whether or not an exchange
+     *     was decoded is returned.
+     */
+    bool DecodeTranscriptExchange(
+        const std::string& buffer,
+        size_t& offset,
+        TranscriptExchange& exchange
+    );
+
+    /**
+     * Read all the exchanges in the given transcript file.
+     *
+     * @param[in] path
+     *     This is the path of the transcript file.
+     *
+     * @param[out] exchanges
+     *     This is where to append the exchanges read from the file.
+     *
+     * @return
+     *     An indication of whether or not the file could be read, and
+     *     held only well-formed exchanges, is returned.
+     */
+    bool ReadTranscriptFile(
+        const std::string& path,
+        std::vector< TranscriptExchange >& exchanges
+    );
+
+    /**
+     * This class appends recorded exchanges to a transcript file.
+     * It may be used by many threads at once.
+     */
+    class TranscriptWriter {
+        // Lifecycle management
+    public:
+        ~TranscriptWriter() noexcept;
+        TranscriptWriter(const TranscriptWriter&) = delete;
+        TranscriptWriter(TranscriptWriter&&) noexcept;
+        TranscriptWriter& operator=(const TranscriptWriter&) = delete;
+        TranscriptWriter& operator=(TranscriptWriter&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the default constructor.
+         */
+        TranscriptWriter();
+
+        /**
+         * Open the given transcript file, creating it if it doesn't
+         * exist, or adding to it if it does.
+         *
+         * @param[in] path
+         *     This is the path of the transcript file.
+         *
+         * @return
+         *     An indication of whether or not the file
+         *     was opened is returned.
+         */
+        bool Open(const std::string& path);
+
+        /**
+         * Append the given exchange to the transcript file.
+         *
+         * @param[in] exchange
+         *     This is the exchange to append.
+         *
+         * @return
+         *     An indication of whether or not the exchange
+         *     was written is returned.
+         */
+        bool Write(const TranscriptExchange& exchange);
+
+        /**
+         * Close the transcript file, writing out anything buffered.
+         */
+        void Close();
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
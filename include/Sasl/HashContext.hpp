@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * @file HashContext.hpp
+ *
+ * This module declares the Sasl::HashContext interface.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Sasl {
+
+    /**
+     * This is the size, in bytes, of the largest digest supported
+     * by the mechanisms which compute digests.
+     */
+    constexpr size_t MAX_DIGEST_LENGTH = 64;
+
+    /**
+     * This represents the common interface to incremental (init/update/final)
+     * computations of a cryptographic hash function.  A new context
+     * is in its initial state, data is absorbed into it piece by piece,
+     * and the digest of all the pieces is produced at the end.
+     */
+    class HashContext {
+        // Lifecycle management
+    public:
+        virtual ~HashContext() = default;
+
+        // Methods
+    public:
+        /**
+         * Make a new context which is an independent copy of this one,
+         * including all data absorbed into it so far.
+         *
+         * @return
+         *     The new context is returned.
+         */
+        virtual std::unique_ptr< HashContext > Clone() const = 0;
+
+        /**
+         * Replace the state of this context with a copy of the state
+         * of the given context, including all data absorbed into it so far.
+         *
+         * @note
+         *     The given context must be of the same type as this one
+         *     (in other words, it must be made by the same factory).
+         *
+         * @param[in] other
+         *     This is the context whose state should be copied.
+         */
+        virtual void CopyFrom(const HashContext& other) = 0;
+
+        /**
+         * Absorb the given data into the digest computation.
+         *
+         * @param[in] data
+         *     This points to the data to absorb.
+         *
+         * @param[in] length
+         *     This is the number of bytes of data to absorb.
+         */
+        virtual void Update(const uint8_t* data, size_t length) = 0;
+
+        /**
+         * Finish the digest computation, storing the digest in the
+         * given buffer.  After this, the state of the context is
+         * unspecified until it is replaced using CopyFrom.
+         *
+         * @param[out] digest
+         *     This is where to store the digest.  It must have room
+         *     for the full digest produced by the hash function.
+         */
+        virtual void Final(uint8_t* digest) = 0;
+    };
+
+    /**
+     * This is the type of function used to make new hash contexts,
+     * each in its initial state.
+     *
+     * @return
+     *     The new hash context is returned.
+     */
+    using HashContextFactory = std::function<
+        std::unique_ptr< HashContext >()
+    >;
+
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+/**
+ * @file KeyCache.hpp
+ *
+ * This module declares the Sasl::KeyCache::Store and
+ * Sasl::KeyCache::Daemon classes, which make up the daemon sharing
+ * derived SCRAM keys among the processes on a host.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Sasl {
+namespace KeyCache {
+
+    /**
+     * This is the default greatest number of bytes the daemon
+     * uses to hold derived keys.
+     */
+    constexpr size_t DEFAULT_MAX_BYTES = 16 * 1024 * 1024;
+
+    /**
+     * This is the greatest number of clients the daemon serves at once.
+     * Clients connecting beyond these are turned away, and fall back
+     * to deriving keys themselves.
+     */
+    constexpr size_t MAX_CLIENTS = 256;
+
+    /**
+     * This is the name of the daemon's socket in the user's runtime
+     * directory, unless another path is given.
+     */
+    constexpr const char* DEFAULT_SOCKET_NAME = "SaslKeyCache.sock";
+
+    /**
+     * Return the runtime directory of the user running the process, as
+     * named by the XDG_RUNTIME_DIR environment variable, but only if it
+     * belongs to the user and no one else has access to it, so that no
+     * one else can put a socket of their own at the daemon's path.
+     *
+     * @return
+     *     The runtime directory of the user is returned, or an empty
+     *     string if there isn't one fit to hold the daemon's socket.
+     */
+    std::string GetRuntimeDirectory();
+
+    /**
+     * Return the default path of the daemon's socket, which is
+     * DEFAULT_SOCKET_NAME in the user's runtime directory.
+     *
+     * @return
+     *     The default path of the daemon's socket is returned, or an
+     *     empty string if the user has no runtime directory fit to
+     *     hold it (see GetRuntimeDirectory).
+     */
+    std::string GetDefaultSocketPath();
+
+    /**
+     * This holds derived keys, up to a fixed number of bytes, forgetting
+     * the least recently used ones to make room for new ones.
+     */
+    class Store {
+        // Types
+    public:
+        /**
+         * This holds statistics about the use of a store.
+         */
+        struct Stats {
+            /**
+             * This is the number of derived keys held.
+             */
+            size_t entries = 0;
+
+            /**
+             * This is the number of bytes used to hold derived keys,
+             * including an estimate of the bookkeeping for each.
+             */
+            size_t bytes = 0;
+
+            /**
+             * This is the number of lookups which found a derived key.
+             */
+            uint64_t hits = 0;
+
+            /**
+             * This is the number of lookups which found nothing.
+             */
+            uint64_t misses = 0;
+
+            /**
+             * This is the number of derived keys forgotten
+             * to make room for others.
+             */
+            uint64_t evictions = 0;
+        };
+
+        // Lifecycle management
+    public:
+        ~Store() noexcept;
+        Store(const Store&) = delete;
+        Store(Store&&) noexcept;
+        Store& operator=(const Store&) = delete;
+        Store& operator=(Store&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructor sets up an empty store.
+         *
+         * @param[in] maxBytes
+         *     This is the greatest number of bytes to use to hold
+         *     derived keys, including an estimate of the bookkeeping
+         *     for each.
+         */
+        explicit Store(size_t maxBytes = DEFAULT_MAX_BYTES);
+
+        /**
+         * Look up the derived key held under the given key.
+         *
+         * @param[in] key
+         *     This is the key to look up.
+         *
+         * @param[out] derivedKey
+         *     This is where to store the derived key, if found.
+         *
+         * @return
+         *     An indication of whether or not the derived key
+         *     was found is returned.
+         */
+        bool Find(const std::string& key, std::string& derivedKey);
+
+        /**
+         * Hold the given derived key under the given key, forgetting
+         * the least recently used derived keys if needed to make room.
+         *
+         * @param[in] key
+         *     This is the key under which to hold the derived key.
+         *
+         * @param[in] derivedKey
+         *     This is the derived key to hold.
+         */
+        void Insert(const std::string& key, const std::string& derivedKey);
+
+        /**
+         * Return statistics about the use of the store.
+         *
+         * @return
+         *     Statistics about the use of the store are returned.
+         */
+        Stats GetStats() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+    /**
+     * This serves a Store to the processes on the host over a Unix-domain
+     * socket, for the Sasl::Client::KeyCacheClient class.  It serves all
+     * clients from one thread, since each request is only a few lookups.
+     *
+     * The socket is made accessible only to the user running the daemon,
+     * and clients running as other users are turned away, because the
+     * derived keys it holds are as good as passwords for authenticating
+     * with SCRAM.
+     */
+    class Daemon {
+        // Lifecycle management
+    public:
+        ~Daemon() noexcept;
+        Daemon(const Daemon&) = delete;
+        Daemon(Daemon&&) noexcept;
+        Daemon& operator=(const Daemon&) = delete;
+        Daemon& operator=(Daemon&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructor sets up a daemon which isn't serving yet.
+         *
+         * @param[in] maxBytes
+         *     This is the greatest number of bytes to use to hold
+         *     derived keys.
+         */
+        explicit Daemon(size_t maxBytes = DEFAULT_MAX_BYTES);
+
+        /**
+         * Begin serving clients on the given socket, replacing any socket
+         * left at its path by a daemon which didn't stop cleanly.  Any
+         * other kind of file at the path, or a socket on which another
+         * daemon is still serving, is left alone, and the daemon
+         * doesn't start.
+         *
+         * @param[in] socketPath
+         *     This is the path of the Unix-domain socket on which
+         *     to serve clients.
+         *
+         * @return
+         *     An indication of whether or not the daemon began serving
+         *     clients is returned.  It's always false on platforms
+         *     without Unix-domain sockets.
+         */
+        bool Start(const std::string& socketPath);
+
+        /**
+         * Stop serving clients, disconnecting any connected,
+         * and remove the socket, unless something else has
+         * since taken its place.
+         */
+        void Stop();
+
+        /**
+         * Return statistics about the use of the daemon's store.
+         *
+         * @return
+         *     Statistics about the use of the daemon's store are returned.
+         */
+        Store::Stats GetStats() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+ * @file Md5.hpp
+ *
+ * This module declares the MD5 hash function
+ * ([RFC 1321](https://tools.ietf.org/html/rfc1321)) built into the library.
+ * MD5 is no longer collision resistant, so it's only provided for legacy
+ * mechanisms which use it in an HMAC, such as CRAM-MD5.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "HashContext.hpp"
+
+#include <memory>
+#include <stddef.h>
+
+namespace Sasl {
+
+    /**
+     * This is the block size, in bytes, of the MD5 hash function.
+     */
+    constexpr size_t MD5_BLOCK_SIZE = 64;
+
+    /**
+     * This is the size, in bits, of the digest produced by the MD5
+     * hash function.
+     */
+    constexpr size_t MD5_DIGEST_SIZE = 128;
+
+    /**
+     * Make a new context in which to compute an MD5 digest.
+     *
+     * @return
+     *     The new hash context is returned.
+     */
+    std::unique_ptr< HashContext > MakeMd5Context();
+
+}
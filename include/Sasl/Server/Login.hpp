@@ -0,0 +1,77 @@
+#pragma once
+
+/**
+ * @file Login.hpp
+ *
+ * This module declares the Sasl::Server::Login class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Mechanism.hpp"
+#include "PasswordVerifier.hpp"
+
+#include <memory>
+#include <string>
+
+namespace Sasl {
+namespace Server {
+
+    /**
+     * This class implements the server side of the LOGIN SASL
+     * ([draft-murchison-sasl-login](https://tools.ietf.org/html/draft-murchison-sasl-login-00))
+     * mechanism.  The username may be given in the client's initial
+     * response, as many clients do, or in reply to the "Username:"
+     * challenge.
+     */
+    class Login
+        : public Mechanism
+    {
+        // Lifecycle management
+    public:
+        ~Login() noexcept;
+        Login(const Login&) = delete;
+        Login(Login&&) noexcept;
+        Login& operator=(const Login&) = delete;
+        Login& operator=(Login&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructor sets up the mechanism.
+         *
+         * @param[in] verifier
+         *     This is used to check the passwords given by clients.
+         */
+        explicit Login(std::shared_ptr< PasswordVerifier > verifier);
+
+        // Mechanism
+    public:
+        virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
+            SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+            size_t minLevel = 0
+        ) override;
+        virtual void Reset() override;
+        virtual std::string Proceed(const std::string& message) override;
+        virtual bool Done() override;
+        virtual bool Succeeded() override;
+        virtual const std::string& GetAuthenticationIdentity() override;
+        virtual const std::string& GetAuthorizationIdentity() override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+/**
+ * @file Mechanism.hpp
+ *
+ * This module declares the Sasl::Server::Mechanism interface.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <functional>
+#include <string>
+#include <SystemAbstractions/DiagnosticsSender.hpp>
+
+namespace Sasl {
+namespace Server {
+
+    /**
+     * This is the type of function used to decide whether or not the
+     * client, having proven the authentication identity, may act as
+     * the authorization identity it asked for.
+     *
+     * @param[in] authenticationIdentity
+     *     This is the identity the client proved.
+     *
+     * @param[in] authorizationIdentity
+     *     This is the identity the client asked to act as.
+     *     It's never empty.
+     *
+     * @return
+     *     An indication of whether or not the client may act as the
+     *     authorization identity is returned.
+     */
+    using AuthorizationDelegate = std::function<
+        bool(
+            const std::string& authenticationIdentity,
+            const std::string& authorizationIdentity
+        )
+    >;
+
+    /**
+     * This is the interface to the server side of a SASL mechanism.
+     * The protocol driver gives each message from the client to the
+     * mechanism, and sends whatever the mechanism returns as the next
+     * challenge, until the mechanism is done.
+     */
+    class Mechanism {
+    public:
+        // Methods
+
+        /**
+         * This is the destructor, which is virtual so that instances
+         * may be owned through pointers to the interface.
+         */
+        virtual ~Mechanism() = default;
+
+        /**
+         * This method forms a new subscription to diagnostic
+         * messages published by the mechanism.
+         *
+         * @param[in] delegate
+         *     This is the function to call to deliver messages
+         *     to the subscriber.
+         *
+         * @param[in] minLevel
+         *     This is the minimum level of message that this subscriber
+         *     desires to receive.
+         *
+         * @return
+         *     A function is returned which may be called
+         *     to terminate the subscription.
+         */
+        virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
+            SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+            size_t minLevel = 0
+        ) = 0;
+
+        /**
+         * Return the mechanism to its initial state, so that it may
+         * be used for a new authentication exchange.
+         */
+        virtual void Reset() = 0;
+
+        /**
+         * Process the next message from the client.
+         *
+         * @param[in] message
+         *     This is the next message from the client.  The first
+         *     message is the client's initial response, which is empty
+         *     if the client didn't send one.
+         *
+         * @return
+         *     The challenge to send to the client is returned.  If the
+         *     mechanism is done, it's the additional data, if any, to
+         *     send along with the outcome.
+         */
+        virtual std::string Proceed(const std::string& message) = 0;
+
+        /**
+         * Return an indication of whether or not the exchange is over.
+         *
+         * @return
+         *     An indication of whether or not the exchange is over
+         *     is returned.
+         */
+        virtual bool Done() = 0;
+
+        /**
+         * Return an indication of whether or not the client was
+         * authenticated.
+         *
+         * @return
+         *     An indication of whether or not the client was
+         *     authenticated is returned.
+         */
+        virtual bool Succeeded() = 0;
+
+        /**
+         * Return the identity the client proved, once the client is
+         * authenticated.
+         *
+         * @return
+         *     The identity the client proved is returned.
+         */
+        virtual const std::string& GetAuthenticationIdentity() = 0;
+
+        /**
+         * Return the identity the client acts as, once the client is
+         * authenticated.  This is the authentication identity, unless the
+         * client asked for, and was permitted, a different one.
+         *
+         * @return
+         *     The identity the client acts as is returned.
+         */
+        virtual const std::string& GetAuthorizationIdentity() = 0;
+    };
+
+}
+}
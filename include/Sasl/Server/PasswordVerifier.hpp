@@ -0,0 +1,215 @@
+#pragma once
+
+/**
+ * @file PasswordVerifier.hpp
+ *
+ * This module declares the Sasl::Server::PasswordVerifier class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Sasl {
+namespace Server {
+
+    /**
+     * This is what a server stores for a password: a key derived from it
+     * with PBKDF2 ([RFC 2898](https://tools.ietf.org/html/rfc2898)),
+     * using HMAC-SHA-256 as the pseudorandom function, along with the
+     * salt and iteration count used to derive it.
+     */
+    struct PasswordRecord {
+        /**
+         * This is the salt mixed into the derived key.
+         */
+        std::vector< uint8_t > salt;
+
+        /**
+         * This is the number of iterations used to derive the key.
+         */
+        size_t iterations = 0;
+
+        /**
+         * This is the key derived from the password, which is the
+         * length of a SHA-256 digest.
+         */
+        std::vector< uint8_t > derivedKey;
+
+        /**
+         * Make the record to store for the given password.
+         *
+         * @param[in] password
+         *     This is the password for which to make the record.
+         *
+         * @param[in] salt
+         *     This is the salt to mix into the derived key.  It should
+         *     be random and unique to the record.
+         *
+         * @param[in] iterations
+         *     This is the number of iterations to use to derive the key.
+         *
+         * @return
+         *     The record to store for the password is returned.
+         */
+        static PasswordRecord Derive(
+            const std::string& password,
+            const std::vector< uint8_t >& salt,
+            size_t iterations
+        );
+    };
+
+    /**
+     * This checks passwords given by clients against the records stored
+     * for them, for mechanisms which pass the password to the server,
+     * such as PLAIN and LOGIN.
+     *
+     * Since deriving the key for every check is expensive by design,
+     * the verifier may keep a cache of recent successful checks, so that
+     * clients which log in repeatedly with the same password (such as
+     * connection pools) skip the key derivation.  The cache doesn't hold
+     * passwords, only a keyed hash of each identity, password, and stored
+     * derived key, under a random key made when the cache is enabled.
+     * Because the stored derived key is hashed too, changing a password
+     * invalidates its cached checks.
+     *
+     * One verifier may be shared by any number of mechanism instances,
+     * on any number of threads, as long as its record lookup delegate
+     * is safe to call from those threads.
+     */
+    class PasswordVerifier {
+        // Types
+    public:
+        /**
+         * This is the type of function used to look up the record stored
+         * for the password of a user.
+         *
+         * @param[in] authenticationIdentity
+         *     This is the identity whose record to look up.
+         *
+         * @param[out] record
+         *     This is where to store the record, if it's found.
+         *
+         * @return
+         *     An indication of whether or not the record was found
+         *     is returned.
+         */
+        using RecordLookupDelegate = std::function<
+            bool(
+                const std::string& authenticationIdentity,
+                PasswordRecord& record
+            )
+        >;
+
+        /**
+         * This holds counts of what the verifier has done.
+         */
+        struct Statistics {
+            /**
+             * This is the number of passwords checked.
+             */
+            size_t verifications = 0;
+
+            /**
+             * This is the number of checks which were answered from
+             * the cache, without deriving a key.
+             */
+            size_t cacheHits = 0;
+
+            /**
+             * This is the number of checks which derived a key.
+             */
+            size_t derivations = 0;
+        };
+
+        // Lifecycle management
+    public:
+        ~PasswordVerifier() noexcept;
+        PasswordVerifier(const PasswordVerifier&) = delete;
+        PasswordVerifier(PasswordVerifier&&) noexcept;
+        PasswordVerifier& operator=(const PasswordVerifier&) = delete;
+        PasswordVerifier& operator=(PasswordVerifier&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructor sets up the verifier, without a cache.
+         *
+         * @param[in] recordLookupDelegate
+         *     This is used to look up the records stored for passwords.
+         */
+        explicit PasswordVerifier(RecordLookupDelegate recordLookupDelegate);
+
+        /**
+         * Enable the cache of recent successful checks, replacing
+         * any cache already in use.
+         *
+         * @param[in] capacity
+         *     This is the number of checks the cache holds.  If zero,
+         *     the cache is disabled.
+         *
+         * @param[in] lifetime
+         *     This is how long each check stays in the cache.
+         */
+        void EnableCache(
+            size_t capacity,
+            std::chrono::steady_clock::duration lifetime
+        );
+
+        /**
+         * Check the given password for the given identity.  A key is
+         * derived even for an identity without a (proper) record, with
+         * the iteration count of the latest proper record seen, so that
+         * checks of unknown identities take as long as checks of wrong
+         * passwords.
+         *
+         * @param[in] authenticationIdentity
+         *     This is the identity whose password to check.
+         *
+         * @param[in] password
+         *     This points to the password to check.
+         *
+         * @param[in] passwordLength
+         *     This is the number of bytes in the password.
+         *
+         * @return
+         *     An indication of whether or not the password is correct
+         *     is returned.
+         */
+        bool Verify(
+            const std::string& authenticationIdentity,
+            const char* password,
+            size_t passwordLength
+        );
+
+        /**
+         * Return counts of what the verifier has done.
+         *
+         * @return
+         *     Counts of what the verifier has done are returned.
+         */
+        Statistics GetStatistics() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+ * @file Plain.hpp
+ *
+ * This module declares the Sasl::Server::Plain class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Mechanism.hpp"
+#include "PasswordVerifier.hpp"
+
+#include <memory>
+#include <string>
+
+namespace Sasl {
+namespace Server {
+
+    /**
+     * This class implements the server side of the PLAIN SASL
+     * ([RFC 4616](https://tools.ietf.org/html/rfc4616)) mechanism.
+     *
+     * The client's message is split in place, and the password is
+     * checked straight from it, without copying it.
+     */
+    class Plain
+        : public Mechanism
+    {
+        // Lifecycle management
+    public:
+        ~Plain() noexcept;
+        Plain(const Plain&) = delete;
+        Plain(Plain&&) noexcept;
+        Plain& operator=(const Plain&) = delete;
+        Plain& operator=(Plain&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructor sets up the mechanism.
+         *
+         * @param[in] verifier
+         *     This is used to check the passwords given by clients.
+         */
+        explicit Plain(std::shared_ptr< PasswordVerifier > verifier);
+
+        /**
+         * Set the function used to decide whether or not a client may
+         * act as an authorization identity other than the one it proved.
+         * If none is set, clients may only act as themselves.
+         *
+         * @param[in] authorizationDelegate
+         *     This is the function used to decide whether or not a client
+         *     may act as the authorization identity it asks for.
+         */
+        void SetAuthorizationDelegate(AuthorizationDelegate authorizationDelegate);
+
+        // Mechanism
+    public:
+        virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
+            SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+            size_t minLevel = 0
+        ) override;
+        virtual void Reset() override;
+        virtual std::string Proceed(const std::string& message) override;
+        virtual bool Done() override;
+        virtual bool Succeeded() override;
+        virtual const std::string& GetAuthenticationIdentity() override;
+        virtual const std::string& GetAuthorizationIdentity() override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+}
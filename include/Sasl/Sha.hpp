@@ -0,0 +1,103 @@
+#pragma once
+
+/**
+ * @file Sha.hpp
+ *
+ * This module declares the hash functions of the Secure Hash Algorithm
+ * (SHA -- [FIPS 180-4](https://doi.org/10.6028/NIST.FIPS.180-4)) family
+ * which are built into the library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "HashContext.hpp"
+
+#include <memory>
+#include <stddef.h>
+
+namespace Sasl {
+
+    /**
+     * This is the block size, in bytes, of the SHA-1 hash function.
+     */
+    constexpr size_t SHA1_BLOCK_SIZE = 64;
+
+    /**
+     * This is the size, in bits, of the digest produced by the SHA-1
+     * hash function.
+     */
+    constexpr size_t SHA1_DIGEST_SIZE = 160;
+
+    /**
+     * This is the block size, in bytes, of the SHA-256 hash function.
+     */
+    constexpr size_t SHA256_BLOCK_SIZE = 64;
+
+    /**
+     * This is the size, in bits, of the digest produced by the SHA-256
+     * hash function.
+     */
+    constexpr size_t SHA256_DIGEST_SIZE = 256;
+
+    /**
+     * This identifies the implementations available for the SHA hash
+     * functions.
+     */
+    enum class ShaImplementation {
+        /**
+         * Use the fastest implementation supported by the processor
+         * on which the program is running.
+         */
+        Automatic,
+
+        /**
+         * Use the implementation written in portable C++.
+         */
+        Portable,
+
+        /**
+         * Use the implementation based on the Intel SHA Extensions
+         * (SHA-NI) processor instructions.  If these aren't supported,
+         * the portable implementation is used instead.
+         */
+        ShaExtensions,
+    };
+
+    /**
+     * Return an indication of whether or not the processor on which
+     * the program is running supports the Intel SHA Extensions (SHA-NI),
+     * and the library was built with the implementation which uses them.
+     *
+     * @return
+     *     An indication of whether or not the SHA Extensions implementation
+     *     is available is returned.
+     */
+    bool IsShaExtensionsAvailable();
+
+    /**
+     * Make a new context in which to compute a SHA-1 digest.
+     *
+     * @param[in] implementation
+     *     This selects which implementation of the hash function to use.
+     *
+     * @return
+     *     The new hash context is returned.
+     */
+    std::unique_ptr< HashContext > MakeSha1Context(
+        ShaImplementation implementation = ShaImplementation::Automatic
+    );
+
+    /**
+     * Make a new context in which to compute a SHA-256 digest.
+     *
+     * @param[in] implementation
+     *     This selects which implementation of the hash function to use.
+     *
+     * @return
+     *     The new hash context is returned.
+     */
+    std::unique_ptr< HashContext > MakeSha256Context(
+        ShaImplementation implementation = ShaImplementation::Automatic
+    );
+
+}
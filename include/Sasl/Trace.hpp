@@ -0,0 +1,163 @@
+#pragma once
+
+/**
+ * @file Trace.hpp
+ *
+ * This module declares the functions and classes used to record
+ * a timeline of the work done by the mechanisms, in the Chrome
+ * trace event format, which can be viewed with chrome://tracing
+ * or the Perfetto UI.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Sasl {
+namespace Trace {
+
+    /**
+     * This is the greatest number of spans kept for each thread between
+     * Start and Stop.  Spans beyond these are counted, but dropped.
+     */
+    constexpr size_t MAX_SPANS_PER_THREAD = 1 << 20;
+
+    /**
+     * Begin recording spans, forgetting any recorded before.  Until this
+     * is called, spans cost only a check of whether recording is on.
+     */
+    void Start();
+
+    /**
+     * Stop recording spans, and write those recorded since Start
+     * to the given file, in the Chrome trace event (JSON) format.
+     *
+     * Each exchange appears as its own track, so that many exchanges
+     * taking place at once can be seen on one timeline.  The gaps
+     * between the steps of an exchange, when the mechanism is waiting
+     * for the application (and normally, the peer), appear as
+     * "waiting" spans.  Spans made outside of any exchange appear on
+     * a track for the thread which made them.
+     *
+     * @param[in] path
+     *     This is the path of the file to write.
+     *
+     * @return
+     *     An indication of whether or not the file was written is returned.
+     */
+    bool Stop(const std::string& path);
+
+    /**
+     * Return an indication of whether or not spans are being recorded.
+     *
+     * @return
+     *     An indication of whether or not spans are being
+     *     recorded is returned.
+     */
+    bool IsEnabled();
+
+    /**
+     * This holds what is traced about one exchange of a mechanism.
+     * A mechanism keeps one, and resets it when a new exchange begins.
+     */
+    struct Exchange {
+        /**
+         * This identifies the exchange in the trace.  It's assigned when
+         * the exchange's first step is traced, and is zero until then.
+         */
+        uint64_t id = 0;
+
+        /**
+         * This is when the exchange's last step ended, in nanoseconds
+         * since recording started, or zero if no step has ended yet.
+         */
+        uint64_t lastStepEnd = 0;
+
+        /**
+         * Forget the exchange, so that the next step traced
+         * begins a new one.
+         */
+        void Reset() {
+            id = 0;
+            lastStepEnd = 0;
+        }
+    };
+
+    /**
+     * This records a span of work, from when it's constructed until it's
+     * destroyed, if recording is on.  The name given must outlive the
+     * recording (normally, it's a string literal).
+     *
+     * Spans are kept in a buffer belonging to the thread which makes them,
+     * so that making one doesn't contend with other threads.
+     */
+    class Span {
+        // Lifecycle management
+    public:
+        ~Span() noexcept;
+        Span(const Span&) = delete;
+        Span(Span&&) = delete;
+        Span& operator=(const Span&) = delete;
+        Span& operator=(Span&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * Begin a span which is part of whatever step of an exchange
+         * the calling thread is carrying out, if any.
+         *
+         * @param[in] name
+         *     This is the name of the span.
+         */
+        explicit Span(const char* name);
+
+        /**
+         * Begin a span which is a step of the given exchange.  Spans
+         * made by the calling thread while this one exists are
+         * part of the same exchange.
+         *
+         * @param[in] name
+         *     This is the name of the span.
+         *
+         * @param[in,out] exchange
+         *     This holds what is traced about the exchange.
+         */
+        Span(const char* name, Exchange& exchange);
+
+        // Private properties
+    private:
+        /**
+         * This is the name of the span, or null if the span
+         * isn't being recorded.
+         */
+        const char* name_ = nullptr;
+
+        /**
+         * If the span is a step of an exchange, this holds
+         * what is traced about the exchange.
+         */
+        Exchange* exchange_ = nullptr;
+
+        /**
+         * This identifies the exchange of which the span is part,
+         * or is zero if it's not part of any exchange.
+         */
+        uint64_t exchangeId_ = 0;
+
+        /**
+         * This identifies the exchange of which the calling thread was
+         * carrying out a step before this span began.
+         */
+        uint64_t outerExchangeId_ = 0;
+
+        /**
+         * This is when the span began, in nanoseconds since
+         * recording started.
+         */
+        uint64_t start_ = 0;
+    };
+
+}
+}
@@ -0,0 +1,156 @@
+/**
+ * @file main.cpp
+ *
+ * This module holds the main() function, which is the entrypoint
+ * to the SCRAM key cache daemon.  It serves the salted passwords
+ * derived by the processes on the host (through
+ * Sasl::Client::KeyCacheClient) to one another over a Unix-domain
+ * socket, until it's interrupted or terminated, and then prints
+ * statistics about its use as JSON.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <Sasl/KeyCache.hpp>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+namespace {
+
+    /**
+     * This holds the options given to the program on the command line.
+     */
+    struct Options {
+        /**
+         * This is the path of the socket on which to serve clients.
+         * By default, it's in the user's runtime directory.
+         */
+        std::string socketPath = Sasl::KeyCache::GetDefaultSocketPath();
+
+        /**
+         * This is the greatest number of bytes to use
+         * to hold derived keys.
+         */
+        size_t maxBytes = Sasl::KeyCache::DEFAULT_MAX_BYTES;
+    };
+
+    /**
+     * Print the usage of the program to the standard error stream.
+     */
+    void PrintUsage() {
+        (void)fprintf(
+            stderr,
+            (
+                "Usage: SaslKeyCache [options]\n"
+                "\n"
+                "Serve SCRAM salted passwords derived by the processes on this host\n"
+                "to one another, until interrupted or terminated.\n"
+                "\n"
+                "Options:\n"
+                "  --socket PATH       socket on which to serve clients, which\n"
+                "                      should be in a directory only this user\n"
+                "                      can write to (default: SaslKeyCache.sock\n"
+                "                      in $XDG_RUNTIME_DIR)\n"
+                "  --max-bytes N       bytes to use to hold derived keys\n"
+                "                      (default: 16777216)\n"
+            )
+        );
+    }
+
+    /**
+     * Parse the given command-line arguments.
+     *
+     * @param[in] argc
+     *     This is the number of command-line arguments.
+     *
+     * @param[in] argv
+     *     This is the array of command-line arguments.
+     *
+     * @param[out] options
+     *     This is where to store the options parsed.
+     *
+     * @return
+     *     An indication of whether or not the arguments were valid
+     *     is returned.
+     */
+    bool ParseArguments(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const char* const name = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const char* const value = argv[++i];
+            if (strcmp(name, "--socket") == 0) {
+                options.socketPath = value;
+            } else if (strcmp(name, "--max-bytes") == 0) {
+                char* end = nullptr;
+                options.maxBytes = (size_t)strtoull(value, &end, 10);
+                if ((*end != '\0') || (options.maxBytes == 0)) {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}
+
+/**
+ * This function is the entrypoint of the program.
+ *
+ * @param[in] argc
+ *     This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *     This is the array of command-line arguments given to the program.
+ */
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+    if (options.socketPath.empty()) {
+        (void)fprintf(
+            stderr,
+            (
+                "There's no runtime directory (XDG_RUNTIME_DIR) belonging only\n"
+                "to this user in which to put the socket; use --socket.\n"
+            )
+        );
+        return EXIT_FAILURE;
+    }
+
+    // The signals which stop the daemon are blocked before it starts,
+    // so that its thread inherits the mask, and they're only taken
+    // here, by waiting for them.
+    sigset_t stopSignals;
+    (void)sigemptyset(&stopSignals);
+    (void)sigaddset(&stopSignals, SIGINT);
+    (void)sigaddset(&stopSignals, SIGTERM);
+    (void)pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+    Sasl::KeyCache::Daemon daemon(options.maxBytes);
+    if (!daemon.Start(options.socketPath)) {
+        (void)fprintf(stderr, "Unable to serve on socket: %s\n", options.socketPath.c_str());
+        return EXIT_FAILURE;
+    }
+    int signalNumber = 0;
+    (void)sigwait(&stopSignals, &signalNumber);
+    daemon.Stop();
+
+    const auto stats = daemon.GetStats();
+    (void)printf("{\n");
+    (void)printf("  \"entries\": %zu,\n", stats.entries);
+    (void)printf("  \"bytes\": %zu,\n", stats.bytes);
+    (void)printf("  \"hits\": %llu,\n", (unsigned long long)stats.hits);
+    (void)printf("  \"misses\": %llu,\n", (unsigned long long)stats.misses);
+    (void)printf("  \"evictions\": %llu\n", (unsigned long long)stats.evictions);
+    (void)printf("}\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,346 @@
+/**
+ * @file ScramResponder.cpp
+ *
+ * This module contains the implementation of the ScramAccounts and
+ * ScramResponder classes.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "ScramResponder.hpp"
+
+#include <algorithm>
+#include <Sasl/Base64.hpp>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the size, in bytes, of the salt made for each user.
+     */
+    constexpr size_t SALT_LENGTH = 16;
+
+    /**
+     * Make the HMAC state for the given key.
+     *
+     * @param[in] profile
+     *     This selects the hash function of the HMAC.
+     *
+     * @param[in] key
+     *     This is the key of the HMAC.
+     *
+     * @param[in] keyLength
+     *     This is the length of the key, in bytes.
+     *
+     * @return
+     *     The HMAC state for the key is returned.
+     */
+    HmacState MakeHmacState(
+        const Sasl::Client::ScramProfile& profile,
+        const uint8_t* key,
+        size_t keyLength
+    ) {
+        const auto& factory = profile.GetHashContextFactory();
+        const auto blockSize = profile.GetBlockSize();
+        std::vector< uint8_t > paddedKey(blockSize, 0);
+        if (keyLength > blockSize) {
+            const auto context = factory();
+            context->Update(key, keyLength);
+            context->Final(paddedKey.data());
+        } else {
+            (void)memcpy(paddedKey.data(), key, keyLength);
+        }
+        HmacState state;
+        state.inner = factory();
+        state.outer = factory();
+        for (auto& byte: paddedKey) {
+            byte ^= 0x36;
+        }
+        state.inner->Update(paddedKey.data(), blockSize);
+        for (auto& byte: paddedKey) {
+            byte ^= 0x36 ^ 0x5c;
+        }
+        state.outer->Update(paddedKey.data(), blockSize);
+        return state;
+    }
+
+    /**
+     * Compute the HMAC of the given data with the given key state.
+     *
+     * @param[in] key
+     *     This is the state of the key of the HMAC.
+     *
+     * @param[in,out] scratch
+     *     This is the context in which to compute the HMAC.
+     *
+     * @param[in] digestLength
+     *     This is the length, in bytes, of the digest.
+     *
+     * @param[in] data
+     *     This is the data to authenticate.
+     *
+     * @param[in] length
+     *     This is the length of the data, in bytes.
+     *
+     * @param[out] digest
+     *     This is where to store the HMAC.
+     */
+    void Hmac(
+        const HmacState& key,
+        Sasl::HashContext& scratch,
+        size_t digestLength,
+        const uint8_t* data,
+        size_t length,
+        uint8_t* digest
+    ) {
+        uint8_t innerDigest[Sasl::MAX_DIGEST_LENGTH];
+        scratch.CopyFrom(*key.inner);
+        scratch.Update(data, length);
+        scratch.Final(innerDigest);
+        scratch.CopyFrom(*key.outer);
+        scratch.Update(innerDigest, digestLength);
+        scratch.Final(digest);
+    }
+
+}
+
+ScramAccounts::ScramAccounts(std::shared_ptr< const Sasl::Client::ScramProfile > profile)
+    : profile_(profile)
+{
+}
+
+void ScramAccounts::Add(
+    const std::string& user,
+    const std::string& password,
+    size_t iterations
+) {
+    const auto& factory = profile_->GetHashContextFactory();
+    const auto digestLength = profile_->GetDigestLength();
+    const auto scratch = factory();
+
+    // Make a salt unique to the user by hashing the user name.
+    uint8_t salt[Sasl::MAX_DIGEST_LENGTH + 4];
+    scratch->Update((const uint8_t*)user.data(), user.length());
+    scratch->Final(salt);
+    const auto saltLength = std::min(SALT_LENGTH, digestLength);
+
+    // SaltedPassword := Hi(Normalize(password), salt, i)
+    const auto passwordHmac = MakeHmacState(
+        *profile_,
+        (const uint8_t*)password.data(),
+        password.length()
+    );
+    uint8_t saltedPassword[Sasl::MAX_DIGEST_LENGTH] = {0};
+    uint8_t u[Sasl::MAX_DIGEST_LENGTH + 4];
+    (void)memcpy(u, salt, saltLength);
+    const uint8_t one[4] = {0, 0, 0, 1};
+    (void)memcpy(u + saltLength, one, sizeof(one));
+    size_t uLength = saltLength + sizeof(one);
+    for (size_t i = 0; i < iterations; ++i) {
+        Hmac(passwordHmac, *scratch, digestLength, u, uLength, u);
+        uLength = digestLength;
+        for (size_t j = 0; j < digestLength; ++j) {
+            saltedPassword[j] ^= u[j];
+        }
+    }
+
+    // ClientKey := HMAC(SaltedPassword, "Client Key")
+    // StoredKey := H(ClientKey)
+    // ServerKey := HMAC(SaltedPassword, "Server Key")
+    const auto saltedPasswordHmac = MakeHmacState(*profile_, saltedPassword, digestLength);
+    Account account;
+    account.encodedSalt = Sasl::Base64::Encode(
+        std::string((const char*)salt, saltLength)
+    );
+    account.iterations = iterations;
+    uint8_t key[Sasl::MAX_DIGEST_LENGTH];
+    Hmac(saltedPasswordHmac, *scratch, digestLength, (const uint8_t*)"Client Key", 10, key);
+    const auto hash = factory();
+    hash->Update(key, digestLength);
+    hash->Final(account.storedKey);
+    account.storedKeyHmac = MakeHmacState(*profile_, account.storedKey, digestLength);
+    Hmac(saltedPasswordHmac, *scratch, digestLength, (const uint8_t*)"Server Key", 10, key);
+    account.serverKeyHmac = MakeHmacState(*profile_, key, digestLength);
+    accounts_[user] = std::move(account);
+}
+
+auto ScramAccounts::Find(const std::string& user) const -> const Account* {
+    const auto account = accounts_.find(user);
+    if (account == accounts_.end()) {
+        return nullptr;
+    }
+    return &account->second;
+}
+
+const Sasl::Client::ScramProfile& ScramAccounts::GetProfile() const {
+    return *profile_;
+}
+
+ScramResponder::ScramResponder(
+    std::shared_ptr< const ScramAccounts > accounts,
+    const std::string& nonceTag
+)
+    : accounts_(accounts)
+    , nonceTag_(nonceTag)
+    , emptyContext_(accounts->GetProfile().GetHashContextFactory()())
+    , scratchContext_(accounts->GetProfile().GetHashContextFactory()())
+{
+}
+
+SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate ScramResponder::SubscribeToDiagnostics(
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+    size_t minLevel
+) {
+    // The stand-in server publishes no diagnostics,
+    // so there's nothing to subscribe to.
+    (void)delegate;
+    (void)minLevel;
+    return []{};
+}
+
+void ScramResponder::Reset() {
+    account_ = nullptr;
+    authenticationIdentity_.clear();
+    step_ = 0;
+    done_ = false;
+    succeeded_ = false;
+}
+
+std::string ScramResponder::Proceed(const std::string& message) {
+    if (done_) {
+        return "";
+    }
+    switch (step_++) {
+        case 0: return HandleClientFirst(message);
+        case 1: return HandleClientFinal(message);
+        default: {
+            done_ = true;
+            return "";
+        }
+    }
+}
+
+bool ScramResponder::Done() {
+    return done_;
+}
+
+bool ScramResponder::Succeeded() {
+    return succeeded_;
+}
+
+const std::string& ScramResponder::GetAuthenticationIdentity() {
+    return authenticationIdentity_;
+}
+
+const std::string& ScramResponder::GetAuthorizationIdentity() {
+    return authenticationIdentity_;
+}
+
+std::string ScramResponder::HandleClientFirst(const std::string& message) {
+    // client-first-message = gs2-header client-first-message-bare
+    // gs2-header = gs2-cbind-flag "," [ authzid ] ","
+    // client-first-message-bare = "n=" saslname ",r=" c-nonce [...]
+    done_ = true;
+    if (message.compare(0, 2, "n,") != 0) {
+        return "e=channel-binding-not-supported";
+    }
+    const auto gs2HeaderEnd = message.find(',', 2);
+    if (
+        (gs2HeaderEnd == std::string::npos)
+        || (message.compare(gs2HeaderEnd + 1, 2, "n=") != 0)
+    ) {
+        return "e=other-error";
+    }
+    const auto userEnd = message.find(',', gs2HeaderEnd + 3);
+    if (
+        (userEnd == std::string::npos)
+        || (message.compare(userEnd + 1, 2, "r=") != 0)
+    ) {
+        return "e=other-error";
+    }
+    const auto nonceStart = userEnd + 3;
+    const auto nonceEnd = std::min(message.find(',', nonceStart), message.length());
+    authenticationIdentity_.assign(message, gs2HeaderEnd + 3, userEnd - gs2HeaderEnd - 3);
+    account_ = accounts_->Find(authenticationIdentity_);
+    if (account_ == nullptr) {
+        return "e=unknown-user";
+    }
+    std::string nonce(message, nonceStart, nonceEnd - nonceStart);
+    nonce += nonceTag_;
+    nonce += std::to_string(++nonceCounter_);
+    std::string serverFirst = "r=" + nonce;
+    serverFirst += ",s=";
+    serverFirst += account_->encodedSalt;
+    serverFirst += ",i=";
+    serverFirst += std::to_string(account_->iterations);
+    authMessage_.assign(message, gs2HeaderEnd + 1, std::string::npos);
+    authMessage_ += ',';
+    authMessage_ += serverFirst;
+    authMessage_ += ',';
+    expectedClientFinalStart_ = "c=";
+    expectedClientFinalStart_ += Sasl::Base64::Encode(message.substr(0, gs2HeaderEnd + 1));
+    expectedClientFinalStart_ += ",r=";
+    expectedClientFinalStart_ += nonce;
+    done_ = false;
+    return serverFirst;
+}
+
+std::string ScramResponder::HandleClientFinal(const std::string& message) {
+    // client-final-message = "c=" base64 ",r=" nonce [...] ",p=" base64
+    done_ = true;
+    const auto proofStart = message.rfind(",p=");
+    if (
+        (proofStart == std::string::npos)
+        || (message.compare(0, expectedClientFinalStart_.length(), expectedClientFinalStart_) != 0)
+    ) {
+        return "e=invalid-proof";
+    }
+    std::string proof;
+    const auto digestLength = accounts_->GetProfile().GetDigestLength();
+    if (
+        !Sasl::Base64::Decode(message.substr(proofStart + 3), proof)
+        || (proof.length() != digestLength)
+    ) {
+        return "e=invalid-proof";
+    }
+    authMessage_.append(message, 0, proofStart);
+
+    // ClientSignature := HMAC(StoredKey, AuthMessage)
+    // ClientKey := ClientProof XOR ClientSignature
+    uint8_t clientKey[Sasl::MAX_DIGEST_LENGTH];
+    ComputeHmac(account_->storedKeyHmac, authMessage_, clientKey);
+    for (size_t i = 0; i < digestLength; ++i) {
+        clientKey[i] ^= (uint8_t)proof[i];
+    }
+    uint8_t storedKey[Sasl::MAX_DIGEST_LENGTH];
+    scratchContext_->CopyFrom(*emptyContext_);
+    scratchContext_->Update(clientKey, digestLength);
+    scratchContext_->Final(storedKey);
+    if (memcmp(storedKey, account_->storedKey, digestLength) != 0) {
+        return "e=invalid-proof";
+    }
+
+    // ServerSignature := HMAC(ServerKey, AuthMessage)
+    uint8_t serverSignature[Sasl::MAX_DIGEST_LENGTH];
+    ComputeHmac(account_->serverKeyHmac, authMessage_, serverSignature);
+    succeeded_ = true;
+    return "v=" + Sasl::Base64::Encode(
+        std::string((const char*)serverSignature, digestLength)
+    );
+}
+
+void ScramResponder::ComputeHmac(
+    const HmacState& key,
+    const std::string& data,
+    uint8_t* digest
+) {
+    Hmac(
+        key,
+        *scratchContext_,
+        accounts_->GetProfile().GetDigestLength(),
+        (const uint8_t*)data.data(),
+        data.length(),
+        digest
+    );
+}
@@ -0,0 +1,300 @@
+#pragma once
+
+/**
+ * @file ScramResponder.hpp
+ *
+ * This module declares the ScramAccounts and ScramResponder classes,
+ * which stand in for a server in the SCRAM load generator.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+#include <Sasl/Client/ScramProfile.hpp>
+#include <Sasl/HashContext.hpp>
+#include <Sasl/Server/Mechanism.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+/**
+ * This holds the hash contexts which have absorbed the padded key of
+ * an HMAC, so that each HMAC computed with the key starts from them.
+ */
+struct HmacState {
+    /**
+     * This is the context which has absorbed the key XOR ipad.
+     */
+    std::unique_ptr< Sasl::HashContext > inner;
+
+    /**
+     * This is the context which has absorbed the key XOR opad.
+     */
+    std::unique_ptr< Sasl::HashContext > outer;
+};
+
+/**
+ * This holds the SCRAM credentials of the users known to the stand-in
+ * server.  Only the stored key and server key of each password are
+ * kept, as a real server would, so the server does no key derivation
+ * during an exchange.
+ */
+class ScramAccounts {
+    // Types
+public:
+    /**
+     * This holds what the server knows about one user.
+     */
+    struct Account {
+        /**
+         * This is the salt of the user's password, encoded in Base64.
+         */
+        std::string encodedSalt;
+
+        /**
+         * This is the iteration count of the user's password.
+         */
+        size_t iterations = 0;
+
+        /**
+         * This is H(ClientKey), used to check the client's proof.
+         */
+        uint8_t storedKey[Sasl::MAX_DIGEST_LENGTH];
+
+        /**
+         * This is the HMAC state keyed with the stored key.
+         */
+        HmacState storedKeyHmac;
+
+        /**
+         * This is the HMAC state keyed with the server key.
+         */
+        HmacState serverKeyHmac;
+    };
+
+    // Lifecycle management
+public:
+    ScramAccounts(const ScramAccounts&) = delete;
+    ScramAccounts(ScramAccounts&&) = delete;
+    ScramAccounts& operator=(const ScramAccounts&) = delete;
+    ScramAccounts& operator=(ScramAccounts&&) = delete;
+
+    // Public methods
+public:
+    /**
+     * This constructs the accounts for the given variant of SCRAM.
+     *
+     * @param[in] profile
+     *     This selects the variant of SCRAM.
+     */
+    explicit ScramAccounts(std::shared_ptr< const Sasl::Client::ScramProfile > profile);
+
+    /**
+     * Add a user with the given password, deriving the keys the server
+     * stores for it.
+     *
+     * @param[in] user
+     *     This is the name of the user.
+     *
+     * @param[in] password
+     *     This is the password of the user.
+     *
+     * @param[in] iterations
+     *     This is the iteration count to use for the password.
+     */
+    void Add(
+        const std::string& user,
+        const std::string& password,
+        size_t iterations
+    );
+
+    /**
+     * Return the account of the given user.
+     *
+     * @param[in] user
+     *     This is the name of the user.
+     *
+     * @return
+     *     The account of the user is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the user isn't known.
+     */
+    const Account* Find(const std::string& user) const;
+
+    /**
+     * Return the variant of SCRAM for which the accounts were made.
+     *
+     * @return
+     *     The profile of the variant of SCRAM is returned.
+     */
+    const Sasl::Client::ScramProfile& GetProfile() const;
+
+    // Private properties
+private:
+    /**
+     * This selects the variant of SCRAM.
+     */
+    std::shared_ptr< const Sasl::Client::ScramProfile > profile_;
+
+    /**
+     * These are the accounts, keyed by user name.
+     */
+    std::unordered_map< std::string, Account > accounts_;
+};
+
+/**
+ * This is a minimal server side of the SCRAM SASL
+ * ([RFC 5802](https://tools.ietf.org/html/rfc5802)) mechanism, used as
+ * a stand-in server by the load generator.  It supports no channel
+ * binding and no escaped characters in user names, and it keeps the
+ * hash contexts it needs, so an exchange costs it a few HMACs.
+ */
+class ScramResponder
+    : public Sasl::Server::Mechanism
+{
+    // Lifecycle management
+public:
+    ScramResponder(const ScramResponder&) = delete;
+    ScramResponder(ScramResponder&&) = delete;
+    ScramResponder& operator=(const ScramResponder&) = delete;
+    ScramResponder& operator=(ScramResponder&&) = delete;
+
+    // Public methods
+public:
+    /**
+     * This constructs a responder which authenticates the users in
+     * the given accounts.
+     *
+     * @param[in] accounts
+     *     These are the users the responder knows.
+     *
+     * @param[in] nonceTag
+     *     This is placed in every nonce the responder makes, so that
+     *     responders make different nonces from each other.
+     */
+    ScramResponder(
+        std::shared_ptr< const ScramAccounts > accounts,
+        const std::string& nonceTag
+    );
+
+    // Sasl::Server::Mechanism
+public:
+    virtual SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+        size_t minLevel = 0
+    ) override;
+    virtual void Reset() override;
+    virtual std::string Proceed(const std::string& message) override;
+    virtual bool Done() override;
+    virtual bool Succeeded() override;
+    virtual const std::string& GetAuthenticationIdentity() override;
+    virtual const std::string& GetAuthorizationIdentity() override;
+
+    // Private methods
+private:
+    /**
+     * Handle the first message from the client.
+     *
+     * @param[in] message
+     *     This is the client-first-message.
+     *
+     * @return
+     *     The server-first-message is returned.
+     */
+    std::string HandleClientFirst(const std::string& message);
+
+    /**
+     * Handle the final message from the client.
+     *
+     * @param[in] message
+     *     This is the client-final-message.
+     *
+     * @return
+     *     The server-final-message is returned.
+     */
+    std::string HandleClientFinal(const std::string& message);
+
+    /**
+     * Compute the HMAC of the given data with the given key state.
+     *
+     * @param[in] key
+     *     This is the state of the key of the HMAC.
+     *
+     * @param[in] data
+     *     This is the data to authenticate.
+     *
+     * @param[out] digest
+     *     This is where to store the HMAC.
+     */
+    void ComputeHmac(
+        const HmacState& key,
+        const std::string& data,
+        uint8_t* digest
+    );
+
+    // Private properties
+private:
+    /**
+     * These are the users the responder knows.
+     */
+    std::shared_ptr< const ScramAccounts > accounts_;
+
+    /**
+     * This is the account of the user being authenticated.
+     */
+    const ScramAccounts::Account* account_ = nullptr;
+
+    /**
+     * This is placed in every nonce the responder makes.
+     */
+    std::string nonceTag_;
+
+    /**
+     * This is counted up to make each nonce unique.
+     */
+    size_t nonceCounter_ = 0;
+
+    /**
+     * This is a context in which no data has been hashed.
+     */
+    std::unique_ptr< Sasl::HashContext > emptyContext_;
+
+    /**
+     * This is the context in which digests are computed.
+     */
+    std::unique_ptr< Sasl::HashContext > scratchContext_;
+
+    /**
+     * This is the expected start of the client-final-message, up to
+     * and including the nonce.
+     */
+    std::string expectedClientFinalStart_;
+
+    /**
+     * This is the AuthMessage of the exchange, built up as the
+     * messages go by.
+     */
+    std::string authMessage_;
+
+    /**
+     * This is the user being authenticated.
+     */
+    std::string authenticationIdentity_;
+
+    /**
+     * This is the number of messages received from the client.
+     */
+    size_t step_ = 0;
+
+    /**
+     * This indicates whether or not the exchange is over.
+     */
+    bool done_ = false;
+
+    /**
+     * This indicates whether or not the client was authenticated.
+     */
+    bool succeeded_ = false;
+};
@@ -0,0 +1,486 @@
+/**
+ * @file main.cpp
+ *
+ * This module holds the main() function, which is the entrypoint
+ * to the SCRAM load generator.  It drives many SCRAM exchanges at once,
+ * between Sasl::Client::Scram instances and stand-in servers in the same
+ * process, and reports handshake throughput, latency, allocations, and
+ * processor time.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "ScramResponder.hpp"
+
+#include <algorithm>
+#include <AllocationCounter.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <Sasl/Client/Scram.hpp>
+#include <Sasl/Trace.hpp>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This holds the options given to the program on the command line.
+     */
+    struct Options {
+        /**
+         * This is the name of the variant of SCRAM to use.
+         */
+        std::string mechanism = "SCRAM-SHA-256";
+
+        /**
+         * This is the iteration count of the users' passwords.
+         */
+        size_t iterations = 4096;
+
+        /**
+         * This is the number of exchanges in progress at once.
+         */
+        size_t exchanges = 64;
+
+        /**
+         * This is the number of threads driving the exchanges.
+         */
+        size_t threads = std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+
+        /**
+         * This is the number of users whose credentials the exchanges
+         * take turns using.  With one user, every exchange reuses the
+         * same credentials.
+         */
+        size_t users = 1;
+
+        /**
+         * This is how long to generate load, in seconds.
+         */
+        double durationSeconds = 5.0;
+
+        /**
+         * If not empty, this is the path of the file to which to write
+         * a trace of the exchanges (see Sasl/Trace.hpp).
+         */
+        std::string tracePath;
+    };
+
+    /**
+     * This holds the state of one exchange slot, in which exchanges are
+     * carried out one after another.
+     */
+    struct Slot {
+        /**
+         * This is the client side of the exchange.
+         */
+        std::unique_ptr< Sasl::Client::Scram > client;
+
+        /**
+         * This is the stand-in server side of the exchange.
+         */
+        std::unique_ptr< ScramResponder > server;
+
+        /**
+         * This is the index of the user whose credentials the client
+         * currently has, or the number of users if it has none yet.
+         */
+        size_t credentialsUser = 0;
+
+        /**
+         * This is the index of the user for the next exchange.
+         */
+        size_t nextUser = 0;
+
+        /**
+         * This is the number of steps taken in the current exchange.
+         */
+        size_t step = 0;
+
+        /**
+         * This is the last message the server sent.
+         */
+        std::string serverMessage;
+
+        /**
+         * This is when the current exchange started.
+         */
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /**
+     * This holds what one thread measured.
+     */
+    struct ThreadResults {
+        /**
+         * These are the times taken by each completed handshake.
+         */
+        std::vector< std::chrono::nanoseconds > latencies;
+
+        /**
+         * This is the number of handshakes which didn't succeed.
+         */
+        size_t failures = 0;
+
+        /**
+         * This is the number of allocations made by the clients.
+         */
+        size_t clientAllocations = 0;
+
+        /**
+         * This is the number of allocations made by the stand-in servers.
+         */
+        size_t serverAllocations = 0;
+    };
+
+    /**
+     * Print the usage of the program to the standard error stream.
+     */
+    void PrintUsage() {
+        (void)fprintf(
+            stderr,
+            (
+                "Usage: SaslLoadGen [options]\n"
+                "\n"
+                "Options:\n"
+                "  --mechanism NAME     SCRAM-SHA-1 or SCRAM-SHA-256 (default: SCRAM-SHA-256)\n"
+                "  --iterations N       iteration count of passwords (default: 4096)\n"
+                "  --exchanges N        exchanges in progress at once (default: 64)\n"
+                "  --threads N          threads driving exchanges (default: hardware threads)\n"
+                "  --users N            users whose credentials are taken in turn (default: 1)\n"
+                "  --duration-s N       how long to generate load (default: 5)\n"
+                "  --trace PATH         write a Chrome trace of the exchanges to PATH\n"
+            )
+        );
+    }
+
+    /**
+     * Parse the given command-line arguments.
+     *
+     * @param[in] argc
+     *     This is the number of command-line arguments.
+     *
+     * @param[in] argv
+     *     This is the array of command-line arguments.
+     *
+     * @param[out] options
+     *     This is where to store the options parsed.
+     *
+     * @return
+     *     An indication of whether or not the arguments were valid
+     *     is returned.
+     */
+    bool ParseArguments(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const char* const name = argv[i];
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const char* const value = argv[++i];
+            char* end = nullptr;
+            if (strcmp(name, "--mechanism") == 0) {
+                options.mechanism = value;
+            } else if (strcmp(name, "--trace") == 0) {
+                options.tracePath = value;
+            } else if (strcmp(name, "--duration-s") == 0) {
+                options.durationSeconds = strtod(value, &end);
+                if ((*end != '\0') || (options.durationSeconds <= 0.0)) {
+                    return false;
+                }
+            } else {
+                const auto number = (size_t)strtoul(value, &end, 10);
+                if ((*end != '\0') || (number == 0)) {
+                    return false;
+                }
+                if (strcmp(name, "--iterations") == 0) {
+                    options.iterations = number;
+                } else if (strcmp(name, "--exchanges") == 0) {
+                    options.exchanges = number;
+                } else if (strcmp(name, "--threads") == 0) {
+                    options.threads = number;
+                } else if (strcmp(name, "--users") == 0) {
+                    options.users = number;
+                } else {
+                    return false;
+                }
+            }
+        }
+        options.threads = std::min(options.threads, options.exchanges);
+        return true;
+    }
+
+    /**
+     * Return the name of the user with the given index.
+     *
+     * @param[in] user
+     *     This is the index of the user.
+     *
+     * @return
+     *     The name of the user is returned.
+     */
+    std::string GetUserName(size_t user) {
+        return "user" + std::to_string(user);
+    }
+
+    /**
+     * Return the password of the user with the given index.
+     *
+     * @param[in] user
+     *     This is the index of the user.
+     *
+     * @return
+     *     The password of the user is returned.
+     */
+    std::string GetPassword(size_t user) {
+        return "pencil" + std::to_string(user);
+    }
+
+    /**
+     * Take the next step of the exchange in the given slot.
+     *
+     * @param[in,out] slot
+     *     This is the slot whose exchange to advance.
+     *
+     * @param[in] numUsers
+     *     This is the number of users whose credentials the exchanges
+     *     take turns using.
+     *
+     * @param[in] userStride
+     *     This is how many users to skip between exchanges in the slot.
+     *
+     * @param[in,out] results
+     *     This is where to record what was measured.
+     */
+    void Advance(
+        Slot& slot,
+        size_t numUsers,
+        size_t userStride,
+        ThreadResults& results
+    ) {
+        size_t allocations = AllocationCounter::GetThreadCount();
+        std::string clientMessage;
+        switch (slot.step++) {
+            case 0: {
+                slot.start = std::chrono::steady_clock::now();
+                slot.client->Reset();
+                if (slot.credentialsUser != slot.nextUser) {
+                    slot.client->SetCredentials(
+                        GetPassword(slot.nextUser),
+                        GetUserName(slot.nextUser)
+                    );
+                    slot.credentialsUser = slot.nextUser;
+                }
+                clientMessage = slot.client->GetInitialResponse();
+            } break;
+
+            case 1: {
+                clientMessage = slot.client->Proceed(slot.serverMessage);
+            } break;
+
+            default: {
+                (void)slot.client->Proceed(slot.serverMessage);
+                results.clientAllocations += AllocationCounter::GetThreadCount() - allocations;
+                if (
+                    slot.client->Succeeded()
+                    && slot.server->Succeeded()
+                ) {
+                    results.latencies.push_back(
+                        std::chrono::duration_cast< std::chrono::nanoseconds >(
+                            std::chrono::steady_clock::now() - slot.start
+                        )
+                    );
+                } else {
+                    ++results.failures;
+                }
+                slot.step = 0;
+                slot.nextUser = (slot.nextUser + userStride) % numUsers;
+                slot.server->Reset();
+                return;
+            }
+        }
+        const auto serverAllocations = AllocationCounter::GetThreadCount();
+        results.clientAllocations += serverAllocations - allocations;
+        slot.serverMessage = slot.server->Proceed(clientMessage);
+        results.serverAllocations += AllocationCounter::GetThreadCount() - serverAllocations;
+    }
+
+    /**
+     * Drive the exchanges in the given slots, one step at a time in
+     * turn, until the given deadline.
+     *
+     * @param[in,out] slots
+     *     These are the slots whose exchanges to drive.
+     *
+     * @param[in] numUsers
+     *     This is the number of users whose credentials the exchanges
+     *     take turns using.
+     *
+     * @param[in] userStride
+     *     This is how many users to skip between exchanges in a slot.
+     *
+     * @param[in] deadline
+     *     This is when to stop.
+     *
+     * @param[out] results
+     *     This is where to record what was measured.
+     */
+    void DriveSlots(
+        std::vector< Slot >& slots,
+        size_t numUsers,
+        size_t userStride,
+        std::chrono::steady_clock::time_point deadline,
+        ThreadResults& results
+    ) {
+        while (std::chrono::steady_clock::now() < deadline) {
+            for (auto& slot: slots) {
+                Advance(slot, numUsers, userStride, results);
+            }
+        }
+    }
+
+    /**
+     * Return the given percentile of the given sorted latencies,
+     * in milliseconds, using the nearest-rank method.
+     *
+     * @param[in] latencies
+     *     These are the latencies, sorted in ascending order.
+     *
+     * @param[in] percentile
+     *     This is the percentile to return.
+     *
+     * @return
+     *     The given percentile of the latencies is returned.
+     */
+    double PercentileMilliseconds(
+        const std::vector< std::chrono::nanoseconds >& latencies,
+        size_t percentile
+    ) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        const auto rank = (latencies.size() * percentile + 99) / 100;
+        return latencies[std::max(rank, (size_t)1) - 1].count() / 1e6;
+    }
+
+}
+
+/**
+ * This function is the entrypoint of the program.
+ *
+ * @param[in] argc
+ *     This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *     This is the array of command-line arguments given to the program.
+ */
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+    std::shared_ptr< const Sasl::Client::ScramProfile > profile;
+    if (options.mechanism == "SCRAM-SHA-1") {
+        profile = Sasl::Client::ScramProfile::Sha1();
+    } else if (options.mechanism == "SCRAM-SHA-256") {
+        profile = Sasl::Client::ScramProfile::Sha256();
+    } else {
+        (void)fprintf(stderr, "Unknown mechanism: %s\n", options.mechanism.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // Set up the users and the exchange slots, dealing the slots
+    // out to the threads.
+    const auto accounts = std::make_shared< ScramAccounts >(profile);
+    for (size_t i = 0; i < options.users; ++i) {
+        accounts->Add(GetUserName(i), GetPassword(i), options.iterations);
+    }
+    std::vector< std::vector< Slot > > threadSlots(options.threads);
+    for (size_t i = 0; i < options.exchanges; ++i) {
+        Slot slot;
+        slot.client.reset(new Sasl::Client::Scram());
+        slot.client->SetProfile(profile);
+        slot.server.reset(new ScramResponder(accounts, "-" + std::to_string(i) + "-"));
+        slot.credentialsUser = options.users;
+        slot.nextUser = i % options.users;
+        threadSlots[i % options.threads].push_back(std::move(slot));
+    }
+
+    // Generate the load.
+    if (!options.tracePath.empty()) {
+        Sasl::Trace::Start();
+    }
+    std::vector< ThreadResults > threadResults(options.threads);
+    std::vector< std::thread > workers;
+    const auto start = std::chrono::steady_clock::now();
+    const auto startCpu = clock();
+    const auto deadline = start + std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+        std::chrono::duration< double >(options.durationSeconds)
+    );
+    for (size_t i = 0; i < options.threads; ++i) {
+        workers.emplace_back(
+            DriveSlots,
+            std::ref(threadSlots[i]),
+            options.users,
+            options.exchanges,
+            deadline,
+            std::ref(threadResults[i])
+        );
+    }
+    for (auto& worker: workers) {
+        worker.join();
+    }
+    const auto elapsed = std::chrono::duration< double >(
+        std::chrono::steady_clock::now() - start
+    ).count();
+    const auto cpuSeconds = (double)(clock() - startCpu) / CLOCKS_PER_SEC;
+    if (
+        !options.tracePath.empty()
+        && !Sasl::Trace::Stop(options.tracePath)
+    ) {
+        (void)fprintf(stderr, "Unable to write trace: %s\n", options.tracePath.c_str());
+    }
+
+    // Report the results.
+    ThreadResults totals;
+    for (const auto& results: threadResults) {
+        totals.latencies.insert(
+            totals.latencies.end(),
+            results.latencies.begin(),
+            results.latencies.end()
+        );
+        totals.failures += results.failures;
+        totals.clientAllocations += results.clientAllocations;
+        totals.serverAllocations += results.serverAllocations;
+    }
+    std::sort(totals.latencies.begin(), totals.latencies.end());
+    const auto handshakes = totals.latencies.size();
+    const auto attempts = std::max(handshakes + totals.failures, (size_t)1);
+    (void)printf(
+        "%s, %zu iterations, %zu exchanges on %zu threads, %zu users, %.1f s\n",
+        profile->GetMechanismName().c_str(),
+        options.iterations,
+        options.exchanges,
+        options.threads,
+        options.users,
+        elapsed
+    );
+    (void)printf("%-32s %12zu\n", "Handshakes", handshakes);
+    (void)printf("%-32s %12zu\n", "Failures", totals.failures);
+    (void)printf("%-32s %12.1f\n", "Handshakes/s", handshakes / elapsed);
+    (void)printf("%-32s %12.3f\n", "Latency p50 (ms)", PercentileMilliseconds(totals.latencies, 50));
+    (void)printf("%-32s %12.3f\n", "Latency p90 (ms)", PercentileMilliseconds(totals.latencies, 90));
+    (void)printf("%-32s %12.3f\n", "Latency p99 (ms)", PercentileMilliseconds(totals.latencies, 99));
+    (void)printf("%-32s %12.3f\n", "Latency max (ms)", PercentileMilliseconds(totals.latencies, 100));
+    (void)printf("%-32s %12.2f\n", "Client allocations/handshake", (double)totals.clientAllocations / attempts);
+    (void)printf("%-32s %12.2f\n", "Server allocations/handshake", (double)totals.serverAllocations / attempts);
+    (void)printf("%-32s %12.1f\n", "CPU us/handshake", cpuSeconds * 1e6 / attempts);
+    return (totals.failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,402 @@
+/**
+ * @file main.cpp
+ *
+ * This module holds the main() function, which is the entrypoint
+ * to the SASL exchange replay program.  It re-runs exchanges recorded
+ * by Sasl::Client::Recorder through the client mechanisms, with the
+ * recorded client nonces and test credentials, and reports how long
+ * each step took, so that changes in performance can be compared
+ * (and bisected) against the exchanges seen in production.  The
+ * results are printed as JSON.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <Sasl/Client/Login.hpp>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <Sasl/Client/Transcript.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This holds the options given to the program on the command line.
+     */
+    struct Options {
+        /**
+         * These are the paths of the transcript files to replay.
+         */
+        std::vector< std::string > transcripts;
+
+        /**
+         * This is the number of times to replay every exchange.
+         */
+        size_t rounds = 1;
+
+        /**
+         * This is the user name to use in place of the recorded one.
+         */
+        std::string user = "user";
+
+        /**
+         * This is the password to use in place of the recorded one.
+         */
+        std::string password = "pencil";
+    };
+
+    /**
+     * This holds the timings of one step of the exchanges
+     * replayed with one mechanism.
+     */
+    struct StepTimings {
+        /**
+         * This indicates whether the step got the initial response
+         * (rather than proceeding with a message from the server).
+         */
+        bool initialResponse = false;
+
+        /**
+         * These are the times the step took in the replay, in nanoseconds.
+         */
+        std::vector< uint64_t > replayed;
+
+        /**
+         * This is the sum of the times the step took when it was
+         * recorded, in nanoseconds.
+         */
+        uint64_t recordedTotal = 0;
+    };
+
+    /**
+     * This holds the results of replaying the exchanges
+     * of one mechanism.
+     */
+    struct MechanismResults {
+        /**
+         * This is the mechanism used to replay the exchanges.
+         */
+        std::unique_ptr< Sasl::Client::Mechanism > mechanism;
+
+        /**
+         * This is the number of exchanges replayed.
+         */
+        size_t exchanges = 0;
+
+        /**
+         * This is the number of exchanges whose replay faulted before
+         * the last recorded step, so that not every step was replayed.
+         */
+        size_t diverged = 0;
+
+        /**
+         * These are the timings of the steps of the exchanges,
+         * in the order taken.
+         */
+        std::vector< StepTimings > steps;
+    };
+
+    /**
+     * Print the usage of the program to the standard error stream.
+     */
+    void PrintUsage() {
+        (void)fprintf(
+            stderr,
+            (
+                "Usage: SaslReplay [options] TRANSCRIPT...\n"
+                "\n"
+                "Replay the exchanges in the given transcript files (written by\n"
+                "Sasl::Client::Recorder) and report the time taken by each step.\n"
+                "PLAIN, LOGIN, SCRAM-SHA-1 and SCRAM-SHA-256 exchanges are replayed.\n"
+                "\n"
+                "Options:\n"
+                "  --rounds N          replay every exchange N times (default: 1)\n"
+                "  --user NAME         user name to authenticate as (default: user)\n"
+                "  --password TEXT     password to authenticate with (default: pencil)\n"
+            )
+        );
+    }
+
+    /**
+     * Parse the given command-line arguments.
+     *
+     * @param[in] argc
+     *     This is the number of command-line arguments.
+     *
+     * @param[in] argv
+     *     This is the array of command-line arguments.
+     *
+     * @param[out] options
+     *     This is where to store the options parsed.
+     *
+     * @return
+     *     An indication of whether or not the arguments were valid
+     *     is returned.
+     */
+    bool ParseArguments(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const char* const name = argv[i];
+            if (strncmp(name, "--", 2) != 0) {
+                options.transcripts.push_back(name);
+                continue;
+            }
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const char* const value = argv[++i];
+            if (strcmp(name, "--rounds") == 0) {
+                char* end = nullptr;
+                options.rounds = (size_t)strtoul(value, &end, 10);
+                if ((*end != '\0') || (options.rounds == 0)) {
+                    return false;
+                }
+            } else if (strcmp(name, "--user") == 0) {
+                options.user = value;
+            } else if (strcmp(name, "--password") == 0) {
+                options.password = value;
+            } else {
+                return false;
+            }
+        }
+        return !options.transcripts.empty();
+    }
+
+    /**
+     * Make a mechanism with which to replay exchanges
+     * of the mechanism with the given name.
+     *
+     * @param[in] name
+     *     This is the name of the mechanism.
+     *
+     * @return
+     *     The new mechanism is returned.
+     *
+     * @retval nullptr
+     *     This is returned if exchanges of the named mechanism
+     *     can't be replayed.
+     */
+    std::unique_ptr< Sasl::Client::Mechanism > MakeMechanism(const std::string& name) {
+        if (name == "PLAIN") {
+            return std::unique_ptr< Sasl::Client::Mechanism >(new Sasl::Client::Plain());
+        } else if (name == "LOGIN") {
+            return std::unique_ptr< Sasl::Client::Mechanism >(new Sasl::Client::Login());
+        } else if (name == "SCRAM-SHA-1") {
+            std::unique_ptr< Sasl::Client::Scram > mech(new Sasl::Client::Scram());
+            mech->SetProfile(Sasl::Client::ScramProfile::Sha1());
+            return mech;
+        } else if (name == "SCRAM-SHA-256") {
+            std::unique_ptr< Sasl::Client::Scram > mech(new Sasl::Client::Scram());
+            mech->SetProfile(Sasl::Client::ScramProfile::Sha256());
+            return mech;
+        } else {
+            return nullptr;
+        }
+    }
+
+    /**
+     * Replay the given exchange with the given mechanism, adding the
+     * time taken by each step to the given results.
+     *
+     * @param[in] exchange
+     *     This is the exchange to replay.
+     *
+     * @param[in,out] results
+     *     This holds the mechanism with which to replay the exchange,
+     *     and is where to add the time taken by each step.
+     */
+    void Replay(
+        const Sasl::Client::TranscriptExchange& exchange,
+        MechanismResults& results
+    ) {
+        auto& mech = *results.mechanism;
+        if (
+            !exchange.steps.empty()
+            && exchange.steps[0].initialResponse
+        ) {
+            mech.SetInitialResponseMode(
+                (exchange.steps[0].clientMessageLength == 0)
+                ? Sasl::Client::InitialResponseMode::Never
+                : Sasl::Client::InitialResponseMode::Always
+            );
+        }
+        const auto scram = dynamic_cast< Sasl::Client::Scram* >(&mech);
+        if (scram != nullptr) {
+            scram->SetClientNonce(exchange.clientNonce);
+        }
+        mech.Reset();
+        ++results.exchanges;
+        if (results.steps.size() < exchange.steps.size()) {
+            results.steps.resize(exchange.steps.size());
+        }
+        for (size_t i = 0; i < exchange.steps.size(); ++i) {
+            const auto& step = exchange.steps[i];
+            if (mech.Faulted()) {
+                ++results.diverged;
+                break;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            if (step.initialResponse) {
+                (void)mech.GetInitialResponse();
+            } else {
+                (void)mech.Proceed(step.serverMessage);
+            }
+            const auto nanoseconds = std::chrono::duration_cast< std::chrono::nanoseconds >(
+                std::chrono::steady_clock::now() - start
+            ).count();
+            auto& timings = results.steps[i];
+            timings.initialResponse = step.initialResponse;
+            timings.replayed.push_back((uint64_t)nanoseconds);
+            timings.recordedTotal += step.nanoseconds;
+        }
+    }
+
+    /**
+     * Return the given percentile of the given sorted times,
+     * using the nearest-rank method.
+     *
+     * @param[in] sorted
+     *     These are the times, in ascending order.
+     *
+     * @param[in] percentile
+     *     This is the percentile to return.
+     *
+     * @return
+     *     The given percentile of the times is returned.
+     */
+    uint64_t Percentile(
+        const std::vector< uint64_t >& sorted,
+        size_t percentile
+    ) {
+        const auto rank = std::max(
+            (sorted.size() * percentile + 99) / 100,
+            (size_t)1
+        );
+        return sorted[rank - 1];
+    }
+
+    /**
+     * Print the timings of the given step as a JSON object.
+     *
+     * @param[in] index
+     *     This is the index of the step in the exchanges.
+     *
+     * @param[in,out] timings
+     *     These are the timings of the step.  The replayed
+     *     times are sorted.
+     *
+     * @param[in] last
+     *     This indicates whether or not the step is the last
+     *     in its array.
+     */
+    void PrintStep(size_t index, StepTimings& timings, bool last) {
+        auto& replayed = timings.replayed;
+        std::sort(replayed.begin(), replayed.end());
+        uint64_t total = 0;
+        for (const auto nanoseconds: replayed) {
+            total += nanoseconds;
+        }
+        const auto count = replayed.size();
+        (void)printf(
+            (
+                "        {\"step\": %zu, \"kind\": \"%s\", \"count\": %zu,"
+                " \"meanUs\": %.3f, \"p50Us\": %.3f, \"p99Us\": %.3f,"
+                " \"maxUs\": %.3f, \"recordedMeanUs\": %.3f}%s\n"
+            ),
+            index,
+            (timings.initialResponse ? "initial-response" : "proceed"),
+            count,
+            (count == 0) ? 0.0 : total / 1e3 / count,
+            (count == 0) ? 0.0 : Percentile(replayed, 50) / 1e3,
+            (count == 0) ? 0.0 : Percentile(replayed, 99) / 1e3,
+            (count == 0) ? 0.0 : replayed.back() / 1e3,
+            (count == 0) ? 0.0 : timings.recordedTotal / 1e3 / count,
+            (last ? "" : ",")
+        );
+    }
+
+}
+
+/**
+ * This function is the entrypoint of the program.
+ *
+ * @param[in] argc
+ *     This is the number of command-line arguments given to the program.
+ *
+ * @param[in] argv
+ *     This is the array of command-line arguments given to the program.
+ */
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+    std::vector< Sasl::Client::TranscriptExchange > exchanges;
+    for (const auto& transcript: options.transcripts) {
+        if (!Sasl::Client::ReadTranscriptFile(transcript, exchanges)) {
+            (void)fprintf(stderr, "Unable to read transcript: %s\n", transcript.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Each mechanism is made once, with the test credentials, and reset
+    // for every exchange, so that only the steps themselves are timed.
+    std::map< std::string, MechanismResults > resultsByMechanism;
+    size_t skipped = 0;
+    for (size_t round = 0; round < options.rounds; ++round) {
+        for (const auto& exchange: exchanges) {
+            auto& results = resultsByMechanism[exchange.mechanism];
+            if (results.mechanism == nullptr) {
+                results.mechanism = MakeMechanism(exchange.mechanism);
+                if (results.mechanism == nullptr) {
+                    ++skipped;
+                    continue;
+                }
+                results.mechanism->SetCredentials(options.password, options.user);
+            }
+            Replay(exchange, results);
+        }
+    }
+
+    (void)printf("{\n");
+    (void)printf("  \"exchanges\": %zu,\n", exchanges.size());
+    (void)printf("  \"rounds\": %zu,\n", options.rounds);
+    (void)printf("  \"skipped\": %zu,\n", skipped);
+    (void)printf("  \"mechanisms\": [\n");
+    size_t printed = 0;
+    size_t toPrint = 0;
+    for (const auto& entry: resultsByMechanism) {
+        if (entry.second.mechanism != nullptr) {
+            ++toPrint;
+        }
+    }
+    for (auto& entry: resultsByMechanism) {
+        auto& results = entry.second;
+        if (results.mechanism == nullptr) {
+            continue;
+        }
+        (void)printf("    {\n");
+        (void)printf("      \"name\": \"%s\",\n", entry.first.c_str());
+        (void)printf("      \"exchanges\": %zu,\n", results.exchanges);
+        (void)printf("      \"diverged\": %zu,\n", results.diverged);
+        (void)printf("      \"steps\": [\n");
+        for (size_t i = 0; i < results.steps.size(); ++i) {
+            PrintStep(i, results.steps[i], i + 1 == results.steps.size());
+        }
+        (void)printf("      ]\n");
+        (void)printf("    }%s\n", ((++printed == toPrint) ? "" : ","));
+    }
+    (void)printf("  ]\n");
+    (void)printf("}\n");
+    return EXIT_SUCCESS;
+}
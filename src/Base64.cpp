@@ -0,0 +1,232 @@
+/**
+ * @file Base64.cpp
+ *
+ * This module contains the implementation of the Base64 encoder and
+ * decoder built into the library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Base64Blocks.hpp"
+#include "Cpu.hpp"
+
+#include <Sasl/Base64.hpp>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This is the Base64 alphabet, indexed by 6-bit value.
+     */
+    const char ENCODING[] = (
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+    );
+
+    /**
+     * This is the 6-bit value of each character in the Base64 alphabet,
+     * indexed by character.  Characters outside the alphabet
+     * (including the padding character) have the value 0x80.
+     */
+    const uint8_t DECODING[256] = {
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x3E, 0x80, 0x80, 0x80, 0x3F,
+        0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+        0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+        0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+        0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    };
+
+    /**
+     * This holds the block encoder and decoder of one implementation.
+     */
+    struct BlockFunctions {
+        /**
+         * This is the block encoder, or nullptr if the portable
+         * implementation is to be used for the whole encoding.
+         */
+        Sasl::Base64Blocks::EncodeFunction encode = nullptr;
+
+        /**
+         * This is the block decoder, or nullptr if the portable
+         * implementation is to be used for the whole decoding.
+         */
+        Sasl::Base64Blocks::DecodeFunction decode = nullptr;
+    };
+
+    /**
+     * Select the block encoder and decoder to use for the given
+     * implementation, taking into account which are built into the
+     * library and supported by the processor.
+     *
+     * @param[in] implementation
+     *     This selects which implementation to use.
+     *
+     * @return
+     *     The block encoder and decoder to use are returned.
+     */
+    BlockFunctions SelectBlockFunctions(Sasl::Base64::Implementation implementation) {
+        BlockFunctions functions;
+        switch (implementation) {
+            case Sasl::Base64::Implementation::Automatic: {
+                static const BlockFunctions fastest = []{
+                    auto functions = SelectBlockFunctions(Sasl::Base64::Implementation::Avx2);
+                    if (functions.encode == nullptr) {
+                        functions = SelectBlockFunctions(Sasl::Base64::Implementation::Sse41);
+                    }
+                    return functions;
+                }();
+                functions = fastest;
+            } break;
+
+            case Sasl::Base64::Implementation::Sse41: {
+                if (Sasl::Base64::IsSse41Available()) {
+                    functions.encode = Sasl::Base64Blocks::GetEncodeSse41();
+                    functions.decode = Sasl::Base64Blocks::GetDecodeSse41();
+                }
+            } break;
+
+            case Sasl::Base64::Implementation::Avx2: {
+                if (Sasl::Base64::IsAvx2Available()) {
+                    functions.encode = Sasl::Base64Blocks::GetEncodeAvx2();
+                    functions.decode = Sasl::Base64Blocks::GetDecodeAvx2();
+                }
+            } break;
+
+            default: break;
+        }
+        return functions;
+    }
+
+}
+
+namespace Sasl {
+namespace Base64 {
+
+    bool IsSse41Available() {
+        return (
+            (Base64Blocks::GetEncodeSse41() != nullptr)
+            && Cpu::HasSse41()
+        );
+    }
+
+    bool IsAvx2Available() {
+        return (
+            (Base64Blocks::GetEncodeAvx2() != nullptr)
+            && Cpu::HasAvx2()
+        );
+    }
+
+    size_t Encode(
+        const void* data,
+        size_t length,
+        char* output,
+        Implementation implementation
+    ) {
+        const auto input = (const uint8_t*)data;
+        auto next = output;
+        size_t i = 0;
+        const auto encodeBlocks = SelectBlockFunctions(implementation).encode;
+        if (encodeBlocks != nullptr) {
+            i = encodeBlocks(input, length, next);
+            next += (i / 3) * 4;
+        }
+        for (; i + 3 <= length; i += 3) {
+            const uint32_t group = (
+                ((uint32_t)input[i] << 16)
+                | ((uint32_t)input[i + 1] << 8)
+                | (uint32_t)input[i + 2]
+            );
+            *next++ = ENCODING[(group >> 18) & 0x3F];
+            *next++ = ENCODING[(group >> 12) & 0x3F];
+            *next++ = ENCODING[(group >> 6) & 0x3F];
+            *next++ = ENCODING[group & 0x3F];
+        }
+        if (i < length) {
+            uint32_t group = ((uint32_t)input[i] << 16);
+            if (i + 1 < length) {
+                group |= ((uint32_t)input[i + 1] << 8);
+            }
+            *next++ = ENCODING[(group >> 18) & 0x3F];
+            *next++ = ENCODING[(group >> 12) & 0x3F];
+            *next++ = (i + 1 < length) ? ENCODING[(group >> 6) & 0x3F] : '=';
+            *next++ = '=';
+        }
+        return (size_t)(next - output);
+    }
+
+    bool Decode(
+        const char* encoded,
+        size_t length,
+        void* output,
+        size_t& decodedLength,
+        Implementation implementation
+    ) {
+        decodedLength = 0;
+        if ((length % 4) != 0) {
+            return false;
+        }
+        const auto start = (uint8_t*)output;
+        auto next = start;
+        size_t i = 0;
+        const auto decodeBlocks = SelectBlockFunctions(implementation).decode;
+        if (decodeBlocks != nullptr) {
+            i = decodeBlocks(encoded, length, next);
+            next += (i / 4) * 3;
+        }
+        for (; i < length; i += 4) {
+            size_t padding = 0;
+            if (
+                (i + 4 == length)
+                && (encoded[i + 3] == '=')
+            ) {
+                padding = ((encoded[i + 2] == '=') ? 2 : 1);
+            }
+            const uint32_t a = DECODING[(uint8_t)encoded[i]];
+            const uint32_t b = DECODING[(uint8_t)encoded[i + 1]];
+            const uint32_t c = ((padding < 2) ? DECODING[(uint8_t)encoded[i + 2]] : 0);
+            const uint32_t d = ((padding < 1) ? DECODING[(uint8_t)encoded[i + 3]] : 0);
+            if (((a | b | c | d) & 0x80) != 0) {
+                return false;
+            }
+            const uint32_t group = ((a << 18) | (b << 12) | (c << 6) | d);
+            *next++ = (uint8_t)(group >> 16);
+            if (padding < 2) {
+                *next++ = (uint8_t)(group >> 8);
+            }
+            if (padding < 1) {
+                *next++ = (uint8_t)group;
+            }
+        }
+        decodedLength = (size_t)(next - start);
+        return true;
+    }
+
+    std::string Encode(const std::string& data) {
+        std::string encoded(EncodedLength(data.length()), '\0');
+        (void)Encode(data.data(), data.length(), &encoded[0]);
+        return encoded;
+    }
+
+    bool Decode(const std::string& encoded, std::string& decoded) {
+        decoded.resize(MaxDecodedLength(encoded.length()));
+        size_t decodedLength;
+        if (!Decode(encoded.data(), encoded.length(), &decoded[0], decodedLength)) {
+            decoded.clear();
+            return false;
+        }
+        decoded.resize(decodedLength);
+        return true;
+    }
+
+}
+}
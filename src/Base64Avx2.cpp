@@ -0,0 +1,234 @@
+/**
+ * @file Base64Avx2.cpp
+ *
+ * This module contains the implementations of the Base64 block encoder
+ * and decoder which use the AVX2 instructions.  It is compiled with the
+ * code generation options needed for the instructions, so it must only be
+ * entered after checking that the processor supports them.
+ *
+ * The methods are those of Wojciech Muła and Daniel Lemire, "Faster Base64
+ * Encoding and Decoding Using AVX2 Instructions" (ACM Transactions on the
+ * Web, 2018).
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Base64Blocks.hpp"
+
+#if defined(__AVX2__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define SASL_BASE64_AVX2_AVAILABLE
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#ifdef SASL_BASE64_AVX2_AVAILABLE
+
+    /**
+     * Split each group of three octets in the given vector into four
+     * 6-bit values, one per byte.
+     *
+     * @param[in] input
+     *     This holds the octets to split in the low twelve bytes
+     *     of each 128-bit lane.
+     *
+     * @return
+     *     The thirty-two 6-bit values are returned.
+     */
+    inline __m256i Split(__m256i input) {
+        input = _mm256_shuffle_epi8(
+            input,
+            _mm256_setr_epi8(
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+            )
+        );
+        const auto high = _mm256_mulhi_epu16(
+            _mm256_and_si256(input, _mm256_set1_epi32(0x0FC0FC00)),
+            _mm256_set1_epi32(0x04000040)
+        );
+        const auto low = _mm256_mullo_epi16(
+            _mm256_and_si256(input, _mm256_set1_epi32(0x003F03F0)),
+            _mm256_set1_epi32(0x01000010)
+        );
+        return _mm256_or_si256(high, low);
+    }
+
+    /**
+     * Translate each 6-bit value in the given vector into its character
+     * in the Base64 alphabet.
+     *
+     * @param[in] values
+     *     These are the values to translate.
+     *
+     * @return
+     *     The characters are returned.
+     */
+    inline __m256i Translate(__m256i values) {
+        auto offsetIndex = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+        const auto isLetterAtoZ = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), values);
+        offsetIndex = _mm256_or_si256(
+            offsetIndex,
+            _mm256_and_si256(isLetterAtoZ, _mm256_set1_epi8(13))
+        );
+        const auto offsets = _mm256_setr_epi8(
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+            '/' - 63, 'A', 0, 0,
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+            '/' - 63, 'A', 0, 0
+        );
+        return _mm256_add_epi8(values, _mm256_shuffle_epi8(offsets, offsetIndex));
+    }
+
+    /**
+     * Translate each character in the given vector from the Base64
+     * alphabet into its 6-bit value.
+     *
+     * @param[in] input
+     *     These are the characters to translate.
+     *
+     * @param[out] values
+     *     This is where to store the values.
+     *
+     * @return
+     *     An indication of whether or not every character is in the
+     *     Base64 alphabet is returned.
+     */
+    inline bool Untranslate(__m256i input, __m256i& values) {
+        const auto highNibbles = _mm256_and_si256(
+            _mm256_srli_epi32(input, 4),
+            _mm256_set1_epi8(0x0F)
+        );
+        const auto lowNibbles = _mm256_and_si256(input, _mm256_set1_epi8(0x0F));
+        const auto validHighNibblesByLowNibble = _mm256_setr_epi8(
+            (char)0xA8, (char)0xF8, (char)0xF8, (char)0xF8,
+            (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8,
+            (char)0xF8, (char)0xF8, (char)0xF0, (char)0x54,
+            (char)0x50, (char)0x50, (char)0x50, (char)0x54,
+            (char)0xA8, (char)0xF8, (char)0xF8, (char)0xF8,
+            (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8,
+            (char)0xF8, (char)0xF8, (char)0xF0, (char)0x54,
+            (char)0x50, (char)0x50, (char)0x50, (char)0x54
+        );
+        const auto highNibbleBits = _mm256_setr_epi8(
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+            0, 0, 0, 0, 0, 0, 0, 0,
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+            0, 0, 0, 0, 0, 0, 0, 0
+        );
+        const auto valid = _mm256_and_si256(
+            _mm256_shuffle_epi8(validHighNibblesByLowNibble, lowNibbles),
+            _mm256_shuffle_epi8(highNibbleBits, highNibbles)
+        );
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(valid, _mm256_setzero_si256())) != 0) {
+            return false;
+        }
+        const auto offsetsByHighNibble = _mm256_setr_epi8(
+            0, 0, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0
+        );
+        const auto offsets = _mm256_blendv_epi8(
+            _mm256_shuffle_epi8(offsetsByHighNibble, highNibbles),
+            _mm256_set1_epi8(16),
+            _mm256_cmpeq_epi8(input, _mm256_set1_epi8('/'))
+        );
+        values = _mm256_add_epi8(input, offsets);
+        return true;
+    }
+
+    /**
+     * Join each group of four 6-bit values in the given vector back
+     * into three octets.
+     *
+     * @param[in] values
+     *     These are the thirty-two values to join.
+     *
+     * @return
+     *     The vector is returned with the twenty-four octets
+     *     in its low twenty-four bytes.
+     */
+    inline __m256i Join(__m256i values) {
+        const auto pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        const auto groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        const auto packedLanes = _mm256_shuffle_epi8(
+            groups,
+            _mm256_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+            )
+        );
+        return _mm256_permutevar8x32_epi32(
+            packedLanes,
+            _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7)
+        );
+    }
+
+    /**
+     * This is the implementation of EncodeFunction which uses the AVX2
+     * instructions.  It encodes twenty-four octets at a time, loading
+     * sixteen octets into each 128-bit lane.
+     */
+    size_t Encode(const uint8_t* data, size_t length, char* output) {
+        size_t i = 0;
+        for (; i + 28 <= length; i += 24) {
+            const auto input = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(data + i))),
+                _mm_loadu_si128((const __m128i*)(data + i + 12)),
+                1
+            );
+            _mm256_storeu_si256((__m256i*)output, Translate(Split(input)));
+            output += 32;
+        }
+        return i;
+    }
+
+    /**
+     * This is the implementation of DecodeFunction which uses the AVX2
+     * instructions.  It decodes thirty-two characters at a time, storing
+     * thirty-two octets of which twenty-four are decoded.
+     */
+    size_t Decode(const char* encoded, size_t length, uint8_t* output) {
+        size_t i = 0;
+        for (; i + 44 <= length; i += 32) {
+            const auto input = _mm256_loadu_si256((const __m256i*)(encoded + i));
+            __m256i values;
+            if (!Untranslate(input, values)) {
+                break;
+            }
+            _mm256_storeu_si256((__m256i*)output, Join(values));
+            output += 24;
+        }
+        return i;
+    }
+
+#endif /* SASL_BASE64_AVX2_AVAILABLE */
+
+}
+
+namespace Sasl {
+namespace Base64Blocks {
+
+    EncodeFunction GetEncodeAvx2() {
+#ifdef SASL_BASE64_AVX2_AVAILABLE
+        return Encode;
+#else
+        return nullptr;
+#endif
+    }
+
+    DecodeFunction GetDecodeAvx2() {
+#ifdef SASL_BASE64_AVX2_AVAILABLE
+        return Decode;
+#else
+        return nullptr;
+#endif
+    }
+
+}
+}
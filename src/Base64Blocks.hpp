@@ -0,0 +1,133 @@
+#pragma once
+
+/**
+ * @file Base64Blocks.hpp
+ *
+ * This module declares the functions which encode and decode the bulk
+ * of a Base64 encoding in blocks, using vector processor instructions.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Sasl {
+namespace Base64Blocks {
+
+    /**
+     * This is the type of function which encodes as many whole blocks
+     * of the given octets in Base64 as it can without reading past the
+     * end of them.  The rest are left to be encoded by the caller.
+     *
+     * @param[in] data
+     *     This points to the octets to encode.
+     *
+     * @param[in] length
+     *     This is the number of octets to encode.
+     *
+     * @param[out] output
+     *     This is where to store the encoding.
+     *
+     * @return
+     *     The number of octets encoded is returned.  It's always
+     *     a multiple of three.
+     */
+    typedef size_t (*EncodeFunction)(
+        const uint8_t* data,
+        size_t length,
+        char* output
+    );
+
+    /**
+     * This is the type of function which decodes as many whole blocks of
+     * the given Base64 encoding as it can without writing past the end of
+     * the decoded octets, leaving the last four characters (which may be
+     * padded) and the rest to be decoded by the caller.  It stops early
+     * at the first block with a character outside the Base64 alphabet,
+     * so that the caller finds it.
+     *
+     * @param[in] encoded
+     *     This points to the encoding to decode.
+     *
+     * @param[in] length
+     *     This is the number of characters to decode.  It must be
+     *     a multiple of four.
+     *
+     * @param[out] output
+     *     This is where to store the decoded octets.
+     *
+     * @return
+     *     The number of characters decoded is returned.  It's always
+     *     a multiple of four.
+     */
+    typedef size_t (*DecodeFunction)(
+        const char* encoded,
+        size_t length,
+        uint8_t* output
+    );
+
+    /**
+     * Return the encoder which uses the SSSE3 and SSE4.1 instructions,
+     * if the library was built with it.
+     *
+     * @note
+     *     The processor's support of the instructions is not checked.
+     *
+     * @return
+     *     The encoder which uses the SSSE3 and SSE4.1 instructions
+     *     is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the library was built without it.
+     */
+    EncodeFunction GetEncodeSse41();
+
+    /**
+     * Return the decoder which uses the SSSE3 and SSE4.1 instructions,
+     * if the library was built with it.
+     *
+     * @note
+     *     The processor's support of the instructions is not checked.
+     *
+     * @return
+     *     The decoder which uses the SSSE3 and SSE4.1 instructions
+     *     is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the library was built without it.
+     */
+    DecodeFunction GetDecodeSse41();
+
+    /**
+     * Return the encoder which uses the AVX2 instructions,
+     * if the library was built with it.
+     *
+     * @note
+     *     The processor's support of the instructions is not checked.
+     *
+     * @return
+     *     The encoder which uses the AVX2 instructions is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the library was built without it.
+     */
+    EncodeFunction GetEncodeAvx2();
+
+    /**
+     * Return the decoder which uses the AVX2 instructions,
+     * if the library was built with it.
+     *
+     * @note
+     *     The processor's support of the instructions is not checked.
+     *
+     * @return
+     *     The decoder which uses the AVX2 instructions is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the library was built without it.
+     */
+    DecodeFunction GetDecodeAvx2();
+
+}
+}
@@ -0,0 +1,207 @@
+/**
+ * @file Base64Sse41.cpp
+ *
+ * This module contains the implementations of the Base64 block encoder
+ * and decoder which use the SSSE3 and SSE4.1 instructions.  It is compiled
+ * with the code generation options needed for the instructions, so it must
+ * only be entered after checking that the processor supports them.
+ *
+ * The methods are those of Wojciech Muła and Daniel Lemire, "Faster Base64
+ * Encoding and Decoding Using AVX2 Instructions" (ACM Transactions on the
+ * Web, 2018), applied to 128-bit vectors.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Base64Blocks.hpp"
+
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define SASL_BASE64_SSE41_AVAILABLE
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#ifdef SASL_BASE64_SSE41_AVAILABLE
+
+    /**
+     * Split each group of three octets in the given vector into four
+     * 6-bit values, one per byte.
+     *
+     * @param[in] input
+     *     This holds the octets to split in its low twelve bytes.
+     *
+     * @return
+     *     The sixteen 6-bit values are returned.
+     */
+    inline __m128i Split(__m128i input) {
+        input = _mm_shuffle_epi8(
+            input,
+            _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10)
+        );
+        const auto high = _mm_mulhi_epu16(
+            _mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)),
+            _mm_set1_epi32(0x04000040)
+        );
+        const auto low = _mm_mullo_epi16(
+            _mm_and_si128(input, _mm_set1_epi32(0x003F03F0)),
+            _mm_set1_epi32(0x01000010)
+        );
+        return _mm_or_si128(high, low);
+    }
+
+    /**
+     * Translate each 6-bit value in the given vector into its character
+     * in the Base64 alphabet.
+     *
+     * @param[in] values
+     *     These are the values to translate.
+     *
+     * @return
+     *     The characters are returned.
+     */
+    inline __m128i Translate(__m128i values) {
+        auto offsetIndex = _mm_subs_epu8(values, _mm_set1_epi8(51));
+        const auto isLetterAtoZ = _mm_cmpgt_epi8(_mm_set1_epi8(26), values);
+        offsetIndex = _mm_or_si128(
+            offsetIndex,
+            _mm_and_si128(isLetterAtoZ, _mm_set1_epi8(13))
+        );
+        const auto offsets = _mm_setr_epi8(
+            'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+            '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+            '/' - 63, 'A', 0, 0
+        );
+        return _mm_add_epi8(values, _mm_shuffle_epi8(offsets, offsetIndex));
+    }
+
+    /**
+     * Translate each character in the given vector from the Base64
+     * alphabet into its 6-bit value.
+     *
+     * @param[in] input
+     *     These are the characters to translate.
+     *
+     * @param[out] values
+     *     This is where to store the values.
+     *
+     * @return
+     *     An indication of whether or not every character is in the
+     *     Base64 alphabet is returned.
+     */
+    inline bool Untranslate(__m128i input, __m128i& values) {
+        const auto highNibbles = _mm_and_si128(
+            _mm_srli_epi32(input, 4),
+            _mm_set1_epi8(0x0F)
+        );
+        const auto lowNibbles = _mm_and_si128(input, _mm_set1_epi8(0x0F));
+        const auto validHighNibblesByLowNibble = _mm_setr_epi8(
+            (char)0xA8, (char)0xF8, (char)0xF8, (char)0xF8,
+            (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8,
+            (char)0xF8, (char)0xF8, (char)0xF0, (char)0x54,
+            (char)0x50, (char)0x50, (char)0x50, (char)0x54
+        );
+        const auto highNibbleBits = _mm_setr_epi8(
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+            0, 0, 0, 0, 0, 0, 0, 0
+        );
+        const auto valid = _mm_and_si128(
+            _mm_shuffle_epi8(validHighNibblesByLowNibble, lowNibbles),
+            _mm_shuffle_epi8(highNibbleBits, highNibbles)
+        );
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(valid, _mm_setzero_si128())) != 0) {
+            return false;
+        }
+        const auto offsetsByHighNibble = _mm_setr_epi8(
+            0, 0, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0
+        );
+        const auto offsets = _mm_blendv_epi8(
+            _mm_shuffle_epi8(offsetsByHighNibble, highNibbles),
+            _mm_set1_epi8(16),
+            _mm_cmpeq_epi8(input, _mm_set1_epi8('/'))
+        );
+        values = _mm_add_epi8(input, offsets);
+        return true;
+    }
+
+    /**
+     * Join each group of four 6-bit values in the given vector back
+     * into three octets.
+     *
+     * @param[in] values
+     *     These are the sixteen values to join.
+     *
+     * @return
+     *     The vector is returned with the twelve octets
+     *     in its low twelve bytes.
+     */
+    inline __m128i Join(__m128i values) {
+        const auto pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const auto groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        return _mm_shuffle_epi8(
+            groups,
+            _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+        );
+    }
+
+    /**
+     * This is the implementation of EncodeFunction which uses the SSSE3
+     * and SSE4.1 instructions.  It encodes twelve octets at a time,
+     * loading sixteen.
+     */
+    size_t Encode(const uint8_t* data, size_t length, char* output) {
+        size_t i = 0;
+        for (; i + 16 <= length; i += 12) {
+            const auto input = _mm_loadu_si128((const __m128i*)(data + i));
+            _mm_storeu_si128((__m128i*)output, Translate(Split(input)));
+            output += 16;
+        }
+        return i;
+    }
+
+    /**
+     * This is the implementation of DecodeFunction which uses the SSSE3
+     * and SSE4.1 instructions.  It decodes sixteen characters at a time,
+     * storing sixteen octets of which twelve are decoded.
+     */
+    size_t Decode(const char* encoded, size_t length, uint8_t* output) {
+        size_t i = 0;
+        for (; i + 24 <= length; i += 16) {
+            const auto input = _mm_loadu_si128((const __m128i*)(encoded + i));
+            __m128i values;
+            if (!Untranslate(input, values)) {
+                break;
+            }
+            _mm_storeu_si128((__m128i*)output, Join(values));
+            output += 12;
+        }
+        return i;
+    }
+
+#endif /* SASL_BASE64_SSE41_AVAILABLE */
+
+}
+
+namespace Sasl {
+namespace Base64Blocks {
+
+    EncodeFunction GetEncodeSse41() {
+#ifdef SASL_BASE64_SSE41_AVAILABLE
+        return Encode;
+#else
+        return nullptr;
+#endif
+    }
+
+    DecodeFunction GetDecodeSse41() {
+#ifdef SASL_BASE64_SSE41_AVAILABLE
+        return Decode;
+#else
+        return nullptr;
+#endif
+    }
+
+}
+}
@@ -0,0 +1,49 @@
+/**
+ * @file CancellationToken.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::CancellationToken class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <atomic>
+#include <Sasl/CancellationToken.hpp>
+
+namespace Sasl {
+
+    /**
+     * This contains the state shared by all copies of a
+     * CancellationToken instance.
+     */
+    struct CancellationToken::State {
+        /**
+         * This indicates whether or not the token has been cancelled.
+         */
+        std::atomic< bool > cancelled{false};
+    };
+
+    CancellationToken CancellationToken::Create() {
+        CancellationToken token;
+        token.state_ = std::make_shared< State >();
+        return token;
+    }
+
+    void CancellationToken::Cancel() {
+        if (state_ != nullptr) {
+            state_->cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    bool CancellationToken::IsCancelled() const {
+        return (
+            (state_ != nullptr)
+            && state_->cancelled.load(std::memory_order_relaxed)
+        );
+    }
+
+    bool CancellationToken::CanBeCancelled() const {
+        return (state_ != nullptr);
+    }
+
+}
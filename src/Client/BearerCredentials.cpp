@@ -0,0 +1,222 @@
+/**
+ * @file BearerCredentials.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::BearerCredentials class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../Wipe.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <Sasl/Client/BearerCredentials.hpp>
+
+namespace {
+
+    /**
+     * This is what is published to diagnostics in place of a token.
+     */
+    const std::string TOKEN_MASK = "*******";
+
+    /**
+     * Build the GS2 header for the given authorization identity, which is
+     * left out if empty, escaping it as a saslname
+     * ([RFC 5801](https://tools.ietf.org/html/rfc5801) section 4).
+     *
+     * @param[in] user
+     *     This is the authorization identity to put in the header.
+     *
+     * @return
+     *     The GS2 header is returned.
+     */
+    std::string MakeGs2Header(const std::string& user) {
+        // gs2-header  = gs2-cbind-flag "," [ gs2-authzid ] ","
+        // gs2-authzid = "a=" saslname
+        // saslname    = 1*(UTF8-char-safe / "=2C" / "=3D")
+        std::string gs2Header = "n,";
+        if (!user.empty()) {
+            gs2Header += "a=";
+            for (auto c: user) {
+                if (c == ',') {
+                    gs2Header += "=2C";
+                } else if (c == '=') {
+                    gs2Header += "=3D";
+                } else {
+                    gs2Header += c;
+                }
+            }
+        }
+        gs2Header += ',';
+        return gs2Header;
+    }
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a BearerCredentials instance.
+     */
+    struct BearerCredentials::Impl {
+        // Properties
+
+        /**
+         * This is the identity of the user on whose behalf the token
+         * was issued.
+         */
+        std::string user;
+
+        /**
+         * This is the name of the server, which OAUTHBEARER passes along,
+         * if not empty.
+         */
+        std::string host;
+
+        /**
+         * This is the port of the server, which OAUTHBEARER passes along,
+         * if not zero.
+         */
+        uint16_t port = 0;
+
+        /**
+         * This is the latest snapshot of the messages built from the
+         * credentials.  It's only accessed with the mutex locked, so that
+         * it can be replaced while other threads read it.
+         */
+        std::shared_ptr< const Payloads > payloads;
+
+        /**
+         * This is used to synchronize access to the latest snapshot.
+         * It's held only long enough to copy or replace the pointer
+         * to the snapshot, never while messages are built.
+         */
+        std::mutex mutex;
+
+        /**
+         * This counts the tokens set in the credentials.  Refresh may be
+         * called from more than one thread at once, so each snapshot
+         * takes its generation from this atomically.
+         */
+        std::atomic< uint64_t > generation;
+
+        // Methods
+
+        /**
+         * This is the default constructor.
+         */
+        Impl()
+            : generation(0)
+        {
+        }
+
+        /**
+         * Build the messages which pass the given token to the server,
+         * and publish them as the latest snapshot.
+         *
+         * @param[in] token
+         *     This is the bearer token to pass to the server.
+         */
+        void Publish(const std::string& token) {
+            std::shared_ptr< Payloads > newPayloads(new Payloads());
+            newPayloads->generation = ++generation;
+
+            // kvpair     = key "=" value kvsep
+            // client-resp = (gs2-header kvsep *kvpair kvsep) / kvsep
+            std::string kvpairs;
+            if (!host.empty()) {
+                kvpairs += "host=" + host + '\x01';
+            }
+            if (port != 0) {
+                kvpairs += "port=" + std::to_string(port) + '\x01';
+            }
+            const auto gs2Header = MakeGs2Header(user);
+            newPayloads->oauthBearerMessage = (
+                gs2Header + '\x01'
+                + kvpairs
+                + "auth=Bearer " + token + '\x01'
+                + '\x01'
+            );
+            std::string diagnosticKvpairs;
+            for (auto c: kvpairs) {
+                if (c == '\x01') {
+                    diagnosticKvpairs += "\\1";
+                } else {
+                    diagnosticKvpairs += c;
+                }
+            }
+            newPayloads->oauthBearerDiagnosticMessage = (
+                "C: AUTH OAUTHBEARER " + gs2Header + "\\1"
+                + diagnosticKvpairs
+                + "auth=Bearer " + TOKEN_MASK + "\\1\\1"
+            );
+
+            // "user=" {User} "^Aauth=Bearer " {Access Token} "^A^A"
+            newPayloads->xoauth2Message = (
+                "user=" + user + '\x01'
+                + "auth=Bearer " + token + '\x01'
+                + '\x01'
+            );
+            newPayloads->xoauth2DiagnosticMessage = (
+                "C: AUTH XOAUTH2 user=" + user + "\\1"
+                + "auth=Bearer " + TOKEN_MASK + "\\1\\1"
+            );
+
+            // If Refresh is called from more than one thread at once, the
+            // snapshot of the latest token wins, whichever is built first.
+            // The snapshot replaced is let go after the mutex is released.
+            std::shared_ptr< const Payloads > snapshot(std::move(newPayloads));
+            std::lock_guard< std::mutex > lock(mutex);
+            if (
+                (payloads == nullptr)
+                || (payloads->generation < snapshot->generation)
+            ) {
+                payloads.swap(snapshot);
+            }
+        }
+    };
+
+    BearerCredentials::Payloads::~Payloads() noexcept {
+        Wipe(oauthBearerMessage);
+        Wipe(xoauth2Message);
+    }
+
+    BearerCredentials::~BearerCredentials() noexcept = default;
+
+    BearerCredentials::BearerCredentials()
+        : impl_(new Impl)
+    {
+    }
+
+    std::shared_ptr< BearerCredentials > BearerCredentials::Create(
+        const std::string& token,
+        const std::string& user,
+        const std::string& host,
+        uint16_t port
+    ) {
+        std::shared_ptr< BearerCredentials > credentials(new BearerCredentials());
+        auto& impl = *credentials->impl_;
+        impl.user = user;
+        impl.host = host;
+        impl.port = port;
+        impl.Publish(token);
+        return credentials;
+    }
+
+    void BearerCredentials::Refresh(const std::string& token) {
+        impl_->Publish(token);
+    }
+
+    std::shared_ptr< const BearerCredentials::Payloads > BearerCredentials::GetPayloads() const {
+        std::lock_guard< std::mutex > lock(impl_->mutex);
+        return impl_->payloads;
+    }
+
+    const std::string& BearerCredentials::GetUser() const {
+        return impl_->user;
+    }
+
+}
+}
@@ -0,0 +1,204 @@
+/**
+ * @file BearerExchange.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::BearerExchange structure.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "BearerExchange.hpp"
+#include "Snapshot.hpp"
+
+#include <memory>
+#include <stdint.h>
+#include <utility>
+
+namespace Sasl {
+namespace Client {
+
+    void BearerExchange::Reset() {
+        payloads = nullptr;
+        errorChallenge.clear();
+        tokenSent = false;
+        faulted = false;
+        responsePending = false;
+        limits.Clear();
+        trace.Reset();
+    }
+
+    void BearerExchange::Release() {
+        credentials = nullptr;
+        payloads = nullptr;
+        std::string().swap(errorChallenge);
+        responsePending = false;
+        limits.Clear();
+        trace.Reset();
+    }
+
+    RoundTripProfile BearerExchange::GetRoundTripProfile() const {
+        RoundTripProfile roundTripProfile;
+        roundTripProfile.sendsInitialResponse = (
+            initialResponseMode != InitialResponseMode::Never
+        );
+        roundTripProfile.roundTrips = (
+            roundTripProfile.sendsInitialResponse
+            ? 1
+            : 2
+        );
+        return roundTripProfile;
+    }
+
+    std::string BearerExchange::GetInitialResponse(
+        const BearerFlavor& flavor,
+        LazyDiagnosticsSender& diagnosticsSender
+    ) {
+        if (
+            (credentials == nullptr)
+            && (payloads == nullptr)
+        ) {
+            return "";
+        }
+        if (initialResponseMode == InitialResponseMode::Never) {
+            if (diagnosticsSender.IsActive()) {
+                diagnosticsSender.SendDiagnosticInformationString(
+                    0,
+                    std::string("C: AUTH ") + flavor.mechanismName
+                );
+            }
+            return "";
+        }
+        return SendToken(flavor, diagnosticsSender);
+    }
+
+    std::string BearerExchange::Proceed(
+        const BearerFlavor& flavor,
+        LazyDiagnosticsSender& diagnosticsSender,
+        const std::string& message
+    ) {
+        responsePending = false;
+        if (
+            faulted
+            || limits.IsCancelled()
+            || limits.IsPastDeadline()
+        ) {
+            faulted = true;
+            return "";
+        }
+        if (!tokenSent) {
+            if (
+                (credentials == nullptr)
+                && (payloads == nullptr)
+            ) {
+                return "";
+            }
+            return SendToken(flavor, diagnosticsSender);
+        }
+
+        // Once the token is sent, the server either reports the outcome
+        // through the protocol, or sends an error challenge, which the
+        // client must acknowledge before the server reports failure
+        // (RFC 7628 section 3.2.3).
+        if (
+            errorChallenge.empty()
+            && !message.empty()
+        ) {
+            errorChallenge = message;
+            responsePending = true;
+            return flavor.errorResponse;
+        }
+        return "";
+    }
+
+    std::string BearerExchange::SendToken(
+        const BearerFlavor& flavor,
+        LazyDiagnosticsSender& diagnosticsSender
+    ) {
+        if (payloads == nullptr) {
+            payloads = credentials->GetPayloads();
+        }
+        diagnosticsSender.SendDiagnosticInformationString(
+            0,
+            (*payloads).*flavor.diagnosticMessage
+        );
+        tokenSent = true;
+        responsePending = true;
+        return (*payloads).*flavor.message;
+    }
+
+    void BearerExchange::Snapshot(
+        const BearerFlavor& flavor,
+        std::string& snapshot,
+        SnapshotCredentials credentials
+    ) const {
+        auto includedPayloads = payloads;
+        if (
+            (includedPayloads == nullptr)
+            && (this->credentials != nullptr)
+        ) {
+            includedPayloads = this->credentials->GetPayloads();
+        }
+        const auto credentialsIncluded = (
+            (credentials == SnapshotCredentials::Include)
+            && (includedPayloads != nullptr)
+        );
+        BeginSnapshot(flavor.mechanismName, credentialsIncluded, snapshot);
+        snapshot += (char)tokenSent;
+        snapshot += (char)faulted;
+        snapshot += (char)initialResponseMode;
+        EncodeString(errorChallenge, snapshot);
+        if (credentialsIncluded) {
+            EncodeString((*includedPayloads).*flavor.message, snapshot);
+            EncodeString((*includedPayloads).*flavor.diagnosticMessage, snapshot);
+            EncodeNumber(includedPayloads->generation, snapshot);
+        }
+    }
+
+    bool BearerExchange::Restore(
+        const BearerFlavor& flavor,
+        const std::string& snapshot
+    ) {
+        size_t offset;
+        bool credentialsIncluded;
+        bool restoredTokenSent;
+        bool restoredFaulted;
+        InitialResponseMode restoredInitialResponseMode;
+        std::string restoredErrorChallenge;
+        if (
+            !BeginRestore(snapshot, flavor.mechanismName, offset, credentialsIncluded)
+            || !DecodeFlag(snapshot, offset, restoredTokenSent)
+            || !DecodeFlag(snapshot, offset, restoredFaulted)
+            || !DecodeInitialResponseMode(snapshot, offset, restoredInitialResponseMode)
+            || !DecodeString(snapshot, offset, restoredErrorChallenge)
+        ) {
+            return false;
+        }
+        // Payloads decoded here which aren't restored, because the rest of
+        // the snapshot doesn't decode, wipe the token when they're let go.
+        std::shared_ptr< const BearerCredentials::Payloads > restoredPayloads;
+        if (credentialsIncluded) {
+            const auto includedPayloads = std::make_shared< BearerCredentials::Payloads >();
+            if (
+                !DecodeString(snapshot, offset, (*includedPayloads).*flavor.message)
+                || !DecodeString(snapshot, offset, (*includedPayloads).*flavor.diagnosticMessage)
+                || !DecodeNumber(snapshot, offset, includedPayloads->generation)
+            ) {
+                return false;
+            }
+            restoredPayloads = includedPayloads;
+        }
+        if (offset != snapshot.length()) {
+            return false;
+        }
+        payloads = restoredPayloads;
+        errorChallenge = std::move(restoredErrorChallenge);
+        tokenSent = restoredTokenSent;
+        faulted = restoredFaulted;
+        responsePending = false;
+        initialResponseMode = restoredInitialResponseMode;
+        trace.Reset();
+        return true;
+    }
+
+}
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+/**
+ * @file BearerExchange.hpp
+ *
+ * This module declares the Sasl::Client::BearerExchange structure.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../LazyDiagnosticsSender.hpp"
+#include "ExchangeLimits.hpp"
+
+#include <memory>
+#include <Sasl/Client/BearerCredentials.hpp>
+#include <Sasl/Client/Mechanism.hpp>
+#include <Sasl/Trace.hpp>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This holds what differs between the mechanisms which pass a bearer
+     * token to the server.
+     */
+    struct BearerFlavor {
+        /**
+         * This is the name of the mechanism, as advertised by servers.
+         */
+        const char* mechanismName;
+
+        /**
+         * This selects the message which passes the token to the server.
+         */
+        std::string BearerCredentials::Payloads::* message;
+
+        /**
+         * This selects the line to publish to diagnostics when the
+         * token is passed to the server.
+         */
+        std::string BearerCredentials::Payloads::* diagnosticMessage;
+
+        /**
+         * This is the response the client sends to acknowledge an
+         * error challenge, after which the server reports failure.
+         */
+        const char* errorResponse;
+    };
+
+    /**
+     * This holds the state of an exchange of a mechanism which passes
+     * a bearer token to the server, such as OAUTHBEARER and XOAUTH2.
+     */
+    struct BearerExchange {
+        // Properties
+
+        /**
+         * These are the credentials to pass along to the server.
+         */
+        std::shared_ptr< const BearerCredentials > credentials;
+
+        /**
+         * This is the snapshot of the messages built from the credentials
+         * that is used for the exchange in progress.  It's picked up from
+         * the credentials when the exchange starts.
+         */
+        std::shared_ptr< const BearerCredentials::Payloads > payloads;
+
+        /**
+         * This is the error challenge the server sent, if any.
+         */
+        std::string errorChallenge;
+
+        /**
+         * This indicates whether or not the token has been sent
+         * to the server.
+         */
+        bool tokenSent = false;
+
+        /**
+         * This selects whether or not the token is sent as an initial
+         * response.
+         */
+        InitialResponseMode initialResponseMode = InitialResponseMode::Auto;
+
+        /**
+         * These may cut short the authentication exchange.
+         */
+        ExchangeLimits limits;
+
+        /**
+         * This indicates whether or not the authentication exchange
+         * was cut short.
+         */
+        bool faulted = false;
+
+        /**
+         * This indicates whether or not the message returned by the
+         * latest call to Proceed is to be sent to the server, even if
+         * it's empty (as the XOAUTH2 acknowledgement of an error
+         * challenge is).
+         */
+        bool responsePending = false;
+
+        /**
+         * This holds what is traced about the exchange.
+         */
+        Trace::Exchange trace;
+
+        // Methods
+
+        /**
+         * Return to the state before the exchange started, so that the
+         * next exchange picks up the latest snapshot of the messages.
+         */
+        void Reset();
+
+        /**
+         * Let go of the credentials and everything held for the
+         * exchange, keeping only its outcome.
+         */
+        void Release();
+
+        /**
+         * Return the profile of the exchange.
+         *
+         * @return
+         *     The profile of the exchange is returned.
+         */
+        RoundTripProfile GetRoundTripProfile() const;
+
+        /**
+         * Return the initial response to send in the authentication
+         * request.
+         *
+         * @param[in] flavor
+         *     This describes the mechanism in use.
+         *
+         * @param[in] diagnosticsSender
+         *     This is used to publish diagnostic messages.
+         *
+         * @return
+         *     The initial response is returned.
+         */
+        std::string GetInitialResponse(
+            const BearerFlavor& flavor,
+            LazyDiagnosticsSender& diagnosticsSender
+        );
+
+        /**
+         * Return the response to the given message from the server.
+         *
+         * @param[in] flavor
+         *     This describes the mechanism in use.
+         *
+         * @param[in] diagnosticsSender
+         *     This is used to publish diagnostic messages.
+         *
+         * @param[in] message
+         *     This is the message from the server.
+         *
+         * @return
+         *     The response to send to the server is returned.
+         */
+        std::string Proceed(
+            const BearerFlavor& flavor,
+            LazyDiagnosticsSender& diagnosticsSender,
+            const std::string& message
+        );
+
+        /**
+         * Pick up the latest snapshot of the messages, mark the token
+         * as sent, and return the message which passes it to the server.
+         *
+         * @param[in] flavor
+         *     This describes the mechanism in use.
+         *
+         * @param[in] diagnosticsSender
+         *     This is used to publish diagnostic messages.
+         *
+         * @return
+         *     The message which passes the token to the server is returned.
+         */
+        std::string SendToken(
+            const BearerFlavor& flavor,
+            LazyDiagnosticsSender& diagnosticsSender
+        );
+
+        /**
+         * Take a snapshot of the state of the exchange.  If the
+         * credentials are included, it's the messages of the mechanism
+         * in use, from the snapshot of the messages used (or about to be
+         * used) by the exchange, that are included, because the token
+         * itself can't be recovered from the credentials.
+         *
+         * @param[in] flavor
+         *     This describes the mechanism in use.
+         *
+         * @param[out] snapshot
+         *     This is where to store the snapshot.
+         *
+         * @param[in] credentials
+         *     This selects whether or not the snapshot includes the
+         *     credentials.
+         */
+        void Snapshot(
+            const BearerFlavor& flavor,
+            std::string& snapshot,
+            SnapshotCredentials credentials
+        ) const;
+
+        /**
+         * Carry on the exchange whose state is in the given snapshot.
+         *
+         * @param[in] flavor
+         *     This describes the mechanism in use.
+         *
+         * @param[in] snapshot
+         *     This is the snapshot to restore.
+         *
+         * @return
+         *     An indication of whether or not the snapshot was restored
+         *     is returned.
+         */
+        bool Restore(
+            const BearerFlavor& flavor,
+            const std::string& snapshot
+        );
+    };
+
+}
+}
@@ -0,0 +1,70 @@
+/**
+ * @file BinaryEncoding.cpp
+ *
+ * This module contains the implementation of the functions used to
+ * encode and decode the pieces of the library's compact binary formats.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "BinaryEncoding.hpp"
+
+namespace Sasl {
+namespace Client {
+
+    void EncodeNumber(uint64_t value, std::string& buffer) {
+        while (value >= 0x80) {
+            buffer += (char)((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        buffer += (char)value;
+    }
+
+    bool DecodeNumber(const std::string& buffer, size_t& offset, uint64_t& value) {
+        value = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7) {
+            if (offset >= buffer.length()) {
+                return false;
+            }
+            const auto byte = (uint8_t)buffer[offset++];
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool DecodeByte(const std::string& buffer, size_t& offset, uint8_t& value) {
+        if (offset >= buffer.length()) {
+            return false;
+        }
+        value = (uint8_t)buffer[offset++];
+        return true;
+    }
+
+    void EncodeString(const std::string& value, std::string& buffer) {
+        EncodeNumber(value.length(), buffer);
+        buffer += value;
+    }
+
+    void EncodeBytes(const uint8_t* data, size_t length, std::string& buffer) {
+        EncodeNumber(length, buffer);
+        (void)buffer.append((const char*)data, length);
+    }
+
+    bool DecodeString(const std::string& buffer, size_t& offset, std::string& value) {
+        uint64_t length;
+        if (
+            !DecodeNumber(buffer, offset, length)
+            || (length > buffer.length() - offset)
+        ) {
+            return false;
+        }
+        (void)value.assign(buffer, offset, (size_t)length);
+        offset += (size_t)length;
+        return true;
+    }
+
+}
+}
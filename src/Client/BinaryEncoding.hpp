@@ -0,0 +1,116 @@
+#pragma once
+
+/**
+ * @file BinaryEncoding.hpp
+ *
+ * This module declares the functions used to encode and decode the
+ * pieces of the library's compact binary formats (transcripts and
+ * mechanism snapshots).
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * Append the given number to the given buffer, encoded as a
+     * variable-length integer: seven bits per byte, least significant
+     * first, with the top bit set on every byte but the last.
+     *
+     * @param[in] value
+     *     This is the number to encode.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer to which to append the encoded number.
+     */
+    void EncodeNumber(uint64_t value, std::string& buffer);
+
+    /**
+     * Decode the variable-length integer at the given position
+     * in the given buffer.
+     *
+     * @param[in] buffer
+     *     This is the buffer holding the encoded number.
+     *
+     * @param[in,out] offset
+     *     This is the position of the encoded number in the buffer.
+     *     On success, it's moved past the number.
+     *
+     * @param[out] value
+     *     This is where to store the decoded number.
+     *
+     * @return
+     *     An indication of whether or not a number was decoded is returned.
+     */
+    bool DecodeNumber(const std::string& buffer, size_t& offset, uint64_t& value);
+
+    /**
+     * Decode the byte at the given position in the given buffer.
+     *
+     * @param[in] buffer
+     *     This is the buffer holding the byte.
+     *
+     * @param[in,out] offset
+     *     This is the position of the byte in the buffer.
+     *     On success, it's moved past the byte.
+     *
+     * @param[out] value
+     *     This is where to store the decoded byte.
+     *
+     * @return
+     *     An indication of whether or not a byte was decoded is returned.
+     */
+    bool DecodeByte(const std::string& buffer, size_t& offset, uint8_t& value);
+
+    /**
+     * Append the given string to the given buffer, preceded
+     * by its length.
+     *
+     * @param[in] value
+     *     This is the string to encode.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer to which to append the encoded string.
+     */
+    void EncodeString(const std::string& value, std::string& buffer);
+
+    /**
+     * Append the given bytes to the given buffer, preceded
+     * by their length.
+     *
+     * @param[in] data
+     *     This points to the bytes to encode.
+     *
+     * @param[in] length
+     *     This is the number of bytes to encode.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer to which to append the encoded bytes.
+     */
+    void EncodeBytes(const uint8_t* data, size_t length, std::string& buffer);
+
+    /**
+     * Decode the string at the given position in the given buffer.
+     *
+     * @param[in] buffer
+     *     This is the buffer holding the encoded string.
+     *
+     * @param[in,out] offset
+     *     This is the position of the encoded string in the buffer.
+     *     On success, it's moved past the string.
+     *
+     * @param[out] value
+     *     This is where to store the decoded string.
+     *
+     * @return
+     *     An indication of whether or not a string was decoded is returned.
+     */
+    bool DecodeString(const std::string& buffer, size_t& offset, std::string& value);
+
+}
+}
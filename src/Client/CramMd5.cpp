@@ -0,0 +1,410 @@
+/**
+ * @file CramMd5.cpp
+ *
+ * This module contains the implementation of the Sasl::Client::CramMd5 class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../LazyDiagnosticsSender.hpp"
+#include "../Md5Compress.hpp"
+#include "../Wipe.hpp"
+#include "ExchangeLimits.hpp"
+#include "Snapshot.hpp"
+
+#include <new>
+#include <Sasl/Client/CramMd5.hpp>
+#include <Sasl/Md5.hpp>
+#include <Sasl/Trace.hpp>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <utility>
+
+namespace {
+
+    /**
+     * This is the name of the mechanism, as recorded in snapshots.
+     */
+    constexpr const char* MECHANISM_NAME = "CRAM-MD5";
+
+    /**
+     * This is the size, in bytes, of an MD5 digest.
+     */
+    constexpr size_t DIGEST_LENGTH = Sasl::MD5_DIGEST_SIZE / 8;
+
+    /**
+     * These are the digits used to encode the digest in hexadecimal.
+     */
+    const char HEX_DIGITS[] = "0123456789abcdef";
+
+    /**
+     * Compute the state of the MD5 hash function after absorbing
+     * the given key, padded to a whole block and combined with the
+     * given pad byte, as HMAC-MD5 does for its inner and outer hashes.
+     *
+     * @param[in] key
+     *     This points to the key, which must be no longer than a block.
+     *
+     * @param[in] keyLength
+     *     This is the number of bytes in the key.
+     *
+     * @param[in] pad
+     *     This is the byte with which to combine the padded key.
+     *
+     * @param[out] state
+     *     This is where to store the state of the hash function.
+     */
+    void AbsorbPaddedKey(
+        const uint8_t* key,
+        size_t keyLength,
+        uint8_t pad,
+        uint32_t* state
+    ) {
+        uint8_t block[Sasl::MD5_BLOCK_SIZE];
+        for (size_t i = 0; i < Sasl::MD5_BLOCK_SIZE; ++i) {
+            block[i] = (uint8_t)(((i < keyLength) ? key[i] : 0) ^ pad);
+        }
+        (void)memcpy(state, Sasl::Md5Compress::INITIAL_STATE, 4 * sizeof(uint32_t));
+        Sasl::Md5Compress::Compress(state, block, 1);
+        (void)memset(block, 0, sizeof(block));
+    }
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a CramMd5 instance.
+     */
+    struct CramMd5::Impl {
+        // Properties
+
+        /**
+         * This is a helper object used to generate and publish
+         * diagnostic messages.
+         */
+        LazyDiagnosticsSender diagnosticsSender;
+
+        /**
+         * This is the response to send to the server, built when the
+         * credentials are set: the authentication identity and a space,
+         * followed by room for the digest, which is filled in when the
+         * challenge is answered.  It's empty until credentials are set.
+         */
+        std::string response;
+
+        /**
+         * This is the state of the MD5 hash function after absorbing
+         * the inner padded key.
+         */
+        uint32_t innerState[4];
+
+        /**
+         * This is the state of the MD5 hash function after absorbing
+         * the outer padded key.
+         */
+        uint32_t outerState[4];
+
+        /**
+         * This indicates whether or not the challenge has been answered.
+         */
+        bool responded = false;
+
+        /**
+         * These may cut short the authentication exchange.
+         */
+        ExchangeLimits limits;
+
+        /**
+         * This indicates whether or not the authentication exchange
+         * was cut short.
+         */
+        bool faulted = false;
+
+        /**
+         * This holds what is traced about the exchange.
+         */
+        Trace::Exchange trace;
+
+        // Methods
+
+        /**
+         * This is the default constructor of the structure
+         */
+        Impl()
+            : diagnosticsSender("CramMd5")
+        {
+        }
+
+        /**
+         * Compute the keyed digest of the given challenge and store it,
+         * encoded in hexadecimal, at the end of the response.
+         *
+         * @param[in] challenge
+         *     This is the challenge from the server.
+         */
+        void AnswerChallenge(const std::string& challenge) {
+            uint8_t digest[DIGEST_LENGTH];
+            uint32_t state[4];
+            (void)memcpy(state, innerState, sizeof(state));
+            Md5Compress::Finish(
+                state,
+                (const uint8_t*)challenge.data(),
+                challenge.length(),
+                MD5_BLOCK_SIZE,
+                digest
+            );
+            (void)memcpy(state, outerState, sizeof(state));
+            Md5Compress::Finish(
+                state,
+                digest,
+                DIGEST_LENGTH,
+                MD5_BLOCK_SIZE,
+                digest
+            );
+            auto hex = &response[response.length() - DIGEST_LENGTH * 2];
+            for (size_t i = 0; i < DIGEST_LENGTH; ++i) {
+                *hex++ = HEX_DIGITS[digest[i] >> 4];
+                *hex++ = HEX_DIGITS[digest[i] & 0x0F];
+            }
+        }
+    };
+
+    CramMd5::~CramMd5() noexcept {
+        impl_->~Impl();
+    }
+
+    CramMd5::CramMd5(CramMd5&& other) noexcept
+        : impl_(new (implStorage_) Impl(std::move(*other.impl_)))
+    {
+    }
+
+    CramMd5& CramMd5::operator=(CramMd5&& other) noexcept {
+        if (this != &other) {
+            *impl_ = std::move(*other.impl_);
+        }
+        return *this;
+    }
+
+    CramMd5::CramMd5()
+        : impl_(new (implStorage_) Impl)
+    {
+        static_assert(
+            sizeof(Impl) <= IMPL_STORAGE_SIZE,
+            "CramMd5::Impl doesn't fit in CramMd5::implStorage_"
+        );
+        static_assert(
+            alignof(Impl) <= alignof(std::max_align_t),
+            "CramMd5::Impl is over-aligned for CramMd5::implStorage_"
+        );
+    }
+
+    SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate CramMd5::SubscribeToDiagnostics(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+        size_t minLevel
+    ) {
+        return impl_->diagnosticsSender.SubscribeToDiagnostics(delegate, minLevel);
+    }
+
+    void CramMd5::Reset() {
+        impl_->trace.Reset();
+        impl_->responded = false;
+        impl_->faulted = false;
+        impl_->limits.Clear();
+    }
+
+    void CramMd5::SetInitialResponseMode(
+        InitialResponseMode initialResponseMode
+    ) {
+        // The CRAM-MD5 mechanism can't have an initial response,
+        // because the client's only message answers the server's
+        // challenge, so there's nothing to select.
+        (void)initialResponseMode;
+    }
+
+    RoundTripProfile CramMd5::GetRoundTripProfile() {
+        RoundTripProfile roundTripProfile;
+        roundTripProfile.sendsInitialResponse = false;
+        roundTripProfile.roundTrips = 2;
+        return roundTripProfile;
+    }
+
+    void CramMd5::SetCancellationToken(
+        const CancellationToken& cancellationToken
+    ) {
+        impl_->limits.cancellationToken = cancellationToken;
+    }
+
+    void CramMd5::SetDeadline(
+        std::chrono::steady_clock::time_point deadline
+    ) {
+        impl_->limits.deadline = deadline;
+    }
+
+    void CramMd5::SetCredentials(
+        const std::string& credentials,
+        const std::string& authenticationIdentity,
+        const std::string& authorizationIdentity
+    ) {
+        Trace::Span span("CramMd5::SetCredentials", impl_->trace);
+        (void)authorizationIdentity;
+        auto key = (const uint8_t*)credentials.data();
+        auto keyLength = credentials.length();
+        uint8_t hashedKey[DIGEST_LENGTH];
+        if (keyLength > MD5_BLOCK_SIZE) {
+            uint32_t state[4];
+            (void)memcpy(state, Md5Compress::INITIAL_STATE, sizeof(state));
+            Md5Compress::Finish(state, key, keyLength, 0, hashedKey);
+            key = hashedKey;
+            keyLength = DIGEST_LENGTH;
+        }
+        AbsorbPaddedKey(key, keyLength, 0x36, impl_->innerState);
+        AbsorbPaddedKey(key, keyLength, 0x5c, impl_->outerState);
+        (void)memset(hashedKey, 0, sizeof(hashedKey));
+        impl_->response.reserve(authenticationIdentity.length() + 1 + DIGEST_LENGTH * 2);
+        impl_->response = authenticationIdentity;
+        impl_->response += ' ';
+        impl_->response.append(DIGEST_LENGTH * 2, '0');
+    }
+
+    std::string CramMd5::GetInitialResponse() {
+        Trace::Span span("CramMd5::GetInitialResponse", impl_->trace);
+        impl_->diagnosticsSender.SendDiagnosticInformationString(
+            0,
+            "C: AUTH CRAM-MD5"
+        );
+        return "";
+    }
+
+    std::string CramMd5::Proceed(const std::string& message) {
+        Trace::Span span("CramMd5::Proceed", impl_->trace);
+        if (
+            impl_->faulted
+            || impl_->limits.IsCancelled()
+            || impl_->limits.IsPastDeadline()
+        ) {
+            impl_->faulted = true;
+            return "";
+        }
+        if (
+            impl_->responded
+            || impl_->response.empty()
+        ) {
+            return "";
+        }
+        impl_->responded = true;
+        {
+            Trace::Span answerSpan("HMAC-MD5");
+            impl_->AnswerChallenge(message);
+        }
+        if (impl_->diagnosticsSender.IsActive()) {
+            impl_->diagnosticsSender.SendDiagnosticInformationString(
+                0,
+                "C: " + impl_->response.substr(
+                    0,
+                    impl_->response.length() - DIGEST_LENGTH * 2
+                ) + "*******"
+            );
+        }
+        return impl_->response;
+    }
+
+    bool CramMd5::Succeeded() {
+        return false;
+    }
+
+    bool CramMd5::Faulted() {
+        return impl_->faulted;
+    }
+
+    bool CramMd5::Snapshot(
+        std::string& snapshot,
+        SnapshotCredentials credentials
+    ) {
+        // The credentials are carried as the authentication identity
+        // and the HMAC-MD5 states of the padded password, which serve
+        // as well as the password itself, so they're just as secret.
+        const auto credentialsIncluded = (
+            (credentials == SnapshotCredentials::Include)
+            && !impl_->response.empty()
+        );
+        BeginSnapshot(MECHANISM_NAME, credentialsIncluded, snapshot);
+        snapshot += (char)impl_->responded;
+        snapshot += (char)impl_->faulted;
+        if (credentialsIncluded) {
+            EncodeString(
+                impl_->response.substr(
+                    0,
+                    impl_->response.length() - 1 - DIGEST_LENGTH * 2
+                ),
+                snapshot
+            );
+            for (const auto word: impl_->innerState) {
+                EncodeNumber(word, snapshot);
+            }
+            for (const auto word: impl_->outerState) {
+                EncodeNumber(word, snapshot);
+            }
+        }
+        return true;
+    }
+
+    bool CramMd5::Restore(const std::string& snapshot) {
+        size_t offset;
+        bool credentialsIncluded;
+        bool responded;
+        bool faulted;
+        std::string authenticationIdentity;
+        uint32_t states[8];
+        auto decoded = (
+            BeginRestore(snapshot, MECHANISM_NAME, offset, credentialsIncluded)
+            && DecodeFlag(snapshot, offset, responded)
+            && DecodeFlag(snapshot, offset, faulted)
+        );
+        if (decoded && credentialsIncluded) {
+            decoded = DecodeString(snapshot, offset, authenticationIdentity);
+            for (auto& word: states) {
+                uint64_t value;
+                if (
+                    !decoded
+                    || !DecodeNumber(snapshot, offset, value)
+                    || (value > 0xFFFFFFFF)
+                ) {
+                    decoded = false;
+                    break;
+                }
+                word = (uint32_t)value;
+            }
+        }
+        decoded = decoded && (offset == snapshot.length());
+
+        // The pad states are as good as the password, so they're wiped
+        // whether or not the snapshot is restored.
+        if (decoded) {
+            if (credentialsIncluded) {
+                (void)memcpy(impl_->innerState, states, sizeof(impl_->innerState));
+                (void)memcpy(impl_->outerState, states + 4, sizeof(impl_->outerState));
+                impl_->response = authenticationIdentity;
+                impl_->response += ' ';
+                impl_->response.append(DIGEST_LENGTH * 2, '0');
+            }
+            impl_->trace.Reset();
+            impl_->responded = responded;
+            impl_->faulted = faulted;
+        }
+        Wipe(states, sizeof(states));
+        return decoded;
+    }
+
+    void CramMd5::Release() {
+        Wipe(impl_->response);
+        Wipe(impl_->innerState, sizeof(impl_->innerState));
+        Wipe(impl_->outerState, sizeof(impl_->outerState));
+        impl_->limits.Clear();
+        impl_->trace.Reset();
+    }
+
+}
+}
@@ -0,0 +1,39 @@
+/**
+ * @file ExchangeLimits.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::ExchangeLimits structure.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "ExchangeLimits.hpp"
+
+namespace Sasl {
+namespace Client {
+
+    bool ExchangeLimits::IsLimited() const {
+        return (
+            cancellationToken.CanBeCancelled()
+            || (deadline != std::chrono::steady_clock::time_point::max())
+        );
+    }
+
+    bool ExchangeLimits::IsCancelled() const {
+        return cancellationToken.IsCancelled();
+    }
+
+    bool ExchangeLimits::IsPastDeadline() const {
+        return (
+            (deadline != std::chrono::steady_clock::time_point::max())
+            && (std::chrono::steady_clock::now() >= deadline)
+        );
+    }
+
+    void ExchangeLimits::Clear() {
+        cancellationToken = CancellationToken();
+        deadline = std::chrono::steady_clock::time_point::max();
+    }
+
+}
+}
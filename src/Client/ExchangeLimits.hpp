@@ -0,0 +1,73 @@
+#pragma once
+
+/**
+ * @file ExchangeLimits.hpp
+ *
+ * This module declares the Sasl::Client::ExchangeLimits structure.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <chrono>
+#include <Sasl/CancellationToken.hpp>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This holds what may cut short an authentication exchange
+     * in progress: a cancellation token and a deadline.
+     */
+    struct ExchangeLimits {
+        // Properties
+
+        /**
+         * This is used to ask for the exchange to be abandoned.
+         */
+        CancellationToken cancellationToken;
+
+        /**
+         * This is the time by which the exchange must be complete.
+         */
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+        // Methods
+
+        /**
+         * Return an indication of whether or not the exchange
+         * may be cut short at all.
+         *
+         * @return
+         *     An indication of whether or not the exchange
+         *     may be cut short at all is returned.
+         */
+        bool IsLimited() const;
+
+        /**
+         * Return an indication of whether or not the exchange
+         * has been cancelled.
+         *
+         * @return
+         *     An indication of whether or not the exchange
+         *     has been cancelled is returned.
+         */
+        bool IsCancelled() const;
+
+        /**
+         * Return an indication of whether or not the deadline
+         * of the exchange has passed.
+         *
+         * @return
+         *     An indication of whether or not the deadline
+         *     of the exchange has passed is returned.
+         */
+        bool IsPastDeadline() const;
+
+        /**
+         * Remove any cancellation token and deadline.
+         */
+        void Clear();
+    };
+
+}
+}
@@ -0,0 +1,615 @@
+/**
+ * @file Framing.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::Framing class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <Sasl/Base64.hpp>
+#include <Sasl/Client/Framing.hpp>
+#include <stddef.h>
+#include <string.h>
+#include <string>
+
+namespace {
+
+    /**
+     * This is the XML namespace of the XMPP SASL elements.
+     */
+    const char XMPP_SASL_NAMESPACE[] = "urn:ietf:params:xml:ns:xmpp-sasl";
+
+    /**
+     * This identifies what a line received from the server is.
+     */
+    enum class LineKind {
+        /**
+         * The line is a challenge, whose payload is to be given
+         * to the mechanism.
+         */
+        Challenge,
+
+        /**
+         * The line reports that authentication succeeded.  It may have
+         * a payload (additional data) to give to the mechanism.
+         */
+        Success,
+
+        /**
+         * The line reports that authentication failed.
+         */
+        Failure,
+
+        /**
+         * The line doesn't concern the exchange.
+         */
+        Unrelated,
+
+        /**
+         * The line isn't understood.
+         */
+        Malformed,
+    };
+
+    /**
+     * This is what was found in a line received from the server.
+     */
+    struct ParsedLine {
+        /**
+         * This identifies what the line is.
+         */
+        LineKind kind = LineKind::Malformed;
+
+        /**
+         * This points to the Base64-encoded payload of the line,
+         * if it has one.
+         */
+        char* payload = nullptr;
+
+        /**
+         * This is the number of characters in the payload.
+         */
+        size_t payloadLength = 0;
+    };
+
+    /**
+     * Determine whether or not the given character is XML whitespace.
+     *
+     * @param[in] c
+     *     This is the character to check.
+     *
+     * @return
+     *     An indication of whether or not the given character
+     *     is XML whitespace is returned.
+     */
+    bool IsWhitespace(char c) {
+        return (
+            (c == ' ')
+            || (c == '\t')
+            || (c == '\r')
+            || (c == '\n')
+        );
+    }
+
+    /**
+     * Parse the given SMTP reply line, without its line ending.
+     *
+     * @param[in] line
+     *     This points to the line to parse.
+     *
+     * @param[in] length
+     *     This is the number of characters in the line.
+     *
+     * @return
+     *     What was found in the line is returned.
+     */
+    ParsedLine ParseSmtp(char* line, size_t length) {
+        ParsedLine parsed;
+        if (
+            (length < 3)
+            || (line[0] < '2') || (line[0] > '5')
+            || (line[1] < '0') || (line[1] > '9')
+            || (line[2] < '0') || (line[2] > '9')
+            || (
+                (length > 3)
+                && (line[3] != ' ')
+                && (line[3] != '-')
+            )
+        ) {
+            return parsed;
+        }
+        const bool continued = ((length > 3) && (line[3] == '-'));
+        if (memcmp(line, "334", 3) == 0) {
+            if (!continued) {
+                parsed.kind = LineKind::Challenge;
+                if (length > 4) {
+                    parsed.payload = line + 4;
+                    parsed.payloadLength = length - 4;
+                }
+            }
+        } else if (continued) {
+            parsed.kind = LineKind::Unrelated;
+        } else if (line[0] == '2') {
+            parsed.kind = LineKind::Success;
+        } else if (line[0] != '3') {
+            parsed.kind = LineKind::Failure;
+        }
+        return parsed;
+    }
+
+    /**
+     * Parse the given IMAP response line, without its line ending.
+     *
+     * @param[in] line
+     *     This points to the line to parse.
+     *
+     * @param[in] length
+     *     This is the number of characters in the line.
+     *
+     * @param[in] tag
+     *     This is the tag of the client's "AUTHENTICATE" command.
+     *
+     * @return
+     *     What was found in the line is returned.
+     */
+    ParsedLine ParseImap(char* line, size_t length, const std::string& tag) {
+        ParsedLine parsed;
+        if (
+            (length >= 1)
+            && (line[0] == '+')
+        ) {
+            if (length == 1) {
+                parsed.kind = LineKind::Challenge;
+            } else if (line[1] == ' ') {
+                parsed.kind = LineKind::Challenge;
+                parsed.payload = line + 2;
+                parsed.payloadLength = length - 2;
+            }
+            return parsed;
+        }
+        if (
+            (length >= 2)
+            && (line[0] == '*')
+            && (line[1] == ' ')
+        ) {
+            parsed.kind = LineKind::Unrelated;
+            return parsed;
+        }
+        const auto tagEnd = (const char*)memchr(line, ' ', length);
+        if (tagEnd == nullptr) {
+            return parsed;
+        }
+        const auto tagLength = (size_t)(tagEnd - line);
+        if (
+            (tagLength != tag.length())
+            || (memcmp(line, tag.data(), tagLength) != 0)
+        ) {
+            parsed.kind = LineKind::Unrelated;
+            return parsed;
+        }
+        const auto result = tagEnd + 1;
+        const auto resultLength = length - tagLength - 1;
+        const auto HasResult = [result, resultLength](const char* name, size_t nameLength) {
+            return (
+                (resultLength >= nameLength)
+                && (memcmp(result, name, nameLength) == 0)
+                && (
+                    (resultLength == nameLength)
+                    || (result[nameLength] == ' ')
+                )
+            );
+        };
+        if (HasResult("OK", 2)) {
+            parsed.kind = LineKind::Success;
+        } else if (
+            HasResult("NO", 2)
+            || HasResult("BAD", 3)
+        ) {
+            parsed.kind = LineKind::Failure;
+        }
+        return parsed;
+    }
+
+    /**
+     * Parse the given XMPP element.
+     *
+     * @param[in] element
+     *     This points to the element to parse.
+     *
+     * @param[in] length
+     *     This is the number of characters in the element.
+     *
+     * @return
+     *     What was found in the element is returned.
+     */
+    ParsedLine ParseXmpp(char* element, size_t length) {
+        ParsedLine parsed;
+        while ((length > 0) && IsWhitespace(element[0])) {
+            ++element;
+            --length;
+        }
+        while ((length > 0) && IsWhitespace(element[length - 1])) {
+            --length;
+        }
+        if (
+            (length < 3)
+            || (element[0] != '<')
+            || (element[length - 1] != '>')
+        ) {
+            return parsed;
+        }
+        size_t nameEnd = 1;
+        while (
+            (nameEnd < length)
+            && !IsWhitespace(element[nameEnd])
+            && (element[nameEnd] != '/')
+            && (element[nameEnd] != '>')
+        ) {
+            ++nameEnd;
+        }
+        const auto qualifiedName = element + 1;
+        const auto qualifiedNameLength = nameEnd - 1;
+        const auto prefixEnd = (const char*)memchr(qualifiedName, ':', qualifiedNameLength);
+        const auto name = (prefixEnd == nullptr) ? qualifiedName : prefixEnd + 1;
+        const auto nameLength = qualifiedNameLength - (size_t)(name - qualifiedName);
+        const auto startTagEnd = (char*)memchr(element + nameEnd, '>', length - nameEnd);
+        const auto startTagLength = (size_t)(startTagEnd - element) + 1;
+        if (startTagEnd[-1] == '/') {
+            if (startTagLength != length) {
+                return parsed;
+            }
+        } else {
+            const auto endTagLength = qualifiedNameLength + 3;
+            if (
+                (length < startTagLength + endTagLength)
+                || (element[length - endTagLength] != '<')
+                || (element[length - endTagLength + 1] != '/')
+                || (
+                    memcmp(
+                        element + length - endTagLength + 2,
+                        qualifiedName,
+                        qualifiedNameLength
+                    ) != 0
+                )
+            ) {
+                return parsed;
+            }
+            parsed.payload = startTagEnd + 1;
+            parsed.payloadLength = length - startTagLength - endTagLength;
+            if (
+                (parsed.payloadLength == 1)
+                && (parsed.payload[0] == '=')
+            ) {
+                parsed.payloadLength = 0;
+            }
+        }
+        const auto IsNamed = [name, nameLength](const char* expected) {
+            return (
+                (nameLength == strlen(expected))
+                && (memcmp(name, expected, nameLength) == 0)
+            );
+        };
+        if (IsNamed("challenge")) {
+            parsed.kind = LineKind::Challenge;
+        } else if (IsNamed("success")) {
+            parsed.kind = LineKind::Success;
+        } else if (IsNamed("failure")) {
+            parsed.kind = LineKind::Failure;
+            parsed.payloadLength = 0;
+        }
+        return parsed;
+    }
+
+    /**
+     * Append the Base64 encoding of the given data to the given buffer,
+     * encoding it straight into the buffer's storage.
+     *
+     * @param[in,out] output
+     *     This is the buffer to which to append the encoding.
+     *
+     * @param[in] data
+     *     This is the data to encode.
+     */
+    void AppendEncoded(std::string& output, const std::string& data) {
+        const auto offset = output.length();
+        output.resize(offset + Sasl::Base64::EncodedLength(data.length()));
+        (void)Sasl::Base64::Encode(data.data(), data.length(), &output[offset]);
+    }
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a Framing instance.
+     */
+    struct Framing::Impl {
+        // Properties
+
+        /**
+         * This is the application protocol over which
+         * the exchange is carried.
+         */
+        Protocol protocol;
+
+        /**
+         * This is the tag of the client's IMAP "AUTHENTICATE" command.
+         */
+        std::string imapTag = "A1";
+
+        /**
+         * This indicates whether or not the server supports
+         * initial responses.
+         */
+        bool initialResponseSupported = true;
+
+        /**
+         * This is the mechanism used in the exchange, or null if
+         * no exchange is taking place.
+         */
+        Mechanism* mechanism = nullptr;
+
+        /**
+         * This indicates whether or not the mechanism used in the
+         * exchange verifies the server before reporting success.
+         */
+        bool verifiesServer = false;
+
+        /**
+         * This holds the decoded payload of the latest server line, in the
+         * form the mechanism takes.  It's kept between lines so that its
+         * storage is reused.
+         */
+        std::string payload;
+
+        // Methods
+
+        /**
+         * This constructor sets up the adapter for the given protocol.
+         *
+         * @param[in] protocol
+         *     This is the application protocol over which
+         *     the exchange is carried.
+         */
+        explicit Impl(Protocol protocol)
+            : protocol(protocol)
+        {
+        }
+
+        /**
+         * Append the given client message, framed for the protocol,
+         * to the given buffer.
+         *
+         * @param[in] message
+         *     This is the message to frame.
+         *
+         * @param[in,out] output
+         *     This is the buffer to which to append the framed message.
+         */
+        void AppendResponse(const std::string& message, std::string& output) {
+            if (protocol == Protocol::Xmpp) {
+                output += "<response xmlns='";
+                output += XMPP_SASL_NAMESPACE;
+                if (message.empty()) {
+                    output += "'/>";
+                } else {
+                    output += "'>";
+                    AppendEncoded(output, message);
+                    output += "</response>";
+                }
+            } else {
+                AppendEncoded(output, message);
+                output += "\r\n";
+            }
+        }
+
+        /**
+         * Append the message which cancels the exchange, framed
+         * for the protocol, to the given buffer.
+         *
+         * @param[in,out] output
+         *     This is the buffer to which to append the framed message.
+         */
+        void AppendAbort(std::string& output) {
+            if (protocol == Protocol::Xmpp) {
+                output += "<abort xmlns='";
+                output += XMPP_SASL_NAMESPACE;
+                output += "'/>";
+            } else {
+                output += "*\r\n";
+            }
+        }
+
+        /**
+         * Decode the payload of the given line into the payload string.
+         * The payload is decoded in place first, so that the only copy
+         * made is into the string's reused storage.
+         *
+         * @param[in] parsed
+         *     This is what was found in the line.
+         *
+         * @return
+         *     An indication of whether or not the payload
+         *     is valid Base64 is returned.
+         */
+        bool DecodePayload(const ParsedLine& parsed) {
+            if (parsed.payloadLength == 0) {
+                payload.clear();
+                return true;
+            }
+            size_t decodedLength;
+            if (
+                !Base64::Decode(
+                    parsed.payload,
+                    parsed.payloadLength,
+                    parsed.payload,
+                    decodedLength
+                )
+            ) {
+                return false;
+            }
+            payload.assign(parsed.payload, decodedLength);
+            return true;
+        }
+    };
+
+    Framing::~Framing() noexcept = default;
+    Framing::Framing(Framing&&) noexcept = default;
+    Framing& Framing::operator=(Framing&&) noexcept = default;
+
+    Framing::Framing(Protocol protocol)
+        : impl_(new Impl(protocol))
+    {
+    }
+
+    void Framing::SetImapTag(const std::string& tag) {
+        impl_->imapTag = tag;
+    }
+
+    void Framing::SetInitialResponseSupported(bool supported) {
+        impl_->initialResponseSupported = supported;
+    }
+
+    void Framing::Begin(
+        Mechanism& mechanism,
+        const std::string& mechanismName,
+        std::string& output
+    ) {
+        impl_->mechanism = &mechanism;
+        if (!impl_->initialResponseSupported) {
+            mechanism.SetInitialResponseMode(InitialResponseMode::Never);
+        }
+        const auto roundTripProfile = mechanism.GetRoundTripProfile();
+        const auto sendsInitialResponse = roundTripProfile.sendsInitialResponse;
+        impl_->verifiesServer = roundTripProfile.verifiesServer;
+        const auto initialResponse = mechanism.GetInitialResponse();
+        switch (impl_->protocol) {
+            case Protocol::Smtp:
+            case Protocol::Imap: {
+                if (impl_->protocol == Protocol::Smtp) {
+                    output += "AUTH ";
+                } else {
+                    output += impl_->imapTag;
+                    output += " AUTHENTICATE ";
+                }
+                output += mechanismName;
+                if (sendsInitialResponse) {
+                    output += ' ';
+                    if (initialResponse.empty()) {
+                        output += '=';
+                    } else {
+                        AppendEncoded(output, initialResponse);
+                    }
+                }
+                output += "\r\n";
+            } break;
+
+            case Protocol::Xmpp: {
+                output += "<auth xmlns='";
+                output += XMPP_SASL_NAMESPACE;
+                output += "' mechanism='";
+                output += mechanismName;
+                if (sendsInitialResponse) {
+                    output += "'>";
+                    if (initialResponse.empty()) {
+                        output += '=';
+                    } else {
+                        AppendEncoded(output, initialResponse);
+                    }
+                    output += "</auth>";
+                } else {
+                    output += "'/>";
+                }
+            } break;
+
+            default: break;
+        }
+    }
+
+    auto Framing::Receive(
+        char* line,
+        size_t length,
+        std::string& output
+    ) -> Status {
+        if (impl_->mechanism == nullptr) {
+            return Status::Ignored;
+        }
+        if (impl_->protocol != Protocol::Xmpp) {
+            if ((length > 0) && (line[length - 1] == '\n')) {
+                --length;
+            }
+            if ((length > 0) && (line[length - 1] == '\r')) {
+                --length;
+            }
+        }
+        ParsedLine parsed;
+        switch (impl_->protocol) {
+            case Protocol::Smtp: parsed = ParseSmtp(line, length); break;
+            case Protocol::Imap: parsed = ParseImap(line, length, impl_->imapTag); break;
+            case Protocol::Xmpp: parsed = ParseXmpp(line, length); break;
+            default: break;
+        }
+        const auto mechanism = impl_->mechanism;
+        switch (parsed.kind) {
+            case LineKind::Challenge: {
+                if (!impl_->DecodePayload(parsed)) {
+                    impl_->AppendAbort(output);
+                    impl_->mechanism = nullptr;
+                    return Status::Malformed;
+                }
+                const auto response = mechanism->Proceed(impl_->payload);
+                if (mechanism->Faulted()) {
+                    impl_->AppendAbort(output);
+                    impl_->mechanism = nullptr;
+                    return Status::Faulted;
+                }
+                impl_->AppendResponse(response, output);
+                return Status::Continue;
+            }
+
+            case LineKind::Success: {
+                impl_->mechanism = nullptr;
+                if (parsed.payloadLength > 0) {
+                    if (!impl_->DecodePayload(parsed)) {
+                        return Status::Malformed;
+                    }
+                    (void)mechanism->Proceed(impl_->payload);
+                }
+
+                // A mechanism which verifies the server must have done so
+                // by now; otherwise the server's claim of success can't
+                // be trusted.
+                if (
+                    mechanism->Faulted()
+                    || (
+                        impl_->verifiesServer
+                        && !mechanism->Succeeded()
+                    )
+                ) {
+                    return Status::Faulted;
+                }
+                return Status::Succeeded;
+            }
+
+            case LineKind::Failure: {
+                impl_->mechanism = nullptr;
+                return Status::Failed;
+            }
+
+            case LineKind::Unrelated: {
+                return Status::Ignored;
+            }
+
+            case LineKind::Malformed:
+            default: {
+                impl_->AppendAbort(output);
+                impl_->mechanism = nullptr;
+                return Status::Malformed;
+            }
+        }
+    }
+
+}
+}
@@ -0,0 +1,769 @@
+/**
+ * @file KeyCacheClient.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::KeyCacheClient class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../Hi.hpp"
+#include "../Hmac.hpp"
+#include "../KeyCacheProtocol.hpp"
+#include "../Wipe.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <Sasl/Client/KeyCacheClient.hpp>
+#include <Sasl/Sha.hpp>
+#include <string.h>
+#include <SystemAbstractions/CryptoRandom.hpp>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    /**
+     * This is a lookup waiting for an answer from the daemon.
+     */
+    struct PendingLookup {
+        /**
+         * This is the key to look up.
+         */
+        std::string key;
+
+        /**
+         * This is the derived key found, or empty if none was found.
+         */
+        std::string derivedKey;
+
+        /**
+         * This indicates whether or not the lookup is over.
+         */
+        bool done = false;
+    };
+
+    /**
+     * Compute the fingerprint of the given password, which is sent to
+     * the daemon in its place: HMAC-SHA-256, keyed with the secret
+     * shared by the clients, over the length of the password (four
+     * bytes, most significant first), the password, and the salt.
+     *
+     * @param[in] secretKey
+     *     This is the HMAC key made from the secret shared by the clients.
+     *
+     * @param[in] password
+     *     This points to the password.
+     *
+     * @param[in] passwordLength
+     *     This is the number of bytes in the password.
+     *
+     * @param[in] salt
+     *     This points to the salt.
+     *
+     * @param[in] saltLength
+     *     This is the number of bytes in the salt.
+     *
+     * @param[out] fingerprint
+     *     This is where to store the fingerprint, which has
+     *     Sasl::KeyCache::FINGERPRINT_LENGTH bytes.
+     */
+    void Fingerprint(
+        const Sasl::HmacKey& secretKey,
+        const uint8_t* password,
+        size_t passwordLength,
+        const uint8_t* salt,
+        size_t saltLength,
+        uint8_t* fingerprint
+    ) {
+        const uint8_t passwordLengthBytes[4] = {
+            (uint8_t)(passwordLength >> 24),
+            (uint8_t)(passwordLength >> 16),
+            (uint8_t)(passwordLength >> 8),
+            (uint8_t)passwordLength,
+        };
+        const auto context = secretKey.Begin();
+        context->Update(passwordLengthBytes, sizeof(passwordLengthBytes));
+        context->Update(password, passwordLength);
+        context->Update(salt, saltLength);
+        secretKey.Finish(*context, fingerprint);
+    }
+
+#ifndef _WIN32
+    /**
+     * Send all of the given data over the given socket.
+     *
+     * @param[in] socket
+     *     This is the socket over which to send the data.
+     *
+     * @param[in] data
+     *     This is the data to send.
+     *
+     * @return
+     *     An indication of whether or not all of the data was sent
+     *     is returned.
+     */
+    bool SendAll(int socket, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.length()) {
+            int flags = 0;
+#ifdef MSG_NOSIGNAL
+            flags |= MSG_NOSIGNAL;
+#endif
+            const auto amount = send(socket, data.data() + sent, data.length() - sent, flags);
+            if (amount < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            sent += (size_t)amount;
+        }
+        return true;
+    }
+
+    /**
+     * Receive exactly the given number of bytes from the given socket.
+     *
+     * @param[in] socket
+     *     This is the socket from which to receive.
+     *
+     * @param[out] buffer
+     *     This is where to store the bytes received.
+     *
+     * @param[in] length
+     *     This is the number of bytes to receive.
+     *
+     * @return
+     *     An indication of whether or not all of the bytes were received
+     *     is returned.
+     */
+    bool ReceiveAll(int socket, char* buffer, size_t length) {
+        size_t received = 0;
+        while (received < length) {
+            const auto amount = recv(socket, buffer + received, length - received, 0);
+            if (amount <= 0) {
+                if (
+                    (amount < 0)
+                    && (errno == EINTR)
+                ) {
+                    continue;
+                }
+                return false;
+            }
+            received += (size_t)amount;
+        }
+        return true;
+    }
+
+    /**
+     * Write all of the given data to the given file.
+     *
+     * @param[in] file
+     *     This is the file to which to write the data.
+     *
+     * @param[in] data
+     *     This points to the data to write.
+     *
+     * @param[in] length
+     *     This is the number of bytes to write.
+     *
+     * @return
+     *     An indication of whether or not all of the data was written
+     *     is returned.
+     */
+    bool WriteAll(int file, const uint8_t* data, size_t length) {
+        size_t written = 0;
+        while (written < length) {
+            const auto amount = write(file, data + written, length - written);
+            if (amount < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            written += (size_t)amount;
+        }
+        return true;
+    }
+
+    /**
+     * Make the file at the given path, holding a new random key cache
+     * secret, unless there's already a file there.  The file is written
+     * under another name and then linked into place, so that no process
+     * ever reads a partly written secret.
+     *
+     * @param[in] path
+     *     This is the path of the file to make.
+     */
+    void MakeSecretFile(const std::string& path) {
+        std::string temporaryPath = path + ".XXXXXX";
+        const auto file = mkstemp(&temporaryPath[0]);
+        if (file < 0) {
+            return;
+        }
+        uint8_t secret[Sasl::Client::KEY_CACHE_SECRET_LENGTH];
+        static SystemAbstractions::CryptoRandom rng;
+        rng.Generate(secret, sizeof(secret));
+        const auto written = (
+            (fchmod(file, S_IRUSR | S_IWUSR) == 0)
+            && WriteAll(file, secret, sizeof(secret))
+        );
+        Sasl::Wipe(secret, sizeof(secret));
+        (void)close(file);
+        if (written) {
+            // If another process made the file first, its secret is used.
+            (void)link(temporaryPath.c_str(), path.c_str());
+        }
+        (void)unlink(temporaryPath.c_str());
+    }
+#endif
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a KeyCacheClient instance.
+     */
+    struct KeyCacheClient::Impl {
+        // Properties
+
+        /**
+         * This is the path of the socket on which the daemon
+         * serves clients.
+         */
+        std::string socketPath;
+
+        /**
+         * This is how long to wait for the daemon to answer
+         * before giving up on it.
+         */
+        std::chrono::milliseconds timeout;
+
+        /**
+         * This is the HMAC key, made from the secret shared by the
+         * clients, with which to fingerprint passwords, or null if
+         * no secret was given, in which case the daemon isn't used.
+         */
+        std::unique_ptr< HmacKey > secretKey;
+
+        /**
+         * This is the socket connected to the daemon, or -1 if
+         * not connected.  Only the thread exchanging a batch with
+         * the daemon uses it.
+         */
+        int socket = -1;
+
+        /**
+         * This is the time before which the daemon isn't to be asked
+         * again, after failing to reach it.
+         */
+        std::chrono::steady_clock::time_point retryAfter;
+
+        /**
+         * This indicates whether or not a thread is exchanging
+         * a batch with the daemon.
+         */
+        bool exchanging = false;
+
+        /**
+         * These are the lookups waiting to be sent to the daemon.
+         */
+        std::vector< PendingLookup* > lookups;
+
+        /**
+         * These are the derived keys waiting to be sent to the daemon.
+         */
+        std::vector< std::pair< std::string, std::string > > stores;
+
+        /**
+         * This is used to synchronize access to the properties above.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is used to wake threads waiting for their lookups
+         * to be answered.
+         */
+        std::condition_variable wakeCondition;
+
+        /**
+         * These count the salted passwords found in the cache,
+         * not found in it, derived because the daemon couldn't be
+         * reached, and passed along to the daemon.
+         */
+        std::atomic< uint64_t > hits;
+        std::atomic< uint64_t > misses;
+        std::atomic< uint64_t > unavailable;
+        std::atomic< uint64_t > stored;
+
+        // Methods
+
+        /**
+         * This constructor sets up the client.
+         *
+         * @param[in] socketPath
+         *     This is the path of the socket on which the daemon
+         *     serves clients.
+         *
+         * @param[in] secret
+         *     This is the secret with which to key the fingerprints
+         *     of passwords.
+         *
+         * @param[in] timeout
+         *     This is how long to wait for the daemon to answer
+         *     before giving up on it.
+         */
+        Impl(
+            const std::string& socketPath,
+            const std::string& secret,
+            std::chrono::milliseconds timeout
+        )
+            : socketPath(socketPath)
+            , timeout(timeout)
+            , hits(0)
+            , misses(0)
+            , unavailable(0)
+            , stored(0)
+        {
+            if (secret.length() >= KEY_CACHE_SECRET_LENGTH) {
+                secretKey.reset(
+                    new HmacKey(
+                        []{ return MakeSha256Context(); },
+                        SHA256_BLOCK_SIZE,
+                        SHA256_DIGEST_SIZE / 8,
+                        (const uint8_t*)secret.data(),
+                        secret.length()
+                    )
+                );
+            }
+        }
+
+        /**
+         * This is the destructor.
+         */
+        ~Impl() noexcept {
+            Disconnect();
+            for (auto& store: stores) {
+                Wipe(store.second);
+            }
+        }
+
+        /**
+         * Close the connection to the daemon, if any.
+         */
+        void Disconnect() {
+#ifndef _WIN32
+            if (socket >= 0) {
+                (void)close(socket);
+                socket = -1;
+            }
+#endif
+        }
+
+        /**
+         * Connect to the daemon, if not already connected.
+         *
+         * @return
+         *     An indication of whether or not the client is connected
+         *     to the daemon is returned.
+         */
+        bool Connect() {
+#ifdef _WIN32
+            return false;
+#else
+            if (socket >= 0) {
+                return true;
+            }
+            struct sockaddr_un address;
+            if (socketPath.length() >= sizeof(address.sun_path)) {
+                return false;
+            }
+            (void)memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            (void)memcpy(address.sun_path, socketPath.data(), socketPath.length());
+            socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (socket < 0) {
+                return false;
+            }
+            struct timeval timeoutValue;
+            timeoutValue.tv_sec = (time_t)(timeout.count() / 1000);
+            timeoutValue.tv_usec = (suseconds_t)((timeout.count() % 1000) * 1000);
+            (void)setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeoutValue, sizeof(timeoutValue));
+            (void)setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeoutValue, sizeof(timeoutValue));
+#ifdef SO_NOSIGPIPE
+            const int one = 1;
+            (void)setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            if (
+                connect(
+                    socket,
+                    (const struct sockaddr*)&address,
+                    sizeof(address)
+                ) != 0
+            ) {
+                Disconnect();
+                return false;
+            }
+
+            // Anyone on the host could have put a socket at the path,
+            // so nothing is sent unless the daemon runs as our own user.
+            if (!KeyCache::IsPeerSameUser(socket)) {
+                Disconnect();
+                return false;
+            }
+            return true;
+#endif
+        }
+
+        /**
+         * Send the given request to the daemon, and receive its response.
+         *
+         * @param[in] request
+         *     This is the request to send.
+         *
+         * @param[out] results
+         *     This is where to store the derived keys found for the keys
+         *     looked up, each empty if nothing was found.
+         *
+         * @return
+         *     An indication of whether or not the daemon answered
+         *     is returned.
+         */
+        bool Exchange(
+            const KeyCache::Request& request,
+            std::vector< std::string >& results
+        ) {
+#ifdef _WIN32
+            (void)request;
+            (void)results;
+            return false;
+#else
+            if (!Connect()) {
+                return false;
+            }
+            std::string message;
+            KeyCache::EncodeRequest(request, message);
+            const auto sent = SendAll(socket, message);
+            Wipe(message);
+            if (!sent) {
+                return false;
+            }
+            uint8_t header[KeyCache::FRAME_HEADER_LENGTH];
+            if (!ReceiveAll(socket, (char*)header, sizeof(header))) {
+                return false;
+            }
+            const auto length = KeyCache::DecodeFrameLength(header);
+            if (length > KeyCache::MAX_FRAME_LENGTH) {
+                return false;
+            }
+            std::string payload(length, '\0');
+            const auto decoded = (
+                ReceiveAll(socket, &payload[0], length)
+                && KeyCache::DecodeResponse(payload, results)
+                && (results.size() == request.lookups.size())
+            );
+            Wipe(payload);
+            return decoded;
+#endif
+        }
+
+        /**
+         * Take batches of the lookups and derived keys waiting, exchange
+         * them with the daemon, and hand the results to the threads
+         * waiting for them, until none are left waiting, so that nothing
+         * queued during an exchange waits for some later caller to be
+         * sent.  This is called with the mutex locked, and unlocks it
+         * during each exchange.
+         *
+         * @param[in,out] lock
+         *     This holds the mutex.
+         */
+        void ExchangeBatch(std::unique_lock< std::mutex >& lock) {
+            exchanging = true;
+            do {
+                const auto batchSize = std::min(lookups.size(), KEY_CACHE_MAX_BATCH);
+                std::vector< PendingLookup* > batch(lookups.begin(), lookups.begin() + batchSize);
+                (void)lookups.erase(lookups.begin(), lookups.begin() + batchSize);
+                KeyCache::Request request;
+                for (const auto lookup: batch) {
+                    request.lookups.push_back(lookup->key);
+                }
+                request.stores.swap(stores);
+                lock.unlock();
+                std::vector< std::string > results;
+                const auto answered = Exchange(request, results);
+                for (auto& store: request.stores) {
+                    Wipe(store.second);
+                }
+                if (answered) {
+                    stored += request.stores.size();
+                } else {
+                    Disconnect();
+                }
+                lock.lock();
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    if (answered) {
+                        batch[i]->derivedKey.swap(results[i]);
+                    }
+                    batch[i]->done = true;
+                }
+                if (!answered) {
+                    // Everyone else derives locally until it's time
+                    // to try the daemon again, and the derived keys
+                    // waiting to be passed along are dropped.
+                    retryAfter = std::chrono::steady_clock::now() + KEY_CACHE_RETRY_INTERVAL;
+                    for (const auto lookup: lookups) {
+                        lookup->done = true;
+                    }
+                    lookups.clear();
+                    for (auto& store: stores) {
+                        Wipe(store.second);
+                    }
+                    stores.clear();
+                }
+                wakeCondition.notify_all();
+            } while (
+                !lookups.empty()
+                || !stores.empty()
+            );
+            exchanging = false;
+        }
+
+        /**
+         * Ask the daemon for the derived key held under the given key.
+         *
+         * @param[in] key
+         *     This is the key to look up.
+         *
+         * @param[out] derivedKey
+         *     This is where to store the derived key, if found.
+         *
+         * @return
+         *     An indication of whether or not the daemon could be
+         *     asked is returned.
+         */
+        bool Lookup(const std::string& key, std::string& derivedKey) {
+            PendingLookup lookup;
+            lookup.key = key;
+            std::unique_lock< std::mutex > lock(mutex);
+            if (std::chrono::steady_clock::now() < retryAfter) {
+                return false;
+            }
+            lookups.push_back(&lookup);
+            while (!lookup.done) {
+                if (exchanging) {
+                    wakeCondition.wait(lock);
+                } else {
+                    ExchangeBatch(lock);
+                }
+            }
+            derivedKey.swap(lookup.derivedKey);
+            return (std::chrono::steady_clock::now() >= retryAfter);
+        }
+
+        /**
+         * Pass the given derived key along to the daemon.
+         *
+         * @param[in] key
+         *     This is the key under which to hold the derived key.
+         *
+         * @param[in] derivedKey
+         *     This is the derived key to pass along.
+         */
+        void Publish(const std::string& key, const std::string& derivedKey) {
+            std::unique_lock< std::mutex > lock(mutex);
+            if (
+                (std::chrono::steady_clock::now() < retryAfter)
+                || (stores.size() >= KEY_CACHE_MAX_PENDING_STORES)
+            ) {
+                return;
+            }
+            stores.emplace_back(key, derivedKey);
+
+            // If a batch is being exchanged, the derived key goes along
+            // with the next one, which the exchanging thread sends
+            // before it's done.
+            if (!exchanging) {
+                ExchangeBatch(lock);
+            }
+        }
+    };
+
+    KeyCacheClient::~KeyCacheClient() noexcept = default;
+    KeyCacheClient::KeyCacheClient(KeyCacheClient&&) noexcept = default;
+    KeyCacheClient& KeyCacheClient::operator=(KeyCacheClient&&) noexcept = default;
+
+    bool ReadKeyCacheSecret(const std::string& path, std::string& secret) {
+#ifdef _WIN32
+        (void)path;
+        (void)secret;
+        return false;
+#else
+        auto file = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        if (
+            (file < 0)
+            && (errno == ENOENT)
+        ) {
+            MakeSecretFile(path);
+            file = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        }
+        if (file < 0) {
+            return false;
+        }
+        struct stat status;
+        uint8_t buffer[KEY_CACHE_SECRET_LENGTH];
+        size_t received = 0;
+        if (
+            (fstat(file, &status) == 0)
+            && S_ISREG(status.st_mode)
+            && (status.st_uid == geteuid())
+            && ((status.st_mode & (S_IRWXG | S_IRWXO)) == 0)
+            && (status.st_size == (off_t)sizeof(buffer))
+        ) {
+            while (received < sizeof(buffer)) {
+                const auto amount = read(file, buffer + received, sizeof(buffer) - received);
+                if (amount <= 0) {
+                    if (
+                        (amount < 0)
+                        && (errno == EINTR)
+                    ) {
+                        continue;
+                    }
+                    break;
+                }
+                received += (size_t)amount;
+            }
+        }
+        (void)close(file);
+        const auto complete = (received == sizeof(buffer));
+        if (complete) {
+            Wipe(secret);
+            secret.assign((const char*)buffer, sizeof(buffer));
+        }
+        Wipe(buffer, sizeof(buffer));
+        return complete;
+#endif
+    }
+
+    KeyCacheClient::KeyCacheClient(
+        const std::string& socketPath,
+        const std::string& secret,
+        std::chrono::milliseconds timeout
+    )
+        : impl_(std::make_shared< Impl >(socketPath, secret, timeout))
+    {
+    }
+
+    std::shared_ptr< const ScramProfile > KeyCacheClient::Attach(
+        std::shared_ptr< const ScramProfile > profile
+    ) const {
+        const auto impl = impl_;
+        return profile->WithKeyDerivation(
+            [impl, profile](
+                const uint8_t* password,
+                size_t passwordLength,
+                const uint8_t* salt,
+                size_t saltLength,
+                size_t iterations,
+                uint8_t* saltedPassword,
+                const std::function< bool() >& keepGoing
+            ){
+                const auto digestLength = profile->GetDigestLength();
+                std::string key;
+                std::string derivedKey;
+                if (impl->secretKey == nullptr) {
+                    ++impl->unavailable;
+                } else {
+                    uint8_t fingerprint[KeyCache::FINGERPRINT_LENGTH];
+                    Fingerprint(
+                        *impl->secretKey,
+                        password,
+                        passwordLength,
+                        salt,
+                        saltLength,
+                        fingerprint
+                    );
+                    key = KeyCache::MakeKey(
+                        profile->GetMechanismName(),
+                        salt,
+                        saltLength,
+                        iterations,
+                        fingerprint
+                    );
+                    if (!impl->Lookup(key, derivedKey)) {
+                        ++impl->unavailable;
+                    } else if (derivedKey.length() == digestLength) {
+                        ++impl->hits;
+                        (void)memcpy(saltedPassword, derivedKey.data(), digestLength);
+                        Wipe(derivedKey);
+                        return true;
+                    } else {
+                        ++impl->misses;
+                    }
+                }
+                const auto& keyDerivation = profile->GetKeyDerivation();
+                const auto derived = (
+                    keyDerivation
+                    ? keyDerivation(
+                        password,
+                        passwordLength,
+                        salt,
+                        saltLength,
+                        iterations,
+                        saltedPassword,
+                        keepGoing
+                    )
+                    : Hi(
+                        HmacKey(
+                            profile->GetHashContextFactory(),
+                            profile->GetBlockSize(),
+                            digestLength,
+                            password,
+                            passwordLength
+                        ),
+                        salt,
+                        saltLength,
+                        iterations,
+                        saltedPassword,
+                        keepGoing
+                    )
+                );
+                if (
+                    derived
+                    && !key.empty()
+                ) {
+                    derivedKey.assign((const char*)saltedPassword, digestLength);
+                    impl->Publish(key, derivedKey);
+                    Wipe(derivedKey);
+                }
+                return derived;
+            }
+        );
+    }
+
+    auto KeyCacheClient::GetStats() const -> Stats {
+        Stats stats;
+        stats.hits = impl_->hits;
+        stats.misses = impl_->misses;
+        stats.unavailable = impl_->unavailable;
+        stats.stores = impl_->stored;
+        return stats;
+    }
+
+}
+}
@@ -6,8 +6,24 @@
  * © 2019 by Richard Walters
  */
 
+#include "../LazyDiagnosticsSender.hpp"
+#include "ExchangeLimits.hpp"
+#include "Snapshot.hpp"
+
+#include <new>
 #include <Sasl/Client/Login.hpp>
+#include <Sasl/Trace.hpp>
 #include <stddef.h>
+#include <utility>
+
+namespace {
+
+    /**
+     * This is the name of the mechanism, as recorded in snapshots.
+     */
+    constexpr const char* MECHANISM_NAME = "LOGIN";
+
+}
 
 namespace Sasl {
 namespace Client {
@@ -22,22 +38,41 @@ namespace Client {
          * This is a helper object used to generate and publish
          * diagnostic messages.
          */
-        SystemAbstractions::DiagnosticsSender diagnosticsSender;
+        LazyDiagnosticsSender diagnosticsSender;
 
         /**
-         * This is the text to provide the server after the first challenge.
+         * These are the credentials to provide to the server.  The
+         * authentication identity is provided after the first challenge,
+         * and the password after the second challenge.
          */
-        std::string username;
+        std::shared_ptr< const PasswordCredentials > credentials;
 
         /**
-         * This is the text to provide the server after the second challenge.
+         * This counts the number of challenges the server has given.
          */
-        std::string password;
+        size_t numChallenges = 0;
 
         /**
-         * This counts the number of challenges the server has given.
+         * This selects whether or not the authentication identity
+         * is sent as an initial response.
          */
-        size_t numChallenges = 0;
+        InitialResponseMode initialResponseMode = InitialResponseMode::Auto;
+
+        /**
+         * These may cut short the authentication exchange.
+         */
+        ExchangeLimits limits;
+
+        /**
+         * This indicates whether or not the authentication exchange
+         * was cut short.
+         */
+        bool faulted = false;
+
+        /**
+         * This holds what is traced about the exchange.
+         */
+        Trace::Exchange trace;
 
         // Methods
 
@@ -50,13 +85,33 @@ namespace Client {
         }
     };
 
-    Login::~Login() noexcept = default;
-    Login::Login(Login&& other) noexcept = default;
-    Login& Login::operator=(Login&& other) noexcept = default;
+    Login::~Login() noexcept {
+        impl_->~Impl();
+    }
+
+    Login::Login(Login&& other) noexcept
+        : impl_(new (implStorage_) Impl(std::move(*other.impl_)))
+    {
+    }
+
+    Login& Login::operator=(Login&& other) noexcept {
+        if (this != &other) {
+            *impl_ = std::move(*other.impl_);
+        }
+        return *this;
+    }
 
     Login::Login()
-        : impl_(new Impl)
+        : impl_(new (implStorage_) Impl)
     {
+        static_assert(
+            sizeof(Impl) <= IMPL_STORAGE_SIZE,
+            "Login::Impl doesn't fit in Login::implStorage_"
+        );
+        static_assert(
+            alignof(Impl) <= alignof(std::max_align_t),
+            "Login::Impl is over-aligned for Login::implStorage_"
+        );
     }
 
     SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate Login::SubscribeToDiagnostics(
@@ -67,7 +122,47 @@ namespace Client {
     }
 
     void Login::Reset() {
+        impl_->trace.Reset();
         impl_->numChallenges = 0;
+        impl_->faulted = false;
+        impl_->limits.Clear();
+    }
+
+    void Login::SetInitialResponseMode(
+        InitialResponseMode initialResponseMode
+    ) {
+        impl_->initialResponseMode = initialResponseMode;
+    }
+
+    RoundTripProfile Login::GetRoundTripProfile() {
+        RoundTripProfile roundTripProfile;
+        roundTripProfile.sendsInitialResponse = (
+            impl_->initialResponseMode == InitialResponseMode::Always
+        );
+        roundTripProfile.roundTrips = (
+            roundTripProfile.sendsInitialResponse
+            ? 2
+            : 3
+        );
+        return roundTripProfile;
+    }
+
+    void Login::SetCancellationToken(
+        const CancellationToken& cancellationToken
+    ) {
+        impl_->limits.cancellationToken = cancellationToken;
+    }
+
+    void Login::SetDeadline(
+        std::chrono::steady_clock::time_point deadline
+    ) {
+        impl_->limits.deadline = deadline;
+    }
+
+    void Login::SetSharedCredentials(
+        std::shared_ptr< const PasswordCredentials > credentials
+    ) {
+        impl_->credentials = credentials;
     }
 
     void Login::SetCredentials(
@@ -75,33 +170,69 @@ namespace Client {
         const std::string& authenticationIdentity,
         const std::string& authorizationIdentity
     ) {
-        impl_->username = authenticationIdentity;
-        impl_->password = credentials;
+        Trace::Span span("Login::SetCredentials", impl_->trace);
+        impl_->credentials = PasswordCredentials::Create(
+            credentials,
+            authenticationIdentity,
+            authorizationIdentity
+        );
     }
 
     std::string Login::GetInitialResponse() {
-        impl_->diagnosticsSender.SendDiagnosticInformationString(
-            0,
-            "C: AUTH LOGIN"
-        );
-        return "";
+        Trace::Span span("Login::GetInitialResponse", impl_->trace);
+        // The LOGIN mechanism doesn't provide for an initial response,
+        // but many servers accept the authentication identity as one,
+        // which saves the round trip for the "Username:" challenge.
+        if (
+            (impl_->initialResponseMode != InitialResponseMode::Always)
+            || (impl_->credentials == nullptr)
+            || (impl_->numChallenges != 0)
+        ) {
+            impl_->diagnosticsSender.SendDiagnosticInformationString(
+                0,
+                "C: AUTH LOGIN"
+            );
+            return "";
+        }
+        if (impl_->diagnosticsSender.IsActive()) {
+            impl_->diagnosticsSender.SendDiagnosticInformationString(
+                0,
+                "C: AUTH LOGIN " + impl_->credentials->GetAuthenticationIdentity()
+            );
+        }
+        impl_->numChallenges = 1;
+        return impl_->credentials->GetAuthenticationIdentity();
     }
 
     std::string Login::Proceed(const std::string& message) {
+        Trace::Span span("Login::Proceed", impl_->trace);
+        if (
+            impl_->faulted
+            || impl_->limits.IsCancelled()
+            || impl_->limits.IsPastDeadline()
+        ) {
+            impl_->faulted = true;
+            return "";
+        }
+        if (impl_->credentials == nullptr) {
+            return "";
+        }
         switch (++impl_->numChallenges) {
             case 1: {
-                impl_->diagnosticsSender.SendDiagnosticInformationString(
-                    0,
-                    "C: " + impl_->username
-                );
-            } return impl_->username;
+                if (impl_->diagnosticsSender.IsActive()) {
+                    impl_->diagnosticsSender.SendDiagnosticInformationString(
+                        0,
+                        "C: " + impl_->credentials->GetAuthenticationIdentity()
+                    );
+                }
+            } return impl_->credentials->GetAuthenticationIdentity();
 
             case 2: {
                 impl_->diagnosticsSender.SendDiagnosticInformationString(
                     0,
                     "C: *******"
                 );
-            } return impl_->password;
+            } return impl_->credentials->GetPassword();
 
             default: return "";
         }
@@ -112,7 +243,65 @@ namespace Client {
     }
 
     bool Login::Faulted() {
-        return false;
+        return impl_->faulted;
+    }
+
+    bool Login::Snapshot(
+        std::string& snapshot,
+        SnapshotCredentials credentials
+    ) {
+        const auto credentialsIncluded = (
+            (credentials == SnapshotCredentials::Include)
+            && (impl_->credentials != nullptr)
+        );
+        BeginSnapshot(MECHANISM_NAME, credentialsIncluded, snapshot);
+        EncodeNumber(impl_->numChallenges, snapshot);
+        snapshot += (char)impl_->faulted;
+        snapshot += (char)impl_->initialResponseMode;
+        if (credentialsIncluded) {
+            EncodePasswordCredentials(*impl_->credentials, snapshot);
+        }
+        return true;
+    }
+
+    bool Login::Restore(const std::string& snapshot) {
+        size_t offset;
+        bool credentialsIncluded;
+        uint64_t numChallenges;
+        bool faulted;
+        InitialResponseMode initialResponseMode;
+        if (
+            !BeginRestore(snapshot, MECHANISM_NAME, offset, credentialsIncluded)
+            || !DecodeNumber(snapshot, offset, numChallenges)
+            || !DecodeFlag(snapshot, offset, faulted)
+            || !DecodeInitialResponseMode(snapshot, offset, initialResponseMode)
+        ) {
+            return false;
+        }
+        auto restoredCredentials = impl_->credentials;
+        if (
+            (
+                credentialsIncluded
+                && !DecodePasswordCredentials(snapshot, offset, restoredCredentials)
+            )
+            || (offset != snapshot.length())
+        ) {
+            return false;
+        }
+        impl_->trace.Reset();
+        impl_->credentials = restoredCredentials;
+        impl_->numChallenges = (size_t)numChallenges;
+        impl_->faulted = faulted;
+        impl_->initialResponseMode = initialResponseMode;
+        return true;
+    }
+
+    void Login::Release() {
+        // The credentials are shared, and wiped when the last
+        // mechanism using them lets them go.
+        impl_->credentials = nullptr;
+        impl_->limits.Clear();
+        impl_->trace.Reset();
     }
 
 }
@@ -0,0 +1,252 @@
+/**
+ * @file MechanismRegistry.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::MechanismRegistry class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <Sasl/Client/CramMd5.hpp>
+#include <Sasl/Client/Login.hpp>
+#include <Sasl/Client/MechanismRegistry.hpp>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <limits>
+#include <memory>
+#include <string.h>
+#include <utility>
+
+namespace {
+
+    /**
+     * Make a new PLAIN mechanism.
+     *
+     * @return
+     *     The new mechanism is returned.
+     */
+    std::unique_ptr< Sasl::Client::Mechanism > MakePlain() {
+        return std::unique_ptr< Sasl::Client::Mechanism >(new Sasl::Client::Plain());
+    }
+
+    /**
+     * Make a new LOGIN mechanism.
+     *
+     * @return
+     *     The new mechanism is returned.
+     */
+    std::unique_ptr< Sasl::Client::Mechanism > MakeLogin() {
+        return std::unique_ptr< Sasl::Client::Mechanism >(new Sasl::Client::Login());
+    }
+
+    /**
+     * Make a new CRAM-MD5 mechanism.
+     *
+     * @return
+     *     The new mechanism is returned.
+     */
+    std::unique_ptr< Sasl::Client::Mechanism > MakeCramMd5() {
+        return std::unique_ptr< Sasl::Client::Mechanism >(new Sasl::Client::CramMd5());
+    }
+
+    /**
+     * Make a new SCRAM-SHA-1 mechanism.
+     *
+     * @return
+     *     The new mechanism is returned.
+     */
+    std::unique_ptr< Sasl::Client::Mechanism > MakeScramSha1() {
+        std::unique_ptr< Sasl::Client::Scram > mech(new Sasl::Client::Scram());
+        mech->SetProfile(Sasl::Client::ScramProfile::Sha1());
+        return std::move(mech);
+    }
+
+    /**
+     * Make a new SCRAM-SHA-256 mechanism.
+     *
+     * @return
+     *     The new mechanism is returned.
+     */
+    std::unique_ptr< Sasl::Client::Mechanism > MakeScramSha256() {
+        std::unique_ptr< Sasl::Client::Scram > mech(new Sasl::Client::Scram());
+        mech->SetProfile(Sasl::Client::ScramProfile::Sha256());
+        return std::move(mech);
+    }
+
+    /**
+     * This is the table of mechanisms built into the library.
+     *
+     * Security: PLAIN and LOGIN reveal the password to the server;
+     * SCRAM doesn't, and SHA-256 is preferred over SHA-1.  CRAM-MD5
+     * doesn't send the password either, but it's rated no higher than
+     * PLAIN, because the server must keep a plaintext-equivalent
+     * password and an eavesdropper can guess passwords offline.
+     *
+     * Round trips: these match what each mechanism reports from
+     * GetRoundTripProfile when left in InitialResponseMode::Auto.
+     * PLAIN sends everything in its initial response, SCRAM needs
+     * a second round trip, CRAM-MD5 waits for the server's challenge,
+     * and LOGIN waits to be asked for each of the username and password.
+     *
+     * CPU cost: SCRAM derives its keys with thousands of HMAC
+     * iterations, CRAM-MD5 computes a single HMAC, and PLAIN and LOGIN
+     * do nothing but copy strings.
+     */
+    constexpr Sasl::Client::MechanismRegistry::Entry BUILT_IN_ENTRIES[] = {
+        Sasl::Client::MechanismRegistry::MakeEntry("SCRAM-SHA-256", MakeScramSha256, 3, 2, 20),
+        Sasl::Client::MechanismRegistry::MakeEntry("SCRAM-SHA-1", MakeScramSha1, 2, 2, 10),
+        Sasl::Client::MechanismRegistry::MakeEntry("PLAIN", MakePlain, 1, 1, 0),
+        Sasl::Client::MechanismRegistry::MakeEntry("CRAM-MD5", MakeCramMd5, 1, 2, 1),
+        Sasl::Client::MechanismRegistry::MakeEntry("LOGIN", MakeLogin, 1, 3, 0),
+    };
+
+    /**
+     * This is the registry of mechanisms built into the library.
+     */
+    constexpr Sasl::Client::MechanismRegistry BUILT_IN_REGISTRY(BUILT_IN_ENTRIES);
+
+    /**
+     * Compute the hash of the given mechanism name, in the same way as
+     * Sasl::Client::MechanismRegistry::HashName, but at run time and
+     * for a name that isn't terminated.
+     *
+     * @param[in] name
+     *     This points to the name to hash.
+     *
+     * @param[in] length
+     *     This is the number of characters in the name.
+     *
+     * @return
+     *     The hash of the given name is returned.
+     */
+    uint32_t ComputeNameHash(const char* name, size_t length) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; ++i) {
+            hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    /**
+     * Determine whether or not the given character separates mechanism
+     * names in a list advertised by a server.
+     *
+     * @param[in] c
+     *     This is the character to check.
+     *
+     * @return
+     *     An indication of whether or not the given character separates
+     *     mechanism names is returned.
+     */
+    bool IsSeparator(char c) {
+        return (
+            (c == ' ')
+            || (c == ',')
+            || (c == '\t')
+            || (c == '\r')
+            || (c == '\n')
+        );
+    }
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    const MechanismRegistry& MechanismRegistry::BuiltIn() {
+        return BUILT_IN_REGISTRY;
+    }
+
+    auto MechanismRegistry::Find(const std::string& name) const -> const Entry* {
+        return Find(name.data(), name.length());
+    }
+
+    auto MechanismRegistry::Select(
+        const std::string& advertised,
+        const Preferences& preferences
+    ) const -> const Entry* {
+        const Entry* bestEntry = nullptr;
+        auto bestScore = std::numeric_limits< long long >::min();
+        size_t nameStart = 0;
+        while (nameStart < advertised.length()) {
+            if (IsSeparator(advertised[nameStart])) {
+                ++nameStart;
+                continue;
+            }
+            auto nameEnd = nameStart;
+            while (
+                (nameEnd < advertised.length())
+                && !IsSeparator(advertised[nameEnd])
+            ) {
+                ++nameEnd;
+            }
+            const auto entry = Find(advertised.data() + nameStart, nameEnd - nameStart);
+            nameStart = nameEnd;
+            if (
+                (entry == nullptr)
+                || (entry->security < preferences.minSecurity)
+            ) {
+                continue;
+            }
+            auto score = (
+                (long long)entry->security * preferences.securityWeight
+                - (long long)entry->roundTrips * preferences.roundTripWeight
+            );
+            if (
+                !preferences.hasPreparedCredentials
+                || !preferences.hasPreparedCredentials(*entry)
+            ) {
+                score -= (long long)entry->cpuCost * preferences.cpuCostWeight;
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                bestEntry = entry;
+            }
+        }
+        return bestEntry;
+    }
+
+    auto MechanismRegistry::Select(const std::string& advertised) const -> const Entry* {
+        return Select(advertised, Preferences());
+    }
+
+    std::unique_ptr< Mechanism > MechanismRegistry::Create(
+        const std::string& advertised,
+        std::string& name,
+        const Preferences& preferences
+    ) const {
+        const auto entry = Select(advertised, preferences);
+        if (entry == nullptr) {
+            return nullptr;
+        }
+        name = entry->name;
+        return entry->factory();
+    }
+
+    std::unique_ptr< Mechanism > MechanismRegistry::Create(
+        const std::string& advertised,
+        std::string& name
+    ) const {
+        return Create(advertised, name, Preferences());
+    }
+
+    auto MechanismRegistry::Find(
+        const char* name,
+        size_t length
+    ) const -> const Entry* {
+        const auto nameHash = ComputeNameHash(name, length);
+        for (size_t i = 0; i < numEntries_; ++i) {
+            const auto& entry = entries_[i];
+            if (
+                (entry.nameHash == nameHash)
+                && (strncmp(entry.name, name, length) == 0)
+                && (entry.name[length] == '\0')
+            ) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+}
+}
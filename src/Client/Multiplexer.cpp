@@ -0,0 +1,232 @@
+/**
+ * @file Multiplexer.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::Multiplexer class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <chrono>
+#include <Sasl/Client/Multiplexer.hpp>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    /**
+     * This identifies a server message which is ready to be given
+     * to the mechanism of an exchange.
+     */
+    struct ReadyMessage {
+        /**
+         * This is the index of the slot holding the exchange.
+         */
+        size_t slot;
+
+        /**
+         * This points to the text of the message.
+         */
+        const std::string* text;
+    };
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a Multiplexer instance.
+     */
+    struct Multiplexer::Impl {
+        // Properties
+
+        /**
+         * These are the mechanisms of the exchanges, in slots which are
+         * reused as exchanges complete and new ones are added.  A slot
+         * is free if its mechanism is null.
+         */
+        std::vector< std::unique_ptr< Mechanism > > mechanisms;
+
+        /**
+         * These identify the connections of the exchanges,
+         * in the same slots as the mechanisms.
+         */
+        std::vector< ConnectionId > connectionIds;
+
+        /**
+         * These are the indexes of the free slots.
+         */
+        std::vector< size_t > freeSlots;
+
+        /**
+         * This maps connections to the slots of their exchanges.
+         */
+        std::unordered_map< ConnectionId, size_t > slotsByConnectionId;
+
+        /**
+         * This is the queue of server messages which are ready to be
+         * given to mechanisms.  It's kept between batches so that
+         * its storage is reused.
+         */
+        std::vector< ReadyMessage > readyMessages;
+
+        /**
+         * This holds measurements of the work done by the multiplexer.
+         */
+        Statistics statistics;
+
+        /**
+         * This is the time at which the statistics were last reset.
+         */
+        std::chrono::steady_clock::time_point statisticsStartTime = std::chrono::steady_clock::now();
+
+        // Methods
+
+        /**
+         * Take the exchange in the given slot out of the multiplexer.
+         *
+         * @param[in] slot
+         *     This is the index of the slot holding the exchange.
+         *
+         * @return
+         *     The mechanism of the exchange is returned.
+         */
+        std::unique_ptr< Mechanism > Take(size_t slot) {
+            (void)slotsByConnectionId.erase(connectionIds[slot]);
+            freeSlots.push_back(slot);
+            return std::move(mechanisms[slot]);
+        }
+    };
+
+    Multiplexer::~Multiplexer() noexcept = default;
+    Multiplexer::Multiplexer(Multiplexer&&) noexcept = default;
+    Multiplexer& Multiplexer::operator=(Multiplexer&&) noexcept = default;
+
+    Multiplexer::Multiplexer()
+        : impl_(new Impl)
+    {
+    }
+
+    void Multiplexer::Reserve(size_t numExchanges) {
+        impl_->mechanisms.reserve(numExchanges);
+        impl_->connectionIds.reserve(numExchanges);
+        impl_->freeSlots.reserve(numExchanges);
+        impl_->slotsByConnectionId.reserve(numExchanges);
+        impl_->readyMessages.reserve(numExchanges);
+    }
+
+    bool Multiplexer::Add(
+        ConnectionId connectionId,
+        std::unique_ptr< Mechanism > mechanism,
+        std::string& initialResponse
+    ) {
+        if (mechanism == nullptr) {
+            return false;
+        }
+        size_t slot;
+        if (impl_->freeSlots.empty()) {
+            slot = impl_->mechanisms.size();
+        } else {
+            slot = impl_->freeSlots.back();
+        }
+        if (!impl_->slotsByConnectionId.emplace(connectionId, slot).second) {
+            return false;
+        }
+        if (slot == impl_->mechanisms.size()) {
+            impl_->mechanisms.push_back(nullptr);
+            impl_->connectionIds.push_back(connectionId);
+        } else {
+            impl_->freeSlots.pop_back();
+            impl_->connectionIds[slot] = connectionId;
+        }
+        initialResponse = mechanism->GetInitialResponse();
+        impl_->mechanisms[slot] = std::move(mechanism);
+        ++impl_->statistics.exchangesStarted;
+        return true;
+    }
+
+    std::unique_ptr< Mechanism > Multiplexer::Remove(ConnectionId connectionId) {
+        const auto slotsByConnectionIdEntry = impl_->slotsByConnectionId.find(connectionId);
+        if (slotsByConnectionIdEntry == impl_->slotsByConnectionId.end()) {
+            return nullptr;
+        }
+        return impl_->Take(slotsByConnectionIdEntry->second);
+    }
+
+    size_t Multiplexer::GetExchangeCount() const {
+        return impl_->slotsByConnectionId.size();
+    }
+
+    void Multiplexer::Process(
+        const std::vector< Message >& inbound,
+        std::vector< Message >& outbound,
+        std::vector< Completion >& completions
+    ) {
+        // First, find the exchanges of all the messages, so that the
+        // mechanisms can then be driven in one pass over the batch.
+        auto& readyMessages = impl_->readyMessages;
+        readyMessages.clear();
+        for (const auto& message: inbound) {
+            const auto slotsByConnectionIdEntry = impl_->slotsByConnectionId.find(message.connectionId);
+            if (slotsByConnectionIdEntry == impl_->slotsByConnectionId.end()) {
+                ++impl_->statistics.messagesDropped;
+            } else {
+                readyMessages.push_back({slotsByConnectionIdEntry->second, &message.text});
+            }
+        }
+        for (const auto& readyMessage: readyMessages) {
+            auto& mechanism = impl_->mechanisms[readyMessage.slot];
+            if (mechanism == nullptr) {
+                // The exchange completed earlier in the same batch.
+                ++impl_->statistics.messagesDropped;
+                continue;
+            }
+            const auto connectionId = impl_->connectionIds[readyMessage.slot];
+            auto response = mechanism->Proceed(*readyMessage.text);
+            ++impl_->statistics.messagesProcessed;
+            const auto faulted = mechanism->Faulted();
+            if (
+                (
+                    response.empty()
+                    && !mechanism->ResponsePending()
+                )
+                || faulted
+            ) {
+                Completion completion;
+                completion.connectionId = connectionId;
+                completion.succeeded = mechanism->Succeeded();
+                completion.faulted = faulted;
+                completion.mechanism = impl_->Take(readyMessage.slot);
+                completions.push_back(std::move(completion));
+                ++impl_->statistics.exchangesCompleted;
+            } else {
+                outbound.push_back({connectionId, std::move(response)});
+            }
+        }
+        readyMessages.clear();
+    }
+
+    auto Multiplexer::GetStatistics() const -> Statistics {
+        auto statistics = impl_->statistics;
+        statistics.elapsedSeconds = std::chrono::duration< double >(
+            std::chrono::steady_clock::now() - impl_->statisticsStartTime
+        ).count();
+        if (statistics.elapsedSeconds > 0.0) {
+            statistics.exchangesPerSecond = (
+                (double)statistics.exchangesCompleted
+                / statistics.elapsedSeconds
+            );
+        }
+        return statistics;
+    }
+
+    void Multiplexer::ResetStatistics() {
+        impl_->statistics = Statistics();
+        impl_->statisticsStartTime = std::chrono::steady_clock::now();
+    }
+
+}
+}
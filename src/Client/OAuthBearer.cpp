@@ -0,0 +1,192 @@
+/**
+ * @file OAuthBearer.cpp
+ *
+ * This module contains the implementation of the Sasl::Client::OAuthBearer class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "BearerExchange.hpp"
+
+#include <new>
+#include <Sasl/Client/OAuthBearer.hpp>
+#include <string>
+#include <utility>
+
+namespace {
+
+    /**
+     * This describes how the OAUTHBEARER mechanism passes the token
+     * to the server.
+     */
+    const Sasl::Client::BearerFlavor FLAVOR = {
+        "OAUTHBEARER",
+        &Sasl::Client::BearerCredentials::Payloads::oauthBearerMessage,
+        &Sasl::Client::BearerCredentials::Payloads::oauthBearerDiagnosticMessage,
+        "\x01",
+    };
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a OAuthBearer instance.
+     */
+    struct OAuthBearer::Impl {
+        // Properties
+
+        /**
+         * This is a helper object used to generate and publish
+         * diagnostic messages.
+         */
+        LazyDiagnosticsSender diagnosticsSender;
+
+        /**
+         * This holds the state of the authentication exchange.
+         */
+        BearerExchange exchange;
+
+        // Methods
+
+        /**
+         * This is the default constructor of the structure
+         */
+        Impl()
+            : diagnosticsSender("OAuthBearer")
+        {
+        }
+    };
+
+    OAuthBearer::~OAuthBearer() noexcept {
+        impl_->~Impl();
+    }
+
+    OAuthBearer::OAuthBearer(OAuthBearer&& other) noexcept
+        : impl_(new (implStorage_) Impl(std::move(*other.impl_)))
+    {
+    }
+
+    OAuthBearer& OAuthBearer::operator=(OAuthBearer&& other) noexcept {
+        if (this != &other) {
+            *impl_ = std::move(*other.impl_);
+        }
+        return *this;
+    }
+
+    OAuthBearer::OAuthBearer()
+        : impl_(new (implStorage_) Impl)
+    {
+        static_assert(
+            sizeof(Impl) <= IMPL_STORAGE_SIZE,
+            "OAuthBearer::Impl doesn't fit in OAuthBearer::implStorage_"
+        );
+        static_assert(
+            alignof(Impl) <= alignof(std::max_align_t),
+            "OAuthBearer::Impl is over-aligned for OAuthBearer::implStorage_"
+        );
+    }
+
+    void OAuthBearer::SetSharedCredentials(
+        std::shared_ptr< const BearerCredentials > credentials
+    ) {
+        impl_->exchange.credentials = credentials;
+        impl_->exchange.payloads = nullptr;
+    }
+
+    const std::string& OAuthBearer::GetErrorChallenge() const {
+        return impl_->exchange.errorChallenge;
+    }
+
+    SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate OAuthBearer::SubscribeToDiagnostics(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+        size_t minLevel
+    ) {
+        return impl_->diagnosticsSender.SubscribeToDiagnostics(delegate, minLevel);
+    }
+
+    void OAuthBearer::Reset() {
+        impl_->exchange.Reset();
+    }
+
+    void OAuthBearer::SetInitialResponseMode(
+        InitialResponseMode initialResponseMode
+    ) {
+        impl_->exchange.initialResponseMode = initialResponseMode;
+    }
+
+    RoundTripProfile OAuthBearer::GetRoundTripProfile() {
+        return impl_->exchange.GetRoundTripProfile();
+    }
+
+    void OAuthBearer::SetCancellationToken(
+        const CancellationToken& cancellationToken
+    ) {
+        impl_->exchange.limits.cancellationToken = cancellationToken;
+    }
+
+    void OAuthBearer::SetDeadline(
+        std::chrono::steady_clock::time_point deadline
+    ) {
+        impl_->exchange.limits.deadline = deadline;
+    }
+
+    void OAuthBearer::SetCredentials(
+        const std::string& credentials,
+        const std::string& authenticationIdentity,
+        const std::string& authorizationIdentity
+    ) {
+        Trace::Span span("OAuthBearer::SetCredentials", impl_->exchange.trace);
+        SetSharedCredentials(
+            BearerCredentials::Create(
+                credentials,
+                (
+                    authorizationIdentity.empty()
+                    ? authenticationIdentity
+                    : authorizationIdentity
+                )
+            )
+        );
+    }
+
+    std::string OAuthBearer::GetInitialResponse() {
+        Trace::Span span("OAuthBearer::GetInitialResponse", impl_->exchange.trace);
+        return impl_->exchange.GetInitialResponse(FLAVOR, impl_->diagnosticsSender);
+    }
+
+    std::string OAuthBearer::Proceed(const std::string& message) {
+        Trace::Span span("OAuthBearer::Proceed", impl_->exchange.trace);
+        return impl_->exchange.Proceed(FLAVOR, impl_->diagnosticsSender, message);
+    }
+
+    bool OAuthBearer::ResponsePending() {
+        return impl_->exchange.responsePending;
+    }
+
+    bool OAuthBearer::Succeeded() {
+        return false;
+    }
+
+    bool OAuthBearer::Faulted() {
+        return impl_->exchange.faulted;
+    }
+
+    bool OAuthBearer::Snapshot(
+        std::string& snapshot,
+        SnapshotCredentials credentials
+    ) {
+        impl_->exchange.Snapshot(FLAVOR, snapshot, credentials);
+        return true;
+    }
+
+    bool OAuthBearer::Restore(const std::string& snapshot) {
+        return impl_->exchange.Restore(FLAVOR, snapshot);
+    }
+
+    void OAuthBearer::Release() {
+        impl_->exchange.Release();
+    }
+
+}
+}
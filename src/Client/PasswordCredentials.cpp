@@ -0,0 +1,125 @@
+/**
+ * @file PasswordCredentials.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::PasswordCredentials class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../Wipe.hpp"
+
+#include <Sasl/Client/PasswordCredentials.hpp>
+
+namespace {
+
+    /**
+     * This is what is published to diagnostics in place of a password.
+     */
+    const std::string PASSWORD_MASK = "*******";
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a PasswordCredentials instance.
+     */
+    struct PasswordCredentials::Impl {
+        // Properties
+
+        /**
+         * This is the password to use in the authentication.
+         */
+        std::string password;
+
+        /**
+         * This is the identity to associate with the password.
+         */
+        std::string authenticationIdentity;
+
+        /**
+         * This is the identity to "act as" in the authentication.
+         */
+        std::string authorizationIdentity;
+
+        /**
+         * This is the message which passes the credentials to the server
+         * in the PLAIN mechanism.
+         */
+        std::string plainMessage;
+
+        /**
+         * This is the line to publish to diagnostics when the PLAIN
+         * mechanism passes the credentials to the server.
+         */
+        std::string plainDiagnosticMessage;
+    };
+
+    PasswordCredentials::~PasswordCredentials() noexcept {
+        Wipe(impl_->password);
+        Wipe(impl_->plainMessage);
+    }
+
+    PasswordCredentials::PasswordCredentials()
+        : impl_(new Impl)
+    {
+    }
+
+    std::shared_ptr< const PasswordCredentials > PasswordCredentials::Create(
+        const std::string& password,
+        const std::string& authenticationIdentity,
+        const std::string& authorizationIdentity
+    ) {
+        std::shared_ptr< PasswordCredentials > credentials(new PasswordCredentials());
+        auto& impl = *credentials->impl_;
+        impl.password = password;
+        impl.authenticationIdentity = authenticationIdentity;
+        impl.authorizationIdentity = authorizationIdentity;
+
+        // message   = [authzid] UTF8NUL authcid UTF8NUL passwd
+        impl.plainMessage.reserve(
+            authorizationIdentity.length()
+            + authenticationIdentity.length()
+            + password.length()
+            + 2
+        );
+        impl.plainMessage += authorizationIdentity;
+        impl.plainMessage += '\0';
+        impl.plainMessage += authenticationIdentity;
+        impl.plainMessage += '\0';
+        impl.plainMessage += password;
+        impl.plainDiagnosticMessage = (
+            "C: AUTH PLAIN "
+            + authorizationIdentity
+            + "\\0"
+            + authenticationIdentity
+            + "\\0"
+            + PASSWORD_MASK
+        );
+        return credentials;
+    }
+
+    const std::string& PasswordCredentials::GetPassword() const {
+        return impl_->password;
+    }
+
+    const std::string& PasswordCredentials::GetAuthenticationIdentity() const {
+        return impl_->authenticationIdentity;
+    }
+
+    const std::string& PasswordCredentials::GetAuthorizationIdentity() const {
+        return impl_->authorizationIdentity;
+    }
+
+    const std::string& PasswordCredentials::GetPlainMessage() const {
+        return impl_->plainMessage;
+    }
+
+    const std::string& PasswordCredentials::GetPlainDiagnosticMessage() const {
+        return impl_->plainDiagnosticMessage;
+    }
+
+}
+}
@@ -6,9 +6,24 @@
  * © 2019 by Richard Walters
  */
 
+#include "../LazyDiagnosticsSender.hpp"
+#include "ExchangeLimits.hpp"
+#include "Snapshot.hpp"
+
+#include <new>
 #include <Sasl/Client/Plain.hpp>
+#include <Sasl/Trace.hpp>
 #include <string>
-#include <sstream>
+#include <utility>
+
+namespace {
+
+    /**
+     * This is the name of the mechanism, as recorded in snapshots.
+     */
+    constexpr const char* MECHANISM_NAME = "PLAIN";
+
+}
 
 namespace Sasl {
 namespace Client {
@@ -23,19 +38,14 @@ namespace Client {
          * This is a helper object used to generate and publish
          * diagnostic messages.
          */
-        SystemAbstractions::DiagnosticsSender diagnosticsSender;
+        LazyDiagnosticsSender diagnosticsSender;
 
         /**
-         * This is the line to provide to the server to pass along
-         * the credentials.
+         * These are the credentials to pass along to the server,
+         * along with the lines built from them to send to the server
+         * and to publish to diagnostics.
          */
-        std::string encodedCredentialsToSend;
-
-        /**
-         * This is the line to publish to diagnostics when passing along
-         * the credentials to the server.
-         */
-        std::string encodedCredentialsToPublishToDiagnostics;
+        std::shared_ptr< const PasswordCredentials > credentials;
 
         /**
          * This indicates whether or not the credentials have been
@@ -43,6 +53,28 @@ namespace Client {
          */
         bool credentialsSent = false;
 
+        /**
+         * This selects whether or not the credentials are sent
+         * as an initial response.
+         */
+        InitialResponseMode initialResponseMode = InitialResponseMode::Auto;
+
+        /**
+         * These may cut short the authentication exchange.
+         */
+        ExchangeLimits limits;
+
+        /**
+         * This indicates whether or not the authentication exchange
+         * was cut short.
+         */
+        bool faulted = false;
+
+        /**
+         * This holds what is traced about the exchange.
+         */
+        Trace::Exchange trace;
+
         // Methods
 
         /**
@@ -54,13 +86,33 @@ namespace Client {
         }
     };
 
-    Plain::~Plain() noexcept = default;
-    Plain::Plain(Plain&& other) noexcept = default;
-    Plain& Plain::operator=(Plain&& other) noexcept = default;
+    Plain::~Plain() noexcept {
+        impl_->~Impl();
+    }
+
+    Plain::Plain(Plain&& other) noexcept
+        : impl_(new (implStorage_) Impl(std::move(*other.impl_)))
+    {
+    }
+
+    Plain& Plain::operator=(Plain&& other) noexcept {
+        if (this != &other) {
+            *impl_ = std::move(*other.impl_);
+        }
+        return *this;
+    }
 
     Plain::Plain()
-        : impl_(new Impl)
+        : impl_(new (implStorage_) Impl)
     {
+        static_assert(
+            sizeof(Impl) <= IMPL_STORAGE_SIZE,
+            "Plain::Impl doesn't fit in Plain::implStorage_"
+        );
+        static_assert(
+            alignof(Impl) <= alignof(std::max_align_t),
+            "Plain::Impl is over-aligned for Plain::implStorage_"
+        );
     }
 
     SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate Plain::SubscribeToDiagnostics(
@@ -71,7 +123,47 @@ namespace Client {
     }
 
     void Plain::Reset() {
+        impl_->trace.Reset();
         impl_->credentialsSent = false;
+        impl_->faulted = false;
+        impl_->limits.Clear();
+    }
+
+    void Plain::SetInitialResponseMode(
+        InitialResponseMode initialResponseMode
+    ) {
+        impl_->initialResponseMode = initialResponseMode;
+    }
+
+    RoundTripProfile Plain::GetRoundTripProfile() {
+        RoundTripProfile roundTripProfile;
+        roundTripProfile.sendsInitialResponse = (
+            impl_->initialResponseMode != InitialResponseMode::Never
+        );
+        roundTripProfile.roundTrips = (
+            roundTripProfile.sendsInitialResponse
+            ? 1
+            : 2
+        );
+        return roundTripProfile;
+    }
+
+    void Plain::SetCancellationToken(
+        const CancellationToken& cancellationToken
+    ) {
+        impl_->limits.cancellationToken = cancellationToken;
+    }
+
+    void Plain::SetDeadline(
+        std::chrono::steady_clock::time_point deadline
+    ) {
+        impl_->limits.deadline = deadline;
+    }
+
+    void Plain::SetSharedCredentials(
+        std::shared_ptr< const PasswordCredentials > credentials
+    ) {
+        impl_->credentials = credentials;
     }
 
     void Plain::SetCredentials(
@@ -79,35 +171,52 @@ namespace Client {
         const std::string& authenticationIdentity,
         const std::string& authorizationIdentity
     ) {
-        std::ostringstream builderForSending, builderForDiagnostics;
-        builderForSending     << authorizationIdentity;
-        builderForDiagnostics << authorizationIdentity;
-        builderForSending     << '\0';
-        builderForDiagnostics << "\\0";
-        builderForSending     << authenticationIdentity;
-        builderForDiagnostics << authenticationIdentity;
-        builderForSending     << '\0';
-        builderForDiagnostics << "\\0";
-        builderForSending     << credentials;
-        builderForDiagnostics << "*******";
-        impl_->encodedCredentialsToSend = builderForSending.str();
-        impl_->encodedCredentialsToPublishToDiagnostics = builderForDiagnostics.str();
+        Trace::Span span("Plain::SetCredentials", impl_->trace);
+        impl_->credentials = PasswordCredentials::Create(
+            credentials,
+            authenticationIdentity,
+            authorizationIdentity
+        );
     }
 
     std::string Plain::GetInitialResponse() {
+        Trace::Span span("Plain::GetInitialResponse", impl_->trace);
+        if (impl_->credentials == nullptr) {
+            return "";
+        }
+        if (impl_->initialResponseMode == InitialResponseMode::Never) {
+            impl_->diagnosticsSender.SendDiagnosticInformationString(
+                0,
+                "C: AUTH PLAIN"
+            );
+            return "";
+        }
         impl_->diagnosticsSender.SendDiagnosticInformationString(
             0,
-            "C: AUTH PLAIN " + impl_->encodedCredentialsToPublishToDiagnostics
+            impl_->credentials->GetPlainDiagnosticMessage()
         );
-        return impl_->encodedCredentialsToSend;
+        impl_->credentialsSent = true;
+        return impl_->credentials->GetPlainMessage();
     }
 
     std::string Plain::Proceed(const std::string& message) {
-        if (impl_->credentialsSent) {
+        Trace::Span span("Plain::Proceed", impl_->trace);
+        if (
+            impl_->faulted
+            || impl_->limits.IsCancelled()
+            || impl_->limits.IsPastDeadline()
+        ) {
+            impl_->faulted = true;
+            return "";
+        }
+        if (
+            impl_->credentialsSent
+            || (impl_->credentials == nullptr)
+        ) {
             return "";
         } else {
             impl_->credentialsSent = true;
-            return impl_->encodedCredentialsToSend;
+            return impl_->credentials->GetPlainMessage();
         }
     }
 
@@ -116,7 +225,65 @@ namespace Client {
     }
 
     bool Plain::Faulted() {
-        return false;
+        return impl_->faulted;
+    }
+
+    bool Plain::Snapshot(
+        std::string& snapshot,
+        SnapshotCredentials credentials
+    ) {
+        const auto credentialsIncluded = (
+            (credentials == SnapshotCredentials::Include)
+            && (impl_->credentials != nullptr)
+        );
+        BeginSnapshot(MECHANISM_NAME, credentialsIncluded, snapshot);
+        snapshot += (char)impl_->credentialsSent;
+        snapshot += (char)impl_->faulted;
+        snapshot += (char)impl_->initialResponseMode;
+        if (credentialsIncluded) {
+            EncodePasswordCredentials(*impl_->credentials, snapshot);
+        }
+        return true;
+    }
+
+    bool Plain::Restore(const std::string& snapshot) {
+        size_t offset;
+        bool credentialsIncluded;
+        bool credentialsSent;
+        bool faulted;
+        InitialResponseMode initialResponseMode;
+        if (
+            !BeginRestore(snapshot, MECHANISM_NAME, offset, credentialsIncluded)
+            || !DecodeFlag(snapshot, offset, credentialsSent)
+            || !DecodeFlag(snapshot, offset, faulted)
+            || !DecodeInitialResponseMode(snapshot, offset, initialResponseMode)
+        ) {
+            return false;
+        }
+        auto restoredCredentials = impl_->credentials;
+        if (
+            (
+                credentialsIncluded
+                && !DecodePasswordCredentials(snapshot, offset, restoredCredentials)
+            )
+            || (offset != snapshot.length())
+        ) {
+            return false;
+        }
+        impl_->trace.Reset();
+        impl_->credentials = restoredCredentials;
+        impl_->credentialsSent = credentialsSent;
+        impl_->faulted = faulted;
+        impl_->initialResponseMode = initialResponseMode;
+        return true;
+    }
+
+    void Plain::Release() {
+        // The credentials are shared, and wiped when the last
+        // mechanism using them lets them go.
+        impl_->credentials = nullptr;
+        impl_->limits.Clear();
+        impl_->trace.Reset();
     }
 
 }
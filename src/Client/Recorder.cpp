@@ -0,0 +1,303 @@
+/**
+ * @file Recorder.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::Recorder class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <Sasl/Client/Recorder.hpp>
+#include <string>
+#include <utility>
+
+namespace {
+
+    /**
+     * Return an indication of whether or not the mechanism
+     * with the given name is a SCRAM mechanism.
+     *
+     * @param[in] mechanismName
+     *     This is the name of the mechanism.
+     *
+     * @return
+     *     An indication of whether or not the mechanism
+     *     is a SCRAM mechanism is returned.
+     */
+    bool IsScram(const std::string& mechanismName) {
+        return (mechanismName.compare(0, 6, "SCRAM-") == 0);
+    }
+
+    /**
+     * Find the value of the attribute with the given name in the
+     * given SCRAM message.
+     *
+     * @param[in] message
+     *     This is the SCRAM message.
+     *
+     * @param[in] name
+     *     This is the name of the attribute.
+     *
+     * @param[out] start
+     *     This is where to store the position of the value.
+     *
+     * @return
+     *     The length of the value of the attribute is returned,
+     *     or zero if the attribute isn't in the message.
+     */
+    size_t FindScramAttribute(
+        const std::string& message,
+        char name,
+        size_t& start
+    ) {
+        for (size_t attribute = 0; attribute < message.length();) {
+            const auto end = std::min(message.find(',', attribute), message.length());
+            if (
+                (end - attribute >= 2)
+                && (message[attribute] == name)
+                && (message[attribute + 1] == '=')
+            ) {
+                start = attribute + 2;
+                return end - start;
+            }
+            attribute = end + 1;
+        }
+        return 0;
+    }
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a Recorder instance.
+     */
+    struct Recorder::Impl {
+        // Properties
+
+        /**
+         * This is the mechanism whose exchanges are recorded.
+         */
+        std::unique_ptr< Mechanism > mechanism;
+
+        /**
+         * This is the function to call with each recorded exchange.
+         */
+        ExchangeDelegate exchangeDelegate;
+
+        /**
+         * This is the exchange being recorded.
+         */
+        TranscriptExchange exchange;
+
+        /**
+         * This indicates whether or not the exchange being recorded
+         * has been handed to the delegate.
+         */
+        bool delivered = false;
+
+        // Methods
+
+        /**
+         * Record a step of the exchange.
+         *
+         * @param[in] initialResponse
+         *     This indicates whether the step got the initial response.
+         *
+         * @param[in] serverMessage
+         *     This is the message received from the server, if any.
+         *
+         * @param[in] clientMessage
+         *     This is the message the client sent in reply.
+         *
+         * @param[in] start
+         *     This is when the step started.
+         */
+        void RecordStep(
+            bool initialResponse,
+            const std::string& serverMessage,
+            const std::string& clientMessage,
+            std::chrono::steady_clock::time_point start
+        ) {
+            const auto nanoseconds = std::chrono::duration_cast< std::chrono::nanoseconds >(
+                std::chrono::steady_clock::now() - start
+            ).count();
+            TranscriptStep step;
+            step.initialResponse = initialResponse;
+            step.serverMessage = serverMessage;
+            step.clientMessageLength = clientMessage.length();
+            step.nanoseconds = (uint64_t)nanoseconds;
+            if (IsScram(exchange.mechanism)) {
+                // The client nonce is sent in the clear in the
+                // client-first-message, and is needed to replay the
+                // server-first-message.
+                size_t valueStart = 0;
+                if (exchange.clientNonce.empty()) {
+                    const auto length = FindScramAttribute(clientMessage, 'r', valueStart);
+                    exchange.clientNonce.assign(clientMessage, valueStart, length);
+                }
+
+                // The server signature, with the salt and nonces, would
+                // let anyone holding the transcript guess passwords
+                // offline, so it's replaced with a placeholder.
+                const auto length = FindScramAttribute(step.serverMessage, 'v', valueStart);
+                for (size_t i = valueStart; i < valueStart + length; ++i) {
+                    if (step.serverMessage[i] != '=') {
+                        step.serverMessage[i] = 'A';
+                    }
+                }
+            }
+            exchange.steps.push_back(std::move(step));
+        }
+
+        /**
+         * Hand the exchange being recorded to the delegate, if it
+         * hasn't been already and has any steps.
+         */
+        void Deliver() {
+            if (
+                delivered
+                || exchange.steps.empty()
+            ) {
+                return;
+            }
+            delivered = true;
+            exchange.succeeded = mechanism->Succeeded();
+            exchange.faulted = mechanism->Faulted();
+            if (exchangeDelegate != nullptr) {
+                exchangeDelegate(exchange);
+            }
+        }
+    };
+
+    Recorder::~Recorder() noexcept {
+        if (impl_ != nullptr) {
+            impl_->Deliver();
+        }
+    }
+    Recorder::Recorder(Recorder&&) noexcept = default;
+    Recorder& Recorder::operator=(Recorder&&) noexcept = default;
+
+    Recorder::Recorder(
+        std::unique_ptr< Mechanism > mechanism,
+        const std::string& mechanismName,
+        ExchangeDelegate exchangeDelegate
+    )
+        : impl_(new Impl)
+    {
+        impl_->mechanism = std::move(mechanism);
+        impl_->exchangeDelegate = exchangeDelegate;
+        impl_->exchange.mechanism = mechanismName;
+    }
+
+    Mechanism& Recorder::GetMechanism() const {
+        return *impl_->mechanism;
+    }
+
+    SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate Recorder::SubscribeToDiagnostics(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+        size_t minLevel
+    ) {
+        return impl_->mechanism->SubscribeToDiagnostics(delegate, minLevel);
+    }
+
+    void Recorder::Reset() {
+        impl_->Deliver();
+        impl_->mechanism->Reset();
+        impl_->exchange.clientNonce.clear();
+        impl_->exchange.steps.clear();
+        impl_->exchange.succeeded = false;
+        impl_->exchange.faulted = false;
+        impl_->delivered = false;
+    }
+
+    void Recorder::SetInitialResponseMode(
+        InitialResponseMode initialResponseMode
+    ) {
+        impl_->mechanism->SetInitialResponseMode(initialResponseMode);
+    }
+
+    RoundTripProfile Recorder::GetRoundTripProfile() {
+        return impl_->mechanism->GetRoundTripProfile();
+    }
+
+    void Recorder::SetCancellationToken(
+        const CancellationToken& cancellationToken
+    ) {
+        impl_->mechanism->SetCancellationToken(cancellationToken);
+    }
+
+    void Recorder::SetDeadline(
+        std::chrono::steady_clock::time_point deadline
+    ) {
+        impl_->mechanism->SetDeadline(deadline);
+    }
+
+    void Recorder::SetCredentials(
+        const std::string& credentials,
+        const std::string& authenticationIdentity,
+        const std::string& authorizationIdentity
+    ) {
+        impl_->mechanism->SetCredentials(
+            credentials,
+            authenticationIdentity,
+            authorizationIdentity
+        );
+    }
+
+    std::string Recorder::GetInitialResponse() {
+        const auto start = std::chrono::steady_clock::now();
+        auto initialResponse = impl_->mechanism->GetInitialResponse();
+        impl_->RecordStep(true, "", initialResponse, start);
+        return initialResponse;
+    }
+
+    std::string Recorder::Proceed(const std::string& message) {
+        const auto start = std::chrono::steady_clock::now();
+        auto output = impl_->mechanism->Proceed(message);
+        impl_->RecordStep(false, message, output, start);
+        if (
+            (
+                output.empty()
+                && !impl_->mechanism->ResponsePending()
+            )
+            || impl_->mechanism->Succeeded()
+            || impl_->mechanism->Faulted()
+        ) {
+            impl_->Deliver();
+        }
+        return output;
+    }
+
+    bool Recorder::ResponsePending() {
+        return impl_->mechanism->ResponsePending();
+    }
+
+    bool Recorder::Succeeded() {
+        return impl_->mechanism->Succeeded();
+    }
+
+    bool Recorder::Faulted() {
+        return impl_->mechanism->Faulted();
+    }
+
+    bool Recorder::Snapshot(
+        std::string& snapshot,
+        SnapshotCredentials credentials
+    ) {
+        return impl_->mechanism->Snapshot(snapshot, credentials);
+    }
+
+    bool Recorder::Restore(const std::string& snapshot) {
+        return impl_->mechanism->Restore(snapshot);
+    }
+
+    void Recorder::Release() {
+        impl_->mechanism->Release();
+    }
+
+}
+}
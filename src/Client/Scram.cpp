@@ -6,16 +6,29 @@
  * © 2019 by Richard Walters
  */
 
-#include <Base64/Base64.hpp>
-#include <Hash/Hmac.hpp>
-#include <Hash/Pbkdf2.hpp>
+#include "../Hi.hpp"
+#include "../Hmac.hpp"
+#include "../LazyDiagnosticsSender.hpp"
+#include "../Wipe.hpp"
+#include "ExchangeLimits.hpp"
+#include "Snapshot.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <new>
+#include <Sasl/Base64.hpp>
 #include <Sasl/Client/Scram.hpp>
+#include <Sasl/Sha.hpp>
+#include <Sasl/Trace.hpp>
 #include <sstream>
 #include <stdint.h>
-#include <stdio.h>
+#include <string.h>
 #include <string>
 #include <StringExtensions/StringExtensions.hpp>
 #include <SystemAbstractions/CryptoRandom.hpp>
+#include <SystemAbstractions/DiagnosticsSender.hpp>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -87,22 +100,6 @@ namespace {
         );
     }
 
-    /**
-     * Convert the given byte vector into the equivalent UTF-8 string.
-     *
-     * @param[in] s
-     *     This is the byte vector to convert.
-     *
-     * @return
-     *     This is the UTF-8 string equivalent of the given byte vector.
-     */
-    std::string StringFromByteVector(const std::vector< uint8_t >& v) {
-        return std::string(
-            v.begin(),
-            v.end()
-        );
-    }
-
     /**
      * Apply the SASLprep profile [RFC4013] of the "stringprep" algorithm
      * [RFC3454] to the given input, returning the result.
@@ -141,6 +138,275 @@ namespace {
         return builder.str();
     }
 
+    /**
+     * This adapts a hash function which computes the digest of a complete
+     * message to the incremental hash context interface, by collecting
+     * the pieces of the message until the digest is requested.
+     *
+     * The hash function is supplied by the user, so the digest it returns
+     * is fitted to the digest length declared for it: any extra bytes are
+     * left out, and any missing bytes are filled with zeroes, so that it
+     * never writes past the end of the buffers sized for that length.
+     */
+    class HashFunctionContext
+        : public Sasl::HashContext
+    {
+        // Public methods
+    public:
+        /**
+         * This constructor sets up the context to use the given
+         * hash function.
+         *
+         * @param[in] hashFunction
+         *     This is the hash function to use to compute the digest.
+         *
+         * @param[in] digestLength
+         *     This is the length, in bytes, of the digest declared
+         *     for the hash function.
+         */
+        HashFunctionContext(
+            std::shared_ptr< const Sasl::Client::Scram::HashFunction > hashFunction,
+            size_t digestLength
+        )
+            : hashFunction_(hashFunction)
+            , digestLength_(digestLength)
+        {
+        }
+
+        /**
+         * This is the destructor.  The message is wiped, since it may
+         * hold an HMAC padded key or other secrets.
+         */
+        ~HashFunctionContext() noexcept {
+            Sasl::Wipe(message_);
+        }
+
+        HashFunctionContext(const HashFunctionContext&) = default;
+        HashFunctionContext& operator=(const HashFunctionContext&) = default;
+
+        // Sasl::HashContext
+    public:
+        virtual std::unique_ptr< Sasl::HashContext > Clone() const override {
+            return std::unique_ptr< Sasl::HashContext >(
+                new HashFunctionContext(*this)
+            );
+        }
+
+        virtual void CopyFrom(const Sasl::HashContext& other) override {
+            message_ = static_cast< const HashFunctionContext& >(other).message_;
+        }
+
+        virtual void Update(const uint8_t* data, size_t length) override {
+            message_.insert(message_.end(), data, data + length);
+        }
+
+        virtual void Final(uint8_t* digest) override {
+            auto messageDigest = (*hashFunction_)(message_);
+            messageDigest.resize(digestLength_, 0);
+            (void)memcpy(digest, messageDigest.data(), digestLength_);
+            Sasl::Wipe(messageDigest);
+        }
+
+        // Private properties
+    private:
+        /**
+         * This is the hash function to use to compute the digest.
+         */
+        std::shared_ptr< const Sasl::Client::Scram::HashFunction > hashFunction_;
+
+        /**
+         * This is the length, in bytes, of the digest declared
+         * for the hash function.
+         */
+        size_t digestLength_ = 0;
+
+        /**
+         * This holds the pieces of the message absorbed so far.
+         */
+        std::vector< uint8_t > message_;
+    };
+
+    /**
+     * This holds the values given by the server in its first message.
+     */
+    struct ServerFirstMessage {
+        /**
+         * This is the nonce given by the server, which is the client's
+         * nonce with more characters added by the server.
+         */
+        std::string serverNonce;
+
+        /**
+         * This is the salt to use in deriving the salted password.
+         */
+        std::vector< uint8_t > salt;
+
+        /**
+         * This is the number of iterations to use in deriving the
+         * salted password.
+         */
+        size_t numIterations = 0;
+    };
+
+    /**
+     * Determine whether or not the given string contains only the
+     * printable characters allowed in SCRAM nonces (any printable ASCII
+     * character except comma).
+     *
+     * @param[in] s
+     *     This is the string to check.
+     *
+     * @return
+     *     An indication of whether or not the given string contains only
+     *     the printable characters allowed in SCRAM nonces is returned.
+     */
+    bool IsPrintable(const std::string& s) {
+        for (const auto c: s) {
+            if (
+                (c < 0x21)
+                || (c > 0x7E)
+                || (c == ',')
+            ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Parse the given string as a positive decimal number, without
+     * any sign, leading zeros, or surrounding whitespace.
+     *
+     * @param[in] s
+     *     This is the string to parse.
+     *
+     * @param[out] number
+     *     This is where to store the parsed number.
+     *
+     * @return
+     *     An indication of whether or not the string was successfully
+     *     parsed is returned.
+     */
+    bool ParsePositiveNumber(const std::string& s, size_t& number) {
+        if (
+            s.empty()
+            || (s[0] == '0')
+        ) {
+            return false;
+        }
+        number = 0;
+        for (const auto c: s) {
+            if (
+                (c < '0')
+                || (c > '9')
+            ) {
+                return false;
+            }
+            const size_t digit = (size_t)(c - '0');
+            if (number > (std::numeric_limits< size_t >::max() - digit) / 10) {
+                return false;
+            }
+            number = number * 10 + digit;
+        }
+        return true;
+    }
+
+    /**
+     * Parse and validate the server's first message, in the form:
+     *
+     *     server-first-message = [reserved-mext ","] nonce "," salt ","
+     *                            iteration-count ["," extensions]
+     *
+     * @param[in] message
+     *     This is the server's first message.
+     *
+     * @param[in] clientNonce
+     *     This is the nonce the client sent in its first message.
+     *
+     * @param[out] serverFirstMessage
+     *     This is where to store the values given in the message.
+     *
+     * @return
+     *     The reason the message is not acceptable is returned.
+     *
+     * @retval Sasl::Client::Scram::FaultReason::None
+     *     This is returned if the message is acceptable.
+     */
+    Sasl::Client::Scram::FaultReason ParseServerFirstMessage(
+        const std::string& message,
+        const std::string& clientNonce,
+        ServerFirstMessage& serverFirstMessage
+    ) {
+        using FaultReason = Sasl::Client::Scram::FaultReason;
+        const auto attributes = StringExtensions::Split(message, ',');
+        if (attributes.empty()) {
+            return FaultReason::MalformedMessage;
+        }
+        for (const auto& attribute: attributes) {
+            if (
+                (attribute.length() < 2)
+                || (attribute[1] != '=')
+            ) {
+                return FaultReason::MalformedMessage;
+            }
+        }
+        if (attributes[0][0] == 'm') {
+            return FaultReason::MandatoryExtension;
+        }
+        if (
+            (attributes.size() < 3)
+            || (attributes[0][0] != 'r')
+            || (attributes[1][0] != 's')
+            || (attributes[2][0] != 'i')
+        ) {
+            return FaultReason::MalformedMessage;
+        }
+        serverFirstMessage.serverNonce = attributes[0].substr(2);
+        if (!IsPrintable(serverFirstMessage.serverNonce)) {
+            return FaultReason::MalformedMessage;
+        }
+        if (
+            (serverFirstMessage.serverNonce.length() <= clientNonce.length())
+            || (serverFirstMessage.serverNonce.compare(0, clientNonce.length(), clientNonce) != 0)
+        ) {
+            return FaultReason::NonceMismatch;
+        }
+        const auto& encodedSalt = attributes[1];
+        serverFirstMessage.salt.resize(
+            Sasl::Base64::MaxDecodedLength(encodedSalt.length() - 2)
+        );
+        size_t saltLength;
+        if (
+            !Sasl::Base64::Decode(
+                encodedSalt.data() + 2,
+                encodedSalt.length() - 2,
+                serverFirstMessage.salt.data(),
+                saltLength
+            )
+            || (saltLength == 0)
+        ) {
+            return FaultReason::InvalidSalt;
+        }
+        serverFirstMessage.salt.resize(saltLength);
+        if (!ParsePositiveNumber(attributes[2].substr(2), serverFirstMessage.numIterations)) {
+            return FaultReason::InvalidIterationCount;
+        }
+        return FaultReason::None;
+    }
+
+    /**
+     * Absorb the given string into the given hash context.
+     *
+     * @param[in,out] context
+     *     This is the hash context into which to absorb the string.
+     *
+     * @param[in] s
+     *     This is the string to absorb.
+     */
+    void Absorb(Sasl::HashContext& context, const std::string& s) {
+        context.Update((const uint8_t*)s.data(), s.length());
+    }
+
 }
 
 namespace Sasl {
@@ -156,7 +422,7 @@ namespace Client {
          * This is a helper object used to generate and publish
          * diagnostic messages.
          */
-        SystemAbstractions::DiagnosticsSender diagnosticsSender;
+        LazyDiagnosticsSender diagnosticsSender;
 
         /**
          * This is used to keep track of what stage the authentication
@@ -165,27 +431,10 @@ namespace Client {
         Step step = Step::ClientNonce;
 
         /**
-         * This is the hash function to use in the SCRAM algorithm.
+         * This selects the hash function and related configuration
+         * to use in the SCRAM algorithm.  It's shared among instances.
          */
-        HashFunction hashFunction;
-
-        /**
-         * This is the size, in bits, of digests produced by the selected
-         * hash function.
-         */
-        size_t digestSize;
-
-        /**
-         * This is the Hash-based Message Authentication Code (HMAC)
-         * function, derived from the selected hash function, to use
-         * in the SCRAM algorithm.
-         */
-        std::function<
-            std::vector< uint8_t >(
-                const std::vector< uint8_t >&,
-                const std::vector< uint8_t >&
-            )
-        > hmac;
+        std::shared_ptr< const ScramProfile > profile;
 
         /**
          * This is the name provided by the client that provides the
@@ -200,10 +449,12 @@ namespace Client {
         std::vector< uint8_t > normalizedPassword;
 
         /**
-         * This is the Base64 encoding of the GS2 Header provided by the
-         * client.
+         * This is the GS2 header at the start of the client's first
+         * message, or empty if no credentials are set.  The rest of the
+         * message is built from the username and client nonce when it's
+         * needed, rather than kept for the life of the mechanism.
          */
-        std::string encodedChannelBinding;
+        std::string gs2Header;
 
         /**
          * This is a cryptographically strong string of printable ASCII
@@ -214,22 +465,31 @@ namespace Client {
         std::string clientNonce;
 
         /**
-         * This is the text of the first line sent by the client to the server.
+         * If not empty, this is the client nonce to use instead of
+         * generating a random one.
          */
-        std::string clientFirstMessage;
+        std::string presetClientNonce;
 
         /**
-         * This is the part of the client's first message that doesn't include
-         * the GS2 header.
+         * This selects whether or not the client's first message is sent
+         * as an initial response.
          */
-        std::string clientFirstMessageBare;
+        InitialResponseMode initialResponseMode = InitialResponseMode::Auto;
 
         /**
          * This is the digest that the client computes and expects the server
          * to provide in order to verify that the server and client have
-         * the same idea of what the password is.
+         * the same idea of what the password is.  It's held in place, with
+         * room for the largest supported digest, so that it costs no
+         * allocation.
          */
-        std::vector< uint8_t > serverSignature;
+        uint8_t serverSignature[MAX_DIGEST_LENGTH];
+
+        /**
+         * This is the number of bytes of serverSignature in use, or zero
+         * if the server signature hasn't been computed.
+         */
+        size_t serverSignatureLength = 0;
 
         /**
          * This flag indicates whether or not the mechanism has determined
@@ -244,6 +504,21 @@ namespace Client {
          */
         bool faulted = false;
 
+        /**
+         * These may cut short the authentication exchange.
+         */
+        ExchangeLimits limits;
+
+        /**
+         * This indicates why the mechanism faulted, if it did.
+         */
+        FaultReason faultReason = FaultReason::None;
+
+        /**
+         * This holds what is traced about the exchange.
+         */
+        Trace::Exchange trace;
+
         // Methods
 
         /**
@@ -253,15 +528,120 @@ namespace Client {
             : diagnosticsSender("Scram")
         {
         }
+
+        /**
+         * Pick the client nonce for a new exchange.
+         */
+        void MakeClientNonce() {
+            if (presetClientNonce.empty()) {
+                Trace::Span nonceSpan("make nonce");
+                clientNonce = MakeNonce();
+            } else {
+                clientNonce = presetClientNonce;
+            }
+        }
+
+        /**
+         * Build the client's first message from the GS2 header,
+         * the username, and the client nonce.
+         *
+         * @return
+         *     The client's first message is returned, or an empty string
+         *     if no credentials are set.
+         */
+        std::string MakeClientFirstMessage() const {
+            Trace::Span span("make client-first-message");
+            std::string clientFirstMessage;
+            if (gs2Header.empty()) {
+                return clientFirstMessage;
+            }
+            clientFirstMessage.reserve(
+                gs2Header.length() + 2 + username.length() + 3 + clientNonce.length()
+            );
+            clientFirstMessage += gs2Header;
+            clientFirstMessage += "n=";
+            clientFirstMessage += username;
+            clientFirstMessage += ",r=";
+            clientFirstMessage += clientNonce;
+            return clientFirstMessage;
+        }
+
+        /**
+         * Feed the part of the client's first message that doesn't include
+         * the GS2 header into the given hash context, without building it.
+         *
+         * @param[in,out] context
+         *     This is the hash context into which to feed the message.
+         */
+        void AbsorbClientFirstMessageBare(HashContext& context) const {
+            Absorb(context, "n=");
+            Absorb(context, username);
+            Absorb(context, ",r=");
+            Absorb(context, clientNonce);
+        }
+
+        /**
+         * Wipe and free what's held only for the exchange in progress,
+         * once it's over.  The credentials are kept, for the next
+         * exchange after a reset.
+         */
+        void EndExchange() {
+            Wipe(clientNonce);
+            Wipe(serverSignature, sizeof(serverSignature));
+            serverSignatureLength = 0;
+        }
+
+        /**
+         * Record that the mechanism has determined that the server
+         * provided an unexpected or incorrect message, for the given
+         * reason, and publish a diagnostic message explaining why.
+         *
+         * @param[in] reason
+         *     This is the reason why the mechanism faulted.
+         *
+         * @param[in] explanation
+         *     This explains why the mechanism faulted.
+         */
+        void Fault(
+            FaultReason reason,
+            const std::string& explanation
+        ) {
+            faulted = true;
+            faultReason = reason;
+            diagnosticsSender.SendDiagnosticInformationString(
+                SystemAbstractions::DiagnosticsSender::Levels::WARNING,
+                explanation
+            );
+        }
     };
 
-    Scram::~Scram() noexcept = default;
-    Scram::Scram(Scram&& other) noexcept = default;
-    Scram& Scram::operator=(Scram&& other) noexcept = default;
+    Scram::~Scram() noexcept {
+        impl_->~Impl();
+    }
+
+    Scram::Scram(Scram&& other) noexcept
+        : impl_(new (implStorage_) Impl(std::move(*other.impl_)))
+    {
+    }
+
+    Scram& Scram::operator=(Scram&& other) noexcept {
+        if (this != &other) {
+            *impl_ = std::move(*other.impl_);
+        }
+        return *this;
+    }
 
     Scram::Scram()
-        : impl_(new Impl)
+        : impl_(new (implStorage_) Impl)
     {
+        static_assert(
+            sizeof(Impl) <= IMPL_STORAGE_SIZE,
+            "Scram::Impl doesn't fit in Scram::implStorage_"
+        );
+        static_assert(
+            alignof(Impl) <= alignof(std::max_align_t),
+            "Scram::Impl is over-aligned for Scram::implStorage_"
+        );
     }
 
     SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate Scram::SubscribeToDiagnostics(
@@ -271,22 +651,108 @@ namespace Client {
         return impl_->diagnosticsSender.SubscribeToDiagnostics(delegate, minLevel);
     }
 
+    void Scram::SetProfile(std::shared_ptr< const ScramProfile > profile) {
+        impl_->profile = profile;
+    }
+
     void Scram::SetHashFunction(
         HashFunction hashFunction,
         size_t blockSize,
         size_t digestSize
     ) {
-        impl_->hashFunction = hashFunction;
-        impl_->hmac = Hash::MakeHmacBytesToBytesFunction(
-            hashFunction,
-            blockSize
+        const auto sharedHashFunction = std::make_shared< const HashFunction >(
+            hashFunction
+        );
+        SetHashContextFactory(
+            [sharedHashFunction, digestSize]{
+                return std::unique_ptr< HashContext >(
+                    new HashFunctionContext(sharedHashFunction, digestSize / 8)
+                );
+            },
+            blockSize,
+            digestSize
         );
-        impl_->digestSize = digestSize;
+    }
+
+    void Scram::SetHashContextFactory(
+        HashContextFactory hashContextFactory,
+        size_t blockSize,
+        size_t digestSize
+    ) {
+        impl_->profile = ScramProfile::Create(
+            "SCRAM",
+            hashContextFactory,
+            blockSize,
+            digestSize
+        );
+    }
+
+    void Scram::SetHashAlgorithm(HashAlgorithm hashAlgorithm) {
+        switch (hashAlgorithm) {
+            case HashAlgorithm::Sha1: {
+                impl_->profile = ScramProfile::Sha1();
+            } break;
+
+            case HashAlgorithm::Sha256: {
+                impl_->profile = ScramProfile::Sha256();
+            } break;
+
+            default: break;
+        }
+    }
+
+    void Scram::SetClientNonce(const std::string& clientNonce) {
+        impl_->presetClientNonce = clientNonce;
+    }
+
+    auto Scram::GetFaultReason() const -> FaultReason {
+        return impl_->faultReason;
     }
 
     void Scram::Reset() {
+        impl_->trace.Reset();
+        impl_->step = Step::ClientNonce;
+        impl_->EndExchange();
+        if (!impl_->gs2Header.empty()) {
+            // A new exchange needs a new nonce.
+            impl_->MakeClientNonce();
+        }
         impl_->succeeded = false;
         impl_->faulted = false;
+        impl_->faultReason = FaultReason::None;
+        impl_->limits.Clear();
+    }
+
+    void Scram::SetInitialResponseMode(
+        InitialResponseMode initialResponseMode
+    ) {
+        impl_->initialResponseMode = initialResponseMode;
+    }
+
+    RoundTripProfile Scram::GetRoundTripProfile() {
+        RoundTripProfile roundTripProfile;
+        roundTripProfile.sendsInitialResponse = (
+            impl_->initialResponseMode != InitialResponseMode::Never
+        );
+        roundTripProfile.roundTrips = (
+            roundTripProfile.sendsInitialResponse
+            ? 2
+            : 3
+        );
+        roundTripProfile.verifiesServer = true;
+        return roundTripProfile;
+    }
+
+    void Scram::SetCancellationToken(
+        const CancellationToken& cancellationToken
+    ) {
+        impl_->limits.cancellationToken = cancellationToken;
+    }
+
+    void Scram::SetDeadline(
+        std::chrono::steady_clock::time_point deadline
+    ) {
+        impl_->limits.deadline = deadline;
     }
 
     void Scram::SetCredentials(
@@ -294,138 +760,371 @@ namespace Client {
         const std::string& authenticationIdentity,
         const std::string& authorizationIdentity
     ) {
+        Trace::Span span("Scram::SetCredentials", impl_->trace);
         impl_->username = authenticationIdentity;
-        impl_->normalizedPassword = ByteVectorFromString(
-            Normalize(credentials)
-        );
-        impl_->clientNonce = MakeNonce();
-        impl_->clientFirstMessageBare = (
-            "n=" + authenticationIdentity
-            + ",r=" + impl_->clientNonce
-        );
-        const std::string gs2Header = (
-            "n," + authorizationIdentity
-            + ","
-        );
-        impl_->clientFirstMessage = (
-            gs2Header + impl_->clientFirstMessageBare
-        );
-        impl_->encodedChannelBinding = Base64::Encode(gs2Header);
+        {
+            Trace::Span normalizeSpan("SASLprep");
+            impl_->normalizedPassword = ByteVectorFromString(
+                Normalize(credentials)
+            );
+        }
+        impl_->gs2Header = "n," + authorizationIdentity + ",";
+        impl_->MakeClientNonce();
     }
 
     std::string Scram::GetInitialResponse() {
-        impl_->diagnosticsSender.SendDiagnosticInformationString(
-            0,
-            "C: AUTH SCRAM* " + impl_->clientFirstMessage
-        );
-        return impl_->clientFirstMessage;
+        Trace::Span span("Scram::GetInitialResponse", impl_->trace);
+        if (impl_->initialResponseMode == InitialResponseMode::Never) {
+            return "";
+        }
+        auto clientFirstMessage = impl_->MakeClientFirstMessage();
+        if (impl_->diagnosticsSender.IsActive()) {
+            impl_->diagnosticsSender.SendDiagnosticInformationString(
+                0,
+                "C: AUTH SCRAM* " + clientFirstMessage
+            );
+        }
+        if (impl_->step == Step::ClientNonce) {
+            impl_->step = Step::ServerChallenge;
+        }
+        return clientFirstMessage;
     }
 
     std::string Scram::Proceed(const std::string& message) {
+        Trace::Span span("Scram::Proceed", impl_->trace);
         if (impl_->faulted) {
             return "";
         }
+        if (impl_->limits.IsCancelled()) {
+            impl_->Fault(FaultReason::Cancelled, "authentication cancelled");
+            return "";
+        }
+        if (impl_->limits.IsPastDeadline()) {
+            impl_->Fault(FaultReason::DeadlineExceeded, "authentication deadline passed");
+            return "";
+        }
         switch (impl_->step) {
             case Step::ClientNonce: {
                 impl_->step = Step::ServerChallenge;
-                impl_->diagnosticsSender.SendDiagnosticInformationString(
-                    0,
-                    "C: AUTH SCRAM* " + impl_->clientFirstMessage
-                );
-                return impl_->clientFirstMessage;
+                auto clientFirstMessage = impl_->MakeClientFirstMessage();
+                if (impl_->diagnosticsSender.IsActive()) {
+                    impl_->diagnosticsSender.SendDiagnosticInformationString(
+                        0,
+                        "C: AUTH SCRAM* " + clientFirstMessage
+                    );
+                }
+                return clientFirstMessage;
             } break;
 
             case Step::ServerChallenge: {
-                const auto pieces = StringExtensions::Split(message, ',');
-                size_t numIterations = 1;
-                std::string serverNonce;
-                std::vector< uint8_t > salt;
-                for (const auto piece: pieces) {
-                    if (piece.length() < 3) {
-                        impl_->faulted = true;
-                        return "";
-                    }
-                    if (piece[1] != '=') {
-                        impl_->faulted = true;
-                        return "";
-                    }
-                    const auto value = piece.substr(2);
-                    switch (piece[0]) {
-                        case 'r': {
-                            serverNonce = value;
-                            if (
-                                serverNonce.substr(0, impl_->clientNonce.length())
-                                != impl_->clientNonce
-                            ) {
-                                impl_->faulted = true;
-                                return "";
-                            }
-                        } break;
-
-                        case 's': {
-                            salt = ByteVectorFromString(Base64::Decode(value));
-                        } break;
-
-                        case 'i': {
-                            if (sscanf(value.c_str(), "%zu", &numIterations) != 1) {
-                                impl_->faulted = true;
-                                return "";
-                            }
-                        } break;
-
-                        default: break;
-                    }
+                // Everything the server gives is checked before any
+                // expensive work is done.
+                ServerFirstMessage serverFirstMessage;
+                FaultReason parseResult;
+                {
+                    Trace::Span parseSpan("parse server-first-message");
+                    parseResult = ParseServerFirstMessage(
+                        message,
+                        impl_->clientNonce,
+                        serverFirstMessage
+                    );
+                }
+                switch (parseResult) {
+                    case FaultReason::None: break;
+
+                    case FaultReason::MandatoryExtension: {
+                        impl_->Fault(parseResult, "server requires an unsupported extension");
+                    } return "";
+
+                    case FaultReason::NonceMismatch: {
+                        impl_->Fault(parseResult, "server nonce does not extend client nonce");
+                    } return "";
+
+                    case FaultReason::InvalidSalt: {
+                        impl_->Fault(parseResult, "server salt is empty or not valid Base64");
+                    } return "";
+
+                    case FaultReason::InvalidIterationCount: {
+                        impl_->Fault(parseResult, "server iteration count is not a positive number");
+                    } return "";
+
+                    default: {
+                        impl_->Fault(parseResult, "server challenge is malformed");
+                    } return "";
+                }
+                const auto& serverNonce = serverFirstMessage.serverNonce;
+                const auto& salt = serverFirstMessage.salt;
+                const auto numIterations = serverFirstMessage.numIterations;
+                if (impl_->profile == nullptr) {
+                    impl_->Fault(FaultReason::NoUsableHashFunction, "no hash function set up");
+                    return "";
+                }
+                const auto& policy = impl_->profile->GetPolicy();
+                if (numIterations < policy.minIterations) {
+                    impl_->Fault(
+                        FaultReason::TooFewIterations,
+                        StringExtensions::sprintf(
+                            "server iteration count (%zu) is below the minimum (%zu)",
+                            numIterations,
+                            policy.minIterations
+                        )
+                    );
+                    return "";
+                }
+                if (numIterations > policy.maxIterations) {
+                    impl_->Fault(
+                        FaultReason::TooManyIterations,
+                        StringExtensions::sprintf(
+                            "server iteration count (%zu) is above the maximum (%zu)",
+                            numIterations,
+                            policy.maxIterations
+                        )
+                    );
+                    return "";
+                }
+                const auto& hashContextFactory = impl_->profile->GetHashContextFactory();
+                const auto blockSize = impl_->profile->GetBlockSize();
+                const auto digestLength = impl_->profile->GetDigestLength();
+                if (
+                    (digestLength == 0)
+                    || (digestLength > MAX_DIGEST_LENGTH)
+                    || !hashContextFactory
+                ) {
+                    impl_->Fault(FaultReason::NoUsableHashFunction, "hash function digest size not supported");
+                    return "";
                 }
                 impl_->step = Step::ServerSignature;
-                const auto saltedPassword = Hash::Pbkdf2(
-                    impl_->hmac,
-                    impl_->digestSize,
-                    impl_->normalizedPassword,
-                    salt,
-                    numIterations,
-                    impl_->digestSize / 8
+                // The derivation may be cut short by the policy's time limit,
+                // by cancellation, or by the exchange's deadline, all of
+                // which are checked every HI_CHECK_INTERVAL iterations.
+                auto derivationDeadline = impl_->limits.deadline;
+                const auto derivationTimeLimited = (policy.derivationTimeLimit.count() > 0);
+                if (derivationTimeLimited) {
+                    derivationDeadline = std::min(
+                        derivationDeadline,
+                        std::chrono::steady_clock::now() + policy.derivationTimeLimit
+                    );
+                }
+                std::function< bool() > keepGoing;
+                if (
+                    derivationTimeLimited
+                    || impl_->limits.IsLimited()
+                ) {
+                    const auto& cancellationToken = impl_->limits.cancellationToken;
+                    keepGoing = [&cancellationToken, derivationDeadline]{
+                        return (
+                            !cancellationToken.IsCancelled()
+                            && (std::chrono::steady_clock::now() < derivationDeadline)
+                        );
+                    };
+                }
+                uint8_t saltedPassword[MAX_DIGEST_LENGTH];
+                const auto& keyDerivation = impl_->profile->GetKeyDerivation();
+                bool derived;
+                {
+                    Trace::Span derivationSpan("derive salted password");
+                    derived = (
+                        keyDerivation
+                        ? keyDerivation(
+                            impl_->normalizedPassword.data(),
+                            impl_->normalizedPassword.size(),
+                            salt.data(),
+                            salt.size(),
+                            numIterations,
+                            saltedPassword,
+                            keepGoing
+                        )
+                        : Hi(
+                            HmacKey(
+                                hashContextFactory,
+                                blockSize,
+                                digestLength,
+                                impl_->normalizedPassword.data(),
+                                impl_->normalizedPassword.size()
+                            ),
+                            salt.data(),
+                            salt.size(),
+                            numIterations,
+                            saltedPassword,
+                            keepGoing
+                        )
+                    );
+                }
+                if (!derived) {
+                    Wipe(saltedPassword, sizeof(saltedPassword));
+                    if (impl_->limits.IsCancelled()) {
+                        impl_->Fault(FaultReason::Cancelled, "authentication cancelled");
+                    } else if (impl_->limits.IsPastDeadline()) {
+                        impl_->Fault(FaultReason::DeadlineExceeded, "authentication deadline passed");
+                    } else if (
+                        !keyDerivation
+                        || (
+                            derivationTimeLimited
+                            && (std::chrono::steady_clock::now() >= derivationDeadline)
+                        )
+                    ) {
+                        impl_->Fault(
+                            FaultReason::DerivationTimeLimitExceeded,
+                            "salted password derivation exceeded its time limit"
+                        );
+                    } else {
+                        impl_->Fault(
+                            FaultReason::KeyDerivationFailed,
+                            "salted password derivation failed"
+                        );
+                    }
+                    return "";
+                }
+                Trace::Span proofSpan("compute client proof and server signature");
+                const HmacKey saltedPasswordKey(
+                    hashContextFactory,
+                    blockSize,
+                    digestLength,
+                    saltedPassword,
+                    digestLength
                 );
-                const auto clientKey = impl_->hmac(saltedPassword, ByteVectorFromString("Client Key"));
-                const auto storedKey = impl_->hashFunction(clientKey);
-                const auto clientFinalMessageWithoutProof = (
-                    "c=" + impl_->encodedChannelBinding
-                    + ",r=" + serverNonce
+                Wipe(saltedPassword, sizeof(saltedPassword));
+                uint8_t clientKey[MAX_DIGEST_LENGTH];
+                uint8_t storedKey[MAX_DIGEST_LENGTH];
+                uint8_t serverKey[MAX_DIGEST_LENGTH];
+                const auto keyContext = saltedPasswordKey.Begin();
+                Absorb(*keyContext, "Client Key");
+                saltedPasswordKey.Finish(*keyContext, clientKey);
+                saltedPasswordKey.Restart(*keyContext);
+                Absorb(*keyContext, "Server Key");
+                saltedPasswordKey.Finish(*keyContext, serverKey);
+                const auto storedKeyContext = impl_->profile->MakeHashContext();
+                storedKeyContext->Update(clientKey, digestLength);
+                storedKeyContext->Final(storedKey);
+
+                // The client's final message is built in place, with room
+                // for the proof, and the part without the proof is absorbed
+                // from it rather than kept separately.
+                const auto& gs2Header = impl_->gs2Header;
+                const auto encodedChannelBindingLength = Base64::EncodedLength(gs2Header.length());
+                std::string clientFinalMessage;
+                clientFinalMessage.reserve(
+                    2 + encodedChannelBindingLength
+                    + 3 + serverNonce.length()
+                    + 3 + Base64::EncodedLength(digestLength)
                 );
-                const auto authMessage = ByteVectorFromString(
-                    impl_->clientFirstMessageBare + ','
-                    + message + ','
-                    + clientFinalMessageWithoutProof
+                clientFinalMessage += "c=";
+                clientFinalMessage.resize(2 + encodedChannelBindingLength);
+                (void)Base64::Encode(
+                    gs2Header.data(),
+                    gs2Header.length(),
+                    &clientFinalMessage[2]
                 );
-                const auto clientSignature = impl_->hmac(storedKey, authMessage);
-                std::vector< uint8_t > clientProof(storedKey.size());
-                for (size_t i = 0; i < clientProof.size(); ++i) {
-                    clientProof[i] = clientKey[i] ^ clientSignature[i];
-                }
-                const auto serverKey = impl_->hmac(
-                    saltedPassword,
-                    ByteVectorFromString("Server Key")
+                clientFinalMessage += ",r=";
+                clientFinalMessage += serverNonce;
+                const auto clientFinalMessageWithoutProofLength = clientFinalMessage.length();
+
+                // The client and server signatures are computed with
+                // different keys, so the keyed hash states can't be shared
+                // between them; instead, the pieces of AuthMessage are
+                // absorbed into each directly, without concatenating them.
+                //
+                // AuthMessage := client-first-message-bare + "," +
+                //                server-first-message + "," +
+                //                client-final-message-without-proof
+                const HmacKey storedKeyHmac(
+                    hashContextFactory,
+                    blockSize,
+                    digestLength,
+                    storedKey,
+                    digestLength
                 );
-                impl_->serverSignature = impl_->hmac(
+                const HmacKey serverKeyHmac(
+                    hashContextFactory,
+                    blockSize,
+                    digestLength,
                     serverKey,
-                    authMessage
-                );
-                impl_->diagnosticsSender.SendDiagnosticInformationString(
-                    0,
-                    "C: " + clientFinalMessageWithoutProof + ",p=*******"
+                    digestLength
                 );
-                return (
-                    clientFinalMessageWithoutProof
-                    + ",p=" + Base64::Encode(StringFromByteVector(clientProof))
+                Wipe(storedKey, sizeof(storedKey));
+                Wipe(serverKey, sizeof(serverKey));
+                const auto clientSignatureContext = storedKeyHmac.Begin();
+                const auto serverSignatureContext = serverKeyHmac.Begin();
+                for (auto context: {
+                    clientSignatureContext.get(),
+                    serverSignatureContext.get(),
+                }) {
+                    impl_->AbsorbClientFirstMessageBare(*context);
+                    Absorb(*context, ",");
+                    Absorb(*context, message);
+                    Absorb(*context, ",");
+                    context->Update(
+                        (const uint8_t*)clientFinalMessage.data(),
+                        clientFinalMessageWithoutProofLength
+                    );
+                }
+                uint8_t clientSignature[MAX_DIGEST_LENGTH];
+                storedKeyHmac.Finish(*clientSignatureContext, clientSignature);
+                serverKeyHmac.Finish(
+                    *serverSignatureContext,
+                    impl_->serverSignature
                 );
+                impl_->serverSignatureLength = digestLength;
+                uint8_t clientProof[MAX_DIGEST_LENGTH];
+                for (size_t i = 0; i < digestLength; ++i) {
+                    clientProof[i] = clientKey[i] ^ clientSignature[i];
+                }
+                Wipe(clientKey, sizeof(clientKey));
+                Wipe(clientSignature, sizeof(clientSignature));
+                char encodedClientProof[Base64::EncodedLength(MAX_DIGEST_LENGTH)];
+                size_t encodedClientProofLength;
+                {
+                    Trace::Span encodeSpan("Base64 encode client proof");
+                    encodedClientProofLength = Base64::Encode(
+                        clientProof,
+                        digestLength,
+                        encodedClientProof
+                    );
+                }
+                Wipe(clientProof, sizeof(clientProof));
+                if (impl_->diagnosticsSender.IsActive()) {
+                    impl_->diagnosticsSender.SendDiagnosticInformationString(
+                        0,
+                        "C: " + clientFinalMessage + ",p=*******"
+                    );
+                }
+                clientFinalMessage += ",p=";
+                clientFinalMessage.append(encodedClientProof, encodedClientProofLength);
+                return clientFinalMessage;
             } break;
 
             case Step::ServerSignature: {
                 impl_->step = Step::Done;
-                const auto expectedMessage = (
-                    "v=" + Base64::Encode(impl_->serverSignature)
+                Trace::Span verifySpan("verify server signature");
+                char encodedServerSignature[Base64::EncodedLength(MAX_DIGEST_LENGTH)];
+                const auto encodedServerSignatureLength = Base64::Encode(
+                    impl_->serverSignature,
+                    impl_->serverSignatureLength,
+                    encodedServerSignature
                 );
-                if (message == expectedMessage) {
+                impl_->EndExchange();
+                if (
+                    (message.length() == 2 + encodedServerSignatureLength)
+                    && (message.compare(0, 2, "v=") == 0)
+                    && (
+                        memcmp(
+                            message.data() + 2,
+                            encodedServerSignature,
+                            encodedServerSignatureLength
+                        ) == 0
+                    )
+                ) {
                     impl_->succeeded = true;
+                } else if (message.compare(0, 2, "e=") == 0) {
+                    impl_->Fault(
+                        FaultReason::ServerError,
+                        "server error: " + message.substr(2)
+                    );
+                } else {
+                    impl_->Fault(
+                        FaultReason::ServerSignatureMismatch,
+                        "server signature does not match"
+                    );
                 }
                 return "";
             } break;
@@ -446,5 +1145,115 @@ namespace Client {
         return impl_->faulted;
     }
 
+    bool Scram::Snapshot(
+        std::string& snapshot,
+        SnapshotCredentials credentials
+    ) {
+        // The name of the mechanism comes from the profile, so that a
+        // snapshot of SCRAM-SHA-1 can't be restored into SCRAM-SHA-256.
+        if (impl_->profile == nullptr) {
+            return false;
+        }
+        const auto credentialsIncluded = (credentials == SnapshotCredentials::Include);
+        BeginSnapshot(impl_->profile->GetMechanismName(), credentialsIncluded, snapshot);
+        snapshot += (char)impl_->step;
+        snapshot += (char)impl_->succeeded;
+        snapshot += (char)impl_->faulted;
+        snapshot += (char)impl_->faultReason;
+        snapshot += (char)impl_->initialResponseMode;
+        EncodeString(impl_->username, snapshot);
+        EncodeString(impl_->gs2Header, snapshot);
+        EncodeString(impl_->clientNonce, snapshot);
+
+        // The server signature is part of the exchange, not the
+        // credentials, because it's needed to finish the exchange;
+        // it's computed once the client's proof is sent, and the
+        // password isn't needed after that.
+        EncodeBytes(
+            impl_->serverSignature,
+            impl_->serverSignatureLength,
+            snapshot
+        );
+        if (credentialsIncluded) {
+            EncodeBytes(
+                impl_->normalizedPassword.data(),
+                impl_->normalizedPassword.size(),
+                snapshot
+            );
+        }
+        return true;
+    }
+
+    bool Scram::Restore(const std::string& snapshot) {
+        if (impl_->profile == nullptr) {
+            return false;
+        }
+        size_t offset;
+        bool credentialsIncluded;
+        uint8_t step;
+        bool succeeded;
+        bool faulted;
+        uint8_t faultReason;
+        InitialResponseMode initialResponseMode;
+        std::string username;
+        std::string gs2Header;
+        std::string clientNonce;
+        std::string serverSignature;
+        std::string normalizedPassword;
+        const auto decoded = (
+            BeginRestore(snapshot, impl_->profile->GetMechanismName(), offset, credentialsIncluded)
+            && DecodeByte(snapshot, offset, step)
+            && (step <= (uint8_t)Step::Done)
+            && DecodeFlag(snapshot, offset, succeeded)
+            && DecodeFlag(snapshot, offset, faulted)
+            && DecodeByte(snapshot, offset, faultReason)
+            && (faultReason <= (uint8_t)FaultReason::KeyDerivationFailed)
+            && DecodeInitialResponseMode(snapshot, offset, initialResponseMode)
+            && DecodeString(snapshot, offset, username)
+            && DecodeString(snapshot, offset, gs2Header)
+            && DecodeString(snapshot, offset, clientNonce)
+            && DecodeString(snapshot, offset, serverSignature)
+            && (serverSignature.length() <= MAX_DIGEST_LENGTH)
+            && (
+                !credentialsIncluded
+                || DecodeString(snapshot, offset, normalizedPassword)
+            )
+            && (offset == snapshot.length())
+        );
+        if (!decoded) {
+            Wipe(serverSignature);
+            Wipe(normalizedPassword);
+            return false;
+        }
+        impl_->trace.Reset();
+        impl_->step = (Step)step;
+        impl_->succeeded = succeeded;
+        impl_->faulted = faulted;
+        impl_->faultReason = (FaultReason)faultReason;
+        impl_->initialResponseMode = initialResponseMode;
+        impl_->username = std::move(username);
+        impl_->clientNonce = std::move(clientNonce);
+        impl_->gs2Header = std::move(gs2Header);
+        (void)memcpy(impl_->serverSignature, serverSignature.data(), serverSignature.length());
+        impl_->serverSignatureLength = serverSignature.length();
+        Wipe(serverSignature);
+        if (credentialsIncluded) {
+            Wipe(impl_->normalizedPassword);
+            impl_->normalizedPassword = ByteVectorFromString(normalizedPassword);
+            Wipe(normalizedPassword);
+        }
+        return true;
+    }
+
+    void Scram::Release() {
+        impl_->EndExchange();
+        Wipe(impl_->normalizedPassword);
+        Wipe(impl_->username);
+        Wipe(impl_->gs2Header);
+        Wipe(impl_->presetClientNonce);
+        impl_->limits.Clear();
+        impl_->trace.Reset();
+    }
+
 }
 }
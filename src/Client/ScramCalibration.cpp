@@ -0,0 +1,165 @@
+/**
+ * @file ScramCalibration.cpp
+ *
+ * This module contains the implementation of the functions used to
+ * calibrate the iteration counts of the SCRAM mechanism.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../Hi.hpp"
+#include "../Hmac.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <Sasl/Client/ScramCalibration.hpp>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the password from which salted passwords are derived
+     * in the measurements.
+     */
+    const uint8_t PROBE_PASSWORD[] = {'p', 'e', 'n', 'c', 'i', 'l'};
+
+    /**
+     * This is the salt used in the measurements.
+     */
+    const uint8_t PROBE_SALT[] = {
+        0x41, 0x25, 0xc2, 0x47, 0xe4, 0x3a, 0xb1, 0xe9,
+        0x3c, 0x6d, 0xff, 0x76,
+    };
+
+    /**
+     * Iteration counts are recommended in multiples of this.
+     */
+    constexpr size_t ITERATIONS_GRANULARITY = 1024;
+
+    /**
+     * Return the given percentile of the given sorted durations,
+     * using the nearest-rank method.
+     *
+     * @param[in] durations
+     *     These are the durations, sorted in ascending order.
+     *     There must be at least one.
+     *
+     * @param[in] percentile
+     *     This is the percentile to return.
+     *
+     * @return
+     *     The given percentile of the durations is returned.
+     */
+    std::chrono::nanoseconds Percentile(
+        const std::vector< std::chrono::nanoseconds >& durations,
+        size_t percentile
+    ) {
+        const auto rank = (durations.size() * percentile + 99) / 100;
+        return durations[std::max(rank, (size_t)1) - 1];
+    }
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    ScramCalibrationSample MeasureScramDerivation(
+        const ScramProfile& profile,
+        size_t threads,
+        size_t probeIterations,
+        size_t derivationsPerThread
+    ) {
+        threads = std::max(threads, (size_t)1);
+        probeIterations = std::max(probeIterations, (size_t)1);
+        derivationsPerThread = std::max(derivationsPerThread, (size_t)1);
+        std::vector< std::vector< std::chrono::nanoseconds > > latencies(threads);
+        std::atomic< size_t > numReady(0);
+        std::atomic< bool > go(false);
+        std::vector< std::thread > workers;
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back(
+                [&profile, &latencies, &numReady, &go, i, probeIterations, derivationsPerThread]{
+                    auto& threadLatencies = latencies[i];
+                    threadLatencies.reserve(derivationsPerThread);
+                    std::vector< uint8_t > saltedPassword(profile.GetDigestLength());
+                    ++numReady;
+                    while (!go) {
+                        std::this_thread::yield();
+                    }
+                    for (size_t j = 0; j < derivationsPerThread; ++j) {
+                        const auto start = std::chrono::steady_clock::now();
+                        (void)Hi(
+                            HmacKey(
+                                profile.GetHashContextFactory(),
+                                profile.GetBlockSize(),
+                                profile.GetDigestLength(),
+                                PROBE_PASSWORD,
+                                sizeof(PROBE_PASSWORD)
+                            ),
+                            PROBE_SALT,
+                            sizeof(PROBE_SALT),
+                            probeIterations,
+                            saltedPassword.data()
+                        );
+                        threadLatencies.push_back(
+                            std::chrono::duration_cast< std::chrono::nanoseconds >(
+                                std::chrono::steady_clock::now() - start
+                            )
+                        );
+                    }
+                }
+            );
+        }
+        while (numReady < threads) {
+            std::this_thread::yield();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        go = true;
+        for (auto& worker: workers) {
+            worker.join();
+        }
+        const auto elapsed = std::chrono::duration< double >(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        std::vector< std::chrono::nanoseconds > allLatencies;
+        allLatencies.reserve(threads * derivationsPerThread);
+        for (const auto& threadLatencies: latencies) {
+            allLatencies.insert(
+                allLatencies.end(),
+                threadLatencies.begin(),
+                threadLatencies.end()
+            );
+        }
+        std::sort(allLatencies.begin(), allLatencies.end());
+        ScramCalibrationSample sample;
+        sample.threads = threads;
+        sample.probeIterations = probeIterations;
+        sample.derivations = allLatencies.size();
+        sample.p50Latency = Percentile(allLatencies, 50);
+        sample.p99Latency = Percentile(allLatencies, 99);
+        sample.iterationsPerSecond = (
+            (double)sample.derivations * probeIterations
+            / std::max(elapsed, 1e-9)
+        );
+        return sample;
+    }
+
+    size_t RecommendScramIterations(
+        const ScramCalibrationSample& sample,
+        std::chrono::nanoseconds targetP99Latency
+    ) {
+        if (sample.p99Latency.count() <= 0) {
+            return 0;
+        }
+        const auto iterations = (size_t)(
+            (double)sample.probeIterations
+            * targetP99Latency.count()
+            / sample.p99Latency.count()
+        );
+        return iterations - iterations % ITERATIONS_GRANULARITY;
+    }
+
+}
+}
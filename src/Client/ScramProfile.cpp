@@ -0,0 +1,162 @@
+/**
+ * @file ScramProfile.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Client::ScramProfile class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <Sasl/Client/ScramProfile.hpp>
+#include <Sasl/Sha.hpp>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a ScramProfile instance.
+     */
+    struct ScramProfile::Impl {
+        // Properties
+
+        /**
+         * This is the name of the SASL mechanism the profile configures.
+         */
+        std::string mechanismName;
+
+        /**
+         * This is used to make contexts for the hash function to use
+         * in the SCRAM algorithm.
+         */
+        HashContextFactory hashContextFactory;
+
+        /**
+         * This is the block size, in bytes, of the hash function.
+         */
+        size_t blockSize = 0;
+
+        /**
+         * This is the size, in bytes, of digests produced by the
+         * hash function.
+         */
+        size_t digestLength = 0;
+
+        /**
+         * This is the policy which limits how much work the client
+         * does on behalf of the server.
+         */
+        Policy policy;
+
+        /**
+         * If set, this is used to derive salted passwords in place
+         * of the built-in derivation.
+         */
+        KeyDerivation keyDerivation;
+    };
+
+    ScramProfile::~ScramProfile() noexcept = default;
+
+    ScramProfile::ScramProfile()
+        : impl_(new Impl)
+    {
+    }
+
+    std::shared_ptr< const ScramProfile > ScramProfile::Create(
+        const std::string& mechanismName,
+        HashContextFactory hashContextFactory,
+        size_t blockSize,
+        size_t digestSize,
+        const Policy& policy
+    ) {
+        std::shared_ptr< ScramProfile > profile(new ScramProfile());
+        profile->impl_->mechanismName = mechanismName;
+        profile->impl_->hashContextFactory = hashContextFactory;
+        profile->impl_->blockSize = blockSize;
+        profile->impl_->digestLength = digestSize / 8;
+        profile->impl_->policy = policy;
+        return profile;
+    }
+
+    std::shared_ptr< const ScramProfile > ScramProfile::Create(
+        const std::string& mechanismName,
+        HashContextFactory hashContextFactory,
+        size_t blockSize,
+        size_t digestSize
+    ) {
+        return Create(
+            mechanismName,
+            hashContextFactory,
+            blockSize,
+            digestSize,
+            Policy()
+        );
+    }
+
+    std::shared_ptr< const ScramProfile > ScramProfile::WithPolicy(
+        const Policy& policy
+    ) const {
+        std::shared_ptr< ScramProfile > profile(new ScramProfile());
+        *profile->impl_ = *impl_;
+        profile->impl_->policy = policy;
+        return profile;
+    }
+
+    std::shared_ptr< const ScramProfile > ScramProfile::WithKeyDerivation(
+        KeyDerivation keyDerivation
+    ) const {
+        std::shared_ptr< ScramProfile > profile(new ScramProfile());
+        *profile->impl_ = *impl_;
+        profile->impl_->keyDerivation = keyDerivation;
+        return profile;
+    }
+
+    std::shared_ptr< const ScramProfile > ScramProfile::Sha1() {
+        static const auto profile = Create(
+            "SCRAM-SHA-1",
+            []{ return MakeSha1Context(); },
+            SHA1_BLOCK_SIZE,
+            SHA1_DIGEST_SIZE
+        );
+        return profile;
+    }
+
+    std::shared_ptr< const ScramProfile > ScramProfile::Sha256() {
+        static const auto profile = Create(
+            "SCRAM-SHA-256",
+            []{ return MakeSha256Context(); },
+            SHA256_BLOCK_SIZE,
+            SHA256_DIGEST_SIZE
+        );
+        return profile;
+    }
+
+    const std::string& ScramProfile::GetMechanismName() const {
+        return impl_->mechanismName;
+    }
+
+    std::unique_ptr< HashContext > ScramProfile::MakeHashContext() const {
+        return impl_->hashContextFactory();
+    }
+
+    const HashContextFactory& ScramProfile::GetHashContextFactory() const {
+        return impl_->hashContextFactory;
+    }
+
+    size_t ScramProfile::GetBlockSize() const {
+        return impl_->blockSize;
+    }
+
+    size_t ScramProfile::GetDigestLength() const {
+        return impl_->digestLength;
+    }
+
+    const ScramProfile::Policy& ScramProfile::GetPolicy() const {
+        return impl_->policy;
+    }
+
+    const ScramProfile::KeyDerivation& ScramProfile::GetKeyDerivation() const {
+        return impl_->keyDerivation;
+    }
+
+}
+}
@@ -0,0 +1,130 @@
+/**
+ * @file Snapshot.cpp
+ *
+ * This module contains the implementation of the functions used by the
+ * client mechanisms to begin and check the snapshots of their exchange
+ * state.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../Wipe.hpp"
+#include "Snapshot.hpp"
+
+namespace {
+
+    /**
+     * These are the flags which may be set in the flags byte
+     * of a snapshot's header.
+     */
+    enum SnapshotFlags: uint8_t {
+        SNAPSHOT_CREDENTIALS_INCLUDED = 0x01,
+    };
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    void BeginSnapshot(
+        const std::string& mechanismName,
+        bool credentialsIncluded,
+        std::string& snapshot
+    ) {
+        snapshot.clear();
+        snapshot += (char)SNAPSHOT_FORMAT_VERSION;
+        EncodeString(mechanismName, snapshot);
+        snapshot += (char)(credentialsIncluded ? SNAPSHOT_CREDENTIALS_INCLUDED : 0);
+    }
+
+    bool BeginRestore(
+        const std::string& snapshot,
+        const std::string& mechanismName,
+        size_t& offset,
+        bool& credentialsIncluded
+    ) {
+        offset = 0;
+        uint8_t version;
+        std::string snapshotMechanismName;
+        uint8_t flags;
+        if (
+            !DecodeByte(snapshot, offset, version)
+            || (version != SNAPSHOT_FORMAT_VERSION)
+            || !DecodeString(snapshot, offset, snapshotMechanismName)
+            || (snapshotMechanismName != mechanismName)
+            || !DecodeByte(snapshot, offset, flags)
+            || ((flags & ~SNAPSHOT_CREDENTIALS_INCLUDED) != 0)
+        ) {
+            return false;
+        }
+        credentialsIncluded = ((flags & SNAPSHOT_CREDENTIALS_INCLUDED) != 0);
+        return true;
+    }
+
+    bool DecodeFlag(
+        const std::string& snapshot,
+        size_t& offset,
+        bool& value
+    ) {
+        uint8_t byte;
+        if (
+            !DecodeByte(snapshot, offset, byte)
+            || (byte > 1)
+        ) {
+            return false;
+        }
+        value = (byte != 0);
+        return true;
+    }
+
+    bool DecodeInitialResponseMode(
+        const std::string& snapshot,
+        size_t& offset,
+        InitialResponseMode& initialResponseMode
+    ) {
+        uint8_t value;
+        if (
+            !DecodeByte(snapshot, offset, value)
+            || (value > (uint8_t)InitialResponseMode::Never)
+        ) {
+            return false;
+        }
+        initialResponseMode = (InitialResponseMode)value;
+        return true;
+    }
+
+    void EncodePasswordCredentials(
+        const PasswordCredentials& credentials,
+        std::string& snapshot
+    ) {
+        EncodeString(credentials.GetPassword(), snapshot);
+        EncodeString(credentials.GetAuthenticationIdentity(), snapshot);
+        EncodeString(credentials.GetAuthorizationIdentity(), snapshot);
+    }
+
+    bool DecodePasswordCredentials(
+        const std::string& snapshot,
+        size_t& offset,
+        std::shared_ptr< const PasswordCredentials >& credentials
+    ) {
+        std::string password;
+        std::string authenticationIdentity;
+        std::string authorizationIdentity;
+        const auto decoded = (
+            DecodeString(snapshot, offset, password)
+            && DecodeString(snapshot, offset, authenticationIdentity)
+            && DecodeString(snapshot, offset, authorizationIdentity)
+        );
+        if (decoded) {
+            credentials = PasswordCredentials::Create(
+                password,
+                authenticationIdentity,
+                authorizationIdentity
+            );
+        }
+        Wipe(password);
+        return decoded;
+    }
+
+}
+}
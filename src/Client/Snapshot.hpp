@@ -0,0 +1,168 @@
+#pragma once
+
+/**
+ * @file Snapshot.hpp
+ *
+ * This module declares the functions used by the client mechanisms
+ * to begin and check the snapshots of their exchange state.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "BinaryEncoding.hpp"
+
+#include <memory>
+#include <Sasl/Client/Mechanism.hpp>
+#include <Sasl/Client/PasswordCredentials.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This is the version of the snapshot format written by the
+     * mechanisms.  It's bumped whenever the state of any mechanism
+     * is laid out differently, and snapshots of other versions
+     * are refused.
+     */
+    constexpr uint8_t SNAPSHOT_FORMAT_VERSION = 1;
+
+    /**
+     * Start a snapshot of a mechanism's exchange state, with the header
+     * common to all mechanisms: the format version, the name of the
+     * mechanism, and whether or not the credentials are included.
+     *
+     * @param[in] mechanismName
+     *     This is the name of the mechanism whose state is being taken.
+     *
+     * @param[in] credentialsIncluded
+     *     This indicates whether or not the credentials will be
+     *     included in the snapshot.
+     *
+     * @param[out] snapshot
+     *     This is where to start the snapshot.
+     */
+    void BeginSnapshot(
+        const std::string& mechanismName,
+        bool credentialsIncluded,
+        std::string& snapshot
+    );
+
+    /**
+     * Check the header of the given snapshot, to make sure it was taken
+     * of the given mechanism, in the version of the format understood.
+     *
+     * @param[in] snapshot
+     *     This is the snapshot to check.
+     *
+     * @param[in] mechanismName
+     *     This is the name of the mechanism being restored.
+     *
+     * @param[out] offset
+     *     This is where to store the position in the snapshot of the
+     *     state specific to the mechanism.
+     *
+     * @param[out] credentialsIncluded
+     *     This is where to store whether or not the credentials
+     *     are included in the snapshot.
+     *
+     * @return
+     *     An indication of whether or not the snapshot may be restored
+     *     into the mechanism is returned.
+     */
+    bool BeginRestore(
+        const std::string& snapshot,
+        const std::string& mechanismName,
+        size_t& offset,
+        bool& credentialsIncluded
+    );
+
+    /**
+     * Decode the flag at the given position in the given snapshot.
+     *
+     * @param[in] snapshot
+     *     This is the snapshot holding the flag.
+     *
+     * @param[in,out] offset
+     *     This is the position of the flag in the snapshot.
+     *     On success, it's moved past it.
+     *
+     * @param[out] value
+     *     This is where to store the decoded flag.
+     *
+     * @return
+     *     An indication of whether or not a valid flag
+     *     was decoded is returned.
+     */
+    bool DecodeFlag(
+        const std::string& snapshot,
+        size_t& offset,
+        bool& value
+    );
+
+    /**
+     * Decode the initial response mode at the given position
+     * in the given snapshot.
+     *
+     * @param[in] snapshot
+     *     This is the snapshot holding the initial response mode.
+     *
+     * @param[in,out] offset
+     *     This is the position of the initial response mode in the
+     *     snapshot.  On success, it's moved past it.
+     *
+     * @param[out] initialResponseMode
+     *     This is where to store the decoded initial response mode.
+     *
+     * @return
+     *     An indication of whether or not a valid initial response mode
+     *     was decoded is returned.
+     */
+    bool DecodeInitialResponseMode(
+        const std::string& snapshot,
+        size_t& offset,
+        InitialResponseMode& initialResponseMode
+    );
+
+    /**
+     * Append the given password credentials to the given snapshot.
+     *
+     * @param[in] credentials
+     *     These are the credentials to append.
+     *
+     * @param[in,out] snapshot
+     *     This is the snapshot to which to append the credentials.
+     */
+    void EncodePasswordCredentials(
+        const PasswordCredentials& credentials,
+        std::string& snapshot
+    );
+
+    /**
+     * Decode the password credentials at the given position
+     * in the given snapshot.
+     *
+     * @param[in] snapshot
+     *     This is the snapshot holding the credentials.
+     *
+     * @param[in,out] offset
+     *     This is the position of the credentials in the snapshot.
+     *     On success, it's moved past them.
+     *
+     * @param[out] credentials
+     *     This is where to store the decoded credentials.
+     *
+     * @return
+     *     An indication of whether or not the credentials
+     *     were decoded is returned.
+     */
+    bool DecodePasswordCredentials(
+        const std::string& snapshot,
+        size_t& offset,
+        std::shared_ptr< const PasswordCredentials >& credentials
+    );
+
+}
+}
@@ -0,0 +1,208 @@
+/**
+ * @file Transcript.cpp
+ *
+ * This module contains the implementation of the functions and classes
+ * used to store recorded authentication exchanges.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "BinaryEncoding.hpp"
+
+#include <mutex>
+#include <Sasl/Client/Transcript.hpp>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+    /**
+     * This is the length of the signature at the start of every
+     * transcript file, not counting the terminating null.
+     */
+    constexpr size_t SIGNATURE_LENGTH = sizeof(Sasl::Client::TRANSCRIPT_FILE_SIGNATURE) - 1;
+
+    /**
+     * These are the flags which may be set in the outcome byte
+     * of an encoded exchange.
+     */
+    enum OutcomeFlags: uint8_t {
+        OUTCOME_SUCCEEDED = 0x01,
+        OUTCOME_FAULTED = 0x02,
+    };
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    void EncodeTranscriptExchange(
+        const TranscriptExchange& exchange,
+        std::string& buffer
+    ) {
+        EncodeString(exchange.mechanism, buffer);
+        EncodeString(exchange.clientNonce, buffer);
+        buffer += (char)(
+            (exchange.succeeded ? OUTCOME_SUCCEEDED : 0)
+            | (exchange.faulted ? OUTCOME_FAULTED : 0)
+        );
+        EncodeNumber(exchange.steps.size(), buffer);
+        for (const auto& step: exchange.steps) {
+            buffer += (char)(step.initialResponse ? 1 : 0);
+            EncodeString(step.serverMessage, buffer);
+            EncodeNumber(step.clientMessageLength, buffer);
+            EncodeNumber(step.nanoseconds, buffer);
+        }
+    }
+
+    bool DecodeTranscriptExchange(
+        const std::string& buffer,
+        size_t& offset,
+        TranscriptExchange& exchange
+    ) {
+        auto position = offset;
+        if (
+            !DecodeString(buffer, position, exchange.mechanism)
+            || !DecodeString(buffer, position, exchange.clientNonce)
+            || (position >= buffer.length())
+        ) {
+            return false;
+        }
+        const auto outcome = (uint8_t)buffer[position++];
+        exchange.succeeded = ((outcome & OUTCOME_SUCCEEDED) != 0);
+        exchange.faulted = ((outcome & OUTCOME_FAULTED) != 0);
+        uint64_t numSteps;
+        if (
+            !DecodeNumber(buffer, position, numSteps)
+            || (numSteps > buffer.length() - position)
+        ) {
+            return false;
+        }
+        exchange.steps.resize((size_t)numSteps);
+        for (auto& step: exchange.steps) {
+            if (position >= buffer.length()) {
+                return false;
+            }
+            step.initialResponse = (buffer[position++] != 0);
+            uint64_t clientMessageLength;
+            if (
+                !DecodeString(buffer, position, step.serverMessage)
+                || !DecodeNumber(buffer, position, clientMessageLength)
+                || !DecodeNumber(buffer, position, step.nanoseconds)
+            ) {
+                return false;
+            }
+            step.clientMessageLength = (size_t)clientMessageLength;
+        }
+        offset = position;
+        return true;
+    }
+
+    bool ReadTranscriptFile(
+        const std::string& path,
+        std::vector< TranscriptExchange >& exchanges
+    ) {
+        const auto file = fopen(path.c_str(), "rb");
+        if (file == NULL) {
+            return false;
+        }
+        std::string buffer;
+        char chunk[4096];
+        for (;;) {
+            const auto amountRead = fread(chunk, 1, sizeof(chunk), file);
+            if (amountRead == 0) {
+                break;
+            }
+            (void)buffer.append(chunk, amountRead);
+        }
+        (void)fclose(file);
+        if (buffer.compare(0, SIGNATURE_LENGTH, TRANSCRIPT_FILE_SIGNATURE) != 0) {
+            return false;
+        }
+        size_t offset = SIGNATURE_LENGTH;
+        while (offset < buffer.length()) {
+            TranscriptExchange exchange;
+            if (!DecodeTranscriptExchange(buffer, offset, exchange)) {
+                return false;
+            }
+            exchanges.push_back(std::move(exchange));
+        }
+        return true;
+    }
+
+    /**
+     * This contains the private properties of a TranscriptWriter instance.
+     */
+    struct TranscriptWriter::Impl {
+        /**
+         * This is the transcript file, if open.
+         */
+        FILE* file = NULL;
+
+        /**
+         * This is used to encode exchanges before writing them,
+         * kept so that its storage is reused.
+         */
+        std::string buffer;
+
+        /**
+         * This is used to let only one thread at a time write.
+         */
+        std::mutex mutex;
+    };
+
+    TranscriptWriter::~TranscriptWriter() noexcept {
+        if (impl_ != nullptr) {
+            Close();
+        }
+    }
+    TranscriptWriter::TranscriptWriter(TranscriptWriter&&) noexcept = default;
+    TranscriptWriter& TranscriptWriter::operator=(TranscriptWriter&&) noexcept = default;
+
+    TranscriptWriter::TranscriptWriter()
+        : impl_(new Impl)
+    {
+    }
+
+    bool TranscriptWriter::Open(const std::string& path) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (impl_->file != NULL) {
+            (void)fclose(impl_->file);
+        }
+        impl_->file = fopen(path.c_str(), "ab");
+        if (impl_->file == NULL) {
+            return false;
+        }
+        (void)fseek(impl_->file, 0, SEEK_END);
+        if (ftell(impl_->file) == 0) {
+            if (fwrite(TRANSCRIPT_FILE_SIGNATURE, SIGNATURE_LENGTH, 1, impl_->file) != 1) {
+                (void)fclose(impl_->file);
+                impl_->file = NULL;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool TranscriptWriter::Write(const TranscriptExchange& exchange) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (impl_->file == NULL) {
+            return false;
+        }
+        impl_->buffer.clear();
+        EncodeTranscriptExchange(exchange, impl_->buffer);
+        return (
+            fwrite(impl_->buffer.data(), impl_->buffer.length(), 1, impl_->file) == 1
+        );
+    }
+
+    void TranscriptWriter::Close() {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (impl_->file != NULL) {
+            (void)fclose(impl_->file);
+            impl_->file = NULL;
+        }
+    }
+
+}
+}
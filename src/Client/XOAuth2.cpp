@@ -0,0 +1,192 @@
+/**
+ * @file XOAuth2.cpp
+ *
+ * This module contains the implementation of the Sasl::Client::XOAuth2 class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "BearerExchange.hpp"
+
+#include <new>
+#include <Sasl/Client/XOAuth2.hpp>
+#include <string>
+#include <utility>
+
+namespace {
+
+    /**
+     * This describes how the XOAUTH2 mechanism passes the token
+     * to the server.
+     */
+    const Sasl::Client::BearerFlavor FLAVOR = {
+        "XOAUTH2",
+        &Sasl::Client::BearerCredentials::Payloads::xoauth2Message,
+        &Sasl::Client::BearerCredentials::Payloads::xoauth2DiagnosticMessage,
+        "",
+    };
+
+}
+
+namespace Sasl {
+namespace Client {
+
+    /**
+     * This contains the private properties of a XOAuth2 instance.
+     */
+    struct XOAuth2::Impl {
+        // Properties
+
+        /**
+         * This is a helper object used to generate and publish
+         * diagnostic messages.
+         */
+        LazyDiagnosticsSender diagnosticsSender;
+
+        /**
+         * This holds the state of the authentication exchange.
+         */
+        BearerExchange exchange;
+
+        // Methods
+
+        /**
+         * This is the default constructor of the structure
+         */
+        Impl()
+            : diagnosticsSender("XOAuth2")
+        {
+        }
+    };
+
+    XOAuth2::~XOAuth2() noexcept {
+        impl_->~Impl();
+    }
+
+    XOAuth2::XOAuth2(XOAuth2&& other) noexcept
+        : impl_(new (implStorage_) Impl(std::move(*other.impl_)))
+    {
+    }
+
+    XOAuth2& XOAuth2::operator=(XOAuth2&& other) noexcept {
+        if (this != &other) {
+            *impl_ = std::move(*other.impl_);
+        }
+        return *this;
+    }
+
+    XOAuth2::XOAuth2()
+        : impl_(new (implStorage_) Impl)
+    {
+        static_assert(
+            sizeof(Impl) <= IMPL_STORAGE_SIZE,
+            "XOAuth2::Impl doesn't fit in XOAuth2::implStorage_"
+        );
+        static_assert(
+            alignof(Impl) <= alignof(std::max_align_t),
+            "XOAuth2::Impl is over-aligned for XOAuth2::implStorage_"
+        );
+    }
+
+    void XOAuth2::SetSharedCredentials(
+        std::shared_ptr< const BearerCredentials > credentials
+    ) {
+        impl_->exchange.credentials = credentials;
+        impl_->exchange.payloads = nullptr;
+    }
+
+    const std::string& XOAuth2::GetErrorChallenge() const {
+        return impl_->exchange.errorChallenge;
+    }
+
+    SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate XOAuth2::SubscribeToDiagnostics(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+        size_t minLevel
+    ) {
+        return impl_->diagnosticsSender.SubscribeToDiagnostics(delegate, minLevel);
+    }
+
+    void XOAuth2::Reset() {
+        impl_->exchange.Reset();
+    }
+
+    void XOAuth2::SetInitialResponseMode(
+        InitialResponseMode initialResponseMode
+    ) {
+        impl_->exchange.initialResponseMode = initialResponseMode;
+    }
+
+    RoundTripProfile XOAuth2::GetRoundTripProfile() {
+        return impl_->exchange.GetRoundTripProfile();
+    }
+
+    void XOAuth2::SetCancellationToken(
+        const CancellationToken& cancellationToken
+    ) {
+        impl_->exchange.limits.cancellationToken = cancellationToken;
+    }
+
+    void XOAuth2::SetDeadline(
+        std::chrono::steady_clock::time_point deadline
+    ) {
+        impl_->exchange.limits.deadline = deadline;
+    }
+
+    void XOAuth2::SetCredentials(
+        const std::string& credentials,
+        const std::string& authenticationIdentity,
+        const std::string& authorizationIdentity
+    ) {
+        Trace::Span span("XOAuth2::SetCredentials", impl_->exchange.trace);
+        SetSharedCredentials(
+            BearerCredentials::Create(
+                credentials,
+                (
+                    authorizationIdentity.empty()
+                    ? authenticationIdentity
+                    : authorizationIdentity
+                )
+            )
+        );
+    }
+
+    std::string XOAuth2::GetInitialResponse() {
+        Trace::Span span("XOAuth2::GetInitialResponse", impl_->exchange.trace);
+        return impl_->exchange.GetInitialResponse(FLAVOR, impl_->diagnosticsSender);
+    }
+
+    std::string XOAuth2::Proceed(const std::string& message) {
+        Trace::Span span("XOAuth2::Proceed", impl_->exchange.trace);
+        return impl_->exchange.Proceed(FLAVOR, impl_->diagnosticsSender, message);
+    }
+
+    bool XOAuth2::ResponsePending() {
+        return impl_->exchange.responsePending;
+    }
+
+    bool XOAuth2::Succeeded() {
+        return false;
+    }
+
+    bool XOAuth2::Faulted() {
+        return impl_->exchange.faulted;
+    }
+
+    bool XOAuth2::Snapshot(
+        std::string& snapshot,
+        SnapshotCredentials credentials
+    ) {
+        impl_->exchange.Snapshot(FLAVOR, snapshot, credentials);
+        return true;
+    }
+
+    bool XOAuth2::Restore(const std::string& snapshot) {
+        return impl_->exchange.Restore(FLAVOR, snapshot);
+    }
+
+    void XOAuth2::Release() {
+        impl_->exchange.Release();
+    }
+
+}
+}
@@ -0,0 +1,134 @@
+/**
+ * @file Cpu.cpp
+ *
+ * This module contains the implementation of functions which detect
+ * the features supported by the processor on which the program is running.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Cpu.hpp"
+
+#include <stdint.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define SASL_CPUID_AVAILABLE
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define SASL_CPUID_AVAILABLE
+#endif
+
+namespace {
+
+    /**
+     * This holds the registers returned by the CPUID instruction.
+     */
+    struct CpuidRegisters {
+        uint32_t eax = 0;
+        uint32_t ebx = 0;
+        uint32_t ecx = 0;
+        uint32_t edx = 0;
+    };
+
+    /**
+     * Execute the CPUID instruction for the given leaf and subleaf.
+     *
+     * @param[in] leaf
+     *     This is the CPUID leaf to query.
+     *
+     * @param[in] subleaf
+     *     This is the CPUID subleaf to query.
+     *
+     * @return
+     *     The registers returned by the instruction are returned.
+     *     If the leaf is not supported, all registers are zero.
+     */
+    CpuidRegisters Cpuid(uint32_t leaf, uint32_t subleaf) {
+        CpuidRegisters registers;
+#if defined(SASL_CPUID_AVAILABLE) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if ((uint32_t)info[0] >= leaf) {
+            __cpuidex(info, (int)leaf, (int)subleaf);
+            registers.eax = (uint32_t)info[0];
+            registers.ebx = (uint32_t)info[1];
+            registers.ecx = (uint32_t)info[2];
+            registers.edx = (uint32_t)info[3];
+        }
+#elif defined(SASL_CPUID_AVAILABLE)
+        unsigned int eax, ebx, ecx, edx;
+        if (__get_cpuid_count(leaf, subleaf, &eax, &ebx, &ecx, &edx)) {
+            registers.eax = eax;
+            registers.ebx = ebx;
+            registers.ecx = ecx;
+            registers.edx = edx;
+        }
+#endif
+        return registers;
+    }
+
+    /**
+     * Return the value of the extended control register which indicates
+     * which processor state the operating system saves.
+     *
+     * @return
+     *     The value of the XCR0 register is returned.
+     */
+    uint64_t GetEnabledProcessorState() {
+#if defined(SASL_CPUID_AVAILABLE) && defined(_MSC_VER)
+        return (uint64_t)_xgetbv(0);
+#elif defined(SASL_CPUID_AVAILABLE)
+        uint32_t eax, edx;
+        __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return ((uint64_t)edx << 32) | eax;
+#else
+        return 0;
+#endif
+    }
+
+}
+
+namespace Sasl {
+namespace Cpu {
+
+    bool HasShaExtensions() {
+        static const bool hasShaExtensions = []{
+            const auto features = Cpuid(1, 0);
+            const auto extendedFeatures = Cpuid(7, 0);
+            const bool hasSsse3 = ((features.ecx & (1 << 9)) != 0);
+            const bool hasSse41 = ((features.ecx & (1 << 19)) != 0);
+            const bool hasSha = ((extendedFeatures.ebx & (1 << 29)) != 0);
+            return hasSsse3 && hasSse41 && hasSha;
+        }();
+        return hasShaExtensions;
+    }
+
+    bool HasSse41() {
+        static const bool hasSse41 = []{
+            const auto features = Cpuid(1, 0);
+            const bool hasSsse3 = ((features.ecx & (1 << 9)) != 0);
+            const bool hasSse41 = ((features.ecx & (1 << 19)) != 0);
+            return hasSsse3 && hasSse41;
+        }();
+        return hasSse41;
+    }
+
+    bool HasAvx2() {
+        static const bool hasAvx2 = []{
+            const auto features = Cpuid(1, 0);
+            const bool hasOsxsave = ((features.ecx & (1 << 27)) != 0);
+            const bool hasAvx = ((features.ecx & (1 << 28)) != 0);
+            if (!hasOsxsave || !hasAvx) {
+                return false;
+            }
+            const bool savesYmmState = ((GetEnabledProcessorState() & 0x6) == 0x6);
+            const auto extendedFeatures = Cpuid(7, 0);
+            const bool hasAvx2 = ((extendedFeatures.ebx & (1 << 5)) != 0);
+            return savesYmmState && hasAvx2;
+        }();
+        return hasAvx2;
+    }
+
+}
+}
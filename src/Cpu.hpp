@@ -0,0 +1,48 @@
+#pragma once
+
+/**
+ * @file Cpu.hpp
+ *
+ * This module declares functions which detect the features supported
+ * by the processor on which the program is running.
+ *
+ * © 2019 by Richard Walters
+ */
+
+namespace Sasl {
+namespace Cpu {
+
+    /**
+     * Return an indication of whether or not the processor supports
+     * the Intel SHA Extensions, along with the SSSE3 and SSE4.1
+     * instructions used alongside them.
+     *
+     * @return
+     *     An indication of whether or not the processor supports
+     *     the Intel SHA Extensions is returned.
+     */
+    bool HasShaExtensions();
+
+    /**
+     * Return an indication of whether or not the processor supports
+     * the SSSE3 and SSE4.1 instructions.
+     *
+     * @return
+     *     An indication of whether or not the processor supports
+     *     the SSSE3 and SSE4.1 instructions is returned.
+     */
+    bool HasSse41();
+
+    /**
+     * Return an indication of whether or not the processor supports
+     * the AVX2 instructions, and the operating system saves the
+     * registers they use.
+     *
+     * @return
+     *     An indication of whether or not the AVX2 instructions
+     *     may be used is returned.
+     */
+    bool HasAvx2();
+
+}
+}
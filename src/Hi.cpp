@@ -0,0 +1,51 @@
+/**
+ * @file Hi.cpp
+ *
+ * This module contains the implementation of the Sasl::Hi function.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Hi.hpp"
+
+#include <string.h>
+
+namespace Sasl {
+
+    bool Hi(
+        const HmacKey& key,
+        const uint8_t* salt,
+        size_t saltLength,
+        size_t iterations,
+        uint8_t* derivedKey,
+        const std::function< bool() >& keepGoing
+    ) {
+        const auto digestLength = key.GetDigestLength();
+        static const uint8_t firstBlockIndex[4] = {0, 0, 0, 1};
+        uint8_t u[MAX_DIGEST_LENGTH];
+        const auto context = key.Begin();
+        context->Update(salt, saltLength);
+        context->Update(firstBlockIndex, sizeof(firstBlockIndex));
+        key.Finish(*context, u);
+        (void)memcpy(derivedKey, u, digestLength);
+        for (size_t i = 1; i < iterations; ++i) {
+            if (
+                ((i % HI_CHECK_INTERVAL) == 0)
+                && keepGoing
+                && !keepGoing()
+            ) {
+                (void)memset(u, 0, sizeof(u));
+                return false;
+            }
+            key.Restart(*context);
+            context->Update(u, digestLength);
+            key.Finish(*context, u);
+            for (size_t j = 0; j < digestLength; ++j) {
+                derivedKey[j] ^= u[j];
+            }
+        }
+        (void)memset(u, 0, sizeof(u));
+        return true;
+    }
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+ * @file Hi.hpp
+ *
+ * This module declares the Sasl::Hi function.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Hmac.hpp"
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Sasl {
+
+    /**
+     * This is the number of iterations the Hi function performs between
+     * checks of whether or not it should keep going.
+     */
+    constexpr size_t HI_CHECK_INTERVAL = 256;
+
+    /**
+     * Compute the Hi function defined in
+     * [RFC 5802](https://tools.ietf.org/html/rfc5802) section 2.2,
+     * which is essentially PBKDF2
+     * ([RFC 2898](https://tools.ietf.org/html/rfc2898)) with HMAC as the
+     * pseudorandom function and with the length of the derived key equal
+     * to the length of the HMAC.
+     *
+     * @param[in] key
+     *     This is the HMAC state keyed with the string (normally
+     *     the normalized password) from which to derive the key.
+     *
+     * @param[in] salt
+     *     This points to the salt.
+     *
+     * @param[in] saltLength
+     *     This is the number of bytes in the salt.
+     *
+     * @param[in] iterations
+     *     This is the number of iterations of the HMAC to apply.
+     *
+     * @param[out] derivedKey
+     *     This is where to store the derived key.  It must have room
+     *     for key.GetDigestLength() bytes.
+     *
+     * @param[in] keepGoing
+     *     If not empty, this is called every HI_CHECK_INTERVAL iterations
+     *     to check whether or not the computation should continue.
+     *     It returns false to stop the computation.
+     *
+     * @return
+     *     An indication of whether or not the computation was completed
+     *     is returned.  If not, the contents of derivedKey are unspecified.
+     */
+    bool Hi(
+        const HmacKey& key,
+        const uint8_t* salt,
+        size_t saltLength,
+        size_t iterations,
+        uint8_t* derivedKey,
+        const std::function< bool() >& keepGoing = nullptr
+    );
+
+}
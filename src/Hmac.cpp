@@ -0,0 +1,105 @@
+/**
+ * @file Hmac.cpp
+ *
+ * This module contains the implementation of the Sasl::HmacKey class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Hmac.hpp"
+#include "Wipe.hpp"
+
+#include <string.h>
+#include <vector>
+
+namespace Sasl {
+
+    /**
+     * This contains the private properties of a HmacKey instance.
+     */
+    struct HmacKey::Impl {
+        // Properties
+
+        /**
+         * This is the size, in bytes, of the digest produced by
+         * the hash function.
+         */
+        size_t digestLength = 0;
+
+        /**
+         * This is the hash context after absorbing the key combined
+         * with the inner pad.
+         */
+        std::unique_ptr< HashContext > inner;
+
+        /**
+         * This is the hash context after absorbing the key combined
+         * with the outer pad.
+         */
+        std::unique_ptr< HashContext > outer;
+    };
+
+    HmacKey::~HmacKey() noexcept {
+        // The padded keys are only held in the hash contexts, and the
+        // built-in hash contexts wipe themselves when destroyed.
+        if (impl_ != nullptr) {
+            impl_->inner.reset();
+            impl_->outer.reset();
+        }
+    }
+    HmacKey::HmacKey(HmacKey&& other) noexcept = default;
+    HmacKey& HmacKey::operator=(HmacKey&& other) noexcept = default;
+
+    HmacKey::HmacKey(
+        const HashContextFactory& hashContextFactory,
+        size_t blockSize,
+        size_t digestLength,
+        const uint8_t* key,
+        size_t keyLength
+    )
+        : impl_(new Impl)
+    {
+        impl_->digestLength = digestLength;
+        std::vector< uint8_t > paddedKey(blockSize);
+        impl_->inner = hashContextFactory();
+        if (keyLength > blockSize) {
+            impl_->inner->Update(key, keyLength);
+            impl_->inner->Final(paddedKey.data());
+            impl_->inner = hashContextFactory();
+        } else {
+            (void)memcpy(paddedKey.data(), key, keyLength);
+        }
+        for (auto& octet: paddedKey) {
+            octet ^= 0x36;
+        }
+        impl_->inner->Update(paddedKey.data(), paddedKey.size());
+        for (auto& octet: paddedKey) {
+            octet ^= (0x36 ^ 0x5C);
+        }
+        impl_->outer = hashContextFactory();
+        impl_->outer->Update(paddedKey.data(), paddedKey.size());
+        Wipe(paddedKey);
+    }
+
+    size_t HmacKey::GetDigestLength() const {
+        return impl_->digestLength;
+    }
+
+    std::unique_ptr< HashContext > HmacKey::Begin() const {
+        return impl_->inner->Clone();
+    }
+
+    void HmacKey::Restart(HashContext& context) const {
+        context.CopyFrom(*impl_->inner);
+    }
+
+    void HmacKey::Finish(HashContext& context, uint8_t* code) const {
+        uint8_t innerDigest[MAX_DIGEST_LENGTH];
+        context.Final(innerDigest);
+        context.CopyFrom(*impl_->outer);
+        context.Update(innerDigest, impl_->digestLength);
+        context.Final(code);
+        Wipe(innerDigest, sizeof(innerDigest));
+    }
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+/**
+ * @file Hmac.hpp
+ *
+ * This module declares the Sasl::HmacKey class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+#include <Sasl/HashContext.hpp>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Sasl {
+
+    /**
+     * This holds the state of the Hash-based Message Authentication Code
+     * (HMAC -- [RFC 2104](https://tools.ietf.org/html/rfc2104)) for one key,
+     * after the inner and outer padded keys have been absorbed.  Any number
+     * of messages may then be authenticated with the key without absorbing
+     * the padded key again.
+     *
+     * The padded keys are as good as the key itself, so they're wiped
+     * when the HmacKey is destroyed, as long as the hash contexts
+     * holding them are the built-in ones, which wipe themselves.
+     */
+    class HmacKey {
+        // Lifecycle management
+    public:
+        ~HmacKey() noexcept;
+        HmacKey(const HmacKey&) = delete;
+        HmacKey(HmacKey&&) noexcept;
+        HmacKey& operator=(const HmacKey&) = delete;
+        HmacKey& operator=(HmacKey&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * Construct the HMAC state for the given key.
+         *
+         * @param[in] hashContextFactory
+         *     This is used to make contexts for the hash function
+         *     on which the HMAC is based.
+         *
+         * @param[in] blockSize
+         *     This is the block size, in bytes, of the hash function.
+         *
+         * @param[in] digestLength
+         *     This is the size, in bytes, of the digest produced by
+         *     the hash function.
+         *
+         * @param[in] key
+         *     This points to the key.
+         *
+         * @param[in] keyLength
+         *     This is the number of bytes in the key.
+         */
+        HmacKey(
+            const HashContextFactory& hashContextFactory,
+            size_t blockSize,
+            size_t digestLength,
+            const uint8_t* key,
+            size_t keyLength
+        );
+
+        /**
+         * Return the size, in bytes, of the codes computed with the key.
+         *
+         * @return
+         *     The size, in bytes, of the codes computed with the key
+         *     is returned.
+         */
+        size_t GetDigestLength() const;
+
+        /**
+         * Make a new context in which to compute the code for a message.
+         * The context has already absorbed the inner padded key, so
+         * the message should be absorbed next, followed by a call to
+         * Finish.
+         *
+         * @return
+         *     The new context is returned.
+         */
+        std::unique_ptr< HashContext > Begin() const;
+
+        /**
+         * Reuse the given context, previously made by Begin, to compute
+         * the code for a new message.  The message should be absorbed next,
+         * followed by a call to Finish.
+         *
+         * @param[in,out] context
+         *     This is the context to reset to the keyed inner state.
+         */
+        void Restart(HashContext& context) const;
+
+        /**
+         * Finish computing the code for the message absorbed into the
+         * given context.
+         *
+         * @param[in,out] context
+         *     This is the context, made by Begin, into which the message
+         *     has been absorbed.  It is reused for the outer hash.
+         *
+         * @param[out] code
+         *     This is where to store the computed code.  It must have
+         *     room for GetDigestLength() bytes.
+         */
+        void Finish(HashContext& context, uint8_t* code) const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
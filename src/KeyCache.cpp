@@ -0,0 +1,636 @@
+/**
+ * @file KeyCache.cpp
+ *
+ * This module contains the implementation of the Sasl::KeyCache::Store
+ * and Sasl::KeyCache::Daemon classes.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "KeyCacheProtocol.hpp"
+#include "Wipe.hpp"
+
+#include <list>
+#include <mutex>
+#include <Sasl/KeyCache.hpp>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    /**
+     * This is an estimate of the number of bytes used to keep track
+     * of each derived key held in a store, beyond the keys themselves.
+     */
+    constexpr size_t ENTRY_OVERHEAD = 128;
+
+    /**
+     * This is the number of bytes read from a client at a time.
+     */
+    constexpr size_t RECEIVE_CHUNK_SIZE = 4096;
+
+    /**
+     * This is how long the daemon waits to send a response to a client
+     * which isn't reading them before disconnecting it.
+     */
+    constexpr int SEND_TIMEOUT_MILLISECONDS = 1000;
+
+    /**
+     * This holds a derived key held in a store.
+     */
+    struct Entry {
+        /**
+         * This is the key under which the derived key is held.
+         */
+        std::string key;
+
+        /**
+         * This is the derived key.
+         */
+        std::string derivedKey;
+    };
+
+    /**
+     * Return the number of bytes counted against a store's limit
+     * for holding the given derived key under the given key.
+     *
+     * @param[in] key
+     *     This is the key under which the derived key is held.
+     *
+     * @param[in] derivedKey
+     *     This is the derived key held.
+     *
+     * @return
+     *     The number of bytes counted for the derived key is returned.
+     */
+    size_t EntrySize(const std::string& key, const std::string& derivedKey) {
+        // The key is held twice: once in the entry, and once in the index.
+        return key.length() * 2 + derivedKey.length() + ENTRY_OVERHEAD;
+    }
+
+#ifndef _WIN32
+    /**
+     * Send all of the given data over the given socket.
+     *
+     * @param[in] socket
+     *     This is the socket over which to send the data.
+     *
+     * @param[in] data
+     *     This is the data to send.
+     *
+     * @return
+     *     An indication of whether or not all of the data was sent
+     *     is returned.
+     */
+    bool SendAll(int socket, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.length()) {
+            int flags = 0;
+#ifdef MSG_NOSIGNAL
+            flags |= MSG_NOSIGNAL;
+#endif
+            const auto amount = send(socket, data.data() + sent, data.length() - sent, flags);
+            if (amount < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            sent += (size_t)amount;
+        }
+        return true;
+    }
+
+    /**
+     * Check whether or not the socket at the given address is stale,
+     * meaning it was left behind by a daemon which is no longer serving
+     * on it.
+     *
+     * @param[in] address
+     *     This is the address of the socket to check.
+     *
+     * @return
+     *     An indication of whether or not the socket is stale
+     *     is returned.  A socket on which something answers,
+     *     or which can't be checked, isn't stale.
+     */
+    bool IsStaleSocket(const struct sockaddr_un& address) {
+        const auto probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe < 0) {
+            return false;
+        }
+        int result;
+        do {
+            result = connect(probe, (const struct sockaddr*)&address, sizeof(address));
+        } while ((result != 0) && (errno == EINTR));
+        const auto stale = ((result != 0) && (errno == ECONNREFUSED));
+        (void)close(probe);
+        return stale;
+    }
+#endif
+
+}
+
+namespace Sasl {
+namespace KeyCache {
+
+    std::string GetRuntimeDirectory() {
+#ifdef _WIN32
+        return "";
+#else
+        const auto directory = getenv("XDG_RUNTIME_DIR");
+        if (
+            (directory == NULL)
+            || (directory[0] != '/')
+        ) {
+            return "";
+        }
+        struct stat status;
+        if (
+            (lstat(directory, &status) != 0)
+            || !S_ISDIR(status.st_mode)
+            || (status.st_uid != geteuid())
+            || ((status.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+        ) {
+            return "";
+        }
+        return directory;
+#endif
+    }
+
+    std::string GetDefaultSocketPath() {
+        const auto directory = GetRuntimeDirectory();
+        if (directory.empty()) {
+            return "";
+        }
+        return directory + "/" + DEFAULT_SOCKET_NAME;
+    }
+
+    /**
+     * This contains the private properties of a Store instance.
+     */
+    struct Store::Impl {
+        // Properties
+
+        /**
+         * This is the greatest number of bytes to use to hold
+         * derived keys.
+         */
+        size_t maxBytes;
+
+        /**
+         * These are the derived keys held, from most to least
+         * recently used.
+         */
+        std::list< Entry > entries;
+
+        /**
+         * This finds each entry by its key.
+         */
+        std::unordered_map< std::string, std::list< Entry >::iterator > index;
+
+        /**
+         * This holds statistics about the use of the store.
+         */
+        Stats stats;
+
+        /**
+         * This is used to synchronize access to the store.
+         */
+        mutable std::mutex mutex;
+
+        // Methods
+
+        /**
+         * Forget the least recently used derived key.
+         */
+        void Evict() {
+            auto& entry = entries.back();
+            stats.bytes -= EntrySize(entry.key, entry.derivedKey);
+            --stats.entries;
+            ++stats.evictions;
+            Wipe(entry.derivedKey);
+            (void)index.erase(entry.key);
+            entries.pop_back();
+        }
+    };
+
+    Store::~Store() noexcept {
+        if (impl_ == nullptr) {
+            return;
+        }
+        for (auto& entry: impl_->entries) {
+            Wipe(entry.derivedKey);
+        }
+    }
+    Store::Store(Store&&) noexcept = default;
+    Store& Store::operator=(Store&&) noexcept = default;
+
+    Store::Store(size_t maxBytes)
+        : impl_(new Impl)
+    {
+        impl_->maxBytes = maxBytes;
+    }
+
+    bool Store::Find(const std::string& key, std::string& derivedKey) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        const auto indexEntry = impl_->index.find(key);
+        if (indexEntry == impl_->index.end()) {
+            ++impl_->stats.misses;
+            return false;
+        }
+        ++impl_->stats.hits;
+        impl_->entries.splice(impl_->entries.begin(), impl_->entries, indexEntry->second);
+        derivedKey = indexEntry->second->derivedKey;
+        return true;
+    }
+
+    void Store::Insert(const std::string& key, const std::string& derivedKey) {
+        const auto size = EntrySize(key, derivedKey);
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (size > impl_->maxBytes) {
+            return;
+        }
+        const auto indexEntry = impl_->index.find(key);
+        if (indexEntry != impl_->index.end()) {
+            auto& entry = *indexEntry->second;
+            impl_->stats.bytes -= EntrySize(entry.key, entry.derivedKey);
+            Wipe(entry.derivedKey);
+            entry.derivedKey = derivedKey;
+            impl_->stats.bytes += size;
+            impl_->entries.splice(impl_->entries.begin(), impl_->entries, indexEntry->second);
+        } else {
+            impl_->entries.push_front({key, derivedKey});
+            impl_->index[key] = impl_->entries.begin();
+            impl_->stats.bytes += size;
+            ++impl_->stats.entries;
+        }
+        while (impl_->stats.bytes > impl_->maxBytes) {
+            impl_->Evict();
+        }
+    }
+
+    auto Store::GetStats() const -> Stats {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->stats;
+    }
+
+    /**
+     * This contains the private properties of a Daemon instance.
+     */
+    struct Daemon::Impl {
+        // Types
+
+        /**
+         * This holds what the daemon keeps for each connected client.
+         */
+        struct Client {
+            /**
+             * This is the socket connected to the client.
+             */
+            int socket;
+
+            /**
+             * This holds what has been received from the client but
+             * not yet handled.
+             */
+            std::string received;
+        };
+
+        // Properties
+
+        /**
+         * This holds the derived keys served to clients.
+         */
+        Store store;
+
+        /**
+         * This is the path of the socket on which clients are served.
+         */
+        std::string socketPath;
+
+#ifndef _WIN32
+        /**
+         * These identify the socket file made by the daemon, so that
+         * it's only removed while it's still the one at its path.
+         */
+        dev_t socketDevice = 0;
+        ino_t socketInode = 0;
+#endif
+
+        /**
+         * This is the socket on which clients connect.
+         */
+        int listenSocket = -1;
+
+        /**
+         * These are the ends of the pipe used to wake the serving
+         * thread when it's time to stop.
+         */
+        int wakePipe[2] = {-1, -1};
+
+        /**
+         * These are the clients connected.
+         */
+        std::vector< Client > clients;
+
+        /**
+         * This is the thread serving clients.
+         */
+        std::thread worker;
+
+        // Methods
+
+        /**
+         * This constructor sets up the daemon's store.
+         *
+         * @param[in] maxBytes
+         *     This is the greatest number of bytes to use to hold
+         *     derived keys.
+         */
+        explicit Impl(size_t maxBytes)
+            : store(maxBytes)
+        {
+        }
+
+        /**
+         * Handle the given request from a client.
+         *
+         * @param[in] payload
+         *     This is the payload of the request.
+         *
+         * @param[out] response
+         *     This is where to store the framed response to send
+         *     to the client.
+         *
+         * @return
+         *     An indication of whether or not the request was well-formed
+         *     is returned.
+         */
+        bool HandleRequest(const std::string& payload, std::string& response) {
+            Request request;
+            if (!DecodeRequest(payload, request)) {
+                return false;
+            }
+            for (auto& entry: request.stores) {
+                store.Insert(entry.first, entry.second);
+                Wipe(entry.second);
+            }
+            std::vector< std::string > results(request.lookups.size());
+            for (size_t i = 0; i < results.size(); ++i) {
+                (void)store.Find(request.lookups[i], results[i]);
+            }
+            EncodeResponse(results, response);
+            for (auto& result: results) {
+                Wipe(result);
+            }
+            return true;
+        }
+
+#ifndef _WIN32
+        /**
+         * Take in what the given client has sent, and answer any
+         * complete requests.
+         *
+         * @param[in,out] client
+         *     This is the client from which to receive.
+         *
+         * @return
+         *     An indication of whether or not the client should stay
+         *     connected is returned.
+         */
+        bool Serve(Client& client) {
+            char buffer[RECEIVE_CHUNK_SIZE];
+            const auto amount = recv(client.socket, buffer, sizeof(buffer), 0);
+            if (amount <= 0) {
+                return (
+                    (amount < 0)
+                    && (errno == EINTR)
+                );
+            }
+            client.received.append(buffer, (size_t)amount);
+            while (client.received.length() >= FRAME_HEADER_LENGTH) {
+                const auto length = DecodeFrameLength(
+                    (const uint8_t*)client.received.data()
+                );
+                if (length > MAX_FRAME_LENGTH) {
+                    return false;
+                }
+                if (client.received.length() < FRAME_HEADER_LENGTH + length) {
+                    break;
+                }
+                auto payload = client.received.substr(FRAME_HEADER_LENGTH, length);
+                (void)memset(&client.received[0], 0, FRAME_HEADER_LENGTH + length);
+                (void)client.received.erase(0, FRAME_HEADER_LENGTH + length);
+                std::string response;
+                const auto handled = HandleRequest(payload, response);
+                Wipe(payload);
+                if (
+                    !handled
+                    || !SendAll(client.socket, response)
+                ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Accept a client connecting to the daemon, unless the daemon
+         * is already serving as many clients as it can.
+         */
+        void Accept() {
+            const auto socket = accept(listenSocket, NULL, NULL);
+            if (socket < 0) {
+                return;
+            }
+            if (
+                (clients.size() >= MAX_CLIENTS)
+                || !IsPeerSameUser(socket)
+            ) {
+                (void)close(socket);
+                return;
+            }
+            struct timeval timeout;
+            timeout.tv_sec = SEND_TIMEOUT_MILLISECONDS / 1000;
+            timeout.tv_usec = (SEND_TIMEOUT_MILLISECONDS % 1000) * 1000;
+            (void)setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+            const int one = 1;
+            (void)setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            clients.push_back({socket, ""});
+        }
+
+        /**
+         * Serve clients until told to stop.
+         */
+        void Run() {
+            std::vector< struct pollfd > pollFds;
+            for (;;) {
+                pollFds.clear();
+                pollFds.push_back({wakePipe[0], POLLIN, 0});
+                pollFds.push_back({listenSocket, POLLIN, 0});
+                for (const auto& client: clients) {
+                    pollFds.push_back({client.socket, POLLIN, 0});
+                }
+                if (poll(pollFds.data(), (nfds_t)pollFds.size(), -1) < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    break;
+                }
+                if (pollFds[0].revents != 0) {
+                    break;
+                }
+                size_t clientIndex = 0;
+                for (size_t i = 2; i < pollFds.size(); ++i) {
+                    auto& client = clients[clientIndex];
+                    if (
+                        (pollFds[i].revents == 0)
+                        || Serve(client)
+                    ) {
+                        ++clientIndex;
+                    } else {
+                        Wipe(client.received);
+                        (void)close(client.socket);
+                        (void)clients.erase(clients.begin() + clientIndex);
+                    }
+                }
+                if (pollFds[1].revents != 0) {
+                    Accept();
+                }
+            }
+        }
+#endif
+    };
+
+    Daemon::~Daemon() noexcept {
+        if (impl_ == nullptr) {
+            return;
+        }
+        Stop();
+    }
+    Daemon::Daemon(Daemon&&) noexcept = default;
+    Daemon& Daemon::operator=(Daemon&&) noexcept = default;
+
+    Daemon::Daemon(size_t maxBytes)
+        : impl_(new Impl(maxBytes))
+    {
+    }
+
+    bool Daemon::Start(const std::string& socketPath) {
+#ifdef _WIN32
+        (void)socketPath;
+        return false;
+#else
+        Stop();
+        struct sockaddr_un address;
+        if (socketPath.length() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        (void)memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        (void)memcpy(address.sun_path, socketPath.data(), socketPath.length());
+        impl_->listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (impl_->listenSocket < 0) {
+            return false;
+        }
+
+        // A socket left at the path by a daemon which didn't stop cleanly
+        // is replaced, but nothing else is: not a file other than a socket,
+        // nor the socket of a daemon still serving on it.
+        struct stat status;
+        if (lstat(socketPath.c_str(), &status) == 0) {
+            if (
+                !S_ISSOCK(status.st_mode)
+                || !IsStaleSocket(address)
+                || (unlink(socketPath.c_str()) != 0)
+            ) {
+                (void)close(impl_->listenSocket);
+                impl_->listenSocket = -1;
+                return false;
+            }
+        }
+
+        // The socket is made accessible only to the user running the
+        // daemon, since the derived keys it holds are secrets.
+        if (
+            bind(
+                impl_->listenSocket,
+                (const struct sockaddr*)&address,
+                sizeof(address)
+            ) != 0
+        ) {
+            (void)close(impl_->listenSocket);
+            impl_->listenSocket = -1;
+            return false;
+        }
+        if (
+            (chmod(socketPath.c_str(), S_IRUSR | S_IWUSR) != 0)
+            || (lstat(socketPath.c_str(), &status) != 0)
+            || (listen(impl_->listenSocket, SOMAXCONN) != 0)
+            || (pipe(impl_->wakePipe) != 0)
+        ) {
+            (void)close(impl_->listenSocket);
+            impl_->listenSocket = -1;
+            (void)unlink(socketPath.c_str());
+            return false;
+        }
+        impl_->socketDevice = status.st_dev;
+        impl_->socketInode = status.st_ino;
+        impl_->socketPath = socketPath;
+        impl_->worker = std::thread(&Impl::Run, impl_.get());
+        return true;
+#endif
+    }
+
+    void Daemon::Stop() {
+#ifndef _WIN32
+        if (!impl_->worker.joinable()) {
+            return;
+        }
+        // Closing the write end of the pipe wakes the serving thread.
+        (void)close(impl_->wakePipe[1]);
+        impl_->wakePipe[1] = -1;
+        impl_->worker.join();
+        for (auto& client: impl_->clients) {
+            Wipe(client.received);
+            (void)close(client.socket);
+        }
+        impl_->clients.clear();
+        (void)close(impl_->listenSocket);
+        impl_->listenSocket = -1;
+        (void)close(impl_->wakePipe[0]);
+        impl_->wakePipe[0] = -1;
+        struct stat status;
+        if (
+            (lstat(impl_->socketPath.c_str(), &status) == 0)
+            && S_ISSOCK(status.st_mode)
+            && (status.st_dev == impl_->socketDevice)
+            && (status.st_ino == impl_->socketInode)
+        ) {
+            (void)unlink(impl_->socketPath.c_str());
+        }
+        impl_->socketPath.clear();
+#endif
+    }
+
+    Store::Stats Daemon::GetStats() const {
+        return impl_->store.GetStats();
+    }
+
+}
+}
@@ -0,0 +1,299 @@
+/**
+ * @file KeyCacheProtocol.cpp
+ *
+ * This module contains the implementation of the functions used to
+ * encode and decode the messages exchanged between the key cache
+ * client and daemon.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Client/BinaryEncoding.hpp"
+#include "KeyCacheProtocol.hpp"
+
+#include <Sasl/HashContext.hpp>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    /**
+     * Begin a framed message in the given buffer, leaving room for
+     * the frame header.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer in which to begin the message.
+     *
+     * @return
+     *     The position of the frame header in the buffer is returned.
+     */
+    size_t BeginFrame(std::string& buffer) {
+        const auto start = buffer.length();
+        buffer.append(Sasl::KeyCache::FRAME_HEADER_LENGTH, '\0');
+        buffer += (char)Sasl::KeyCache::PROTOCOL_VERSION;
+        return start;
+    }
+
+    /**
+     * Fill in the frame header of the message at the given position
+     * in the given buffer, now that the message is complete.
+     *
+     * @param[in] start
+     *     This is the position of the frame header in the buffer.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer holding the message.
+     */
+    void EndFrame(size_t start, std::string& buffer) {
+        const auto length = buffer.length() - start - Sasl::KeyCache::FRAME_HEADER_LENGTH;
+        for (size_t i = 0; i < Sasl::KeyCache::FRAME_HEADER_LENGTH; ++i) {
+            buffer[start + i] = (char)(
+                length >> (8 * (Sasl::KeyCache::FRAME_HEADER_LENGTH - 1 - i))
+            );
+        }
+    }
+
+    /**
+     * Decode a count at the given position in the given payload, making
+     * sure the payload is long enough to hold that many items (each
+     * at least one byte long).
+     *
+     * @param[in] payload
+     *     This is the payload holding the count.
+     *
+     * @param[in,out] offset
+     *     This is the position of the count in the payload.
+     *     On success, it's moved past the count.
+     *
+     * @param[out] count
+     *     This is where to store the decoded count.
+     *
+     * @return
+     *     An indication of whether or not the count was decoded
+     *     is returned.
+     */
+    bool DecodeCount(const std::string& payload, size_t& offset, size_t& count) {
+        uint64_t value;
+        if (
+            !Sasl::Client::DecodeNumber(payload, offset, value)
+            || (value > payload.length() - offset)
+        ) {
+            return false;
+        }
+        count = (size_t)value;
+        return true;
+    }
+
+    /**
+     * Decode a key at the given position in the given payload.
+     *
+     * @param[in] payload
+     *     This is the payload holding the key.
+     *
+     * @param[in,out] offset
+     *     This is the position of the key in the payload.
+     *     On success, it's moved past the key.
+     *
+     * @param[out] key
+     *     This is where to store the decoded key.
+     *
+     * @return
+     *     An indication of whether or not the key was decoded
+     *     is returned.
+     */
+    bool DecodeKey(const std::string& payload, size_t& offset, std::string& key) {
+        return (
+            Sasl::Client::DecodeString(payload, offset, key)
+            && !key.empty()
+            && (key.length() <= Sasl::KeyCache::MAX_KEY_LENGTH)
+        );
+    }
+
+    /**
+     * Decode a derived key at the given position in the given payload.
+     *
+     * @param[in] payload
+     *     This is the payload holding the derived key.
+     *
+     * @param[in,out] offset
+     *     This is the position of the derived key in the payload.
+     *     On success, it's moved past the derived key.
+     *
+     * @param[out] derivedKey
+     *     This is where to store the decoded derived key.
+     *
+     * @return
+     *     An indication of whether or not the derived key was decoded
+     *     is returned.
+     */
+    bool DecodeDerivedKey(const std::string& payload, size_t& offset, std::string& derivedKey) {
+        return (
+            Sasl::Client::DecodeString(payload, offset, derivedKey)
+            && (derivedKey.length() <= Sasl::MAX_DIGEST_LENGTH)
+        );
+    }
+
+    /**
+     * Check the protocol version at the start of the given payload.
+     *
+     * @param[in] payload
+     *     This is the payload to check.
+     *
+     * @param[out] offset
+     *     This is where to store the position in the payload
+     *     after the version.
+     *
+     * @return
+     *     An indication of whether or not the payload is of the
+     *     version of the protocol spoken is returned.
+     */
+    bool CheckVersion(const std::string& payload, size_t& offset) {
+        offset = 0;
+        uint8_t version;
+        return (
+            Sasl::Client::DecodeByte(payload, offset, version)
+            && (version == Sasl::KeyCache::PROTOCOL_VERSION)
+        );
+    }
+
+}
+
+namespace Sasl {
+namespace KeyCache {
+
+    std::string MakeKey(
+        const std::string& mechanismName,
+        const uint8_t* salt,
+        size_t saltLength,
+        size_t iterations,
+        const uint8_t* fingerprint
+    ) {
+        std::string key;
+        Client::EncodeString(mechanismName, key);
+        Client::EncodeBytes(salt, saltLength, key);
+        Client::EncodeNumber(iterations, key);
+        (void)key.append((const char*)fingerprint, FINGERPRINT_LENGTH);
+        return key;
+    }
+
+    void EncodeRequest(const Request& request, std::string& buffer) {
+        const auto start = BeginFrame(buffer);
+        Client::EncodeNumber(request.lookups.size(), buffer);
+        for (const auto& key: request.lookups) {
+            Client::EncodeString(key, buffer);
+        }
+        Client::EncodeNumber(request.stores.size(), buffer);
+        for (const auto& store: request.stores) {
+            Client::EncodeString(store.first, buffer);
+            Client::EncodeString(store.second, buffer);
+        }
+        EndFrame(start, buffer);
+    }
+
+    bool DecodeRequest(const std::string& payload, Request& request) {
+        size_t offset;
+        size_t numLookups;
+        if (
+            !CheckVersion(payload, offset)
+            || !DecodeCount(payload, offset, numLookups)
+        ) {
+            return false;
+        }
+        request.lookups.resize(numLookups);
+        for (auto& key: request.lookups) {
+            if (!DecodeKey(payload, offset, key)) {
+                return false;
+            }
+        }
+        size_t numStores;
+        if (!DecodeCount(payload, offset, numStores)) {
+            return false;
+        }
+        request.stores.resize(numStores);
+        for (auto& store: request.stores) {
+            if (
+                !DecodeKey(payload, offset, store.first)
+                || !DecodeDerivedKey(payload, offset, store.second)
+                || store.second.empty()
+            ) {
+                return false;
+            }
+        }
+        return (offset == payload.length());
+    }
+
+    void EncodeResponse(
+        const std::vector< std::string >& results,
+        std::string& buffer
+    ) {
+        const auto start = BeginFrame(buffer);
+        Client::EncodeNumber(results.size(), buffer);
+        for (const auto& result: results) {
+            Client::EncodeString(result, buffer);
+        }
+        EndFrame(start, buffer);
+    }
+
+    bool DecodeResponse(
+        const std::string& payload,
+        std::vector< std::string >& results
+    ) {
+        size_t offset;
+        size_t numResults;
+        if (
+            !CheckVersion(payload, offset)
+            || !DecodeCount(payload, offset, numResults)
+        ) {
+            return false;
+        }
+        results.resize(numResults);
+        for (auto& result: results) {
+            if (!DecodeDerivedKey(payload, offset, result)) {
+                return false;
+            }
+        }
+        return (offset == payload.length());
+    }
+
+    size_t DecodeFrameLength(const uint8_t* header) {
+        size_t length = 0;
+        for (size_t i = 0; i < FRAME_HEADER_LENGTH; ++i) {
+            length = (length << 8) | header[i];
+        }
+        return length;
+    }
+
+#ifndef _WIN32
+    bool IsPeerSameUser(int socket) {
+#if defined(SO_PEERCRED)
+        struct ucred credentials;
+        socklen_t credentialsLength = sizeof(credentials);
+        if (
+            getsockopt(
+                socket,
+                SOL_SOCKET,
+                SO_PEERCRED,
+                &credentials,
+                &credentialsLength
+            ) != 0
+        ) {
+            return false;
+        }
+        return (credentials.uid == geteuid());
+#else
+        uid_t user;
+        gid_t group;
+        if (getpeereid(socket, &user, &group) != 0) {
+            return false;
+        }
+        return (user == geteuid());
+#endif
+    }
+#endif
+
+}
+}
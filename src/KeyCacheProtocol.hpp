@@ -0,0 +1,195 @@
+#pragma once
+
+/**
+ * @file KeyCacheProtocol.hpp
+ *
+ * This module declares the functions used to encode and decode the
+ * messages exchanged between the key cache client and daemon.
+ *
+ * A message is framed by its length, as four bytes, most significant
+ * first, followed by the payload, which starts with the version of the
+ * protocol.  The client sends requests, each holding a batch of keys
+ * to look up and a batch of derived keys to store, and the daemon
+ * answers each request with a response holding what it found for each
+ * key looked up (empty if nothing), in the same order.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Sasl {
+namespace KeyCache {
+
+    /**
+     * This is the version of the protocol spoken by the client
+     * and daemon.  Messages of other versions are refused.
+     */
+    constexpr uint8_t PROTOCOL_VERSION = 1;
+
+    /**
+     * This is the number of bytes in the length which frames
+     * each message.
+     */
+    constexpr size_t FRAME_HEADER_LENGTH = 4;
+
+    /**
+     * This is the greatest number of bytes allowed in the payload
+     * of a message.
+     */
+    constexpr size_t MAX_FRAME_LENGTH = 65536;
+
+    /**
+     * This is the size of the fingerprint of the password in each key.
+     */
+    constexpr size_t FINGERPRINT_LENGTH = 32;
+
+    /**
+     * This is the greatest number of bytes allowed in a key.
+     */
+    constexpr size_t MAX_KEY_LENGTH = 512;
+
+    /**
+     * This holds the keys to look up and the derived keys to store
+     * in one request from the client.
+     */
+    struct Request {
+        /**
+         * These are the keys to look up.
+         */
+        std::vector< std::string > lookups;
+
+        /**
+         * These are the keys and derived keys to store.
+         */
+        std::vector< std::pair< std::string, std::string > > stores;
+    };
+
+    /**
+     * Build the key under which the salted password derived with the
+     * given parameters is cached.
+     *
+     * @param[in] mechanismName
+     *     This is the name of the SCRAM mechanism, which selects
+     *     the hash function.
+     *
+     * @param[in] salt
+     *     This points to the salt.
+     *
+     * @param[in] saltLength
+     *     This is the number of bytes in the salt.
+     *
+     * @param[in] iterations
+     *     This is the iteration count.
+     *
+     * @param[in] fingerprint
+     *     This points to the fingerprint of the password,
+     *     which has FINGERPRINT_LENGTH bytes.
+     *
+     * @return
+     *     The key is returned.
+     */
+    std::string MakeKey(
+        const std::string& mechanismName,
+        const uint8_t* salt,
+        size_t saltLength,
+        size_t iterations,
+        const uint8_t* fingerprint
+    );
+
+    /**
+     * Append the given request, framed, to the given buffer.
+     *
+     * @param[in] request
+     *     This is the request to encode.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer to which to append the request.
+     */
+    void EncodeRequest(const Request& request, std::string& buffer);
+
+    /**
+     * Decode the given request payload (not including the frame header).
+     *
+     * @param[in] payload
+     *     This is the payload to decode.
+     *
+     * @param[out] request
+     *     This is where to store the decoded request.
+     *
+     * @return
+     *     An indication of whether or not the request was decoded
+     *     is returned.
+     */
+    bool DecodeRequest(const std::string& payload, Request& request);
+
+    /**
+     * Append the given response, framed, to the given buffer.
+     *
+     * @param[in] results
+     *     These are the derived keys found for the keys looked up,
+     *     each empty if nothing was found.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer to which to append the response.
+     */
+    void EncodeResponse(
+        const std::vector< std::string >& results,
+        std::string& buffer
+    );
+
+    /**
+     * Decode the given response payload (not including the frame header).
+     *
+     * @param[in] payload
+     *     This is the payload to decode.
+     *
+     * @param[out] results
+     *     This is where to store the derived keys found for the keys
+     *     looked up, each empty if nothing was found.
+     *
+     * @return
+     *     An indication of whether or not the response was decoded
+     *     is returned.
+     */
+    bool DecodeResponse(
+        const std::string& payload,
+        std::vector< std::string >& results
+    );
+
+    /**
+     * Return the length of the payload of the message framed
+     * by the given header.
+     *
+     * @param[in] header
+     *     This points to the FRAME_HEADER_LENGTH bytes of the header.
+     *
+     * @return
+     *     The length of the payload is returned.
+     */
+    size_t DecodeFrameLength(const uint8_t* header);
+
+#ifndef _WIN32
+    /**
+     * Check that the process at the other end of the given connected
+     * Unix-domain socket runs as the same user as this one.  Nothing
+     * secret is to be exchanged with a peer which fails this check,
+     * since anyone on the host might have made the socket.
+     *
+     * @param[in] socket
+     *     This is the connected socket whose peer to check.
+     *
+     * @return
+     *     An indication of whether or not the peer runs as the same
+     *     user is returned.  It's false if the peer's user can't be
+     *     found out.
+     */
+    bool IsPeerSameUser(int socket);
+#endif
+
+}
+}
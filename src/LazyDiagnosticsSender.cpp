@@ -0,0 +1,42 @@
+/**
+ * @file LazyDiagnosticsSender.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::LazyDiagnosticsSender class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "LazyDiagnosticsSender.hpp"
+
+namespace Sasl {
+
+    LazyDiagnosticsSender::LazyDiagnosticsSender(const char* name)
+        : name_(name)
+    {
+    }
+
+    SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate LazyDiagnosticsSender::SubscribeToDiagnostics(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+        size_t minLevel
+    ) {
+        if (sender_ == nullptr) {
+            sender_.reset(new SystemAbstractions::DiagnosticsSender(name_));
+        }
+        return sender_->SubscribeToDiagnostics(delegate, minLevel);
+    }
+
+    bool LazyDiagnosticsSender::IsActive() const {
+        return (sender_ != nullptr);
+    }
+
+    void LazyDiagnosticsSender::SendDiagnosticInformationString(
+        size_t level,
+        const std::string& message
+    ) const {
+        if (sender_ != nullptr) {
+            sender_->SendDiagnosticInformationString(level, message);
+        }
+    }
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+/**
+ * @file LazyDiagnosticsSender.hpp
+ *
+ * This module declares the Sasl::LazyDiagnosticsSender class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+#include <SystemAbstractions/DiagnosticsSender.hpp>
+
+namespace Sasl {
+
+    /**
+     * This wraps a SystemAbstractions::DiagnosticsSender which is made
+     * only when the first subscription to diagnostic messages is formed.
+     * Until then, nothing is allocated, and messages are dropped.
+     */
+    class LazyDiagnosticsSender {
+        // Public methods
+    public:
+        /**
+         * This constructor sets up the sender, without making the
+         * wrapped sender.
+         *
+         * @param[in] name
+         *     This is the name to give the wrapped sender when it's made.
+         *     It must remain valid for the lifetime of the instance.
+         */
+        explicit LazyDiagnosticsSender(const char* name);
+
+        /**
+         * This method forms a new subscription to diagnostic
+         * messages published by the sender, making the wrapped sender
+         * if it hasn't been made already.
+         *
+         * @param[in] delegate
+         *     This is the function to call to deliver messages
+         *     to the subscriber.
+         *
+         * @param[in] minLevel
+         *     This is the minimum level of message that this subscriber
+         *     desires to receive.
+         *
+         * @return
+         *     A function is returned which may be called
+         *     to terminate the subscription.
+         */
+        SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
+            SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+            size_t minLevel
+        );
+
+        /**
+         * Return an indication of whether or not any subscription to
+         * diagnostic messages was ever formed.  If not, callers may skip
+         * building messages, since they would be dropped.
+         *
+         * @return
+         *     An indication of whether or not any subscription to
+         *     diagnostic messages was ever formed is returned.
+         */
+        bool IsActive() const;
+
+        /**
+         * Publish the given diagnostic message, if any subscription to
+         * diagnostic messages was ever formed.
+         *
+         * @param[in] level
+         *     This is the level of the message.
+         *
+         * @param[in] message
+         *     This is the message to publish.
+         */
+        void SendDiagnosticInformationString(
+            size_t level,
+            const std::string& message
+        ) const;
+
+        // Private properties
+    private:
+        /**
+         * This is the name to give the wrapped sender when it's made.
+         */
+        const char* name_;
+
+        /**
+         * This is the wrapped sender, once it's made.
+         */
+        std::unique_ptr< SystemAbstractions::DiagnosticsSender > sender_;
+    };
+
+}
@@ -0,0 +1,307 @@
+/**
+ * @file Md5.cpp
+ *
+ * This module contains the implementation of the MD5 hash function
+ * built into the library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Md5Compress.hpp"
+#include "Wipe.hpp"
+
+#include <algorithm>
+#include <Sasl/Md5.hpp>
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+
+    /**
+     * These are the additive constants of the MD5 compression function,
+     * derived from the sine function.
+     */
+    const uint32_t MD5_K[64] = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee,
+        0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+        0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+        0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+        0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
+        0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
+        0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+        0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+        0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+        0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05,
+        0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039,
+        0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+        0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+        0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+    };
+
+    /**
+     * These are the numbers of bits by which the MD5 compression function
+     * rotates in each round, four per group of sixteen rounds.
+     */
+    const int MD5_SHIFTS[16] = {
+        7, 12, 17, 22,
+        5, 9, 14, 20,
+        4, 11, 16, 23,
+        6, 10, 15, 21,
+    };
+
+    /**
+     * This is the size, in bytes, of the blocks processed by the
+     * compression function of the MD5 hash function.
+     */
+    constexpr size_t BLOCK_SIZE = 64;
+
+    /**
+     * Rotate the given 32-bit word left by the given number of bits.
+     *
+     * @param[in] x
+     *     This is the word to rotate.
+     *
+     * @param[in] n
+     *     This is the number of bits by which to rotate the word.
+     *
+     * @return
+     *     The rotated word is returned.
+     */
+    inline uint32_t RotateLeft(uint32_t x, int n) {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    /**
+     * Read a little-endian 32-bit word from the given location.
+     *
+     * @param[in] p
+     *     This points to the word to read.
+     *
+     * @return
+     *     The word read is returned.
+     */
+    inline uint32_t ReadLittleEndian(const uint8_t* p) {
+        return (
+            (uint32_t)p[0]
+            | ((uint32_t)p[1] << 8)
+            | ((uint32_t)p[2] << 16)
+            | ((uint32_t)p[3] << 24)
+        );
+    }
+
+    /**
+     * Apply one round of the MD5 compression function.
+     *
+     * @param[in,out] a
+     *     This is the working variable A.
+     *
+     * @param[in,out] b
+     *     This is the working variable B.
+     *
+     * @param[in,out] c
+     *     This is the working variable C.
+     *
+     * @param[in,out] d
+     *     This is the working variable D.
+     *
+     * @param[in] f
+     *     This is the result of the round function.
+     *
+     * @param[in] i
+     *     This is the number of the round.
+     *
+     * @param[in] m
+     *     This is the message word for the round.
+     */
+    inline void Md5Round(
+        uint32_t& a,
+        uint32_t& b,
+        uint32_t& c,
+        uint32_t& d,
+        uint32_t f,
+        size_t i,
+        uint32_t m
+    ) {
+        const auto temp = d;
+        d = c;
+        c = b;
+        b += RotateLeft(a + f + MD5_K[i] + m, MD5_SHIFTS[(i / 16) * 4 + (i % 4)]);
+        a = temp;
+    }
+
+    /**
+     * This is a hash context which computes an MD5 digest.
+     */
+    class Md5Context
+        : public Sasl::HashContext
+    {
+        // Public methods
+    public:
+        /**
+         * This constructor sets up the context in its initial state.
+         */
+        Md5Context() {
+            (void)memcpy(state_, Sasl::Md5Compress::INITIAL_STATE, sizeof(state_));
+        }
+
+        /**
+         * This is the destructor.  The state is wiped, since it may
+         * hold keyed hash states (HMAC padded keys) or other secrets.
+         */
+        ~Md5Context() noexcept {
+            Sasl::Wipe(state_, sizeof(state_));
+            Sasl::Wipe(buffer_, sizeof(buffer_));
+        }
+
+        Md5Context(const Md5Context&) = default;
+        Md5Context& operator=(const Md5Context&) = default;
+
+        // Sasl::HashContext
+    public:
+        virtual std::unique_ptr< Sasl::HashContext > Clone() const override {
+            return std::unique_ptr< Sasl::HashContext >(new Md5Context(*this));
+        }
+
+        virtual void CopyFrom(const Sasl::HashContext& other) override {
+            *this = static_cast< const Md5Context& >(other);
+        }
+
+        virtual void Update(const uint8_t* data, size_t length) override {
+            totalLength_ += length;
+            if (bufferLength_ > 0) {
+                const auto numToBuffer = std::min(length, BLOCK_SIZE - bufferLength_);
+                (void)memcpy(buffer_ + bufferLength_, data, numToBuffer);
+                bufferLength_ += numToBuffer;
+                data += numToBuffer;
+                length -= numToBuffer;
+                if (bufferLength_ < BLOCK_SIZE) {
+                    return;
+                }
+                Sasl::Md5Compress::Compress(state_, buffer_, 1);
+                bufferLength_ = 0;
+            }
+            const auto numBlocks = length / BLOCK_SIZE;
+            if (numBlocks > 0) {
+                Sasl::Md5Compress::Compress(state_, data, numBlocks);
+                data += numBlocks * BLOCK_SIZE;
+                length -= numBlocks * BLOCK_SIZE;
+            }
+            (void)memcpy(buffer_, data, length);
+            bufferLength_ = length;
+        }
+
+        virtual void Final(uint8_t* digest) override {
+            Sasl::Md5Compress::Finish(
+                state_,
+                buffer_,
+                bufferLength_,
+                totalLength_ - bufferLength_,
+                digest
+            );
+        }
+
+        // Private properties
+    private:
+        /**
+         * This is the intermediate hash value.
+         */
+        uint32_t state_[4];
+
+        /**
+         * This holds data absorbed but not yet compressed, because
+         * it doesn't yet fill a block.
+         */
+        uint8_t buffer_[BLOCK_SIZE];
+
+        /**
+         * This is the number of bytes held in the buffer.
+         */
+        size_t bufferLength_ = 0;
+
+        /**
+         * This is the total number of bytes absorbed.
+         */
+        uint64_t totalLength_ = 0;
+    };
+
+}
+
+namespace Sasl {
+
+    namespace Md5Compress {
+
+        const uint32_t INITIAL_STATE[4] = {
+            0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476,
+        };
+
+        void Compress(uint32_t* state, const uint8_t* blocks, size_t numBlocks) {
+            for (size_t block = 0; block < numBlocks; ++block, blocks += BLOCK_SIZE) {
+                uint32_t m[16];
+                for (size_t i = 0; i < 16; ++i) {
+                    m[i] = ReadLittleEndian(blocks + 4 * i);
+                }
+                auto a = state[0];
+                auto b = state[1];
+                auto c = state[2];
+                auto d = state[3];
+                for (size_t i = 0; i < 16; ++i) {
+                    Md5Round(a, b, c, d, (b & c) | (~b & d), i, m[i]);
+                }
+                for (size_t i = 16; i < 32; ++i) {
+                    Md5Round(a, b, c, d, (d & b) | (~d & c), i, m[(5 * i + 1) % 16]);
+                }
+                for (size_t i = 32; i < 48; ++i) {
+                    Md5Round(a, b, c, d, b ^ c ^ d, i, m[(3 * i + 5) % 16]);
+                }
+                for (size_t i = 48; i < 64; ++i) {
+                    Md5Round(a, b, c, d, c ^ (b | ~d), i, m[(7 * i) % 16]);
+                }
+                state[0] += a;
+                state[1] += b;
+                state[2] += c;
+                state[3] += d;
+            }
+        }
+
+        void Finish(
+            uint32_t* state,
+            const uint8_t* data,
+            size_t length,
+            uint64_t prefixLength,
+            uint8_t* digest
+        ) {
+            const uint64_t totalBits = (prefixLength + length) * 8;
+            const auto numBlocks = length / BLOCK_SIZE;
+            Compress(state, data, numBlocks);
+            data += numBlocks * BLOCK_SIZE;
+            length -= numBlocks * BLOCK_SIZE;
+            uint8_t buffer[BLOCK_SIZE];
+            (void)memcpy(buffer, data, length);
+            buffer[length++] = 0x80;
+            if (length > BLOCK_SIZE - 8) {
+                (void)memset(buffer + length, 0, BLOCK_SIZE - length);
+                Compress(state, buffer, 1);
+                length = 0;
+            }
+            (void)memset(buffer + length, 0, BLOCK_SIZE - 8 - length);
+            for (size_t i = 0; i < 8; ++i) {
+                buffer[BLOCK_SIZE - 8 + i] = (uint8_t)(totalBits >> (8 * i));
+            }
+            Compress(state, buffer, 1);
+            for (size_t i = 0; i < 4; ++i) {
+                digest[4 * i] = (uint8_t)state[i];
+                digest[4 * i + 1] = (uint8_t)(state[i] >> 8);
+                digest[4 * i + 2] = (uint8_t)(state[i] >> 16);
+                digest[4 * i + 3] = (uint8_t)(state[i] >> 24);
+            }
+        }
+
+    }
+
+    std::unique_ptr< HashContext > MakeMd5Context() {
+        return std::unique_ptr< HashContext >(new Md5Context());
+    }
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * @file Md5Compress.hpp
+ *
+ * This module declares the compression function of the MD5 hash function,
+ * for use by code which keeps MD5 states of its own (such as the padded
+ * keys of an HMAC) rather than hash contexts.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Sasl {
+namespace Md5Compress {
+
+    /**
+     * These are the initial hash values of the MD5 hash function.
+     */
+    extern const uint32_t INITIAL_STATE[4];
+
+    /**
+     * Apply the compression function of the MD5 hash function to one
+     * or more consecutive 64-byte blocks.
+     *
+     * @param[in,out] state
+     *     This is the intermediate hash value to update.
+     *
+     * @param[in] blocks
+     *     This points to the blocks to compress.
+     *
+     * @param[in] numBlocks
+     *     This is the number of blocks to compress.
+     */
+    void Compress(uint32_t* state, const uint8_t* blocks, size_t numBlocks);
+
+    /**
+     * Absorb the last of a message, pad it, and produce its digest.
+     *
+     * @param[in,out] state
+     *     This is the intermediate hash value after all whole blocks
+     *     before the given data were compressed.  It's left in an
+     *     unspecified state.
+     *
+     * @param[in] data
+     *     This points to the rest of the message, which may be
+     *     any length.
+     *
+     * @param[in] length
+     *     This is the number of bytes in the rest of the message.
+     *
+     * @param[in] prefixLength
+     *     This is the number of bytes of the message which were already
+     *     compressed into the state.  It must be a multiple of 64.
+     *
+     * @param[out] digest
+     *     This is where to store the 16-byte digest.
+     */
+    void Finish(
+        uint32_t* state,
+        const uint8_t* data,
+        size_t length,
+        uint64_t prefixLength,
+        uint8_t* digest
+    );
+
+}
+}
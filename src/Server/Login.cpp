@@ -0,0 +1,158 @@
+/**
+ * @file Login.cpp
+ *
+ * This module contains the implementation of the Sasl::Server::Login class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../LazyDiagnosticsSender.hpp"
+
+#include <Sasl/Server/Login.hpp>
+#include <string>
+
+namespace {
+
+    /**
+     * This is the challenge which asks the client for its username.
+     */
+    const std::string USERNAME_CHALLENGE = "Username:";
+
+    /**
+     * This is the challenge which asks the client for its password.
+     */
+    const std::string PASSWORD_CHALLENGE = "Password:";
+
+}
+
+namespace Sasl {
+namespace Server {
+
+    /**
+     * This contains the private properties of a Login instance.
+     */
+    struct Login::Impl {
+        // Properties
+
+        /**
+         * This is a helper object used to generate and publish
+         * diagnostic messages.
+         */
+        LazyDiagnosticsSender diagnosticsSender;
+
+        /**
+         * This is used to check the passwords given by clients.
+         */
+        std::shared_ptr< PasswordVerifier > verifier;
+
+        /**
+         * This is the username the client gave.
+         */
+        std::string authenticationIdentity;
+
+        /**
+         * This indicates whether or not the server asked the client
+         * for its username.
+         */
+        bool askedForUsername = false;
+
+        /**
+         * This indicates whether or not the exchange is over.
+         */
+        bool done = false;
+
+        /**
+         * This indicates whether or not the client was authenticated.
+         */
+        bool succeeded = false;
+
+        // Methods
+
+        /**
+         * This is the default constructor of the structure
+         */
+        Impl()
+            : diagnosticsSender("Login")
+        {
+        }
+    };
+
+    Login::~Login() noexcept = default;
+    Login::Login(Login&&) noexcept = default;
+    Login& Login::operator=(Login&&) noexcept = default;
+
+    Login::Login(std::shared_ptr< PasswordVerifier > verifier)
+        : impl_(new Impl)
+    {
+        impl_->verifier = verifier;
+    }
+
+    SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate Login::SubscribeToDiagnostics(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+        size_t minLevel
+    ) {
+        return impl_->diagnosticsSender.SubscribeToDiagnostics(delegate, minLevel);
+    }
+
+    void Login::Reset() {
+        impl_->authenticationIdentity.clear();
+        impl_->askedForUsername = false;
+        impl_->done = false;
+        impl_->succeeded = false;
+    }
+
+    std::string Login::Proceed(const std::string& message) {
+        if (impl_->done) {
+            return "";
+        }
+        if (impl_->authenticationIdentity.empty()) {
+            if (message.empty()) {
+                if (impl_->askedForUsername) {
+                    impl_->done = true;
+                    return "";
+                }
+                impl_->askedForUsername = true;
+                return USERNAME_CHALLENGE;
+            }
+            impl_->authenticationIdentity = message;
+            return PASSWORD_CHALLENGE;
+        }
+        impl_->succeeded = (
+            !message.empty()
+            && impl_->verifier->Verify(
+                impl_->authenticationIdentity,
+                message.data(),
+                message.length()
+            )
+        );
+        impl_->done = true;
+        if (impl_->diagnosticsSender.IsActive()) {
+            impl_->diagnosticsSender.SendDiagnosticInformationString(
+                0,
+                (
+                    "LOGIN authentication of '" + impl_->authenticationIdentity
+                    + (impl_->succeeded ? "' succeeded" : "' failed")
+                )
+            );
+        }
+        return "";
+    }
+
+    bool Login::Done() {
+        return impl_->done;
+    }
+
+    bool Login::Succeeded() {
+        return impl_->succeeded;
+    }
+
+    const std::string& Login::GetAuthenticationIdentity() {
+        return impl_->authenticationIdentity;
+    }
+
+    const std::string& Login::GetAuthorizationIdentity() {
+        return impl_->authenticationIdentity;
+    }
+
+}
+}
@@ -0,0 +1,373 @@
+/**
+ * @file PasswordVerifier.cpp
+ *
+ * This module contains the implementation of the
+ * Sasl::Server::PasswordVerifier class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../Hi.hpp"
+#include "../Hmac.hpp"
+#include "../Wipe.hpp"
+
+#include <mutex>
+#include <Sasl/Server/PasswordVerifier.hpp>
+#include <Sasl/Sha.hpp>
+#include <stdint.h>
+#include <string.h>
+#include <SystemAbstractions/CryptoRandom.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the size, in bytes, of the keys derived from passwords,
+     * and of the keyed hashes held in the cache.
+     */
+    constexpr size_t DIGEST_LENGTH = Sasl::SHA256_DIGEST_SIZE / 8;
+
+    /**
+     * This is used to make the contexts of the hash function on which
+     * the derived keys and cache hashes are based.
+     */
+    const Sasl::HashContextFactory HASH_CONTEXT_FACTORY = []{
+        return Sasl::MakeSha256Context();
+    };
+
+    /**
+     * This is the number of iterations used to derive a key for an
+     * unknown identity (or a broken record) until a proper record has
+     * been seen, after which that record's iteration count is used.
+     */
+    constexpr size_t DEFAULT_DUMMY_ITERATIONS = 4096;
+
+    /**
+     * This is the salt used to derive a key for an unknown identity
+     * (or a broken record).
+     */
+    const std::vector< uint8_t > DUMMY_SALT(16, 0);
+
+    /**
+     * Compare the given byte sequences in time which depends only on
+     * their length, so as not to reveal where they first differ.
+     *
+     * @param[in] a
+     *     This points to the first sequence to compare.
+     *
+     * @param[in] b
+     *     This points to the second sequence to compare.
+     *
+     * @param[in] length
+     *     This is the number of bytes to compare.
+     *
+     * @return
+     *     An indication of whether or not the sequences are equal
+     *     is returned.
+     */
+    bool ConstantTimeEquals(const uint8_t* a, const uint8_t* b, size_t length) {
+        uint8_t difference = 0;
+        for (size_t i = 0; i < length; ++i) {
+            difference |= a[i] ^ b[i];
+        }
+        return (difference == 0);
+    }
+
+    /**
+     * Derive a key from the given password.
+     *
+     * @param[in] password
+     *     This points to the password from which to derive the key.
+     *
+     * @param[in] passwordLength
+     *     This is the number of bytes in the password.
+     *
+     * @param[in] salt
+     *     This is the salt to mix into the derived key.
+     *
+     * @param[in] iterations
+     *     This is the number of iterations to use to derive the key.
+     *
+     * @param[out] derivedKey
+     *     This is where to store the derived key.  It must have room
+     *     for DIGEST_LENGTH bytes.
+     */
+    void DeriveKey(
+        const char* password,
+        size_t passwordLength,
+        const std::vector< uint8_t >& salt,
+        size_t iterations,
+        uint8_t* derivedKey
+    ) {
+        const Sasl::HmacKey key(
+            HASH_CONTEXT_FACTORY,
+            Sasl::SHA256_BLOCK_SIZE,
+            DIGEST_LENGTH,
+            (const uint8_t*)password,
+            passwordLength
+        );
+        (void)Sasl::Hi(key, salt.data(), salt.size(), iterations, derivedKey);
+    }
+
+    /**
+     * Compute the keyed hash under which a check is cached.
+     *
+     * @param[in] cacheKey
+     *     This is the HMAC state keyed with the cache's random key.
+     *
+     * @param[in] authenticationIdentity
+     *     This is the identity whose password is checked.
+     *
+     * @param[in] password
+     *     This points to the password checked.
+     *
+     * @param[in] passwordLength
+     *     This is the number of bytes in the password.
+     *
+     * @param[in] record
+     *     This is the record stored for the password.
+     *
+     * @param[out] hash
+     *     This is where to store the keyed hash.  It must have room
+     *     for DIGEST_LENGTH bytes.
+     */
+    void HashCheck(
+        const Sasl::HmacKey& cacheKey,
+        const std::string& authenticationIdentity,
+        const char* password,
+        size_t passwordLength,
+        const Sasl::Server::PasswordRecord& record,
+        uint8_t* hash
+    ) {
+        const uint8_t separator = 0;
+        const auto context = cacheKey.Begin();
+        context->Update(
+            (const uint8_t*)authenticationIdentity.data(),
+            authenticationIdentity.length()
+        );
+        context->Update(&separator, 1);
+        context->Update((const uint8_t*)password, passwordLength);
+        context->Update(&separator, 1);
+        context->Update(record.derivedKey.data(), record.derivedKey.size());
+        cacheKey.Finish(*context, hash);
+    }
+
+    /**
+     * This is one entry in the cache of recent successful checks.
+     */
+    struct CacheEntry {
+        /**
+         * This is the keyed hash of the identity, password, and stored
+         * derived key which were checked.
+         */
+        uint8_t hash[DIGEST_LENGTH];
+
+        /**
+         * This is the time after which the entry is no longer used.
+         */
+        std::chrono::steady_clock::time_point expiration;
+    };
+
+}
+
+namespace Sasl {
+namespace Server {
+
+    PasswordRecord PasswordRecord::Derive(
+        const std::string& password,
+        const std::vector< uint8_t >& salt,
+        size_t iterations
+    ) {
+        PasswordRecord record;
+        record.salt = salt;
+        record.iterations = iterations;
+        record.derivedKey.resize(DIGEST_LENGTH);
+        DeriveKey(
+            password.data(),
+            password.length(),
+            salt,
+            iterations,
+            record.derivedKey.data()
+        );
+        return record;
+    }
+
+    /**
+     * This contains the private properties of a PasswordVerifier instance.
+     */
+    struct PasswordVerifier::Impl {
+        // Properties
+
+        /**
+         * This is used to look up the records stored for passwords.
+         */
+        RecordLookupDelegate recordLookupDelegate;
+
+        /**
+         * This is the HMAC state keyed with the random key used to hash
+         * the checks held in the cache, if the cache is enabled.
+         */
+        std::shared_ptr< const HmacKey > cacheKey;
+
+        /**
+         * These are the entries of the cache of recent successful checks.
+         * Each check has one place in the cache, selected by its hash,
+         * and replaces whatever was there.
+         */
+        std::vector< CacheEntry > cache;
+
+        /**
+         * This is how long each check stays in the cache.
+         */
+        std::chrono::steady_clock::duration cacheLifetime;
+
+        /**
+         * These are counts of what the verifier has done.
+         */
+        Statistics statistics;
+
+        /**
+         * This is the number of iterations used to derive a key for an
+         * unknown identity (or a broken record), so that turning it
+         * down takes as long as turning down a wrong password.  It's
+         * the iteration count of the latest proper record seen.
+         */
+        size_t dummyIterations = DEFAULT_DUMMY_ITERATIONS;
+
+        /**
+         * This is used to synchronize access to the cache and statistics.
+         */
+        mutable std::mutex mutex;
+
+        // Methods
+
+        /**
+         * Return the entry of the cache where the check with the
+         * given hash belongs.
+         *
+         * @param[in] hash
+         *     This is the keyed hash of the check.
+         *
+         * @return
+         *     The entry of the cache where the check belongs is returned.
+         */
+        CacheEntry& SelectEntry(const uint8_t* hash) {
+            uint64_t index = 0;
+            (void)memcpy(&index, hash, sizeof(index));
+            return cache[index % cache.size()];
+        }
+    };
+
+    PasswordVerifier::~PasswordVerifier() noexcept = default;
+    PasswordVerifier::PasswordVerifier(PasswordVerifier&&) noexcept = default;
+    PasswordVerifier& PasswordVerifier::operator=(PasswordVerifier&&) noexcept = default;
+
+    PasswordVerifier::PasswordVerifier(RecordLookupDelegate recordLookupDelegate)
+        : impl_(new Impl)
+    {
+        impl_->recordLookupDelegate = recordLookupDelegate;
+    }
+
+    void PasswordVerifier::EnableCache(
+        size_t capacity,
+        std::chrono::steady_clock::duration lifetime
+    ) {
+        std::shared_ptr< const HmacKey > cacheKey;
+        if (capacity > 0) {
+            static SystemAbstractions::CryptoRandom rng;
+            uint8_t key[DIGEST_LENGTH];
+            rng.Generate(key, sizeof(key));
+            cacheKey.reset(
+                new HmacKey(
+                    HASH_CONTEXT_FACTORY,
+                    SHA256_BLOCK_SIZE,
+                    DIGEST_LENGTH,
+                    key,
+                    sizeof(key)
+                )
+            );
+            Wipe(key, sizeof(key));
+        }
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->cacheKey = std::move(cacheKey);
+        impl_->cache.assign(capacity, CacheEntry());
+        impl_->cacheLifetime = lifetime;
+    }
+
+    bool PasswordVerifier::Verify(
+        const std::string& authenticationIdentity,
+        const char* password,
+        size_t passwordLength
+    ) {
+        PasswordRecord record;
+        const auto found = (
+            impl_->recordLookupDelegate(authenticationIdentity, record)
+            && (record.derivedKey.size() == DIGEST_LENGTH)
+        );
+        std::unique_lock< decltype(impl_->mutex) > lock(impl_->mutex);
+        ++impl_->statistics.verifications;
+        const auto cacheKey = impl_->cacheKey;
+        if (found) {
+            impl_->dummyIterations = record.iterations;
+        }
+        const auto dummyIterations = impl_->dummyIterations;
+        lock.unlock();
+        if (!found) {
+            // A key is derived anyway, so that an unknown identity
+            // takes as long to turn down as a wrong password, and
+            // doesn't reveal which identities exist.
+            uint8_t derivedKey[DIGEST_LENGTH];
+            DeriveKey(password, passwordLength, DUMMY_SALT, dummyIterations, derivedKey);
+            Wipe(derivedKey, sizeof(derivedKey));
+            lock.lock();
+            ++impl_->statistics.derivations;
+            return false;
+        }
+        uint8_t hash[DIGEST_LENGTH];
+        if (cacheKey != nullptr) {
+            HashCheck(*cacheKey, authenticationIdentity, password, passwordLength, record, hash);
+            lock.lock();
+
+            // The cache may have been replaced since the key was fetched,
+            // in which case the hash no longer applies.
+            if (impl_->cacheKey == cacheKey) {
+                const auto& entry = impl_->SelectEntry(hash);
+                if (
+                    ConstantTimeEquals(entry.hash, hash, DIGEST_LENGTH)
+                    && (std::chrono::steady_clock::now() < entry.expiration)
+                ) {
+                    ++impl_->statistics.cacheHits;
+                    return true;
+                }
+            }
+            lock.unlock();
+        }
+        uint8_t derivedKey[DIGEST_LENGTH];
+        DeriveKey(password, passwordLength, record.salt, record.iterations, derivedKey);
+        const auto verified = ConstantTimeEquals(
+            derivedKey,
+            record.derivedKey.data(),
+            DIGEST_LENGTH
+        );
+        Wipe(derivedKey, sizeof(derivedKey));
+        lock.lock();
+        ++impl_->statistics.derivations;
+        if (
+            verified
+            && (cacheKey != nullptr)
+            && (impl_->cacheKey == cacheKey)
+        ) {
+            auto& entry = impl_->SelectEntry(hash);
+            (void)memcpy(entry.hash, hash, DIGEST_LENGTH);
+            entry.expiration = std::chrono::steady_clock::now() + impl_->cacheLifetime;
+        }
+        return verified;
+    }
+
+    PasswordVerifier::Statistics PasswordVerifier::GetStatistics() const {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->statistics;
+    }
+
+}
+}
@@ -0,0 +1,195 @@
+/**
+ * @file Plain.cpp
+ *
+ * This module contains the implementation of the Sasl::Server::Plain class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../LazyDiagnosticsSender.hpp"
+
+#include <Sasl/Server/Plain.hpp>
+#include <string.h>
+#include <string>
+
+namespace Sasl {
+namespace Server {
+
+    /**
+     * This contains the private properties of a Plain instance.
+     */
+    struct Plain::Impl {
+        // Properties
+
+        /**
+         * This is a helper object used to generate and publish
+         * diagnostic messages.
+         */
+        LazyDiagnosticsSender diagnosticsSender;
+
+        /**
+         * This is used to check the passwords given by clients.
+         */
+        std::shared_ptr< PasswordVerifier > verifier;
+
+        /**
+         * This is used to decide whether or not a client may act as
+         * an authorization identity other than the one it proved.
+         */
+        AuthorizationDelegate authorizationDelegate;
+
+        /**
+         * This is the identity the client gave with its password.
+         */
+        std::string authenticationIdentity;
+
+        /**
+         * This is the identity the client acts as.
+         */
+        std::string authorizationIdentity;
+
+        /**
+         * This indicates whether or not the server has asked the client
+         * for its credentials, because they weren't in the initial
+         * response.
+         */
+        bool challenged = false;
+
+        /**
+         * This indicates whether or not the exchange is over.
+         */
+        bool done = false;
+
+        /**
+         * This indicates whether or not the client was authenticated.
+         */
+        bool succeeded = false;
+
+        // Methods
+
+        /**
+         * This is the default constructor of the structure
+         */
+        Impl()
+            : diagnosticsSender("Plain")
+        {
+        }
+
+        /**
+         * Check the credentials in the given message from the client.
+         *
+         * @param[in] message
+         *     This is the message from the client.
+         *
+         * @return
+         *     An indication of whether or not the client was
+         *     authenticated is returned.
+         */
+        bool Authenticate(const std::string& message) {
+            // message   = [authzid] UTF8NUL authcid UTF8NUL passwd
+            const auto begin = message.data();
+            const auto end = begin + message.length();
+            const auto authcid = (const char*)memchr(begin, 0, message.length());
+            if (authcid == nullptr) {
+                return false;
+            }
+            const auto passwd = (const char*)memchr(authcid + 1, 0, end - authcid - 1);
+            if (
+                (passwd == nullptr)
+                || (passwd == authcid + 1)
+                || (passwd + 1 == end)
+                || (memchr(passwd + 1, 0, end - passwd - 1) != nullptr)
+            ) {
+                return false;
+            }
+            authenticationIdentity.assign(authcid + 1, passwd);
+            authorizationIdentity.assign(begin, authcid);
+            if (!verifier->Verify(authenticationIdentity, passwd + 1, end - passwd - 1)) {
+                return false;
+            }
+            if (
+                authorizationIdentity.empty()
+                || (authorizationIdentity == authenticationIdentity)
+            ) {
+                authorizationIdentity = authenticationIdentity;
+                return true;
+            }
+            return (
+                (authorizationDelegate != nullptr)
+                && authorizationDelegate(authenticationIdentity, authorizationIdentity)
+            );
+        }
+    };
+
+    Plain::~Plain() noexcept = default;
+    Plain::Plain(Plain&&) noexcept = default;
+    Plain& Plain::operator=(Plain&&) noexcept = default;
+
+    Plain::Plain(std::shared_ptr< PasswordVerifier > verifier)
+        : impl_(new Impl)
+    {
+        impl_->verifier = verifier;
+    }
+
+    void Plain::SetAuthorizationDelegate(AuthorizationDelegate authorizationDelegate) {
+        impl_->authorizationDelegate = authorizationDelegate;
+    }
+
+    SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate Plain::SubscribeToDiagnostics(
+        SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate,
+        size_t minLevel
+    ) {
+        return impl_->diagnosticsSender.SubscribeToDiagnostics(delegate, minLevel);
+    }
+
+    void Plain::Reset() {
+        impl_->authenticationIdentity.clear();
+        impl_->authorizationIdentity.clear();
+        impl_->challenged = false;
+        impl_->done = false;
+        impl_->succeeded = false;
+    }
+
+    std::string Plain::Proceed(const std::string& message) {
+        if (impl_->done) {
+            return "";
+        }
+        if (
+            message.empty()
+            && !impl_->challenged
+        ) {
+            impl_->challenged = true;
+            return "";
+        }
+        impl_->succeeded = impl_->Authenticate(message);
+        impl_->done = true;
+        if (impl_->diagnosticsSender.IsActive()) {
+            impl_->diagnosticsSender.SendDiagnosticInformationString(
+                0,
+                (
+                    "PLAIN authentication of '" + impl_->authenticationIdentity
+                    + (impl_->succeeded ? "' succeeded" : "' failed")
+                )
+            );
+        }
+        return "";
+    }
+
+    bool Plain::Done() {
+        return impl_->done;
+    }
+
+    bool Plain::Succeeded() {
+        return impl_->succeeded;
+    }
+
+    const std::string& Plain::GetAuthenticationIdentity() {
+        return impl_->authenticationIdentity;
+    }
+
+    const std::string& Plain::GetAuthorizationIdentity() {
+        return impl_->authorizationIdentity;
+    }
+
+}
+}
@@ -0,0 +1,463 @@
+/**
+ * @file Sha.cpp
+ *
+ * This module contains the implementation of the SHA-1 and SHA-256 hash
+ * functions built into the library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Cpu.hpp"
+#include "ShaCompress.hpp"
+#include "Wipe.hpp"
+
+#include <algorithm>
+#include <Sasl/Sha.hpp>
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+
+    /**
+     * These are the initial hash values of the SHA-1 hash function.
+     */
+    const uint32_t SHA1_INITIAL_STATE[5] = {
+        0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0,
+    };
+
+    /**
+     * These are the initial hash values of the SHA-256 hash function.
+     */
+    const uint32_t SHA256_INITIAL_STATE[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+
+    /**
+     * These are the round constants of the SHA-256 hash function.
+     */
+    const uint32_t SHA256_K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+        0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+        0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+        0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+        0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+        0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+        0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+        0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+    };
+
+    /**
+     * This is the size, in bytes, of the blocks processed by the
+     * compression functions of the SHA-1 and SHA-256 hash functions.
+     */
+    constexpr size_t BLOCK_SIZE = 64;
+
+    /**
+     * Rotate the given 32-bit word left by the given number of bits.
+     *
+     * @param[in] x
+     *     This is the word to rotate.
+     *
+     * @param[in] n
+     *     This is the number of bits by which to rotate the word.
+     *
+     * @return
+     *     The rotated word is returned.
+     */
+    inline uint32_t RotateLeft(uint32_t x, int n) {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    /**
+     * Rotate the given 32-bit word right by the given number of bits.
+     *
+     * @param[in] x
+     *     This is the word to rotate.
+     *
+     * @param[in] n
+     *     This is the number of bits by which to rotate the word.
+     *
+     * @return
+     *     The rotated word is returned.
+     */
+    inline uint32_t RotateRight(uint32_t x, int n) {
+        return (x >> n) | (x << (32 - n));
+    }
+
+    /**
+     * Read a big-endian 32-bit word from the given location.
+     *
+     * @param[in] p
+     *     This points to the word to read.
+     *
+     * @return
+     *     The word read is returned.
+     */
+    inline uint32_t ReadBigEndian(const uint8_t* p) {
+        return (
+            ((uint32_t)p[0] << 24)
+            | ((uint32_t)p[1] << 16)
+            | ((uint32_t)p[2] << 8)
+            | (uint32_t)p[3]
+        );
+    }
+
+    /**
+     * Apply one round of the SHA-1 compression function.
+     *
+     * @param[in,out] a
+     *     This is the working variable A.
+     *
+     * @param[in,out] b
+     *     This is the working variable B.
+     *
+     * @param[in,out] c
+     *     This is the working variable C.
+     *
+     * @param[in,out] d
+     *     This is the working variable D.
+     *
+     * @param[in,out] e
+     *     This is the working variable E.
+     *
+     * @param[in] f
+     *     This is the result of the round function.
+     *
+     * @param[in] k
+     *     This is the round constant.
+     *
+     * @param[in] w
+     *     This is the message schedule word for the round.
+     */
+    inline void Sha1Round(
+        uint32_t& a,
+        uint32_t& b,
+        uint32_t& c,
+        uint32_t& d,
+        uint32_t& e,
+        uint32_t f,
+        uint32_t k,
+        uint32_t w
+    ) {
+        const auto temp = RotateLeft(a, 5) + f + e + k + w;
+        e = d;
+        d = c;
+        c = RotateLeft(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    /**
+     * This is an incremental computation of one of the SHA hash functions
+     * which share the same block size, padding, and word size (SHA-1 and
+     * SHA-256).  The hash functions differ only in their initial state,
+     * compression function, and digest length.
+     */
+    class ShaContext
+        : public Sasl::HashContext
+    {
+        // Public methods
+    public:
+        /**
+         * This constructor sets up the context in its initial state.
+         *
+         * @param[in] initialState
+         *     These are the initial hash values of the hash function.
+         *
+         * @param[in] stateWords
+         *     This is the number of words in the hash function's state,
+         *     which is also the number of words in its digest.
+         *
+         * @param[in] compress
+         *     This is the compression function of the hash function.
+         */
+        ShaContext(
+            const uint32_t* initialState,
+            size_t stateWords,
+            Sasl::ShaCompress::CompressFunction compress
+        )
+            : stateWords_(stateWords)
+            , compress_(compress)
+        {
+            (void)memcpy(state_, initialState, stateWords * sizeof(uint32_t));
+        }
+
+        /**
+         * This is the destructor.  The state is wiped, since it may
+         * hold keyed hash states (HMAC padded keys) or other secrets.
+         */
+        ~ShaContext() noexcept {
+            Sasl::Wipe(state_, sizeof(state_));
+            Sasl::Wipe(buffer_, sizeof(buffer_));
+        }
+
+        ShaContext(const ShaContext&) = default;
+        ShaContext& operator=(const ShaContext&) = default;
+
+        // Sasl::HashContext
+    public:
+        virtual std::unique_ptr< Sasl::HashContext > Clone() const override {
+            return std::unique_ptr< Sasl::HashContext >(new ShaContext(*this));
+        }
+
+        virtual void CopyFrom(const Sasl::HashContext& other) override {
+            *this = static_cast< const ShaContext& >(other);
+        }
+
+        virtual void Update(const uint8_t* data, size_t length) override {
+            totalLength_ += length;
+            if (bufferLength_ > 0) {
+                const auto numToBuffer = std::min(length, BLOCK_SIZE - bufferLength_);
+                (void)memcpy(buffer_ + bufferLength_, data, numToBuffer);
+                bufferLength_ += numToBuffer;
+                data += numToBuffer;
+                length -= numToBuffer;
+                if (bufferLength_ < BLOCK_SIZE) {
+                    return;
+                }
+                compress_(state_, buffer_, 1);
+                bufferLength_ = 0;
+            }
+            const auto numBlocks = length / BLOCK_SIZE;
+            if (numBlocks > 0) {
+                compress_(state_, data, numBlocks);
+                data += numBlocks * BLOCK_SIZE;
+                length -= numBlocks * BLOCK_SIZE;
+            }
+            (void)memcpy(buffer_, data, length);
+            bufferLength_ = length;
+        }
+
+        virtual void Final(uint8_t* digest) override {
+            const uint64_t totalBits = totalLength_ * 8;
+            buffer_[bufferLength_++] = 0x80;
+            if (bufferLength_ > BLOCK_SIZE - 8) {
+                (void)memset(buffer_ + bufferLength_, 0, BLOCK_SIZE - bufferLength_);
+                compress_(state_, buffer_, 1);
+                bufferLength_ = 0;
+            }
+            (void)memset(buffer_ + bufferLength_, 0, BLOCK_SIZE - 8 - bufferLength_);
+            for (size_t i = 0; i < 8; ++i) {
+                buffer_[BLOCK_SIZE - 1 - i] = (uint8_t)(totalBits >> (8 * i));
+            }
+            compress_(state_, buffer_, 1);
+            for (size_t i = 0; i < stateWords_; ++i) {
+                digest[4 * i] = (uint8_t)(state_[i] >> 24);
+                digest[4 * i + 1] = (uint8_t)(state_[i] >> 16);
+                digest[4 * i + 2] = (uint8_t)(state_[i] >> 8);
+                digest[4 * i + 3] = (uint8_t)state_[i];
+            }
+        }
+
+        // Private properties
+    private:
+        /**
+         * This is the intermediate hash value.
+         */
+        uint32_t state_[8];
+
+        /**
+         * This is the number of words in the hash function's state.
+         */
+        size_t stateWords_;
+
+        /**
+         * This is the compression function of the hash function.
+         */
+        Sasl::ShaCompress::CompressFunction compress_;
+
+        /**
+         * This holds data absorbed but not yet compressed, because
+         * it doesn't yet fill a block.
+         */
+        uint8_t buffer_[BLOCK_SIZE];
+
+        /**
+         * This is the number of bytes held in the buffer.
+         */
+        size_t bufferLength_ = 0;
+
+        /**
+         * This is the total number of bytes absorbed.
+         */
+        uint64_t totalLength_ = 0;
+    };
+
+    /**
+     * Select the compression function to use, given the requested
+     * implementation and the implementation that uses the Intel SHA
+     * Extensions, if it's available.
+     *
+     * @param[in] implementation
+     *     This is the requested implementation.
+     *
+     * @param[in] portable
+     *     This is the portable implementation.
+     *
+     * @param[in] shaExtensions
+     *     This is the implementation which uses the Intel SHA Extensions,
+     *     or nullptr if the library was built without it.
+     *
+     * @return
+     *     The compression function to use is returned.
+     */
+    Sasl::ShaCompress::CompressFunction SelectCompressFunction(
+        Sasl::ShaImplementation implementation,
+        Sasl::ShaCompress::CompressFunction portable,
+        Sasl::ShaCompress::CompressFunction shaExtensions
+    ) {
+        if (
+            (implementation != Sasl::ShaImplementation::Portable)
+            && (shaExtensions != nullptr)
+            && Sasl::Cpu::HasShaExtensions()
+        ) {
+            return shaExtensions;
+        }
+        return portable;
+    }
+
+}
+
+namespace Sasl {
+
+    namespace ShaCompress {
+
+        void Sha1Portable(uint32_t* state, const uint8_t* blocks, size_t numBlocks) {
+            for (size_t block = 0; block < numBlocks; ++block, blocks += BLOCK_SIZE) {
+                uint32_t w[80];
+                for (size_t i = 0; i < 16; ++i) {
+                    w[i] = ReadBigEndian(blocks + 4 * i);
+                }
+                for (size_t i = 16; i < 80; ++i) {
+                    w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+                }
+                auto a = state[0];
+                auto b = state[1];
+                auto c = state[2];
+                auto d = state[3];
+                auto e = state[4];
+                for (size_t i = 0; i < 20; ++i) {
+                    Sha1Round(a, b, c, d, e, (b & c) | (~b & d), 0x5A827999, w[i]);
+                }
+                for (size_t i = 20; i < 40; ++i) {
+                    Sha1Round(a, b, c, d, e, b ^ c ^ d, 0x6ED9EBA1, w[i]);
+                }
+                for (size_t i = 40; i < 60; ++i) {
+                    Sha1Round(a, b, c, d, e, (b & c) | (b & d) | (c & d), 0x8F1BBCDC, w[i]);
+                }
+                for (size_t i = 60; i < 80; ++i) {
+                    Sha1Round(a, b, c, d, e, b ^ c ^ d, 0xCA62C1D6, w[i]);
+                }
+                state[0] += a;
+                state[1] += b;
+                state[2] += c;
+                state[3] += d;
+                state[4] += e;
+            }
+        }
+
+        void Sha256Portable(uint32_t* state, const uint8_t* blocks, size_t numBlocks) {
+            for (size_t block = 0; block < numBlocks; ++block, blocks += BLOCK_SIZE) {
+                uint32_t w[64];
+                for (size_t i = 0; i < 16; ++i) {
+                    w[i] = ReadBigEndian(blocks + 4 * i);
+                }
+                for (size_t i = 16; i < 64; ++i) {
+                    const auto s0 = (
+                        RotateRight(w[i - 15], 7)
+                        ^ RotateRight(w[i - 15], 18)
+                        ^ (w[i - 15] >> 3)
+                    );
+                    const auto s1 = (
+                        RotateRight(w[i - 2], 17)
+                        ^ RotateRight(w[i - 2], 19)
+                        ^ (w[i - 2] >> 10)
+                    );
+                    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+                }
+                auto a = state[0];
+                auto b = state[1];
+                auto c = state[2];
+                auto d = state[3];
+                auto e = state[4];
+                auto f = state[5];
+                auto g = state[6];
+                auto h = state[7];
+                for (size_t i = 0; i < 64; ++i) {
+                    const auto s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+                    const auto ch = (e & f) ^ (~e & g);
+                    const auto temp1 = h + s1 + ch + SHA256_K[i] + w[i];
+                    const auto s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+                    const auto maj = (a & b) ^ (a & c) ^ (b & c);
+                    const auto temp2 = s0 + maj;
+                    h = g;
+                    g = f;
+                    f = e;
+                    e = d + temp1;
+                    d = c;
+                    c = b;
+                    b = a;
+                    a = temp1 + temp2;
+                }
+                state[0] += a;
+                state[1] += b;
+                state[2] += c;
+                state[3] += d;
+                state[4] += e;
+                state[5] += f;
+                state[6] += g;
+                state[7] += h;
+            }
+        }
+
+    }
+
+    bool IsShaExtensionsAvailable() {
+        return (
+            (ShaCompress::GetSha1ShaExtensions() != nullptr)
+            && Cpu::HasShaExtensions()
+        );
+    }
+
+    std::unique_ptr< HashContext > MakeSha1Context(
+        ShaImplementation implementation
+    ) {
+        return std::unique_ptr< HashContext >(
+            new ShaContext(
+                SHA1_INITIAL_STATE,
+                5,
+                SelectCompressFunction(
+                    implementation,
+                    ShaCompress::Sha1Portable,
+                    ShaCompress::GetSha1ShaExtensions()
+                )
+            )
+        );
+    }
+
+    std::unique_ptr< HashContext > MakeSha256Context(
+        ShaImplementation implementation
+    ) {
+        return std::unique_ptr< HashContext >(
+            new ShaContext(
+                SHA256_INITIAL_STATE,
+                8,
+                SelectCompressFunction(
+                    implementation,
+                    ShaCompress::Sha256Portable,
+                    ShaCompress::GetSha256ShaExtensions()
+                )
+            )
+        );
+    }
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+/**
+ * @file ShaCompress.hpp
+ *
+ * This module declares the compression functions of the SHA-1 and SHA-256
+ * hash functions.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Sasl {
+namespace ShaCompress {
+
+    /**
+     * This is the type of function which applies the compression function
+     * of a SHA hash function to one or more consecutive 64-byte blocks.
+     *
+     * @param[in,out] state
+     *     This is the intermediate hash value to update.
+     *
+     * @param[in] blocks
+     *     This points to the blocks to compress.
+     *
+     * @param[in] numBlocks
+     *     This is the number of blocks to compress.
+     */
+    typedef void (*CompressFunction)(
+        uint32_t* state,
+        const uint8_t* blocks,
+        size_t numBlocks
+    );
+
+    /**
+     * This is the implementation of the SHA-1 compression function
+     * written in portable C++.
+     */
+    void Sha1Portable(uint32_t* state, const uint8_t* blocks, size_t numBlocks);
+
+    /**
+     * This is the implementation of the SHA-256 compression function
+     * written in portable C++.
+     */
+    void Sha256Portable(uint32_t* state, const uint8_t* blocks, size_t numBlocks);
+
+    /**
+     * Return the implementation of the SHA-1 compression function which
+     * uses the Intel SHA Extensions, if the library was built with it.
+     *
+     * @note
+     *     The processor's support of the instructions is not checked.
+     *
+     * @return
+     *     The implementation of the SHA-1 compression function which uses
+     *     the Intel SHA Extensions is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the library was built without it.
+     */
+    CompressFunction GetSha1ShaExtensions();
+
+    /**
+     * Return the implementation of the SHA-256 compression function which
+     * uses the Intel SHA Extensions, if the library was built with it.
+     *
+     * @note
+     *     The processor's support of the instructions is not checked.
+     *
+     * @return
+     *     The implementation of the SHA-256 compression function which uses
+     *     the Intel SHA Extensions is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the library was built without it.
+     */
+    CompressFunction GetSha256ShaExtensions();
+
+}
+}
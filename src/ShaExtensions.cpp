@@ -0,0 +1,225 @@
+/**
+ * @file ShaExtensions.cpp
+ *
+ * This module contains the implementations of the SHA-1 and SHA-256
+ * compression functions which use the Intel SHA Extensions.  It is compiled
+ * with the code generation options needed for the instructions, so it must
+ * only be entered after checking that the processor supports them.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "ShaCompress.hpp"
+
+#if defined(__SHA__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define SASL_SHA_EXTENSIONS_AVAILABLE
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#ifdef SASL_SHA_EXTENSIONS_AVAILABLE
+
+    /**
+     * These are the round constants of the SHA-256 hash function.
+     */
+    alignas(16) const uint32_t SHA256_K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+        0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+        0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+        0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+        0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+        0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+        0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+        0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+    };
+
+    /**
+     * Apply one group of four rounds of the SHA-1 compression function.
+     * Each group consumes four message schedule words, kept in a ring of
+     * four registers.  While a group is consumed, the words of later groups
+     * are prepared.
+     *
+     * @param[in] Function
+     *     This selects the round function (0-3) used by the rounds.
+     *     It must be a constant because it's an immediate operand
+     *     of the instruction.
+     *
+     * @param[in] i
+     *     This is the index of the group of rounds (0-19).
+     *
+     * @param[in] block
+     *     This points to the block being compressed.
+     *
+     * @param[in] byteSwap
+     *     This is the shuffle control used to convert the words in the
+     *     block from big-endian.
+     *
+     * @param[in,out] abcd
+     *     These are the working variables A, B, C, and D.
+     *
+     * @param[in,out] e
+     *     These alternately hold the working variable E, added to the
+     *     message schedule words for the group.
+     *
+     * @param[in,out] w
+     *     This is the ring of message schedule words.
+     */
+    template< int Function > inline void Sha1Group(
+        size_t i,
+        const uint8_t* block,
+        __m128i byteSwap,
+        __m128i& abcd,
+        __m128i (&e)[2],
+        __m128i (&w)[4]
+    ) {
+        auto& current = e[i % 2];
+        auto& next = e[(i + 1) % 2];
+        if (i < 4) {
+            w[i] = _mm_shuffle_epi8(
+                _mm_loadu_si128((const __m128i*)(block + 16 * i)),
+                byteSwap
+            );
+        }
+        if (i == 0) {
+            current = _mm_add_epi32(current, w[0]);
+        } else {
+            current = _mm_sha1nexte_epu32(current, w[i % 4]);
+        }
+        next = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, current, Function);
+        if ((i >= 3) && (i <= 18)) {
+            w[(i + 1) % 4] = _mm_sha1msg2_epu32(w[(i + 1) % 4], w[i % 4]);
+        }
+        if ((i >= 2) && (i <= 17)) {
+            w[(i + 2) % 4] = _mm_xor_si128(w[(i + 2) % 4], w[i % 4]);
+        }
+        if ((i >= 1) && (i <= 16)) {
+            w[(i + 3) % 4] = _mm_sha1msg1_epu32(w[(i + 3) % 4], w[i % 4]);
+        }
+    }
+
+    void Sha1(uint32_t* state, const uint8_t* blocks, size_t numBlocks) {
+        const __m128i byteSwap = _mm_set_epi64x(
+            0x0001020304050607ULL,
+            0x08090a0b0c0d0e0fULL
+        );
+        __m128i abcd = _mm_shuffle_epi32(
+            _mm_loadu_si128((const __m128i*)state),
+            0x1B
+        );
+        __m128i e[2];
+        e[0] = _mm_set_epi32((int)state[4], 0, 0, 0);
+        for (size_t block = 0; block < numBlocks; ++block, blocks += 64) {
+            const auto abcdSave = abcd;
+            const auto eSave = e[0];
+            __m128i w[4];
+            for (size_t i = 0; i < 5; ++i) {
+                Sha1Group< 0 >(i, blocks, byteSwap, abcd, e, w);
+            }
+            for (size_t i = 5; i < 10; ++i) {
+                Sha1Group< 1 >(i, blocks, byteSwap, abcd, e, w);
+            }
+            for (size_t i = 10; i < 15; ++i) {
+                Sha1Group< 2 >(i, blocks, byteSwap, abcd, e, w);
+            }
+            for (size_t i = 15; i < 20; ++i) {
+                Sha1Group< 3 >(i, blocks, byteSwap, abcd, e, w);
+            }
+            e[0] = _mm_sha1nexte_epu32(e[0], eSave);
+            abcd = _mm_add_epi32(abcd, abcdSave);
+        }
+        _mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1B));
+        state[4] = (uint32_t)_mm_extract_epi32(e[0], 3);
+    }
+
+    void Sha256(uint32_t* state, const uint8_t* blocks, size_t numBlocks) {
+        const __m128i byteSwap = _mm_set_epi64x(
+            0x0c0d0e0f08090a0bULL,
+            0x0405060700010203ULL
+        );
+
+        // The instructions operate on the working variables arranged
+        // as ABEF and CDGH, rather than ABCD and EFGH.
+        const auto dcba = _mm_shuffle_epi32(
+            _mm_loadu_si128((const __m128i*)&state[0]),
+            0xB1
+        );
+        auto cdgh = _mm_shuffle_epi32(
+            _mm_loadu_si128((const __m128i*)&state[4]),
+            0x1B
+        );
+        auto abef = _mm_alignr_epi8(dcba, cdgh, 8);
+        cdgh = _mm_blend_epi16(cdgh, dcba, 0xF0);
+        for (size_t block = 0; block < numBlocks; ++block, blocks += 64) {
+            const auto abefSave = abef;
+            const auto cdghSave = cdgh;
+
+            // Each group of four rounds consumes four message schedule
+            // words, kept in a ring of four registers.
+            __m128i w[4];
+            for (size_t i = 0; i < 16; ++i) {
+                if (i < 4) {
+                    w[i] = _mm_shuffle_epi8(
+                        _mm_loadu_si128((const __m128i*)(blocks + 16 * i)),
+                        byteSwap
+                    );
+                } else {
+                    w[i % 4] = _mm_sha256msg2_epu32(
+                        _mm_add_epi32(
+                            _mm_sha256msg1_epu32(w[i % 4], w[(i + 1) % 4]),
+                            _mm_alignr_epi8(w[(i + 3) % 4], w[(i + 2) % 4], 4)
+                        ),
+                        w[(i + 3) % 4]
+                    );
+                }
+                auto message = _mm_add_epi32(
+                    w[i % 4],
+                    _mm_load_si128((const __m128i*)&SHA256_K[4 * i])
+                );
+                cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+                message = _mm_shuffle_epi32(message, 0x0E);
+                abef = _mm_sha256rnds2_epu32(abef, cdgh, message);
+            }
+            abef = _mm_add_epi32(abef, abefSave);
+            cdgh = _mm_add_epi32(cdgh, cdghSave);
+        }
+        const auto feba = _mm_shuffle_epi32(abef, 0x1B);
+        const auto dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+        _mm_storeu_si128((__m128i*)&state[0], _mm_blend_epi16(feba, dchg, 0xF0));
+        _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(dchg, feba, 8));
+    }
+
+#endif /* SASL_SHA_EXTENSIONS_AVAILABLE */
+
+}
+
+namespace Sasl {
+namespace ShaCompress {
+
+    CompressFunction GetSha1ShaExtensions() {
+#ifdef SASL_SHA_EXTENSIONS_AVAILABLE
+        return Sha1;
+#else
+        return nullptr;
+#endif
+    }
+
+    CompressFunction GetSha256ShaExtensions() {
+#ifdef SASL_SHA_EXTENSIONS_AVAILABLE
+        return Sha256;
+#else
+        return nullptr;
+#endif
+    }
+
+}
+}
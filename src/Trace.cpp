@@ -0,0 +1,377 @@
+/**
+ * @file Trace.cpp
+ *
+ * This module contains the implementation of the functions and classes
+ * used to record a timeline of the work done by the mechanisms.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <Sasl/Trace.hpp>
+#include <set>
+#include <stdio.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the name given to the gaps between the steps
+     * of an exchange.
+     */
+    constexpr const char* WAITING_SPAN_NAME = "waiting";
+
+    /**
+     * This is a span which was recorded.
+     */
+    struct RecordedSpan {
+        /**
+         * This is the name of the span.
+         */
+        const char* name;
+
+        /**
+         * This identifies the exchange of which the span is part,
+         * or is zero if it's not part of any exchange.
+         */
+        uint64_t exchangeId;
+
+        /**
+         * This is when the span began, in nanoseconds since
+         * recording started.
+         */
+        uint64_t start;
+
+        /**
+         * This is when the span ended, in nanoseconds since
+         * recording started.
+         */
+        uint64_t end;
+    };
+
+    /**
+     * This holds the spans recorded by one thread.
+     */
+    struct ThreadBuffer {
+        /**
+         * This numbers the thread, starting from one.
+         */
+        size_t threadIndex = 0;
+
+        /**
+         * These are the spans recorded by the thread.
+         */
+        std::vector< RecordedSpan > spans;
+
+        /**
+         * This is the number of spans which were dropped because
+         * the buffer was full.
+         */
+        size_t dropped = 0;
+
+        /**
+         * This is used to synchronize access to the buffer.  Only its
+         * own thread and Start or Stop ever use it, so it's almost
+         * never contended.
+         */
+        std::mutex mutex;
+    };
+
+    /**
+     * This holds the buffers of all threads which have recorded spans.
+     */
+    struct Registry {
+        /**
+         * These are the buffers of the threads which have recorded spans.
+         */
+        std::vector< std::shared_ptr< ThreadBuffer > > buffers;
+
+        /**
+         * This is the number to give the next thread to record a span.
+         */
+        size_t nextThreadIndex = 1;
+
+        /**
+         * This is used to synchronize access to the registry.
+         */
+        std::mutex mutex;
+    };
+
+    /**
+     * This indicates whether or not spans are being recorded.
+     */
+    std::atomic< bool > enabled(false);
+
+    /**
+     * This is the time, in nanoseconds since the steady clock's epoch,
+     * when recording started.
+     */
+    std::atomic< int64_t > recordingStart(0);
+
+    /**
+     * This is the identifier to give the next exchange traced.
+     */
+    std::atomic< uint64_t > nextExchangeId(1);
+
+    /**
+     * This is the buffer of spans recorded by the current thread,
+     * if it has recorded any.
+     */
+    thread_local std::shared_ptr< ThreadBuffer > threadBuffer;
+
+    /**
+     * This identifies the exchange of which the current thread is
+     * carrying out a step, or is zero if it isn't carrying out any.
+     */
+    thread_local uint64_t currentExchangeId = 0;
+
+    /**
+     * Return the registry of thread buffers.
+     *
+     * @return
+     *     The registry of thread buffers is returned.
+     */
+    Registry& GetRegistry() {
+        static Registry registry;
+        return registry;
+    }
+
+    /**
+     * Return the time, in nanoseconds since recording started.
+     *
+     * @return
+     *     The time, in nanoseconds since recording started, is returned.
+     */
+    uint64_t Now() {
+        return (uint64_t)(
+            std::chrono::duration_cast< std::chrono::nanoseconds >(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()
+            - recordingStart
+        );
+    }
+
+    /**
+     * Keep the given span in the current thread's buffer.
+     *
+     * @param[in] span
+     *     This is the span to keep.
+     */
+    void Keep(const RecordedSpan& span) {
+        if (threadBuffer == nullptr) {
+            threadBuffer = std::make_shared< ThreadBuffer >();
+            auto& registry = GetRegistry();
+            std::lock_guard< decltype(registry.mutex) > lock(registry.mutex);
+            threadBuffer->threadIndex = registry.nextThreadIndex++;
+            registry.buffers.push_back(threadBuffer);
+        }
+        std::lock_guard< decltype(threadBuffer->mutex) > lock(threadBuffer->mutex);
+        if (threadBuffer->spans.size() < Sasl::Trace::MAX_SPANS_PER_THREAD) {
+            threadBuffer->spans.push_back(span);
+        } else {
+            ++threadBuffer->dropped;
+        }
+    }
+
+    /**
+     * Write the given string to the given file as a JSON string.
+     *
+     * @param[in] file
+     *     This is the file to which to write the string.
+     *
+     * @param[in] s
+     *     This is the string to write.
+     */
+    void WriteJsonString(FILE* file, const char* s) {
+        (void)fputc('"', file);
+        for (; *s != '\0'; ++s) {
+            const auto c = (unsigned char)*s;
+            if (
+                (c == '"')
+                || (c == '\\')
+            ) {
+                (void)fputc('\\', file);
+                (void)fputc(c, file);
+            } else if (c < 0x20) {
+                (void)fprintf(file, "\\u%04x", c);
+            } else {
+                (void)fputc(c, file);
+            }
+        }
+        (void)fputc('"', file);
+    }
+
+}
+
+namespace Sasl {
+namespace Trace {
+
+    void Start() {
+        auto& registry = GetRegistry();
+        std::lock_guard< decltype(registry.mutex) > lock(registry.mutex);
+        for (const auto& buffer: registry.buffers) {
+            std::lock_guard< decltype(buffer->mutex) > bufferLock(buffer->mutex);
+            buffer->spans.clear();
+            buffer->dropped = 0;
+        }
+        recordingStart = std::chrono::duration_cast< std::chrono::nanoseconds >(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+        enabled = true;
+    }
+
+    bool Stop(const std::string& path) {
+        enabled = false;
+
+        // Take the spans out of every thread's buffer, and let go of
+        // the buffers of threads which have since exited.
+        struct ThreadSpans {
+            size_t threadIndex;
+            std::vector< RecordedSpan > spans;
+        };
+        std::vector< ThreadSpans > threads;
+        size_t dropped = 0;
+        {
+            auto& registry = GetRegistry();
+            std::lock_guard< decltype(registry.mutex) > lock(registry.mutex);
+            for (auto buffer = registry.buffers.begin(); buffer != registry.buffers.end();) {
+                ThreadSpans thread;
+                thread.threadIndex = (*buffer)->threadIndex;
+                {
+                    std::lock_guard< decltype((*buffer)->mutex) > bufferLock((*buffer)->mutex);
+                    thread.spans.swap((*buffer)->spans);
+                    dropped += (*buffer)->dropped;
+                    (*buffer)->dropped = 0;
+                }
+                threads.push_back(std::move(thread));
+                if (buffer->use_count() == 1) {
+                    buffer = registry.buffers.erase(buffer);
+                } else {
+                    ++buffer;
+                }
+            }
+        }
+
+        // Write the spans as Chrome trace events.  Spans of exchanges
+        // are put in one "process", with a "thread" for each exchange,
+        // and spans outside of any exchange are put in another, with a
+        // "thread" for each thread.
+        const auto file = fopen(path.c_str(), "w");
+        if (file == NULL) {
+            return false;
+        }
+        (void)fprintf(
+            file,
+            (
+                "{\"traceEvents\":[\n"
+                "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"SASL exchanges\"}},\n"
+                "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"SASL threads\"}}"
+            )
+        );
+        std::set< uint64_t > exchangeIds;
+        for (const auto& thread: threads) {
+            for (const auto& span: thread.spans) {
+                (void)fprintf(file, ",\n{\"name\":");
+                WriteJsonString(file, span.name);
+                (void)fprintf(
+                    file,
+                    (
+                        ",\"cat\":\"sasl\",\"ph\":\"X\",\"pid\":%d,\"tid\":%llu,"
+                        "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"thread\":%zu}}"
+                    ),
+                    ((span.exchangeId == 0) ? 2 : 1),
+                    (unsigned long long)(
+                        (span.exchangeId == 0)
+                        ? thread.threadIndex
+                        : span.exchangeId
+                    ),
+                    span.start / 1e3,
+                    (span.end - span.start) / 1e3,
+                    thread.threadIndex
+                );
+                if (span.exchangeId != 0) {
+                    (void)exchangeIds.insert(span.exchangeId);
+                }
+            }
+        }
+        for (const auto exchangeId: exchangeIds) {
+            (void)fprintf(
+                file,
+                (
+                    ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%llu,"
+                    "\"args\":{\"name\":\"exchange %llu\"}}"
+                ),
+                (unsigned long long)exchangeId,
+                (unsigned long long)exchangeId
+            );
+        }
+        for (const auto& thread: threads) {
+            (void)fprintf(
+                file,
+                (
+                    ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":%zu,"
+                    "\"args\":{\"name\":\"thread %zu\"}}"
+                ),
+                thread.threadIndex,
+                thread.threadIndex
+            );
+        }
+        (void)fprintf(
+            file,
+            "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedSpans\":\"%zu\"}}\n",
+            dropped
+        );
+        return (fclose(file) == 0);
+    }
+
+    bool IsEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    Span::~Span() noexcept {
+        if (name_ == nullptr) {
+            return;
+        }
+        const auto end = Now();
+        Keep({name_, exchangeId_, start_, end});
+        if (exchange_ != nullptr) {
+            exchange_->lastStepEnd = end;
+            currentExchangeId = outerExchangeId_;
+        }
+    }
+
+    Span::Span(const char* name) {
+        if (!IsEnabled()) {
+            return;
+        }
+        name_ = name;
+        exchangeId_ = currentExchangeId;
+        start_ = Now();
+    }
+
+    Span::Span(const char* name, Exchange& exchange) {
+        if (!IsEnabled()) {
+            return;
+        }
+        if (exchange.id == 0) {
+            exchange.id = nextExchangeId++;
+        }
+        name_ = name;
+        exchange_ = &exchange;
+        exchangeId_ = exchange.id;
+        outerExchangeId_ = currentExchangeId;
+        currentExchangeId = exchange.id;
+        start_ = Now();
+        if (
+            (exchange.lastStepEnd != 0)
+            && (exchange.lastStepEnd < start_)
+        ) {
+            Keep({WAITING_SPAN_NAME, exchangeId_, exchange.lastStepEnd, start_});
+        }
+    }
+
+}
+}
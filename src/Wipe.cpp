@@ -0,0 +1,46 @@
+/**
+ * @file Wipe.cpp
+ *
+ * This module contains the implementation of the Sasl::Wipe functions.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Wipe.hpp"
+
+#include <string.h>
+
+namespace {
+
+    /**
+     * This is called to overwrite memory.  It's reached through a
+     * volatile pointer so that the compiler can't tell it's memset,
+     * and so can't leave out calls made just before the memory is freed.
+     */
+    void* (*const volatile memsetFunction)(void*, int, size_t) = memset;
+
+}
+
+namespace Sasl {
+
+    void Wipe(void* memory, size_t length) {
+        if (length > 0) {
+            (void)memsetFunction(memory, 0, length);
+        }
+    }
+
+    void Wipe(std::string& s) {
+        // The whole capacity is overwritten, since the string may once
+        // have been longer than it is now.
+        s.resize(s.capacity());
+        Wipe(&s[0], s.length());
+        std::string().swap(s);
+    }
+
+    void Wipe(std::vector< uint8_t >& v) {
+        v.resize(v.capacity());
+        Wipe(v.data(), v.size());
+        std::vector< uint8_t >().swap(v);
+    }
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ * @file Wipe.hpp
+ *
+ * This module declares the Sasl::Wipe functions, which overwrite
+ * secrets so that they don't linger in memory once they're no
+ * longer needed.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Sasl {
+
+    /**
+     * Overwrite the given memory with zeroes, in a way the compiler
+     * won't leave out even if the memory is never read again.
+     *
+     * @param[in,out] memory
+     *     This points to the memory to overwrite.
+     *
+     * @param[in] length
+     *     This is the number of bytes to overwrite.
+     */
+    void Wipe(void* memory, size_t length);
+
+    /**
+     * Overwrite the contents of the given string, and then empty it,
+     * freeing any memory it had allocated.
+     *
+     * @param[in,out] s
+     *     This is the string to wipe.
+     */
+    void Wipe(std::string& s);
+
+    /**
+     * Overwrite the contents of the given vector, and then empty it,
+     * freeing any memory it had allocated.
+     *
+     * @param[in,out] v
+     *     This is the vector to wipe.
+     */
+    void Wipe(std::vector< uint8_t >& v);
+
+}
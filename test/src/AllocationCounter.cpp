@@ -0,0 +1,292 @@
+/**
+ * @file AllocationCounter.cpp
+ *
+ * This module replaces the global operator new and operator delete
+ * in order to count the dynamic memory allocations made by the unit tests
+ * and the load generator.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "AllocationCounter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <cxxabi.h>
+#include <execinfo.h>
+#define ALLOCATION_COUNTER_HAS_BACKTRACE
+#define ALLOCATION_COUNTER_NOINLINE __attribute__((noinline))
+#else
+#define ALLOCATION_COUNTER_NOINLINE
+#endif
+
+namespace {
+
+    /**
+     * This is the number of stack frames to leave out of each recorded
+     * stack, because they belong to the allocation hook itself
+     * (AllocationCounter::Allocate).  The frame of operator new may
+     * still appear, unless the compiler made its call to the hook
+     * a tail call.
+     */
+    constexpr size_t HOOK_STACK_FRAMES = 1;
+
+    /**
+     * This is the number of dynamic memory allocations made through
+     * the global operator new since the program started.
+     */
+    std::atomic< size_t > allocationCount(0);
+
+    /**
+     * This is the number of dynamic memory allocations made through
+     * the global operator new by the current thread.
+     */
+    thread_local size_t threadAllocationCount = 0;
+
+    /**
+     * This is the number of bytes allocated through the global
+     * operator new and not yet freed.
+     */
+    std::atomic< size_t > liveBytes(0);
+
+    /**
+     * This is the number of bytes put in front of each allocation to
+     * hold its size, so that it can be taken off the live bytes when the
+     * allocation is freed.  It keeps the allocation suitably aligned.
+     */
+    constexpr size_t SIZE_HEADER_LENGTH = alignof(max_align_t);
+
+    /**
+     * This is the innermost allocation counting scope of the
+     * current thread, if any.
+     */
+    thread_local AllocationCounter::Scope* innermostScope = nullptr;
+
+    /**
+     * This is set while the allocation hook, or a scope's report,
+     * is running on the current thread, so that the allocations they
+     * make themselves aren't counted in any scope.
+     */
+    thread_local bool hookActive = false;
+
+    /**
+     * Return the given symbol from a stack trace, with any C++ name
+     * in it demangled.
+     *
+     * @param[in] symbol
+     *     This is the symbol to demangle.
+     *
+     * @return
+     *     The symbol, with any C++ name in it demangled, is returned.
+     */
+    std::string Demangle(const char* symbol) {
+        std::string result(symbol);
+#ifdef ALLOCATION_COUNTER_HAS_BACKTRACE
+        const auto nameStart = result.find("_Z");
+        if (nameStart == std::string::npos) {
+            return result;
+        }
+        const auto nameEnd = result.find_first_of("+ )", nameStart);
+        const auto nameLength = (
+            (nameEnd == std::string::npos)
+            ? std::string::npos
+            : nameEnd - nameStart
+        );
+        int status = -1;
+        const auto demangled = abi::__cxa_demangle(
+            result.substr(nameStart, nameLength).c_str(),
+            nullptr,
+            nullptr,
+            &status
+        );
+        if (demangled != nullptr) {
+            if (status == 0) {
+                (void)result.replace(nameStart, nameLength, demangled);
+            }
+            free(demangled);
+        }
+#endif
+        return result;
+    }
+
+}
+
+namespace AllocationCounter {
+
+    /**
+     * Allocate the given amount of memory, counting the allocation.
+     *
+     * @param[in] size
+     *     This is the number of bytes to allocate.
+     *
+     * @return
+     *     A pointer to the allocated memory is returned.
+     *
+     * @throw std::bad_alloc
+     *     This is thrown if the memory could not be allocated.
+     */
+    ALLOCATION_COUNTER_NOINLINE void* Allocate(size_t size) {
+        ++allocationCount;
+        ++threadAllocationCount;
+        if (
+            (innermostScope != nullptr)
+            && !hookActive
+        ) {
+            hookActive = true;
+            void* frames[MAX_STACK_FRAMES + HOOK_STACK_FRAMES];
+            size_t numFrames = 0;
+#ifdef ALLOCATION_COUNTER_HAS_BACKTRACE
+            numFrames = (size_t)backtrace(frames, (int)(MAX_STACK_FRAMES + HOOK_STACK_FRAMES));
+#endif
+            const auto firstFrame = std::min(numFrames, HOOK_STACK_FRAMES);
+            for (auto scope = innermostScope; scope != nullptr; scope = scope->outer_) {
+                ++scope->count_;
+                scope->bytes_ += size;
+                if (scope->allocations_.size() < scope->allocations_.capacity()) {
+                    Scope::Allocation allocation;
+                    allocation.size = size;
+                    allocation.numFrames = numFrames - firstFrame;
+                    (void)memcpy(
+                        allocation.frames,
+                        frames + firstFrame,
+                        allocation.numFrames * sizeof(void*)
+                    );
+                    scope->allocations_.push_back(allocation);
+                }
+            }
+            hookActive = false;
+        }
+        const auto memory = (uint8_t*)malloc(SIZE_HEADER_LENGTH + size);
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        (void)memcpy(memory, &size, sizeof(size));
+        liveBytes += size;
+        return memory + SIZE_HEADER_LENGTH;
+    }
+
+    /**
+     * Free the given memory, allocated by the Allocate function.
+     *
+     * @param[in] memory
+     *     This points to the memory to free.
+     */
+    void Free(void* memory) {
+        if (memory == nullptr) {
+            return;
+        }
+        const auto block = (uint8_t*)memory - SIZE_HEADER_LENGTH;
+        size_t size;
+        (void)memcpy(&size, block, sizeof(size));
+        liveBytes -= size;
+        free(block);
+    }
+
+    Scope::~Scope() noexcept {
+        innermostScope = outer_;
+    }
+
+    Scope::Scope() {
+        const auto wasHookActive = hookActive;
+        hookActive = true;
+        allocations_.reserve(MAX_RECORDED_ALLOCATIONS);
+        hookActive = wasHookActive;
+        outer_ = innermostScope;
+        innermostScope = this;
+    }
+
+    size_t Scope::GetCount() const {
+        return count_;
+    }
+
+    size_t Scope::GetBytes() const {
+        return bytes_;
+    }
+
+    auto Scope::GetAllocations() const -> const std::vector< Allocation >& {
+        return allocations_;
+    }
+
+    std::string Scope::Report() const {
+        const auto wasHookActive = hookActive;
+        hookActive = true;
+        char line[64];
+        (void)snprintf(line, sizeof(line), "%zu allocation(s), %zu byte(s)\n", count_, bytes_);
+        std::string report = line;
+        for (size_t i = 0; i < allocations_.size(); ++i) {
+            const auto& allocation = allocations_[i];
+            (void)snprintf(line, sizeof(line), "allocation %zu: %zu byte(s)\n", i + 1, allocation.size);
+            report += line;
+#ifdef ALLOCATION_COUNTER_HAS_BACKTRACE
+            const auto symbols = backtrace_symbols(allocation.frames, (int)allocation.numFrames);
+            if (symbols != nullptr) {
+                for (size_t j = 0; j < allocation.numFrames; ++j) {
+                    report += "    ";
+                    report += Demangle(symbols[j]);
+                    report += '\n';
+                }
+                free(symbols);
+            }
+#else
+            report += "    (stack traces aren't available on this platform)\n";
+#endif
+        }
+        if (count_ > allocations_.size()) {
+            (void)snprintf(line, sizeof(line), "%zu more not recorded\n", count_ - allocations_.size());
+            report += line;
+        }
+        hookActive = wasHookActive;
+        return report;
+    }
+
+    void Scope::Clear() {
+        count_ = 0;
+        bytes_ = 0;
+        allocations_.clear();
+    }
+
+    size_t GetCount() {
+        return allocationCount;
+    }
+
+    size_t GetThreadCount() {
+        return threadAllocationCount;
+    }
+
+    size_t GetLiveBytes() {
+        return liveBytes;
+    }
+
+}
+
+void* operator new(size_t size) {
+    return AllocationCounter::Allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return AllocationCounter::Allocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    AllocationCounter::Free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    AllocationCounter::Free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    AllocationCounter::Free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    AllocationCounter::Free(memory);
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+/**
+ * @file AllocationCounter.hpp
+ *
+ * This module declares functions and classes which count the dynamic
+ * memory allocations made by the unit tests and the load generator.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace AllocationCounter {
+
+    /**
+     * This is the greatest number of stack frames recorded
+     * for an allocation.
+     */
+    constexpr size_t MAX_STACK_FRAMES = 32;
+
+    /**
+     * This is the greatest number of allocations whose stacks a scope
+     * records.  Allocations beyond these are still counted.
+     */
+    constexpr size_t MAX_RECORDED_ALLOCATIONS = 16;
+
+    /**
+     * Return the number of dynamic memory allocations made through
+     * the global operator new since the program started.
+     *
+     * @return
+     *     The number of dynamic memory allocations made through
+     *     the global operator new since the program started is returned.
+     */
+    size_t GetCount();
+
+    /**
+     * Return the number of dynamic memory allocations made through
+     * the global operator new by the calling thread since it started.
+     * Each thread counts its own, so reading this costs no
+     * synchronization between threads.
+     *
+     * @return
+     *     The number of dynamic memory allocations made through
+     *     the global operator new by the calling thread since it started
+     *     is returned.
+     */
+    size_t GetThreadCount();
+
+    /**
+     * Return the number of bytes allocated through the global
+     * operator new and not yet freed.
+     *
+     * @return
+     *     The number of bytes allocated through the global operator new
+     *     and not yet freed is returned.
+     */
+    size_t GetLiveBytes();
+
+    /**
+     * This counts the dynamic memory allocations made by the thread which
+     * constructs it, for as long as it exists, and records where the
+     * first few of them were made.  Scopes may be nested, in which case
+     * each allocation is counted by every scope enclosing it.
+     *
+     * It's meant for checking allocation budgets, such as:
+     *
+     *     AllocationCounter::Scope scope;
+     *     (void)mech.Proceed(challenge);
+     *     EXPECT_LE(scope.GetCount(), 1) << scope.Report();
+     */
+    class Scope {
+        // Types
+    public:
+        /**
+         * This records one allocation made in a scope.
+         */
+        struct Allocation {
+            /**
+             * This is the number of bytes allocated.
+             */
+            size_t size = 0;
+
+            /**
+             * These are the return addresses on the stack when the
+             * allocation was made, innermost first.
+             */
+            void* frames[MAX_STACK_FRAMES];
+
+            /**
+             * This is the number of frames recorded.
+             */
+            size_t numFrames = 0;
+        };
+
+        // Lifecycle management
+    public:
+        ~Scope() noexcept;
+        Scope(const Scope&) = delete;
+        Scope(Scope&&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        Scope& operator=(Scope&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * This is the default constructor, which starts counting
+         * allocations made by the calling thread.
+         */
+        Scope();
+
+        /**
+         * Return the number of allocations counted so far.
+         *
+         * @return
+         *     The number of allocations counted so far is returned.
+         */
+        size_t GetCount() const;
+
+        /**
+         * Return the total number of bytes allocated so far.
+         *
+         * @return
+         *     The total number of bytes allocated so far is returned.
+         */
+        size_t GetBytes() const;
+
+        /**
+         * Return the allocations recorded so far.
+         *
+         * @return
+         *     The allocations recorded so far is returned.
+         */
+        const std::vector< Allocation >& GetAllocations() const;
+
+        /**
+         * Return a human-readable description of the allocations
+         * counted so far, including the stack of each one recorded.
+         *
+         * @return
+         *     A description of the allocations counted so far is returned.
+         */
+        std::string Report() const;
+
+        /**
+         * Start over, forgetting the allocations counted so far.
+         */
+        void Clear();
+
+        // Private properties
+    private:
+        /**
+         * This is the scope which was innermost when this one began.
+         */
+        Scope* outer_ = nullptr;
+
+        /**
+         * This is the number of allocations counted.
+         */
+        size_t count_ = 0;
+
+        /**
+         * This is the total number of bytes allocated.
+         */
+        size_t bytes_ = 0;
+
+        /**
+         * These are the allocations recorded.  Capacity for all of them
+         * is reserved up front, so recording one doesn't allocate.
+         */
+        std::vector< Allocation > allocations_;
+
+        // Friends
+    private:
+        friend void* Allocate(size_t size);
+    };
+
+}
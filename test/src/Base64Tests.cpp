@@ -0,0 +1,249 @@
+/**
+ * @file Base64Tests.cpp
+ *
+ * This module contains the unit tests of the Base64 encoder and decoder
+ * built into the Sasl library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <Base64/Base64.hpp>
+#include <gtest/gtest.h>
+#include <Sasl/Base64.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the value stored in the bytes just past the end of an
+     * output buffer, to detect anything stored beyond it.
+     */
+    constexpr char GUARD = (char)0xA5;
+
+    /**
+     * This is the number of guard bytes placed past the end
+     * of output buffers.
+     */
+    constexpr size_t NUM_GUARD_BYTES = 64;
+
+    /**
+     * These are the implementations to test.
+     */
+    const std::vector< Sasl::Base64::Implementation > IMPLEMENTATIONS = {
+        Sasl::Base64::Implementation::Automatic,
+        Sasl::Base64::Implementation::Portable,
+        Sasl::Base64::Implementation::Sse41,
+        Sasl::Base64::Implementation::Avx2,
+    };
+
+    /**
+     * Encode the given data using the given implementation, checking
+     * that nothing is stored past the end of the encoding.
+     *
+     * @param[in] data
+     *     This is the data to encode.
+     *
+     * @param[in] implementation
+     *     This selects which implementation of the encoder to use.
+     *
+     * @return
+     *     The encoding is returned.
+     */
+    std::string Encode(
+        const std::string& data,
+        Sasl::Base64::Implementation implementation
+    ) {
+        const auto encodedLength = Sasl::Base64::EncodedLength(data.length());
+        std::vector< char > buffer(encodedLength + NUM_GUARD_BYTES, GUARD);
+        EXPECT_EQ(
+            encodedLength,
+            Sasl::Base64::Encode(data.data(), data.length(), buffer.data(), implementation)
+        );
+        for (size_t i = encodedLength; i < buffer.size(); ++i) {
+            EXPECT_EQ(GUARD, buffer[i]) << "length: " << data.length();
+        }
+        return std::string(buffer.data(), encodedLength);
+    }
+
+    /**
+     * Decode the given encoding using the given implementation, checking
+     * that nothing is stored past the largest possible decoded length.
+     *
+     * @param[in] encoded
+     *     This is the encoding to decode.
+     *
+     * @param[out] decoded
+     *     This is where to store the decoded data.
+     *
+     * @param[in] implementation
+     *     This selects which implementation of the decoder to use.
+     *
+     * @return
+     *     An indication of whether or not the encoding is valid
+     *     is returned.
+     */
+    bool Decode(
+        const std::string& encoded,
+        std::string& decoded,
+        Sasl::Base64::Implementation implementation
+    ) {
+        const auto maxDecodedLength = Sasl::Base64::MaxDecodedLength(encoded.length());
+        std::vector< char > buffer(maxDecodedLength + NUM_GUARD_BYTES, GUARD);
+        size_t decodedLength;
+        const auto valid = Sasl::Base64::Decode(
+            encoded.data(),
+            encoded.length(),
+            buffer.data(),
+            decodedLength,
+            implementation
+        );
+        for (size_t i = maxDecodedLength; i < buffer.size(); ++i) {
+            EXPECT_EQ(GUARD, buffer[i]) << "length: " << encoded.length();
+        }
+        decoded.assign(buffer.data(), valid ? decodedLength : 0);
+        return valid;
+    }
+
+}
+
+TEST(Base64Tests, Rfc4648TestVectors) {
+    const std::vector< std::pair< std::string, std::string > > testVectors = {
+        {"", ""},
+        {"f", "Zg=="},
+        {"fo", "Zm8="},
+        {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="},
+        {"fooba", "Zm9vYmE="},
+        {"foobar", "Zm9vYmFy"},
+    };
+    for (const auto implementation: IMPLEMENTATIONS) {
+        for (const auto& testVector: testVectors) {
+            EXPECT_EQ(testVector.second, Encode(testVector.first, implementation))
+                << "implementation: " << (int)implementation;
+            std::string decoded;
+            EXPECT_TRUE(Decode(testVector.second, decoded, implementation))
+                << "implementation: " << (int)implementation;
+            EXPECT_EQ(testVector.first, decoded)
+                << "implementation: " << (int)implementation;
+        }
+    }
+}
+
+TEST(Base64Tests, MatchesBase64LibraryForEveryLength) {
+    std::string data;
+    for (size_t i = 0; i < 300; ++i) {
+        data.push_back((char)(i * 167 + 13));
+    }
+    for (const auto implementation: IMPLEMENTATIONS) {
+        for (size_t length = 0; length <= data.length(); ++length) {
+            const auto piece = data.substr(0, length);
+            const auto encoded = Encode(piece, implementation);
+            EXPECT_EQ(Base64::Encode(piece), encoded)
+                << "implementation: " << (int)implementation << ", length: " << length;
+            std::string decoded;
+            EXPECT_TRUE(Decode(encoded, decoded, implementation))
+                << "implementation: " << (int)implementation << ", length: " << length;
+            EXPECT_EQ(piece, decoded)
+                << "implementation: " << (int)implementation << ", length: " << length;
+        }
+    }
+}
+
+TEST(Base64Tests, RejectInvalidEncodings) {
+    const std::vector< std::string > invalidEncodings = {
+        "Zg",
+        "Zg=",
+        "Zm9vY",
+        "Zg==Zg==",
+        "Z===",
+        "====",
+        "Zm=v",
+        "Zm9v\r\n",
+        "Zm9v Zm9v",
+        "Zm9-",
+        "Zm9_",
+    };
+    for (const auto implementation: IMPLEMENTATIONS) {
+        for (const auto& encoding: invalidEncodings) {
+            std::string decoded;
+            EXPECT_FALSE(Decode(encoding, decoded, implementation))
+                << "implementation: " << (int)implementation << ", encoding: " << encoding;
+        }
+    }
+}
+
+TEST(Base64Tests, RejectInvalidCharacterAnywhere) {
+    std::string data;
+    for (size_t i = 0; i < 150; ++i) {
+        data.push_back((char)i);
+    }
+    const auto encoded = Sasl::Base64::Encode(data);
+    for (const auto implementation: IMPLEMENTATIONS) {
+        for (const auto invalidCharacter: {'\0', '-', ':', '[', '{', '=', (char)0x80, (char)0xC1}) {
+            for (size_t i = 0; i < encoded.length(); ++i) {
+                if (
+                    (invalidCharacter == '=')
+                    && (i + 1 == encoded.length())
+                ) {
+                    continue;
+                }
+                auto corrupted = encoded;
+                corrupted[i] = invalidCharacter;
+                std::string decoded;
+                EXPECT_FALSE(Decode(corrupted, decoded, implementation))
+                    << "implementation: " << (int)implementation
+                    << ", character: " << (int)invalidCharacter
+                    << ", position: " << i;
+            }
+        }
+    }
+}
+
+TEST(Base64Tests, EveryCharacterOfAlphabet) {
+    const std::string alphabet = (
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+    );
+    const auto expected = Base64::Decode(alphabet + alphabet);
+    for (const auto implementation: IMPLEMENTATIONS) {
+        std::string decoded;
+        EXPECT_TRUE(Decode(alphabet + alphabet, decoded, implementation))
+            << "implementation: " << (int)implementation;
+        EXPECT_EQ(expected, decoded) << "implementation: " << (int)implementation;
+    }
+}
+
+TEST(Base64Tests, DecodeInPlace) {
+    std::string data;
+    for (size_t i = 0; i < 300; ++i) {
+        data.push_back((char)(i * 167 + 13));
+    }
+    for (const auto implementation: IMPLEMENTATIONS) {
+        for (size_t length = 0; length <= data.length(); ++length) {
+            const auto piece = data.substr(0, length);
+            auto buffer = Sasl::Base64::Encode(piece);
+            size_t decodedLength;
+            EXPECT_TRUE(
+                Sasl::Base64::Decode(
+                    &buffer[0],
+                    buffer.length(),
+                    &buffer[0],
+                    decodedLength,
+                    implementation
+                )
+            ) << "implementation: " << (int)implementation << ", length: " << length;
+            EXPECT_EQ(piece, buffer.substr(0, decodedLength))
+                << "implementation: " << (int)implementation << ", length: " << length;
+        }
+    }
+}
+
+TEST(Base64Tests, StringInterface) {
+    EXPECT_EQ("Zm9vYmE=", Sasl::Base64::Encode(std::string("fooba")));
+    std::string decoded = "leftover";
+    EXPECT_TRUE(Sasl::Base64::Decode("Zm9vYmE=", decoded));
+    EXPECT_EQ("fooba", decoded);
+    EXPECT_FALSE(Sasl::Base64::Decode("Zm9vYmE", decoded));
+    EXPECT_EQ("", decoded);
+}
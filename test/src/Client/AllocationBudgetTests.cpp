@@ -0,0 +1,151 @@
+/**
+ * @file AllocationBudgetTests.cpp
+ *
+ * This module contains the unit tests which hold the client mechanisms
+ * to budgets of dynamic memory allocations for each step of an exchange,
+ * so that changes which add allocations to them are caught.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../AllocationCounter.hpp"
+
+#include <functional>
+#include <gtest/gtest.h>
+#include <memory>
+#include <Sasl/Client/Login.hpp>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <stddef.h>
+#include <string>
+
+namespace {
+
+    /**
+     * Carry out the given step, and check that it makes no more than
+     * the given number of dynamic memory allocations.  If it makes
+     * more, the stacks of the allocations are reported.
+     *
+     * @param[in] step
+     *     This is the name of the step, used in the report.
+     *
+     * @param[in] budget
+     *     This is the greatest number of allocations the step may make.
+     *
+     * @param[in] operation
+     *     This is the step to carry out.
+     */
+    void ExpectAllocationsWithin(
+        const char* step,
+        size_t budget,
+        const std::function< void() >& operation
+    ) {
+        size_t count = 0;
+        std::string report;
+        {
+            AllocationCounter::Scope scope;
+            operation();
+            count = scope.GetCount();
+            if (count > budget) {
+                report = scope.Report();
+            }
+        }
+        EXPECT_LE(count, budget)
+            << step << " exceeded its budget of " << budget << " allocation(s): "
+            << report;
+    }
+
+}
+
+TEST(AllocationBudgetTests, Plain) {
+    const std::string password = "hunter2";
+    const std::string user = "bob";
+    const std::string challenge;
+    std::unique_ptr< Sasl::Client::Plain > mech;
+    ExpectAllocationsWithin("construction", 1, [&]{ mech.reset(new Sasl::Client::Plain()); });
+    ExpectAllocationsWithin("SetCredentials", 4, [&]{ mech->SetCredentials(password, user); });
+    for (int exchange = 0; exchange < 2; ++exchange) {
+        ExpectAllocationsWithin("Reset", 0, [&]{ mech->Reset(); });
+        ExpectAllocationsWithin("GetInitialResponse", 0, [&]{ (void)mech->GetInitialResponse(); });
+        ExpectAllocationsWithin("Proceed (outcome)", 0, [&]{ (void)mech->Proceed(challenge); });
+    }
+}
+
+TEST(AllocationBudgetTests, Login) {
+    const std::string password = "hunter2";
+    const std::string user = "bob";
+    const std::string usernameChallenge = "Username:";
+    const std::string passwordChallenge = "Password:";
+    const std::string outcome;
+    std::unique_ptr< Sasl::Client::Login > mech;
+    ExpectAllocationsWithin("construction", 1, [&]{ mech.reset(new Sasl::Client::Login()); });
+    ExpectAllocationsWithin("SetCredentials", 4, [&]{ mech->SetCredentials(password, user); });
+    for (int exchange = 0; exchange < 2; ++exchange) {
+        ExpectAllocationsWithin("Reset", 0, [&]{ mech->Reset(); });
+        ExpectAllocationsWithin("GetInitialResponse", 0, [&]{ (void)mech->GetInitialResponse(); });
+        ExpectAllocationsWithin("Proceed (username)", 0, [&]{ (void)mech->Proceed(usernameChallenge); });
+        ExpectAllocationsWithin("Proceed (password)", 0, [&]{ (void)mech->Proceed(passwordChallenge); });
+        ExpectAllocationsWithin("Proceed (outcome)", 0, [&]{ (void)mech->Proceed(outcome); });
+    }
+}
+
+// The SCRAM budgets are where the mechanism stands now; lower them as
+// allocations are taken out of it.
+TEST(AllocationBudgetTests, Scram) {
+    const std::string password = "pencil";
+    const std::string user = "user";
+    const std::string clientNonce = "fyko+d2lbbFgONRv9qkxdawL";
+    const std::string serverFirstMessage = "r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096";
+    const std::string serverFinalMessage = "v=rmF9pqV8S7suAoZWja4dJRkFsKQ=";
+    const auto profile = Sasl::Client::ScramProfile::Sha1();
+    std::unique_ptr< Sasl::Client::Scram > mech;
+    ExpectAllocationsWithin("construction", 1, [&]{ mech.reset(new Sasl::Client::Scram()); });
+    ExpectAllocationsWithin("SetProfile", 0, [&]{ mech->SetProfile(profile); });
+    ExpectAllocationsWithin("SetClientNonce", 1, [&]{ mech->SetClientNonce(clientNonce); });
+    ExpectAllocationsWithin("SetCredentials", 2, [&]{ mech->SetCredentials(password, user); });
+    for (int exchange = 0; exchange < 2; ++exchange) {
+        ExpectAllocationsWithin("Reset", 1, [&]{ mech->Reset(); });
+        ExpectAllocationsWithin("GetInitialResponse", 1, [&]{ (void)mech->GetInitialResponse(); });
+        ExpectAllocationsWithin("Proceed (server-first-message)", 29, [&]{
+            (void)mech->Proceed(serverFirstMessage);
+        });
+        ExpectAllocationsWithin("Proceed (server-final-message)", 0, [&]{
+            (void)mech->Proceed(serverFinalMessage);
+        });
+        EXPECT_TRUE(mech->Succeeded());
+    }
+}
+
+TEST(AllocationBudgetTests, ScopeReportsStacks) {
+    // A raw buffer is allocated, rather than a standard library container,
+    // so that exactly one allocation of a known size is made on every
+    // platform.  Its address is stored where the compiler can't see it
+    // unused, so the allocation isn't left out.
+    static char* volatile escaped = nullptr;
+    size_t innerCount = 0;
+    size_t innerBytes = 0;
+    size_t innerRecorded = 0;
+    size_t outerCount = 0;
+    std::string report;
+    {
+        AllocationCounter::Scope outer;
+        {
+            AllocationCounter::Scope inner;
+            std::unique_ptr< char[] > value(new char[41]);
+            escaped = value.get();
+            innerCount = inner.GetCount();
+            innerBytes = inner.GetBytes();
+            innerRecorded = inner.GetAllocations().size();
+            report = inner.Report();
+        }
+        outerCount = outer.GetCount();
+    }
+    EXPECT_EQ(1, innerCount);
+    EXPECT_EQ(41, innerBytes);
+    EXPECT_EQ(1, innerRecorded);
+    EXPECT_EQ(1, outerCount);
+    EXPECT_EQ(0, report.find("1 allocation(s)")) << report;
+#if defined(__GLIBC__) || defined(__APPLE__)
+    EXPECT_NE(std::string::npos, report.find("ScopeReportsStacks")) << report;
+#endif
+}
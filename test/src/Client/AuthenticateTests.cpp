@@ -0,0 +1,317 @@
+/**
+ * @file AuthenticateTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Client::Authenticate coroutine.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <Sasl/Client/Authenticate.hpp>
+
+#ifdef SASL_HAS_COROUTINES
+
+#include <gtest/gtest.h>
+#include <map>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <Sasl/Client/XOAuth2.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is a transport which plays back a script of messages from
+     * the server, and records the messages sent to the server.  It can
+     * be set up to suspend the coroutine on each receive, so that the
+     * test decides when each message arrives.
+     */
+    struct ScriptedTransport {
+        // Properties
+
+        /**
+         * These are the messages to receive from the server, in order.
+         */
+        std::vector< std::string > script;
+
+        /**
+         * This is the index of the next message to receive from the server.
+         */
+        size_t next = 0;
+
+        /**
+         * These are the messages sent to the server.
+         */
+        std::vector< std::string > sent;
+
+        /**
+         * This indicates whether or not to suspend the coroutine
+         * on each receive.
+         */
+        bool suspendOnReceive = false;
+
+        /**
+         * If the coroutine is suspended waiting to receive a message,
+         * this refers to the coroutine.
+         */
+        std::coroutine_handle<> receiver;
+
+        // Methods
+
+        struct SendAwaiter {
+            bool await_ready() noexcept {
+                return true;
+            }
+
+            void await_suspend(std::coroutine_handle<>) noexcept {
+            }
+
+            void await_resume() noexcept {
+            }
+        };
+
+        struct ReceiveAwaiter {
+            ScriptedTransport& transport;
+            std::string& message;
+
+            bool await_ready() noexcept {
+                return !transport.suspendOnReceive;
+            }
+
+            void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+                transport.receiver = coroutine;
+            }
+
+            bool await_resume() {
+                transport.receiver = nullptr;
+                if (transport.next >= transport.script.size()) {
+                    return false;
+                }
+                message = transport.script[transport.next++];
+                return true;
+            }
+        };
+
+        SendAwaiter Send(const std::string& message) {
+            sent.push_back(message);
+            return SendAwaiter();
+        }
+
+        ReceiveAwaiter Receive(std::string& message) {
+            return ReceiveAwaiter{*this, message};
+        }
+    };
+
+    /**
+     * This is an executor which holds on to the coroutines given to it,
+     * so that the test decides when they're resumed.
+     */
+    struct DeferredExecutor {
+        std::vector< std::coroutine_handle<> >* coroutines;
+
+        void operator()(std::coroutine_handle<> coroutine) {
+            coroutines->push_back(coroutine);
+        }
+    };
+
+    /**
+     * This is a frame allocator which counts how many frames it provides
+     * and takes back, and checks that each frame is taken back with
+     * the size it was provided with.
+     */
+    struct CountingFrameAllocator
+        : public Sasl::Client::FrameAllocator
+    {
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        std::map< void*, size_t > sizes;
+
+        virtual void* Allocate(size_t size) override {
+            ++allocations;
+            const auto memory = ::operator new(size);
+            sizes[memory] = size;
+            return memory;
+        }
+
+        virtual void Deallocate(void* memory, size_t size) override {
+            ++deallocations;
+            EXPECT_EQ(sizes[memory], size);
+            (void)sizes.erase(memory);
+            ::operator delete(memory);
+        }
+    };
+
+    /**
+     * Make a SCRAM-SHA-1 mechanism set up to use the example exchange
+     * from RFC 5802.
+     *
+     * @param[out] mech
+     *     This is the mechanism to set up.
+     *
+     * @param[out] transport
+     *     This is the transport to set up with the server's messages.
+     */
+    void SetUpRfc5802Example(
+        Sasl::Client::Scram& mech,
+        ScriptedTransport& transport
+    ) {
+        mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+        mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+        mech.SetCredentials("pencil", "user");
+        transport.script = {
+            "r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096",
+            "v=rmF9pqV8S7suAoZWja4dJRkFsKQ=",
+        };
+    }
+
+}
+
+TEST(AuthenticateTests, ScramExchange) {
+    Sasl::Client::Scram mech;
+    ScriptedTransport transport;
+    SetUpRfc5802Example(mech, transport);
+    auto task = Sasl::Client::Authenticate(mech, transport);
+    EXPECT_FALSE(task.IsDone());
+    task.Start();
+    ASSERT_TRUE(task.IsDone());
+    const auto outcome = task.GetResult();
+    EXPECT_TRUE(outcome.succeeded);
+    EXPECT_FALSE(outcome.faulted);
+    EXPECT_EQ(
+        (std::vector< std::string >{
+            "n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL",
+            "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        }),
+        transport.sent
+    );
+}
+
+TEST(AuthenticateTests, NoInitialResponse) {
+    Sasl::Client::Scram mech;
+    ScriptedTransport transport;
+    SetUpRfc5802Example(mech, transport);
+    mech.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Never);
+    transport.script.insert(transport.script.begin(), "");
+    auto task = Sasl::Client::Authenticate(mech, transport);
+    task.Start();
+    ASSERT_TRUE(task.IsDone());
+    EXPECT_TRUE(task.GetResult().succeeded);
+    EXPECT_EQ(
+        (std::vector< std::string >{
+            "",
+            "n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL",
+            "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        }),
+        transport.sent
+    );
+}
+
+TEST(AuthenticateTests, ServerEndsExchange) {
+    Sasl::Client::Plain mech;
+    mech.SetCredentials("hunter2", "bob");
+    ScriptedTransport transport;
+    transport.suspendOnReceive = true;
+    auto task = Sasl::Client::Authenticate(mech, transport);
+    task.Start();
+    EXPECT_FALSE(task.IsDone());
+    ASSERT_TRUE(transport.receiver);
+    transport.receiver.resume();
+    ASSERT_TRUE(task.IsDone());
+    const auto outcome = task.GetResult();
+    EXPECT_FALSE(outcome.succeeded);
+    EXPECT_FALSE(outcome.faulted);
+    EXPECT_EQ(
+        (std::vector< std::string >{
+            std::string("\0bob\0hunter2", 12),
+        }),
+        transport.sent
+    );
+}
+
+TEST(AuthenticateTests, XOAuth2ErrorChallengeAcknowledged) {
+    Sasl::Client::XOAuth2 mech;
+    mech.SetCredentials("token1", "bob");
+    ScriptedTransport transport;
+    transport.script = {
+        "{\"status\":\"401\",\"schemes\":\"bearer\",\"scope\":\"mail\"}",
+    };
+    auto task = Sasl::Client::Authenticate(mech, transport);
+    task.Start();
+    ASSERT_TRUE(task.IsDone());
+    const auto outcome = task.GetResult();
+    EXPECT_FALSE(outcome.succeeded);
+    EXPECT_FALSE(outcome.faulted);
+
+    // The empty acknowledgement of the error challenge is sent.
+    EXPECT_EQ(
+        (std::vector< std::string >{
+            "user=bob\x01" "auth=Bearer token1\x01\x01",
+            "",
+        }),
+        transport.sent
+    );
+}
+
+TEST(AuthenticateTests, AwaitFromAnotherCoroutine) {
+    Sasl::Client::Scram mech;
+    ScriptedTransport transport;
+    SetUpRfc5802Example(mech, transport);
+    auto outer = [](
+        Sasl::Client::Scram& mech,
+        ScriptedTransport& transport
+    ) -> Sasl::Client::Task< bool > {
+        const auto outcome = co_await Sasl::Client::Authenticate(mech, transport);
+        co_return outcome.succeeded;
+    }(mech, transport);
+    outer.Start();
+    ASSERT_TRUE(outer.IsDone());
+    EXPECT_TRUE(outer.GetResult());
+}
+
+TEST(AuthenticateTests, ProceedOnExecutor) {
+    Sasl::Client::Scram mech;
+    ScriptedTransport transport;
+    SetUpRfc5802Example(mech, transport);
+    std::vector< std::coroutine_handle<> > coroutines;
+    auto task = Sasl::Client::Authenticate(
+        mech,
+        transport,
+        DeferredExecutor{&coroutines}
+    );
+    task.Start();
+    size_t numResumptions = 0;
+    while (!coroutines.empty()) {
+        const auto coroutine = coroutines.back();
+        coroutines.pop_back();
+        EXPECT_FALSE(task.IsDone());
+        coroutine.resume();
+        ++numResumptions;
+    }
+    EXPECT_EQ(2, numResumptions);
+    ASSERT_TRUE(task.IsDone());
+    EXPECT_TRUE(task.GetResult().succeeded);
+}
+
+TEST(AuthenticateTests, FrameFromGivenAllocator) {
+    Sasl::Client::Scram mech;
+    ScriptedTransport transport;
+    SetUpRfc5802Example(mech, transport);
+    CountingFrameAllocator allocator;
+    {
+        auto task = Sasl::Client::Authenticate(
+            std::allocator_arg,
+            allocator,
+            mech,
+            transport
+        );
+        EXPECT_EQ(1, allocator.allocations);
+        EXPECT_EQ(0, allocator.deallocations);
+        task.Start();
+        EXPECT_TRUE(task.GetResult().succeeded);
+    }
+    EXPECT_EQ(1, allocator.allocations);
+    EXPECT_EQ(1, allocator.deallocations);
+}
+
+#endif /* SASL_HAS_COROUTINES */
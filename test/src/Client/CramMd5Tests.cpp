@@ -0,0 +1,131 @@
+/**
+ * @file CramMd5Tests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Client::CramMd5 class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../AllocationCounter.hpp"
+
+#include <gtest/gtest.h>
+#include <Sasl/Client/CramMd5.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(CramMd5Tests, Rfc2195Example) {
+    Sasl::Client::CramMd5 mech;
+    mech.SetCredentials("tanstaaftanstaaf", "tim");
+    EXPECT_EQ("", mech.GetInitialResponse());
+    EXPECT_EQ(
+        "tim b913a602c7eda7a495b4e6e7334d3890",
+        mech.Proceed("<1896.697170952@postoffice.reston.mci.net>")
+    );
+    EXPECT_EQ("", mech.Proceed(""));
+    EXPECT_FALSE(mech.Succeeded());
+    EXPECT_FALSE(mech.Faulted());
+}
+
+TEST(CramMd5Tests, HmacKnownAnswers) {
+    // These are test cases 2 and 6 of RFC 2202, the second of which
+    // has a password longer than a block, which is hashed first.
+    Sasl::Client::CramMd5 mech;
+    mech.SetCredentials("Jefe", "bob");
+    EXPECT_EQ(
+        "bob 750c783e6ab0b503eaa86e310a5db738",
+        mech.Proceed("what do ya want for nothing?")
+    );
+    mech.SetCredentials(std::string(80, '\xaa'), "bob");
+    mech.Reset();
+    EXPECT_EQ(
+        "bob 6b1ab7fe4bd7bf8f0b62e6ce61b9d0cd",
+        mech.Proceed("Test Using Larger Than Block-Size Key - Hash Key First")
+    );
+}
+
+TEST(CramMd5Tests, ChallengeLongerThanBlock) {
+    // This is test case 7 of RFC 2202.
+    Sasl::Client::CramMd5 mech;
+    mech.SetCredentials(std::string(80, '\xaa'), "bob");
+    EXPECT_EQ(
+        "bob 6f630fad67cda0ee1fb1f562db3aa53e",
+        mech.Proceed("Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data")
+    );
+}
+
+TEST(CramMd5Tests, Reset) {
+    Sasl::Client::CramMd5 mech;
+    mech.SetCredentials("tanstaaftanstaaf", "tim");
+    (void)mech.Proceed("<1896.697170952@postoffice.reston.mci.net>");
+    mech.Reset();
+    EXPECT_EQ(
+        "tim b913a602c7eda7a495b4e6e7334d3890",
+        mech.Proceed("<1896.697170952@postoffice.reston.mci.net>")
+    );
+}
+
+TEST(CramMd5Tests, NoInitialResponseInAnyMode) {
+    Sasl::Client::CramMd5 mech;
+    mech.SetCredentials("tanstaaftanstaaf", "tim");
+    mech.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Always);
+    const auto profile = mech.GetRoundTripProfile();
+    EXPECT_FALSE(profile.sendsInitialResponse);
+    EXPECT_EQ(2, profile.roundTrips);
+    EXPECT_EQ("", mech.GetInitialResponse());
+}
+
+TEST(CramMd5Tests, NoResponseWithoutCredentials) {
+    Sasl::Client::CramMd5 mech;
+    EXPECT_EQ("", mech.Proceed("<1896.697170952@postoffice.reston.mci.net>"));
+}
+
+TEST(CramMd5Tests, DiagnosticsMaskDigest) {
+    Sasl::Client::CramMd5 mech;
+    std::vector< std::string > diagnosticMessages;
+    const auto unsubscribe = mech.SubscribeToDiagnostics(
+        [&diagnosticMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            diagnosticMessages.push_back(message);
+        }
+    );
+    mech.SetCredentials("tanstaaftanstaaf", "tim");
+    (void)mech.GetInitialResponse();
+    (void)mech.Proceed("<1896.697170952@postoffice.reston.mci.net>");
+    EXPECT_EQ(
+        (std::vector< std::string >{
+            "C: AUTH CRAM-MD5",
+            "C: tim *******",
+        }),
+        diagnosticMessages
+    );
+    unsubscribe();
+}
+
+TEST(CramMd5Tests, ConstructionAndMoveDoNotAllocate) {
+    const auto allocationsBefore = AllocationCounter::GetCount();
+    Sasl::Client::CramMd5 mech;
+    Sasl::Client::CramMd5 other(std::move(mech));
+    mech = std::move(other);
+    EXPECT_EQ(allocationsBefore, AllocationCounter::GetCount());
+}
+
+TEST(CramMd5Tests, CancelledExchangeFaults) {
+    Sasl::Client::CramMd5 mech;
+    auto cancellationToken = Sasl::CancellationToken::Create();
+    mech.SetCancellationToken(cancellationToken);
+    mech.SetCredentials("tanstaaftanstaaf", "tim");
+    cancellationToken.Cancel();
+    EXPECT_EQ("", mech.Proceed("<1896.697170952@postoffice.reston.mci.net>"));
+    EXPECT_TRUE(mech.Faulted());
+    mech.Reset();
+    EXPECT_FALSE(mech.Faulted());
+    EXPECT_EQ(
+        "tim b913a602c7eda7a495b4e6e7334d3890",
+        mech.Proceed("<1896.697170952@postoffice.reston.mci.net>")
+    );
+}
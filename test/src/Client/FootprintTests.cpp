@@ -0,0 +1,208 @@
+/**
+ * @file FootprintTests.cpp
+ *
+ * This module contains the unit tests which report how much memory each
+ * client mechanism holds (its own size, plus what it holds on the heap)
+ * with credentials set, once its exchange is done, and once released,
+ * and check that released mechanisms hold nothing on the heap.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../AllocationCounter.hpp"
+
+#include <functional>
+#include <gtest/gtest.h>
+#include <Sasl/Client/CramMd5.hpp>
+#include <Sasl/Client/Login.hpp>
+#include <Sasl/Client/OAuthBearer.hpp>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <Sasl/Client/XOAuth2.hpp>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+
+namespace {
+
+    /**
+     * This holds the memory a mechanism holds at each point
+     * in its life.
+     */
+    struct Footprint {
+        /**
+         * This is the bytes the mechanism holds on the heap
+         * once its credentials are set.
+         */
+        size_t withCredentials = 0;
+
+        /**
+         * This is the bytes the mechanism holds on the heap
+         * once its exchange is done.
+         */
+        size_t whenDone = 0;
+
+        /**
+         * This is the bytes the mechanism holds on the heap
+         * once it's released.
+         */
+        size_t released = 0;
+    };
+
+    /**
+     * Make a mechanism of the given type, set its credentials, carry
+     * out an exchange with it, and release it, measuring the memory
+     * it holds along the way.  The footprint is reported on the
+     * standard output stream.
+     *
+     * @param[in] name
+     *     This is the name of the mechanism, used in the report.
+     *
+     * @param[in] setCredentials
+     *     This sets the credentials of the mechanism.
+     *
+     * @param[in] exchange
+     *     This carries out the exchange.
+     *
+     * @return
+     *     The memory held by the mechanism is returned.
+     */
+    template< typename T > Footprint Measure(
+        const char* name,
+        const std::function< void(T& mech) >& setCredentials,
+        const std::function< void(T& mech) >& exchange
+    ) {
+        Footprint footprint;
+        const auto baseline = AllocationCounter::GetLiveBytes();
+        {
+            T mech;
+            setCredentials(mech);
+            footprint.withCredentials = AllocationCounter::GetLiveBytes() - baseline;
+            exchange(mech);
+            footprint.whenDone = AllocationCounter::GetLiveBytes() - baseline;
+            mech.Release();
+            footprint.released = AllocationCounter::GetLiveBytes() - baseline;
+        }
+        (void)printf(
+            "%-12s sizeof %3zu, heap with credentials %3zu, when done %3zu, released %3zu\n",
+            name,
+            sizeof(T),
+            footprint.withCredentials,
+            footprint.whenDone,
+            footprint.released
+        );
+        return footprint;
+    }
+
+}
+
+TEST(FootprintTests, Plain) {
+    const auto footprint = Measure< Sasl::Client::Plain >(
+        "PLAIN",
+        [](Sasl::Client::Plain& mech){ mech.SetCredentials("pencil", "user"); },
+        [](Sasl::Client::Plain& mech){
+            (void)mech.GetInitialResponse();
+            (void)mech.Proceed("");
+        }
+    );
+    EXPECT_EQ(footprint.withCredentials, footprint.whenDone);
+    EXPECT_EQ(0, footprint.released);
+}
+
+TEST(FootprintTests, Login) {
+    const auto footprint = Measure< Sasl::Client::Login >(
+        "LOGIN",
+        [](Sasl::Client::Login& mech){ mech.SetCredentials("pencil", "user"); },
+        [](Sasl::Client::Login& mech){
+            (void)mech.Proceed("Username:");
+            (void)mech.Proceed("Password:");
+            (void)mech.Proceed("");
+        }
+    );
+    EXPECT_EQ(footprint.withCredentials, footprint.whenDone);
+    EXPECT_EQ(0, footprint.released);
+}
+
+TEST(FootprintTests, CramMd5) {
+    const auto footprint = Measure< Sasl::Client::CramMd5 >(
+        "CRAM-MD5",
+        [](Sasl::Client::CramMd5& mech){ mech.SetCredentials("tanstaaftanstaaf", "tim"); },
+        [](Sasl::Client::CramMd5& mech){
+            (void)mech.Proceed("<1896.697170952@postoffice.reston.mci.net>");
+            (void)mech.Proceed("");
+        }
+    );
+    EXPECT_EQ(footprint.withCredentials, footprint.whenDone);
+    EXPECT_EQ(0, footprint.released);
+}
+
+TEST(FootprintTests, OAuthBearer) {
+    const auto footprint = Measure< Sasl::Client::OAuthBearer >(
+        "OAUTHBEARER",
+        [](Sasl::Client::OAuthBearer& mech){ mech.SetCredentials("vF9dft4qmTc2Nvb3RlckBhbHRhdmlzdGEuY29tCg==", "user"); },
+        [](Sasl::Client::OAuthBearer& mech){
+            (void)mech.GetInitialResponse();
+            (void)mech.Proceed("");
+        }
+    );
+    EXPECT_EQ(0, footprint.released);
+}
+
+TEST(FootprintTests, XOAuth2) {
+    const auto footprint = Measure< Sasl::Client::XOAuth2 >(
+        "XOAUTH2",
+        [](Sasl::Client::XOAuth2& mech){ mech.SetCredentials("vF9dft4qmTc2Nvb3RlckBhbHRhdmlzdGEuY29tCg==", "user"); },
+        [](Sasl::Client::XOAuth2& mech){
+            (void)mech.GetInitialResponse();
+            (void)mech.Proceed("");
+        }
+    );
+    EXPECT_EQ(0, footprint.released);
+}
+
+TEST(FootprintTests, Scram) {
+    // The profile is shared, and made the first time it's asked for,
+    // so it's made before measuring.
+    const auto profile = Sasl::Client::ScramProfile::Sha1();
+    const auto footprint = Measure< Sasl::Client::Scram >(
+        "SCRAM-SHA-1",
+        [&](Sasl::Client::Scram& mech){
+            mech.SetProfile(profile);
+            mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+            mech.SetCredentials("pencil", "user");
+        },
+        [](Sasl::Client::Scram& mech){
+            (void)mech.GetInitialResponse();
+            (void)mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096");
+            (void)mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ=");
+            EXPECT_TRUE(mech.Succeeded());
+        }
+    );
+    // The client nonce is let go once the exchange is done.
+    EXPECT_LT(footprint.whenDone, footprint.withCredentials);
+    EXPECT_EQ(0, footprint.released);
+}
+
+TEST(FootprintTests, ScramResultKeptAfterRelease) {
+    Sasl::Client::Scram mech;
+    mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    (void)mech.GetInitialResponse();
+    (void)mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096");
+    (void)mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ=");
+    mech.Release();
+    EXPECT_TRUE(mech.Succeeded());
+    EXPECT_FALSE(mech.Faulted());
+
+    // Without credentials, a reset mechanism has nothing to send.
+    mech.Reset();
+    EXPECT_EQ("", mech.GetInitialResponse());
+
+    // The client nonce set before is forgotten too, since a nonce
+    // is only for one exchange.
+    mech.SetCredentials("pencil", "user");
+    const auto initialResponse = mech.GetInitialResponse();
+    EXPECT_EQ(0, initialResponse.find("n,,n=user,r="));
+    EXPECT_EQ(std::string::npos, initialResponse.find("fyko+d2lbbFgONRv9qkxdawL"));
+}
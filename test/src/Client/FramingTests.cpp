@@ -0,0 +1,404 @@
+/**
+ * @file FramingTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Client::Framing class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../AllocationCounter.hpp"
+
+#include <gtest/gtest.h>
+#include <Sasl/Base64.hpp>
+#include <Sasl/Client/Framing.hpp>
+#include <Sasl/Client/Login.hpp>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <string.h>
+#include <string>
+
+namespace {
+
+    /**
+     * This is the namespace attribute of the XMPP SASL elements.
+     */
+    const std::string XMLNS = "xmlns='urn:ietf:params:xml:ns:xmpp-sasl'";
+
+    /**
+     * This is the server-first-message of the example exchange
+     * from RFC 5802.
+     */
+    const std::string RFC5802_SERVER_FIRST = (
+        "r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096"
+    );
+
+    /**
+     * This is the client-final-message of the example exchange
+     * from RFC 5802.
+     */
+    const std::string RFC5802_CLIENT_FINAL = (
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts="
+    );
+
+    /**
+     * This is the server-final-message of the example exchange
+     * from RFC 5802.
+     */
+    const std::string RFC5802_SERVER_FINAL = "v=rmF9pqV8S7suAoZWja4dJRkFsKQ=";
+
+    /**
+     * Give the given line to the given adapter, as if it had just
+     * been received from the server.
+     *
+     * @param[in,out] framing
+     *     This is the adapter to which to give the line.
+     *
+     * @param[in] line
+     *     This is the line to give to the adapter.
+     *
+     * @param[in,out] output
+     *     This is the buffer of data to send to the server.
+     *
+     * @return
+     *     What came of the line is returned.
+     */
+    Sasl::Client::Framing::Status Receive(
+        Sasl::Client::Framing& framing,
+        std::string line,
+        std::string& output
+    ) {
+        return framing.Receive(&line[0], line.length(), output);
+    }
+
+    /**
+     * Set up the given SCRAM mechanism to use the example exchange
+     * from RFC 5802.
+     *
+     * @param[out] mech
+     *     This is the mechanism to set up.
+     */
+    void SetUpRfc5802Example(Sasl::Client::Scram& mech) {
+        mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+        mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+        mech.SetCredentials("pencil", "user");
+    }
+
+}
+
+TEST(FramingTests, SmtpPlainWithInitialResponse) {
+    Sasl::Client::Plain mech;
+    mech.SetCredentials("hunter2", "bob");
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Smtp);
+    std::string output;
+    framing.Begin(mech, "PLAIN", output);
+    EXPECT_EQ("AUTH PLAIN AGJvYgBodW50ZXIy\r\n", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Succeeded,
+        Receive(framing, "235 2.7.0 Authentication successful\r\n", output)
+    );
+    EXPECT_EQ("", output);
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Ignored,
+        Receive(framing, "250 OK\r\n", output)
+    );
+}
+
+TEST(FramingTests, SmtpLoginRejected) {
+    Sasl::Client::Login mech;
+    mech.SetCredentials("hunter2", "bob");
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Smtp);
+    std::string output;
+    framing.Begin(mech, "LOGIN", output);
+    EXPECT_EQ("AUTH LOGIN\r\n", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(framing, "334 VXNlcm5hbWU6\r\n", output)
+    );
+    EXPECT_EQ("Ym9i\r\n", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(framing, "334 UGFzc3dvcmQ6", output)
+    );
+    EXPECT_EQ("aHVudGVyMg==\r\n", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Ignored,
+        Receive(framing, "535-5.7.8 Username and Password not accepted.\r\n", output)
+    );
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Failed,
+        Receive(framing, "535 5.7.8 Learn more at example.com\r\n", output)
+    );
+    EXPECT_EQ("", output);
+}
+
+TEST(FramingTests, SmtpScramVerifiesServer) {
+    Sasl::Client::Scram mech;
+    SetUpRfc5802Example(mech);
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Smtp);
+    std::string output;
+    framing.Begin(mech, "SCRAM-SHA-1", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(framing, "334 " + Sasl::Base64::Encode(RFC5802_SERVER_FIRST) + "\r\n", output)
+    );
+    EXPECT_EQ(Sasl::Base64::Encode(RFC5802_CLIENT_FINAL) + "\r\n", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(framing, "334 " + Sasl::Base64::Encode(RFC5802_SERVER_FINAL) + "\r\n", output)
+    );
+    EXPECT_EQ("\r\n", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Succeeded,
+        Receive(framing, "235 2.7.0 Authentication successful\r\n", output)
+    );
+    EXPECT_TRUE(mech.Succeeded());
+}
+
+TEST(FramingTests, SmtpScramSuccessWithoutServerFinalFaults) {
+    Sasl::Client::Scram mech;
+    SetUpRfc5802Example(mech);
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Smtp);
+    std::string output;
+    framing.Begin(mech, "SCRAM-SHA-1", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(framing, "334 " + Sasl::Base64::Encode(RFC5802_SERVER_FIRST) + "\r\n", output)
+    );
+    output.clear();
+
+    // The server claims success without proving it knows the password.
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Faulted,
+        Receive(framing, "235 2.7.0 Authentication successful\r\n", output)
+    );
+    EXPECT_EQ("", output);
+    EXPECT_FALSE(mech.Succeeded());
+}
+
+TEST(FramingTests, ImapScramWithInitialResponse) {
+    Sasl::Client::Scram mech;
+    SetUpRfc5802Example(mech);
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Imap);
+    framing.SetImapTag("a001");
+    std::string output;
+    framing.Begin(mech, "SCRAM-SHA-1", output);
+    EXPECT_EQ(
+        "a001 AUTHENTICATE SCRAM-SHA-1 "
+        + Sasl::Base64::Encode(std::string("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL"))
+        + "\r\n",
+        output
+    );
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(framing, "+ " + Sasl::Base64::Encode(RFC5802_SERVER_FIRST) + "\r\n", output)
+    );
+    EXPECT_EQ(Sasl::Base64::Encode(RFC5802_CLIENT_FINAL) + "\r\n", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(framing, "+ " + Sasl::Base64::Encode(RFC5802_SERVER_FINAL) + "\r\n", output)
+    );
+    EXPECT_EQ("\r\n", output);
+    EXPECT_TRUE(mech.Succeeded());
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Ignored,
+        Receive(framing, "* CAPABILITY IMAP4rev1 IDLE\r\n", output)
+    );
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Ignored,
+        Receive(framing, "a000 OK earlier command\r\n", output)
+    );
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Succeeded,
+        Receive(framing, "a001 OK Success\r\n", output)
+    );
+    EXPECT_EQ("", output);
+}
+
+TEST(FramingTests, ImapWithoutInitialResponseSupport) {
+    Sasl::Client::Plain mech;
+    mech.SetCredentials("hunter2", "bob");
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Imap);
+    framing.SetInitialResponseSupported(false);
+    std::string output;
+    framing.Begin(mech, "PLAIN", output);
+    EXPECT_EQ("A1 AUTHENTICATE PLAIN\r\n", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(framing, "+\r\n", output)
+    );
+    EXPECT_EQ("AGJvYgBodW50ZXIy\r\n", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Failed,
+        Receive(framing, "A1 NO [AUTHENTICATIONFAILED] Invalid credentials\r\n", output)
+    );
+    EXPECT_EQ("", output);
+}
+
+TEST(FramingTests, XmppScramWithAdditionalDataOnSuccess) {
+    Sasl::Client::Scram mech;
+    SetUpRfc5802Example(mech);
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Xmpp);
+    std::string output;
+    framing.Begin(mech, "SCRAM-SHA-1", output);
+    EXPECT_EQ(
+        "<auth " + XMLNS + " mechanism='SCRAM-SHA-1'>"
+        + Sasl::Base64::Encode(std::string("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL"))
+        + "</auth>",
+        output
+    );
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(
+            framing,
+            "<challenge " + XMLNS + ">" + Sasl::Base64::Encode(RFC5802_SERVER_FIRST) + "</challenge>",
+            output
+        )
+    );
+    EXPECT_EQ(
+        "<response " + XMLNS + ">" + Sasl::Base64::Encode(RFC5802_CLIENT_FINAL) + "</response>",
+        output
+    );
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Succeeded,
+        Receive(
+            framing,
+            "<success " + XMLNS + ">" + Sasl::Base64::Encode(RFC5802_SERVER_FINAL) + "</success>\n",
+            output
+        )
+    );
+    EXPECT_EQ("", output);
+    EXPECT_TRUE(mech.Succeeded());
+}
+
+TEST(FramingTests, XmppWrongServerSignatureOnSuccess) {
+    Sasl::Client::Scram mech;
+    SetUpRfc5802Example(mech);
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Xmpp);
+    std::string output;
+    framing.Begin(mech, "SCRAM-SHA-1", output);
+    (void)Receive(
+        framing,
+        "<challenge " + XMLNS + ">" + Sasl::Base64::Encode(RFC5802_SERVER_FIRST) + "</challenge>",
+        output
+    );
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Faulted,
+        Receive(
+            framing,
+            "<success " + XMLNS + ">" + Sasl::Base64::Encode(std::string("v=xyz")) + "</success>",
+            output
+        )
+    );
+    EXPECT_FALSE(mech.Succeeded());
+}
+
+TEST(FramingTests, XmppEmptyElements) {
+    Sasl::Client::Login mech;
+    mech.SetCredentials("hunter2", "bob");
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Xmpp);
+    std::string output;
+    framing.Begin(mech, "LOGIN", output);
+    EXPECT_EQ("<auth " + XMLNS + " mechanism='LOGIN'/>", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        Receive(framing, "<challenge " + XMLNS + ">VXNlcm5hbWU6</challenge>", output)
+    );
+    EXPECT_EQ("<response " + XMLNS + ">Ym9i</response>", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Failed,
+        Receive(framing, "<failure " + XMLNS + "><not-authorized/></failure>", output)
+    );
+    EXPECT_EQ("", output);
+}
+
+TEST(FramingTests, CancelWhenMechanismFaults) {
+    Sasl::Client::Scram mech;
+    SetUpRfc5802Example(mech);
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Imap);
+    std::string output;
+    framing.Begin(mech, "SCRAM-SHA-1", output);
+    output.clear();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Faulted,
+        Receive(framing, "+ " + Sasl::Base64::Encode(std::string("foobar")) + "\r\n", output)
+    );
+    EXPECT_EQ("*\r\n", output);
+    EXPECT_TRUE(mech.Faulted());
+}
+
+TEST(FramingTests, CancelOnMalformedLines) {
+    for (const auto& line: {
+        "334 not*base64\r\n",
+        "334-VXNlcm5hbWU6\r\n",
+        "hello\r\n",
+        "",
+    }) {
+        Sasl::Client::Login mech;
+        mech.SetCredentials("hunter2", "bob");
+        Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Smtp);
+        std::string output;
+        framing.Begin(mech, "LOGIN", output);
+        output.clear();
+        EXPECT_EQ(
+            Sasl::Client::Framing::Status::Malformed,
+            Receive(framing, line, output)
+        ) << line;
+        EXPECT_EQ("*\r\n", output) << line;
+    }
+    for (const auto& element: {
+        "<challenge " + XMLNS + ">VXNlcm5hbWU6</response>",
+        "<challenge " + XMLNS + ">VXNlcm5hbWU</challenge>",
+        "<proceed " + XMLNS + "/>",
+        std::string("challenge"),
+    }) {
+        Sasl::Client::Login mech;
+        mech.SetCredentials("hunter2", "bob");
+        Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Xmpp);
+        std::string output;
+        framing.Begin(mech, "LOGIN", output);
+        output.clear();
+        EXPECT_EQ(
+            Sasl::Client::Framing::Status::Malformed,
+            Receive(framing, element, output)
+        ) << element;
+        EXPECT_EQ("<abort " + XMLNS + "/>", output) << element;
+    }
+}
+
+TEST(FramingTests, ChallengeDecodedInPlaceWithoutAllocating) {
+    Sasl::Client::Login mech;
+    mech.SetCredentials("hunter2", "bob");
+    Sasl::Client::Framing framing(Sasl::Client::Framing::Protocol::Smtp);
+    std::string output;
+    output.reserve(64);
+    framing.Begin(mech, "LOGIN", output);
+    output.clear();
+    char receiveBuffer[] = "334 VXNlcm5hbWU6\r\n";
+    const auto allocationsBefore = AllocationCounter::GetCount();
+    EXPECT_EQ(
+        Sasl::Client::Framing::Status::Continue,
+        framing.Receive(receiveBuffer, sizeof(receiveBuffer) - 1, output)
+    );
+    EXPECT_EQ(allocationsBefore, AllocationCounter::GetCount());
+    EXPECT_EQ("Ym9i\r\n", output);
+    EXPECT_EQ(0, memcmp(receiveBuffer + 4, "Username:", 9));
+}
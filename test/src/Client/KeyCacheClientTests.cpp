@@ -0,0 +1,149 @@
+/**
+ * @file KeyCacheClientTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Client::KeyCacheClient class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <Sasl/Client/KeyCacheClient.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <Sasl/KeyCache.hpp>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    /**
+     * This is the secret shared by the key cache clients in the tests.
+     */
+    const std::string SECRET(Sasl::Client::KEY_CACHE_SECRET_LENGTH, 's');
+
+    /**
+     * Run the example exchange from RFC 5802 with a SCRAM-SHA-1 mechanism
+     * using the given profile.
+     *
+     * @param[in] profile
+     *     This is the profile to use.
+     *
+     * @param[in] password
+     *     This is the password to use.
+     *
+     * @return
+     *     An indication of whether or not the exchange succeeded
+     *     is returned.
+     */
+    bool RunRfc5802Example(
+        std::shared_ptr< const Sasl::Client::ScramProfile > profile,
+        const std::string& password = "pencil"
+    ) {
+        Sasl::Client::Scram mech;
+        mech.SetProfile(profile);
+        mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+        mech.SetCredentials(password, "user");
+        (void)mech.GetInitialResponse();
+        (void)mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096");
+        (void)mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ=");
+        return mech.Succeeded();
+    }
+
+}
+
+#ifndef _WIN32
+TEST(KeyCacheClientTests, SecondClientFindsKeyDerivedByFirst) {
+    const auto socketPath = (
+        "/tmp/SaslKeyCacheClientTests-" + std::to_string(getpid()) + ".sock"
+    );
+    Sasl::KeyCache::Daemon daemon;
+    ASSERT_TRUE(daemon.Start(socketPath));
+    const Sasl::Client::KeyCacheClient first(socketPath, SECRET);
+    EXPECT_TRUE(RunRfc5802Example(first.Attach(Sasl::Client::ScramProfile::Sha1())));
+    auto stats = first.GetStats();
+    EXPECT_EQ(0, stats.hits);
+    EXPECT_EQ(1, stats.misses);
+    EXPECT_EQ(1, stats.stores);
+    EXPECT_EQ(1, daemon.GetStats().entries);
+    const Sasl::Client::KeyCacheClient second(socketPath, SECRET);
+    EXPECT_TRUE(RunRfc5802Example(second.Attach(Sasl::Client::ScramProfile::Sha1())));
+    stats = second.GetStats();
+    EXPECT_EQ(1, stats.hits);
+    EXPECT_EQ(0, stats.misses);
+    EXPECT_EQ(0, stats.stores);
+
+    // A different password has a different fingerprint,
+    // so it isn't served the cached key.
+    EXPECT_FALSE(RunRfc5802Example(second.Attach(Sasl::Client::ScramProfile::Sha1()), "pen"));
+    stats = second.GetStats();
+    EXPECT_EQ(1, stats.hits);
+    EXPECT_EQ(1, stats.misses);
+
+    // A client with a different secret makes different fingerprints,
+    // so it isn't served the cached key either.
+    const Sasl::Client::KeyCacheClient third(
+        socketPath,
+        std::string(Sasl::Client::KEY_CACHE_SECRET_LENGTH, 't')
+    );
+    EXPECT_TRUE(RunRfc5802Example(third.Attach(Sasl::Client::ScramProfile::Sha1())));
+    stats = third.GetStats();
+    EXPECT_EQ(0, stats.hits);
+    EXPECT_EQ(1, stats.misses);
+    daemon.Stop();
+}
+
+TEST(KeyCacheClientTests, DeriveLocallyWithoutSecret) {
+    const auto socketPath = (
+        "/tmp/SaslKeyCacheClientTests-" + std::to_string(getpid()) + ".sock"
+    );
+    Sasl::KeyCache::Daemon daemon;
+    ASSERT_TRUE(daemon.Start(socketPath));
+    const Sasl::Client::KeyCacheClient client(socketPath, "short");
+    EXPECT_TRUE(RunRfc5802Example(client.Attach(Sasl::Client::ScramProfile::Sha1())));
+    const auto stats = client.GetStats();
+    EXPECT_EQ(0, stats.hits);
+    EXPECT_EQ(0, stats.misses);
+    EXPECT_EQ(1, stats.unavailable);
+    EXPECT_EQ(0, stats.stores);
+    EXPECT_EQ(0, daemon.GetStats().entries);
+    daemon.Stop();
+}
+
+TEST(KeyCacheClientTests, ReadKeyCacheSecretMadeOnce) {
+    const auto path = (
+        "/tmp/SaslKeyCacheClientTests-" + std::to_string(getpid()) + ".key"
+    );
+    (void)unlink(path.c_str());
+    std::string first;
+    ASSERT_TRUE(Sasl::Client::ReadKeyCacheSecret(path, first));
+    EXPECT_EQ(Sasl::Client::KEY_CACHE_SECRET_LENGTH, first.length());
+    struct stat status;
+    ASSERT_EQ(0, stat(path.c_str(), &status));
+    EXPECT_EQ(0, status.st_mode & (S_IRWXG | S_IRWXO));
+    std::string second;
+    ASSERT_TRUE(Sasl::Client::ReadKeyCacheSecret(path, second));
+    EXPECT_EQ(first, second);
+
+    // A secret others can read isn't used.
+    ASSERT_EQ(0, chmod(path.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
+    EXPECT_FALSE(Sasl::Client::ReadKeyCacheSecret(path, second));
+    (void)unlink(path.c_str());
+}
+#endif
+
+TEST(KeyCacheClientTests, DeriveLocallyWhenDaemonAbsent) {
+    const Sasl::Client::KeyCacheClient client("/tmp/SaslKeyCacheClientTests-absent.sock", SECRET);
+    const auto profile = client.Attach(Sasl::Client::ScramProfile::Sha1());
+    EXPECT_TRUE(RunRfc5802Example(profile));
+    EXPECT_TRUE(RunRfc5802Example(profile));
+    const auto stats = client.GetStats();
+    EXPECT_EQ(0, stats.hits);
+    EXPECT_EQ(0, stats.misses);
+    EXPECT_EQ(2, stats.unavailable);
+    EXPECT_EQ(0, stats.stores);
+}
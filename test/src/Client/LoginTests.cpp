@@ -7,8 +7,12 @@
  * © 2019 by Richard Walters
  */
 
+#include "../AllocationCounter.hpp"
+
+#include <chrono>
 #include <gtest/gtest.h>
 #include <Sasl/Client/Login.hpp>
+#include <utility>
 
 TEST(LoginTests, NoInitialResponse) {
     Sasl::Client::Login mech;
@@ -60,3 +64,50 @@ TEST(LoginTests, MechanismCannotDetermineSuccess) {
     (void)mech.Proceed("Password:");
     EXPECT_FALSE(mech.Succeeded());
 }
+
+TEST(LoginTests, SharedCredentials) {
+    const auto credentials = Sasl::Client::PasswordCredentials::Create("hunter2", "bob");
+    Sasl::Client::Login mechs[2];
+    for (auto& mech: mechs) {
+        mech.SetSharedCredentials(credentials);
+        EXPECT_EQ("bob", mech.Proceed("Username:"));
+        EXPECT_EQ("hunter2", mech.Proceed("Password:"));
+    }
+    EXPECT_EQ(3, credentials.use_count());
+}
+
+TEST(LoginTests, ConstructionAndMoveDoNotAllocate) {
+    const auto allocationsBefore = AllocationCounter::GetCount();
+    Sasl::Client::Login mech;
+    Sasl::Client::Login other(std::move(mech));
+    mech = std::move(other);
+    EXPECT_EQ(allocationsBefore, AllocationCounter::GetCount());
+}
+
+TEST(LoginTests, ExchangePastDeadlineFaults) {
+    Sasl::Client::Login mech;
+    mech.SetCredentials("hunter2", "bob");
+    mech.SetDeadline(std::chrono::steady_clock::now() + std::chrono::hours(1));
+    EXPECT_EQ("bob", mech.Proceed("Username:"));
+    EXPECT_FALSE(mech.Faulted());
+    mech.SetDeadline(std::chrono::steady_clock::now() - std::chrono::seconds(1));
+    EXPECT_EQ("", mech.Proceed("Password:"));
+    EXPECT_TRUE(mech.Faulted());
+}
+
+TEST(LoginTests, InitialResponseModeAlways) {
+    Sasl::Client::Login mech;
+    mech.SetCredentials("hunter2", "bob");
+    auto profile = mech.GetRoundTripProfile();
+    EXPECT_FALSE(profile.sendsInitialResponse);
+    EXPECT_EQ(3, profile.roundTrips);
+    EXPECT_EQ("", mech.GetInitialResponse());
+    mech.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Always);
+    profile = mech.GetRoundTripProfile();
+    EXPECT_TRUE(profile.sendsInitialResponse);
+    EXPECT_EQ(2, profile.roundTrips);
+    mech.Reset();
+    EXPECT_EQ("bob", mech.GetInitialResponse());
+    EXPECT_EQ("hunter2", mech.Proceed("Password:"));
+    EXPECT_EQ("", mech.Proceed(""));
+}
@@ -0,0 +1,136 @@
+/**
+ * @file MechanismRegistryTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Client::MechanismRegistry class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <Sasl/Client/MechanismRegistry.hpp>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <string>
+
+namespace {
+
+    /**
+     * This counts the number of mechanisms made by MakeTestMechanism.
+     */
+    size_t numTestMechanismsMade = 0;
+
+    /**
+     * Make a mechanism for a custom registry table.
+     *
+     * @return
+     *     The new mechanism is returned.
+     */
+    std::unique_ptr< Sasl::Client::Mechanism > MakeTestMechanism() {
+        ++numTestMechanismsMade;
+        return std::unique_ptr< Sasl::Client::Mechanism >(new Sasl::Client::Plain());
+    }
+
+    /**
+     * This is a custom registry table, built at compile time.
+     */
+    constexpr Sasl::Client::MechanismRegistry::Entry TEST_ENTRIES[] = {
+        Sasl::Client::MechanismRegistry::MakeEntry("X-FOO", MakeTestMechanism, 5, 1, 0),
+        Sasl::Client::MechanismRegistry::MakeEntry("X-BAR", MakeTestMechanism, 5, 3, 0),
+    };
+
+    /**
+     * This is a custom registry, built at compile time.
+     */
+    constexpr Sasl::Client::MechanismRegistry TEST_REGISTRY(TEST_ENTRIES);
+
+    static_assert(
+        TEST_REGISTRY.GetNumEntries() == 2,
+        "custom registry should be built at compile time"
+    );
+
+    static_assert(
+        TEST_ENTRIES[0].nameHash == Sasl::Client::MechanismRegistry::HashName("X-FOO"),
+        "mechanism name hashes should be computed at compile time"
+    );
+
+}
+
+TEST(MechanismRegistryTests, FindBuiltInMechanisms) {
+    const auto& registry = Sasl::Client::MechanismRegistry::BuiltIn();
+    EXPECT_EQ(5, registry.GetNumEntries());
+    for (const auto name: {"SCRAM-SHA-256", "SCRAM-SHA-1", "PLAIN", "CRAM-MD5", "LOGIN"}) {
+        const auto entry = registry.Find(name);
+        ASSERT_NE(nullptr, entry) << name;
+        EXPECT_EQ(std::string(name), entry->name);
+        EXPECT_NE(nullptr, entry->factory());
+    }
+    EXPECT_EQ(nullptr, registry.Find("SCRAM-SHA"));
+    EXPECT_EQ(nullptr, registry.Find("SCRAM-SHA-1-PLUS"));
+    EXPECT_EQ(nullptr, registry.Find(""));
+}
+
+TEST(MechanismRegistryTests, SelectMostSecure) {
+    const auto& registry = Sasl::Client::MechanismRegistry::BuiltIn();
+    const auto entry = registry.Select("PLAIN LOGIN SCRAM-SHA-1 SCRAM-SHA-256");
+    ASSERT_NE(nullptr, entry);
+    EXPECT_EQ(std::string("SCRAM-SHA-256"), entry->name);
+    EXPECT_EQ(
+        std::string("SCRAM-SHA-1"),
+        registry.Select("LOGIN, SCRAM-SHA-1,PLAIN DIGEST-MD5")->name
+    );
+}
+
+TEST(MechanismRegistryTests, SelectFewestRoundTripsAtSameSecurity) {
+    const auto& registry = Sasl::Client::MechanismRegistry::BuiltIn();
+    EXPECT_EQ(std::string("PLAIN"), registry.Select("LOGIN PLAIN")->name);
+    EXPECT_EQ(std::string("CRAM-MD5"), registry.Select("LOGIN CRAM-MD5")->name);
+    EXPECT_EQ(std::string("PLAIN"), registry.Select("CRAM-MD5 PLAIN")->name);
+    EXPECT_EQ(std::string("X-FOO"), TEST_REGISTRY.Select("X-BAR X-FOO")->name);
+}
+
+TEST(MechanismRegistryTests, NothingSelectable) {
+    const auto& registry = Sasl::Client::MechanismRegistry::BuiltIn();
+    EXPECT_EQ(nullptr, registry.Select(""));
+    EXPECT_EQ(nullptr, registry.Select("GSSAPI DIGEST-MD5"));
+    Sasl::Client::MechanismRegistry::Preferences preferences;
+    preferences.minSecurity = 2;
+    EXPECT_EQ(nullptr, registry.Select("PLAIN LOGIN", preferences));
+    std::string name;
+    EXPECT_EQ(nullptr, registry.Create("PLAIN LOGIN", name, preferences));
+}
+
+TEST(MechanismRegistryTests, PreferPreparedCredentials) {
+    const auto& registry = Sasl::Client::MechanismRegistry::BuiltIn();
+    Sasl::Client::MechanismRegistry::Preferences preferences;
+    preferences.securityWeight = 1;
+    preferences.roundTripWeight = 0;
+    EXPECT_EQ(std::string("PLAIN"), registry.Select("SCRAM-SHA-1 PLAIN", preferences)->name);
+    preferences.hasPreparedCredentials = [](
+        const Sasl::Client::MechanismRegistry::Entry& entry
+    ){
+        return (std::string(entry.name) == "SCRAM-SHA-1");
+    };
+    EXPECT_EQ(std::string("SCRAM-SHA-1"), registry.Select("SCRAM-SHA-1 PLAIN", preferences)->name);
+}
+
+TEST(MechanismRegistryTests, CreateSelectedMechanism) {
+    std::string name;
+    const auto mech = Sasl::Client::MechanismRegistry::BuiltIn().Create("PLAIN SCRAM-SHA-1", name);
+    ASSERT_NE(nullptr, mech);
+    EXPECT_EQ("SCRAM-SHA-1", name);
+    const auto scram = dynamic_cast< Sasl::Client::Scram* >(mech.get());
+    ASSERT_NE(nullptr, scram);
+    scram->SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    scram->SetCredentials("pencil", "user");
+    (void)scram->Proceed("");
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        scram->Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096")
+    );
+    numTestMechanismsMade = 0;
+    EXPECT_NE(nullptr, TEST_REGISTRY.Create("X-FOO", name));
+    EXPECT_EQ("X-FOO", name);
+    EXPECT_EQ(1, numTestMechanismsMade);
+}
@@ -0,0 +1,198 @@
+/**
+ * @file MultiplexerTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Client::Multiplexer class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <Sasl/Client/Login.hpp>
+#include <Sasl/Client/Multiplexer.hpp>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <Sasl/Client/XOAuth2.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * Make a new PLAIN mechanism with the given credentials.
+     *
+     * @param[in] password
+     *     This is the password to use in the authentication.
+     *
+     * @param[in] username
+     *     This is the username to use in the authentication.
+     *
+     * @return
+     *     The new mechanism is returned.
+     */
+    std::unique_ptr< Sasl::Client::Mechanism > MakePlain(
+        const std::string& password,
+        const std::string& username
+    ) {
+        std::unique_ptr< Sasl::Client::Mechanism > mech(new Sasl::Client::Plain());
+        mech->SetCredentials(password, username);
+        return mech;
+    }
+
+}
+
+TEST(MultiplexerTests, DriveManyExchanges) {
+    constexpr size_t numExchanges = 1000;
+    Sasl::Client::Multiplexer multiplexer;
+    multiplexer.Reserve(numExchanges);
+    std::vector< Sasl::Client::Multiplexer::Message > inbound;
+    for (size_t i = 0; i < numExchanges; ++i) {
+        std::unique_ptr< Sasl::Client::Mechanism > mech(new Sasl::Client::Login());
+        mech->SetCredentials("hunter" + std::to_string(i), "bob" + std::to_string(i));
+        std::string initialResponse;
+        ASSERT_TRUE(multiplexer.Add(i, std::move(mech), initialResponse));
+        EXPECT_EQ("", initialResponse);
+        inbound.push_back({i, "Username:"});
+    }
+    EXPECT_EQ(numExchanges, multiplexer.GetExchangeCount());
+    std::vector< Sasl::Client::Multiplexer::Message > outbound;
+    std::vector< Sasl::Client::Multiplexer::Completion > completions;
+    multiplexer.Process(inbound, outbound, completions);
+    ASSERT_EQ(numExchanges, outbound.size());
+    EXPECT_TRUE(completions.empty());
+    for (size_t i = 0; i < numExchanges; ++i) {
+        EXPECT_EQ(i, outbound[i].connectionId);
+        EXPECT_EQ("bob" + std::to_string(i), outbound[i].text);
+        inbound[i].text = "Password:";
+    }
+    outbound.clear();
+    multiplexer.Process(inbound, outbound, completions);
+    ASSERT_EQ(numExchanges, outbound.size());
+    for (size_t i = 0; i < numExchanges; ++i) {
+        EXPECT_EQ("hunter" + std::to_string(i), outbound[i].text);
+        inbound[i].text = "";
+    }
+    outbound.clear();
+    multiplexer.Process(inbound, outbound, completions);
+    EXPECT_TRUE(outbound.empty());
+    ASSERT_EQ(numExchanges, completions.size());
+    for (size_t i = 0; i < numExchanges; ++i) {
+        EXPECT_EQ(i, completions[i].connectionId);
+        EXPECT_FALSE(completions[i].faulted);
+        EXPECT_NE(nullptr, completions[i].mechanism);
+    }
+    EXPECT_EQ(0, multiplexer.GetExchangeCount());
+    const auto statistics = multiplexer.GetStatistics();
+    EXPECT_EQ(numExchanges, statistics.exchangesStarted);
+    EXPECT_EQ(numExchanges, statistics.exchangesCompleted);
+    EXPECT_EQ(3 * numExchanges, statistics.messagesProcessed);
+    EXPECT_EQ(0, statistics.messagesDropped);
+    EXPECT_GT(statistics.exchangesPerSecond, 0.0);
+}
+
+TEST(MultiplexerTests, ScramExchange) {
+    Sasl::Client::Multiplexer multiplexer;
+    std::unique_ptr< Sasl::Client::Scram > scram(new Sasl::Client::Scram());
+    scram->SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+    scram->SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    scram->SetCredentials("pencil", "user");
+    std::string initialResponse;
+    ASSERT_TRUE(multiplexer.Add(42, std::move(scram), initialResponse));
+    EXPECT_EQ("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL", initialResponse);
+    std::vector< Sasl::Client::Multiplexer::Message > outbound;
+    std::vector< Sasl::Client::Multiplexer::Completion > completions;
+    multiplexer.Process(
+        {{42, "r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096"}},
+        outbound,
+        completions
+    );
+    ASSERT_EQ(1, outbound.size());
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        outbound[0].text
+    );
+    outbound.clear();
+    multiplexer.Process({{42, "v=rmF9pqV8S7suAoZWja4dJRkFsKQ="}}, outbound, completions);
+    EXPECT_TRUE(outbound.empty());
+    ASSERT_EQ(1, completions.size());
+    EXPECT_EQ(42, completions[0].connectionId);
+    EXPECT_TRUE(completions[0].succeeded);
+    EXPECT_FALSE(completions[0].faulted);
+}
+
+TEST(MultiplexerTests, FaultedExchangeCompletes) {
+    Sasl::Client::Multiplexer multiplexer;
+    std::unique_ptr< Sasl::Client::Scram > scram(new Sasl::Client::Scram());
+    scram->SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+    scram->SetCredentials("pencil", "user");
+    std::string initialResponse;
+    ASSERT_TRUE(multiplexer.Add(1, std::move(scram), initialResponse));
+    std::vector< Sasl::Client::Multiplexer::Message > outbound;
+    std::vector< Sasl::Client::Multiplexer::Completion > completions;
+    multiplexer.Process({{1, "foobar"}, {1, "v=xyz"}}, outbound, completions);
+    EXPECT_TRUE(outbound.empty());
+    ASSERT_EQ(1, completions.size());
+    EXPECT_TRUE(completions[0].faulted);
+    EXPECT_FALSE(completions[0].succeeded);
+    EXPECT_EQ(1, multiplexer.GetStatistics().messagesDropped);
+}
+
+TEST(MultiplexerTests, XOAuth2ErrorChallengeAcknowledged) {
+    Sasl::Client::Multiplexer multiplexer;
+    std::unique_ptr< Sasl::Client::Mechanism > xoauth2(new Sasl::Client::XOAuth2());
+    xoauth2->SetCredentials("token1", "bob");
+    std::string initialResponse;
+    ASSERT_TRUE(multiplexer.Add(1, std::move(xoauth2), initialResponse));
+    EXPECT_EQ("user=bob\x01" "auth=Bearer token1\x01\x01", initialResponse);
+    std::vector< Sasl::Client::Multiplexer::Message > outbound;
+    std::vector< Sasl::Client::Multiplexer::Completion > completions;
+    multiplexer.Process(
+        {{1, "{\"status\":\"401\",\"schemes\":\"bearer\",\"scope\":\"mail\"}"}},
+        outbound,
+        completions
+    );
+
+    // The empty acknowledgement of the error challenge is sent, and the
+    // exchange goes on until the server reports its outcome.
+    ASSERT_EQ(1, outbound.size());
+    EXPECT_EQ(1, outbound[0].connectionId);
+    EXPECT_EQ("", outbound[0].text);
+    EXPECT_TRUE(completions.empty());
+    EXPECT_EQ(1, multiplexer.GetExchangeCount());
+}
+
+TEST(MultiplexerTests, OneExchangePerConnection) {
+    Sasl::Client::Multiplexer multiplexer;
+    std::string initialResponse;
+    EXPECT_TRUE(multiplexer.Add(1, MakePlain("hunter2", "bob"), initialResponse));
+    EXPECT_EQ(std::string("\0bob\0hunter2", 12), initialResponse);
+    EXPECT_FALSE(multiplexer.Add(1, MakePlain("pencil", "user"), initialResponse));
+    EXPECT_FALSE(multiplexer.Add(2, nullptr, initialResponse));
+    EXPECT_EQ(1, multiplexer.GetExchangeCount());
+    EXPECT_NE(nullptr, multiplexer.Remove(1));
+    EXPECT_EQ(nullptr, multiplexer.Remove(1));
+    EXPECT_EQ(0, multiplexer.GetExchangeCount());
+    EXPECT_TRUE(multiplexer.Add(1, MakePlain("pencil", "user"), initialResponse));
+}
+
+TEST(MultiplexerTests, MessagesForUnknownConnectionsDropped) {
+    Sasl::Client::Multiplexer multiplexer;
+    std::unique_ptr< Sasl::Client::Mechanism > mech(MakePlain("hunter2", "bob"));
+    mech->SetInitialResponseMode(Sasl::Client::InitialResponseMode::Never);
+    std::string initialResponse;
+    EXPECT_TRUE(multiplexer.Add(1, std::move(mech), initialResponse));
+    EXPECT_EQ("", initialResponse);
+    std::vector< Sasl::Client::Multiplexer::Message > outbound;
+    std::vector< Sasl::Client::Multiplexer::Completion > completions;
+    multiplexer.Process({{2, ""}, {1, ""}, {3, ""}}, outbound, completions);
+    ASSERT_EQ(1, outbound.size());
+    EXPECT_EQ(1, outbound[0].connectionId);
+    auto statistics = multiplexer.GetStatistics();
+    EXPECT_EQ(2, statistics.messagesDropped);
+    EXPECT_EQ(1, statistics.messagesProcessed);
+    multiplexer.ResetStatistics();
+    statistics = multiplexer.GetStatistics();
+    EXPECT_EQ(0, statistics.messagesDropped);
+    EXPECT_EQ(0, statistics.messagesProcessed);
+}
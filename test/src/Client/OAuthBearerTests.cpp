@@ -0,0 +1,246 @@
+/**
+ * @file OAuthBearerTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Client::OAuthBearer and Sasl::Client::BearerCredentials classes.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../AllocationCounter.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <Sasl/Client/OAuthBearer.hpp>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST(OAuthBearerTests, Rfc7628Example) {
+    // This is the example of RFC 7628 section 4.1.
+    Sasl::Client::OAuthBearer mech;
+    mech.SetSharedCredentials(
+        Sasl::Client::BearerCredentials::Create(
+            "vF9dft4qmTc2Nvb3RlckBhbHRhdmlzdGEuY29tCg==",
+            "user@example.com",
+            "server.example.com",
+            143
+        )
+    );
+    EXPECT_EQ(
+        "n,a=user@example.com,\x01host=server.example.com\x01port=143\x01"
+        "auth=Bearer vF9dft4qmTc2Nvb3RlckBhbHRhdmlzdGEuY29tCg==\x01\x01",
+        mech.GetInitialResponse()
+    );
+    EXPECT_EQ("", mech.Proceed(""));
+    EXPECT_EQ("", mech.GetErrorChallenge());
+}
+
+TEST(OAuthBearerTests, CredentialsFromSetCredentials) {
+    Sasl::Client::OAuthBearer mech;
+    mech.SetCredentials("token1", "bob");
+    EXPECT_EQ(
+        "n,a=bob,\x01" "auth=Bearer token1\x01\x01",
+        mech.GetInitialResponse()
+    );
+    mech.SetCredentials("token1", "bob", "alex");
+    mech.Reset();
+    EXPECT_EQ(
+        "n,a=alex,\x01" "auth=Bearer token1\x01\x01",
+        mech.GetInitialResponse()
+    );
+}
+
+TEST(OAuthBearerTests, EmptyUserLeftOutOfGs2Header) {
+    Sasl::Client::OAuthBearer mech;
+    mech.SetCredentials("token1", "");
+    EXPECT_EQ(
+        "n,,\x01" "auth=Bearer token1\x01\x01",
+        mech.GetInitialResponse()
+    );
+}
+
+TEST(OAuthBearerTests, UserEscapedInGs2Header) {
+    Sasl::Client::OAuthBearer mech;
+    mech.SetCredentials("token1", "a,b=c");
+    EXPECT_EQ(
+        "n,a=a=2Cb=3Dc,\x01" "auth=Bearer token1\x01\x01",
+        mech.GetInitialResponse()
+    );
+}
+
+TEST(OAuthBearerTests, InitialResponseModeNever) {
+    Sasl::Client::OAuthBearer mech;
+    mech.SetCredentials("token1", "bob");
+    auto profile = mech.GetRoundTripProfile();
+    EXPECT_TRUE(profile.sendsInitialResponse);
+    EXPECT_EQ(1, profile.roundTrips);
+    mech.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Never);
+    profile = mech.GetRoundTripProfile();
+    EXPECT_FALSE(profile.sendsInitialResponse);
+    EXPECT_EQ(2, profile.roundTrips);
+    EXPECT_EQ("", mech.GetInitialResponse());
+    EXPECT_EQ(
+        "n,a=bob,\x01" "auth=Bearer token1\x01\x01",
+        mech.Proceed("")
+    );
+}
+
+TEST(OAuthBearerTests, ErrorChallengeAcknowledged) {
+    // This is the example of RFC 7628 section 4.3.
+    const std::string errorChallenge = (
+        "{\"status\":\"invalid_token\","
+        "\"scope\":\"example_scope\","
+        "\"openid-configuration\":\"https://example.com/.well-known/openid-configuration\"}"
+    );
+    Sasl::Client::OAuthBearer mech;
+    mech.SetCredentials("token1", "bob");
+    (void)mech.GetInitialResponse();
+    EXPECT_EQ("\x01", mech.Proceed(errorChallenge));
+    EXPECT_EQ(errorChallenge, mech.GetErrorChallenge());
+    EXPECT_EQ("", mech.Proceed(""));
+    EXPECT_FALSE(mech.Succeeded());
+    EXPECT_FALSE(mech.Faulted());
+    mech.Reset();
+    EXPECT_EQ("", mech.GetErrorChallenge());
+}
+
+TEST(OAuthBearerTests, RefreshSeenAtNextExchange) {
+    const auto credentials = Sasl::Client::BearerCredentials::Create("token1", "bob");
+    EXPECT_EQ(1, credentials->GetPayloads()->generation);
+    Sasl::Client::OAuthBearer mech1, mech2;
+    mech1.SetSharedCredentials(credentials);
+    mech2.SetSharedCredentials(credentials);
+    mech1.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Never);
+    (void)mech1.GetInitialResponse();
+    EXPECT_EQ(
+        "n,a=bob,\x01" "auth=Bearer token1\x01\x01",
+        mech2.GetInitialResponse()
+    );
+    credentials->Refresh("token2");
+    EXPECT_EQ(2, credentials->GetPayloads()->generation);
+    EXPECT_EQ(
+        "n,a=bob,\x01" "auth=Bearer token2\x01\x01",
+        mech1.Proceed("")
+    );
+    mech2.Reset();
+    EXPECT_EQ(
+        "n,a=bob,\x01" "auth=Bearer token2\x01\x01",
+        mech2.GetInitialResponse()
+    );
+}
+
+TEST(OAuthBearerTests, ExchangeKeepsPayloadItStartedWith) {
+    const auto credentials = Sasl::Client::BearerCredentials::Create("token1", "bob");
+    const auto payloads = credentials->GetPayloads();
+    Sasl::Client::OAuthBearer mech;
+    mech.SetSharedCredentials(credentials);
+    (void)mech.GetInitialResponse();
+    EXPECT_EQ(3, payloads.use_count());
+    credentials->Refresh("token2");
+    EXPECT_EQ(2, payloads.use_count());
+    mech.Reset();
+    EXPECT_EQ(1, payloads.use_count());
+}
+
+TEST(OAuthBearerTests, RefreshWhileOtherThreadsAuthenticate) {
+    const auto credentials = Sasl::Client::BearerCredentials::Create("token0", "bob");
+    std::atomic< bool > stop(false);
+    std::atomic< size_t > badPayloads(0);
+    std::vector< std::thread > threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back(
+            [&]{
+                Sasl::Client::OAuthBearer mech;
+                mech.SetSharedCredentials(credentials);
+                while (!stop) {
+                    mech.Reset();
+                    const auto payload = mech.GetInitialResponse();
+                    if (
+                        (payload.substr(0, 26) != "n,a=bob,\x01" "auth=Bearer token")
+                        || (payload.substr(payload.length() - 2) != "\x01\x01")
+                    ) {
+                        ++badPayloads;
+                    }
+                }
+            }
+        );
+    }
+    for (size_t i = 1; i <= 1000; ++i) {
+        credentials->Refresh("token" + std::to_string(i));
+    }
+    stop = true;
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    EXPECT_EQ(0, badPayloads);
+    EXPECT_EQ(1001, credentials->GetPayloads()->generation);
+}
+
+TEST(OAuthBearerTests, RefreshFromManyThreadsKeepsLatest) {
+    const auto credentials = Sasl::Client::BearerCredentials::Create("token0", "bob");
+    std::vector< std::thread > threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back(
+            [&]{
+                for (size_t j = 0; j < 250; ++j) {
+                    credentials->Refresh("token");
+                }
+            }
+        );
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    EXPECT_EQ(1001, credentials->GetPayloads()->generation);
+}
+
+TEST(OAuthBearerTests, DiagnosticsMaskToken) {
+    Sasl::Client::OAuthBearer mech;
+    std::vector< std::string > diagnosticMessages;
+    const auto unsubscribe = mech.SubscribeToDiagnostics(
+        [&diagnosticMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            diagnosticMessages.push_back(message);
+        }
+    );
+    mech.SetSharedCredentials(
+        Sasl::Client::BearerCredentials::Create("token1", "bob", "mail.example.com", 587)
+    );
+    (void)mech.GetInitialResponse();
+    EXPECT_EQ(
+        (std::vector< std::string >{
+            "C: AUTH OAUTHBEARER n,a=bob,\\1host=mail.example.com\\1port=587\\1auth=Bearer *******\\1\\1",
+        }),
+        diagnosticMessages
+    );
+    unsubscribe();
+}
+
+TEST(OAuthBearerTests, ConstructionAndMoveDoNotAllocate) {
+    const auto allocationsBefore = AllocationCounter::GetCount();
+    Sasl::Client::OAuthBearer mech;
+    Sasl::Client::OAuthBearer other(std::move(mech));
+    mech = std::move(other);
+    EXPECT_EQ(allocationsBefore, AllocationCounter::GetCount());
+}
+
+TEST(OAuthBearerTests, CancelledExchangeFaults) {
+    Sasl::Client::OAuthBearer mech;
+    auto cancellationToken = Sasl::CancellationToken::Create();
+    mech.SetCancellationToken(cancellationToken);
+    mech.SetCredentials("token1", "bob");
+    cancellationToken.Cancel();
+    EXPECT_EQ("", mech.Proceed(""));
+    EXPECT_TRUE(mech.Faulted());
+    mech.Reset();
+    EXPECT_FALSE(mech.Faulted());
+    EXPECT_EQ(
+        "n,a=bob,\x01" "auth=Bearer token1\x01\x01",
+        mech.Proceed("")
+    );
+}
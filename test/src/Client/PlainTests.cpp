@@ -7,8 +7,13 @@
  * © 2019 by Richard Walters
  */
 
+#include "../AllocationCounter.hpp"
+
 #include <gtest/gtest.h>
 #include <Sasl/Client/Plain.hpp>
+#include <utility>
+#include <string>
+#include <vector>
 
 TEST(PlainTests, CredentialsInInitialResponse) {
     Sasl::Client::Plain mech;
@@ -67,3 +72,86 @@ TEST(PlainTests, MechanismCannotDetermineSuccess) {
     (void)mech.Proceed("");
     EXPECT_FALSE(mech.Succeeded());
 }
+
+TEST(PlainTests, SharedCredentials) {
+    const auto credentials = Sasl::Client::PasswordCredentials::Create("hunter2", "bob", "alex");
+    EXPECT_EQ(
+        std::string("alex\0bob\0hunter2", 16),
+        credentials->GetPlainMessage()
+    );
+    Sasl::Client::Plain mechs[2];
+    for (auto& mech: mechs) {
+        mech.SetSharedCredentials(credentials);
+        EXPECT_EQ(
+            std::string("alex\0bob\0hunter2", 16),
+            mech.GetInitialResponse()
+        );
+    }
+    EXPECT_EQ(3, credentials.use_count());
+}
+
+TEST(PlainTests, DiagnosticsMaskPassword) {
+    Sasl::Client::Plain mech;
+    std::vector< std::string > diagnosticMessages;
+    const auto unsubscribe = mech.SubscribeToDiagnostics(
+        [&diagnosticMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            diagnosticMessages.push_back(message);
+        }
+    );
+    mech.SetCredentials("hunter2", "bob", "alex");
+    (void)mech.GetInitialResponse();
+    EXPECT_EQ(
+        (std::vector< std::string >{
+            "C: AUTH PLAIN alex\\0bob\\0*******",
+        }),
+        diagnosticMessages
+    );
+    unsubscribe();
+}
+
+TEST(PlainTests, ConstructionAndMoveDoNotAllocate) {
+    const auto allocationsBefore = AllocationCounter::GetCount();
+    Sasl::Client::Plain mech;
+    Sasl::Client::Plain other(std::move(mech));
+    mech = std::move(other);
+    EXPECT_EQ(allocationsBefore, AllocationCounter::GetCount());
+}
+
+TEST(PlainTests, CancelledExchangeFaults) {
+    Sasl::Client::Plain mech;
+    auto cancellationToken = Sasl::CancellationToken::Create();
+    mech.SetCancellationToken(cancellationToken);
+    mech.SetCredentials("hunter2", "bob");
+    cancellationToken.Cancel();
+    EXPECT_EQ("", mech.Proceed(""));
+    EXPECT_TRUE(mech.Faulted());
+    mech.Reset();
+    EXPECT_FALSE(mech.Faulted());
+    EXPECT_EQ(std::string("\0bob\0hunter2", 12), mech.Proceed(""));
+}
+
+TEST(PlainTests, InitialResponseModeNever) {
+    Sasl::Client::Plain mech;
+    mech.SetCredentials("hunter2", "bob");
+    auto profile = mech.GetRoundTripProfile();
+    EXPECT_TRUE(profile.sendsInitialResponse);
+    EXPECT_EQ(1, profile.roundTrips);
+    mech.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Never);
+    profile = mech.GetRoundTripProfile();
+    EXPECT_FALSE(profile.sendsInitialResponse);
+    EXPECT_EQ(2, profile.roundTrips);
+    EXPECT_EQ("", mech.GetInitialResponse());
+    EXPECT_EQ(std::string("\0bob\0hunter2", 12), mech.Proceed(""));
+    EXPECT_EQ("", mech.Proceed(""));
+}
+
+TEST(PlainTests, InitialResponseNotSentAgain) {
+    Sasl::Client::Plain mech;
+    mech.SetCredentials("hunter2", "bob");
+    EXPECT_EQ(std::string("\0bob\0hunter2", 12), mech.GetInitialResponse());
+    EXPECT_EQ("", mech.Proceed(""));
+}
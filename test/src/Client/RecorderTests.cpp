@@ -0,0 +1,154 @@
+/**
+ * @file RecorderTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Client::Recorder class and the transcript functions.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Recorder.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <Sasl/Client/Transcript.hpp>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+TEST(RecorderTests, RecordsScramExchangeWithoutSecrets) {
+    std::vector< Sasl::Client::TranscriptExchange > exchanges;
+    std::unique_ptr< Sasl::Client::Scram > scram(new Sasl::Client::Scram());
+    scram->SetProfile(Sasl::Client::ScramProfile::Sha1());
+    scram->SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    Sasl::Client::Recorder mech(
+        std::move(scram),
+        "SCRAM-SHA-1",
+        [&exchanges](const Sasl::Client::TranscriptExchange& exchange){
+            exchanges.push_back(exchange);
+        }
+    );
+    mech.SetCredentials("pencil", "user");
+    mech.Reset();
+    EXPECT_EQ("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL", mech.GetInitialResponse());
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096")
+    );
+    EXPECT_TRUE(exchanges.empty());
+    EXPECT_EQ("", mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ="));
+    EXPECT_TRUE(mech.Succeeded());
+    ASSERT_EQ(1, exchanges.size());
+    const auto& exchange = exchanges[0];
+    EXPECT_EQ("SCRAM-SHA-1", exchange.mechanism);
+    EXPECT_EQ("fyko+d2lbbFgONRv9qkxdawL", exchange.clientNonce);
+    EXPECT_TRUE(exchange.succeeded);
+    EXPECT_FALSE(exchange.faulted);
+    ASSERT_EQ(3, exchange.steps.size());
+    EXPECT_TRUE(exchange.steps[0].initialResponse);
+    EXPECT_EQ("", exchange.steps[0].serverMessage);
+    EXPECT_EQ(36, exchange.steps[0].clientMessageLength);
+    EXPECT_FALSE(exchange.steps[1].initialResponse);
+    EXPECT_EQ(
+        "r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096",
+        exchange.steps[1].serverMessage
+    );
+    EXPECT_EQ(82, exchange.steps[1].clientMessageLength);
+    EXPECT_GT(exchange.steps[1].nanoseconds, 0);
+    EXPECT_EQ("v=AAAAAAAAAAAAAAAAAAAAAAAAAAA=", exchange.steps[2].serverMessage);
+    EXPECT_EQ(0, exchange.steps[2].clientMessageLength);
+
+    // The exchange isn't delivered again when the mechanism is reset.
+    mech.Reset();
+    EXPECT_EQ(1, exchanges.size());
+}
+
+TEST(RecorderTests, AbandonedExchangeDeliveredOnReset) {
+    std::vector< Sasl::Client::TranscriptExchange > exchanges;
+    Sasl::Client::Recorder mech(
+        std::unique_ptr< Sasl::Client::Mechanism >(new Sasl::Client::Plain()),
+        "PLAIN",
+        [&exchanges](const Sasl::Client::TranscriptExchange& exchange){
+            exchanges.push_back(exchange);
+        }
+    );
+    mech.SetCredentials("hunter2", "bob");
+    EXPECT_EQ(std::string("\0bob\0hunter2", 12), mech.GetInitialResponse());
+    EXPECT_TRUE(exchanges.empty());
+    mech.Reset();
+    ASSERT_EQ(1, exchanges.size());
+    EXPECT_EQ("PLAIN", exchanges[0].mechanism);
+    EXPECT_EQ("", exchanges[0].clientNonce);
+    EXPECT_FALSE(exchanges[0].succeeded);
+    EXPECT_FALSE(exchanges[0].faulted);
+    ASSERT_EQ(1, exchanges[0].steps.size());
+    EXPECT_EQ(12, exchanges[0].steps[0].clientMessageLength);
+
+    // A reset with nothing recorded delivers nothing.
+    mech.Reset();
+    EXPECT_EQ(1, exchanges.size());
+}
+
+TEST(RecorderTests, TranscriptRoundTrip) {
+    Sasl::Client::TranscriptExchange original;
+    original.mechanism = "SCRAM-SHA-256";
+    original.clientNonce = "rOprNGfwEbeRWgbNEkqO";
+    original.faulted = true;
+    original.steps.resize(2);
+    original.steps[0].initialResponse = true;
+    original.steps[0].clientMessageLength = 34;
+    original.steps[0].nanoseconds = 1234;
+    original.steps[1].serverMessage = "r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096";
+    original.steps[1].clientMessageLength = 108;
+    original.steps[1].nanoseconds = 12345678901ull;
+    std::string buffer;
+    Sasl::Client::EncodeTranscriptExchange(original, buffer);
+    Sasl::Client::EncodeTranscriptExchange(original, buffer);
+
+    // Decode both copies, and make sure every truncation is rejected.
+    size_t offset = 0;
+    for (int i = 0; i < 2; ++i) {
+        Sasl::Client::TranscriptExchange decoded;
+        ASSERT_TRUE(Sasl::Client::DecodeTranscriptExchange(buffer, offset, decoded));
+        EXPECT_EQ(original.mechanism, decoded.mechanism);
+        EXPECT_EQ(original.clientNonce, decoded.clientNonce);
+        EXPECT_FALSE(decoded.succeeded);
+        EXPECT_TRUE(decoded.faulted);
+        ASSERT_EQ(2, decoded.steps.size());
+        for (size_t j = 0; j < 2; ++j) {
+            EXPECT_EQ(original.steps[j].initialResponse, decoded.steps[j].initialResponse);
+            EXPECT_EQ(original.steps[j].serverMessage, decoded.steps[j].serverMessage);
+            EXPECT_EQ(original.steps[j].clientMessageLength, decoded.steps[j].clientMessageLength);
+            EXPECT_EQ(original.steps[j].nanoseconds, decoded.steps[j].nanoseconds);
+        }
+    }
+    EXPECT_EQ(buffer.length(), offset);
+    const auto encodedLength = buffer.length() / 2;
+    for (size_t length = 0; length < encodedLength; ++length) {
+        size_t truncatedOffset = 0;
+        Sasl::Client::TranscriptExchange decoded;
+        EXPECT_FALSE(
+            Sasl::Client::DecodeTranscriptExchange(
+                buffer.substr(0, length),
+                truncatedOffset,
+                decoded
+            )
+        ) << length;
+        EXPECT_EQ(0, truncatedOffset);
+    }
+
+    // Write to a file in two sessions, and read it back.
+    const std::string path = "RecorderTests.transcript";
+    (void)remove(path.c_str());
+    for (int i = 0; i < 2; ++i) {
+        Sasl::Client::TranscriptWriter writer;
+        ASSERT_TRUE(writer.Open(path));
+        EXPECT_TRUE(writer.Write(original));
+    }
+    std::vector< Sasl::Client::TranscriptExchange > exchanges;
+    EXPECT_TRUE(Sasl::Client::ReadTranscriptFile(path, exchanges));
+    ASSERT_EQ(2, exchanges.size());
+    EXPECT_EQ(original.steps[1].serverMessage, exchanges[1].steps[1].serverMessage);
+    (void)remove(path.c_str());
+}
@@ -0,0 +1,53 @@
+/**
+ * @file ScramCalibrationTests.cpp
+ *
+ * This module contains the unit tests of the functions used to
+ * calibrate the iteration counts of the SCRAM mechanism.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <Sasl/Client/ScramCalibration.hpp>
+
+TEST(ScramCalibrationTests, MeasureScramDerivation) {
+    const auto sample = Sasl::Client::MeasureScramDerivation(
+        *Sasl::Client::ScramProfile::Sha256(),
+        2,
+        256,
+        5
+    );
+    EXPECT_EQ(2, sample.threads);
+    EXPECT_EQ(256, sample.probeIterations);
+    EXPECT_EQ(10, sample.derivations);
+    EXPECT_GT(sample.p50Latency.count(), 0);
+    EXPECT_LE(sample.p50Latency, sample.p99Latency);
+    EXPECT_GT(sample.iterationsPerSecond, 0.0);
+}
+
+TEST(ScramCalibrationTests, RecommendScramIterations) {
+    Sasl::Client::ScramCalibrationSample sample;
+    sample.threads = 4;
+    sample.probeIterations = 4096;
+    sample.derivations = 100;
+    sample.p50Latency = std::chrono::milliseconds(3);
+    sample.p99Latency = std::chrono::milliseconds(4);
+    EXPECT_EQ(
+        102400,
+        Sasl::Client::RecommendScramIterations(sample, std::chrono::milliseconds(100))
+    );
+    EXPECT_EQ(
+        5120,
+        Sasl::Client::RecommendScramIterations(sample, std::chrono::milliseconds(5))
+    );
+    EXPECT_EQ(
+        0,
+        Sasl::Client::RecommendScramIterations(sample, std::chrono::microseconds(500))
+    );
+    sample.p99Latency = std::chrono::nanoseconds(0);
+    EXPECT_EQ(
+        0,
+        Sasl::Client::RecommendScramIterations(sample, std::chrono::milliseconds(100))
+    );
+}
@@ -8,18 +8,68 @@
  */
 
 #include <Base64/Base64.hpp>
+#include "../AllocationCounter.hpp"
+
+#include <chrono>
 #include <gtest/gtest.h>
 #include <Hash/Hmac.hpp>
 #include <Hash/Pbkdf2.hpp>
 #include <Hash/Sha1.hpp>
+#include <limits>
 #include <Sasl/Client/Scram.hpp>
+#include <utility>
 #include <stdint.h>
+#include <string.h>
 #include <string>
 #include <StringExtensions/StringExtensions.hpp>
+#include <thread>
 #include <vector>
 
 namespace {
 
+    /**
+     * This is an incremental hash context used to test the
+     * Scram::SetHashContextFactory method.  It counts the number of
+     * times it's updated and computes SHA-1 digests with Hash::Sha1.
+     */
+    struct Sha1Context
+        : public Sasl::HashContext
+    {
+        // Properties
+
+        /**
+         * This is the total number of times any context has been updated.
+         */
+        static size_t numUpdates;
+
+        /**
+         * This holds the data absorbed so far.
+         */
+        std::vector< uint8_t > message;
+
+        // Sasl::HashContext
+
+        virtual std::unique_ptr< Sasl::HashContext > Clone() const override {
+            return std::unique_ptr< Sasl::HashContext >(new Sha1Context(*this));
+        }
+
+        virtual void CopyFrom(const Sasl::HashContext& other) override {
+            message = static_cast< const Sha1Context& >(other).message;
+        }
+
+        virtual void Update(const uint8_t* data, size_t length) override {
+            ++numUpdates;
+            message.insert(message.end(), data, data + length);
+        }
+
+        virtual void Final(uint8_t* digest) override {
+            const auto messageDigest = Hash::Sha1(message);
+            std::copy(messageDigest.begin(), messageDigest.end(), digest);
+        }
+    };
+
+    size_t Sha1Context::numUpdates = 0;
+
     /**
      * Convert the given encoded UTF-8 string into the equivalent byte vector.
      *
@@ -343,3 +393,457 @@ TEST(ScramTests, FaultThenReset) {
     mech.Reset();
     EXPECT_FALSE(mech.Faulted());
 }
+
+TEST(ScramTests, IncrementalHashFunction) {
+    Sasl::Client::Scram mech;
+    mech.SetHashContextFactory(
+        []{ return std::unique_ptr< Sasl::HashContext >(new Sha1Context()); },
+        Hash::SHA1_BLOCK_SIZE,
+        160
+    );
+    mech.SetCredentials("hunter2", "bob");
+    const auto usernameWithClientNonce = mech.Proceed("");
+    const auto clientNonce = usernameWithClientNonce.substr(11);
+    const auto serverNonce = clientNonce + "Poggers";
+    const auto base64EncodedSalt = Base64::Encode("PJSalt");
+    Sha1Context::numUpdates = 0;
+    const auto line = mech.Proceed("r=" + serverNonce + ",s=" + base64EncodedSalt + ",i=4096");
+    EXPECT_GT(Sha1Context::numUpdates, 4096);
+    const auto expectedClientProofAndServerSignature = ComputeClientProofAndServerSignature(
+        "bob",
+        "hunter2",
+        base64EncodedSalt,
+        clientNonce,
+        serverNonce,
+        4096,
+        Hash::Sha1,
+        Hash::SHA1_BLOCK_SIZE,
+        160
+    );
+    EXPECT_EQ("c=biws,r=" + serverNonce + ",p=" + expectedClientProofAndServerSignature.clientProof, line);
+    (void)mech.Proceed("v=" + expectedClientProofAndServerSignature.serverSignature);
+    EXPECT_TRUE(mech.Succeeded());
+}
+
+TEST(ScramTests, HashFunctionDigestFittedToDeclaredLength) {
+    // A hash function returning more than the declared digest length
+    // has the extra bytes left out, rather than written past the end
+    // of the buffers holding the digest.
+    Sasl::Client::Scram mech;
+    mech.SetHashFunction(
+        [](const std::vector< uint8_t >& input){
+            auto digest = Hash::Sha1(input);
+            digest.resize(digest.size() + 100, 0xAA);
+            return digest;
+        },
+        Hash::SHA1_BLOCK_SIZE,
+        160
+    );
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    (void)mech.GetInitialResponse();
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096")
+    );
+    EXPECT_EQ("", mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ="));
+    EXPECT_TRUE(mech.Succeeded());
+
+    // A hash function returning less than the declared digest length
+    // has the missing bytes filled with zeroes, so the exchange fails
+    // rather than reading past the end of the digest.
+    mech.SetHashFunction(
+        [](const std::vector< uint8_t >& input){
+            auto digest = Hash::Sha1(input);
+            digest.resize(4);
+            return digest;
+        },
+        Hash::SHA1_BLOCK_SIZE,
+        160
+    );
+    mech.Reset();
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    (void)mech.GetInitialResponse();
+    (void)mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096");
+    (void)mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ=");
+    EXPECT_FALSE(mech.Succeeded());
+    EXPECT_TRUE(mech.Faulted());
+}
+
+TEST(ScramTests, Rfc5802ExampleWithBuiltInSha1) {
+    Sasl::Client::Scram mech;
+    mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    EXPECT_EQ("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL", mech.GetInitialResponse());
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096")
+    );
+    EXPECT_EQ("", mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ="));
+    EXPECT_TRUE(mech.Succeeded());
+    EXPECT_FALSE(mech.Faulted());
+}
+
+TEST(ScramTests, Rfc7677ExampleWithBuiltInSha256) {
+    Sasl::Client::Scram mech;
+    mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha256);
+    mech.SetClientNonce("rOprNGfwEbeRWgbNEkqO");
+    mech.SetCredentials("pencil", "user");
+    EXPECT_EQ("n,,n=user,r=rOprNGfwEbeRWgbNEkqO", mech.GetInitialResponse());
+    EXPECT_EQ(
+        "c=biws,r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,p=dHzbZapWIk4jUhN+Ute9ytag9zjfMHgsqmmiz7AndVQ=",
+        mech.Proceed("r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096")
+    );
+    EXPECT_EQ("", mech.Proceed("v=6rriTRBi23WpRR/wtup+mMhUZUn/dB5nLTJRsjl95G4="));
+    EXPECT_TRUE(mech.Succeeded());
+    EXPECT_FALSE(mech.Faulted());
+}
+
+TEST(ScramTests, ProfileSharedAmongInstances) {
+    const auto profile = Sasl::Client::ScramProfile::Sha256();
+    EXPECT_EQ(profile, Sasl::Client::ScramProfile::Sha256());
+    EXPECT_EQ("SCRAM-SHA-256", profile->GetMechanismName());
+    EXPECT_EQ(32, profile->GetDigestLength());
+    Sasl::Client::Scram mechs[2];
+    for (auto& mech: mechs) {
+        mech.SetProfile(profile);
+        mech.SetClientNonce("rOprNGfwEbeRWgbNEkqO");
+        mech.SetCredentials("pencil", "user");
+        (void)mech.Proceed("");
+        EXPECT_EQ(
+            "c=biws,r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,p=dHzbZapWIk4jUhN+Ute9ytag9zjfMHgsqmmiz7AndVQ=",
+            mech.Proceed("r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096")
+        );
+        (void)mech.Proceed("v=6rriTRBi23WpRR/wtup+mMhUZUn/dB5nLTJRsjl95G4=");
+        EXPECT_TRUE(mech.Succeeded());
+    }
+    // References: static profile, local variable, and one per instance
+    EXPECT_EQ(4, profile.use_count());
+}
+
+TEST(ScramTests, CustomProfile) {
+    const auto profile = Sasl::Client::ScramProfile::Create(
+        "SCRAM-SHA-1",
+        []{ return std::unique_ptr< Sasl::HashContext >(new Sha1Context()); },
+        Hash::SHA1_BLOCK_SIZE,
+        160
+    );
+    EXPECT_EQ("SCRAM-SHA-1", profile->GetMechanismName());
+    EXPECT_EQ(Hash::SHA1_BLOCK_SIZE, profile->GetBlockSize());
+    EXPECT_EQ(20, profile->GetDigestLength());
+    Sasl::Client::Scram mech;
+    mech.SetProfile(profile);
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    (void)mech.Proceed("");
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096")
+    );
+}
+
+TEST(ScramTests, FaultWithoutHashFunction) {
+    Sasl::Client::Scram mech;
+    mech.SetCredentials("pencil", "user");
+    const auto clientFirstMessage = mech.Proceed("");
+    const auto clientNonce = clientFirstMessage.substr(12);
+    EXPECT_EQ("", mech.Proceed("r=" + clientNonce + "3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096"));
+    EXPECT_TRUE(mech.Faulted());
+    EXPECT_EQ(
+        Sasl::Client::Scram::FaultReason::NoUsableHashFunction,
+        mech.GetFaultReason()
+    );
+}
+
+TEST(ScramTests, RejectInvalidServerChallenges) {
+    using FaultReason = Sasl::Client::Scram::FaultReason;
+    struct TestVector {
+        std::string challenge;
+        FaultReason expectedFaultReason;
+    };
+    const std::vector< TestVector > testVectors{
+        {"", FaultReason::MalformedMessage},
+        {"foobar", FaultReason::MalformedMessage},
+        {"s=QSXCR+Q6sek8bf92,r=fyko+d2lbbFgONRv9qkxdawL3rfc,i=4096", FaultReason::MalformedMessage},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92", FaultReason::MalformedMessage},
+        {"m=foo,r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=4096", FaultReason::MandatoryExtension},
+        {"r=,s=QSXCR+Q6sek8bf92,i=4096", FaultReason::NonceMismatch},
+        {"r=fyko+d2lbbFgONRv9qkxdawL,s=QSXCR+Q6sek8bf92,i=4096", FaultReason::NonceMismatch},
+        {"r=3rfcfyko+d2lbbFgONRv9qkxdawL,s=QSXCR+Q6sek8bf92,i=4096", FaultReason::NonceMismatch},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=,i=4096", FaultReason::InvalidSalt},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf9,i=4096", FaultReason::InvalidSalt},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXC*+Q6sek8bf92,i=4096", FaultReason::InvalidSalt},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=", FaultReason::InvalidIterationCount},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=0", FaultReason::InvalidIterationCount},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=-4096", FaultReason::InvalidIterationCount},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=4096x", FaultReason::InvalidIterationCount},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=99999999999999999999999", FaultReason::InvalidIterationCount},
+        {"r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=1000001", FaultReason::TooManyIterations},
+    };
+    size_t index = 0;
+    for (const auto& testVector: testVectors) {
+        Sasl::Client::Scram mech;
+        mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+        mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+        mech.SetCredentials("pencil", "user");
+        (void)mech.Proceed("");
+        EXPECT_EQ("", mech.Proceed(testVector.challenge)) << index;
+        EXPECT_TRUE(mech.Faulted()) << index;
+        EXPECT_EQ(testVector.expectedFaultReason, mech.GetFaultReason()) << index;
+        ++index;
+    }
+}
+
+TEST(ScramTests, AcceptOptionalExtensionsInServerChallenge) {
+    Sasl::Client::Scram mech;
+    mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    (void)mech.Proceed("");
+    const auto clientFinalMessage = mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096,x=foo");
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=",
+        clientFinalMessage.substr(0, 54)
+    );
+    EXPECT_FALSE(mech.Faulted());
+}
+
+TEST(ScramTests, IterationCountLimitedByPolicy) {
+    using FaultReason = Sasl::Client::Scram::FaultReason;
+    Sasl::Client::ScramProfile::Policy policy;
+    policy.minIterations = 4096;
+    policy.maxIterations = 8192;
+    const auto profile = Sasl::Client::ScramProfile::Sha1()->WithPolicy(policy);
+    EXPECT_EQ(4096, profile->GetPolicy().minIterations);
+    EXPECT_EQ(8192, profile->GetPolicy().maxIterations);
+    EXPECT_EQ(1, Sasl::Client::ScramProfile::Sha1()->GetPolicy().minIterations);
+    const std::vector< std::pair< std::string, FaultReason > > testVectors{
+        {"4095", FaultReason::TooFewIterations},
+        {"4096", FaultReason::None},
+        {"8192", FaultReason::None},
+        {"8193", FaultReason::TooManyIterations},
+    };
+    for (const auto& testVector: testVectors) {
+        Sasl::Client::Scram mech;
+        mech.SetProfile(profile);
+        mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+        mech.SetCredentials("pencil", "user");
+        (void)mech.Proceed("");
+        (void)mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=" + testVector.first);
+        EXPECT_EQ(testVector.second != FaultReason::None, mech.Faulted()) << testVector.first;
+        EXPECT_EQ(testVector.second, mech.GetFaultReason()) << testVector.first;
+    }
+}
+
+TEST(ScramTests, DerivationTimeLimitedByPolicy) {
+    Sasl::Client::ScramProfile::Policy policy;
+    policy.maxIterations = std::numeric_limits< size_t >::max();
+    policy.derivationTimeLimit = std::chrono::milliseconds(1);
+    Sasl::Client::Scram mech;
+    mech.SetProfile(Sasl::Client::ScramProfile::Sha1()->WithPolicy(policy));
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    (void)mech.Proceed("");
+    EXPECT_EQ("", mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=1000000000"));
+    EXPECT_TRUE(mech.Faulted());
+    EXPECT_EQ(
+        Sasl::Client::Scram::FaultReason::DerivationTimeLimitExceeded,
+        mech.GetFaultReason()
+    );
+}
+
+TEST(ScramTests, FaultOnServerErrorOrSignatureMismatch) {
+    using FaultReason = Sasl::Client::Scram::FaultReason;
+    const std::vector< std::pair< std::string, FaultReason > > testVectors{
+        {"v=rmF9pqV8S7suAoZWja4dJRkFsKQ=", FaultReason::None},
+        {"v=rmF9pqV8S7suAoZWja4dJRkFsKA=", FaultReason::ServerSignatureMismatch},
+        {"e=invalid-proof", FaultReason::ServerError},
+        {"", FaultReason::ServerSignatureMismatch},
+    };
+    for (const auto& testVector: testVectors) {
+        Sasl::Client::Scram mech;
+        mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+        mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+        mech.SetCredentials("pencil", "user");
+        (void)mech.Proceed("");
+        (void)mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096");
+        (void)mech.Proceed(testVector.first);
+        EXPECT_EQ(testVector.second == FaultReason::None, mech.Succeeded()) << testVector.first;
+        EXPECT_EQ(testVector.second, mech.GetFaultReason()) << testVector.first;
+    }
+}
+
+TEST(ScramTests, CancelDuringKeyDerivation) {
+    Sasl::Client::ScramProfile::Policy policy;
+    policy.maxIterations = std::numeric_limits< size_t >::max();
+    Sasl::Client::Scram mech;
+    mech.SetProfile(Sasl::Client::ScramProfile::Sha1()->WithPolicy(policy));
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    auto cancellationToken = Sasl::CancellationToken::Create();
+    mech.SetCancellationToken(cancellationToken);
+    (void)mech.Proceed("");
+    std::thread canceller(
+        [cancellationToken]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            cancellationToken.Cancel();
+        }
+    );
+    EXPECT_EQ("", mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=1000000000"));
+    canceller.join();
+    EXPECT_TRUE(mech.Faulted());
+    EXPECT_EQ(
+        Sasl::Client::Scram::FaultReason::Cancelled,
+        mech.GetFaultReason()
+    );
+}
+
+TEST(ScramTests, DeadlineDuringKeyDerivation) {
+    Sasl::Client::ScramProfile::Policy policy;
+    policy.maxIterations = std::numeric_limits< size_t >::max();
+    Sasl::Client::Scram mech;
+    mech.SetProfile(Sasl::Client::ScramProfile::Sha1()->WithPolicy(policy));
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    mech.SetDeadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(10));
+    (void)mech.Proceed("");
+    EXPECT_EQ("", mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfc,s=QSXCR+Q6sek8bf92,i=1000000000"));
+    EXPECT_TRUE(mech.Faulted());
+    EXPECT_EQ(
+        Sasl::Client::Scram::FaultReason::DeadlineExceeded,
+        mech.GetFaultReason()
+    );
+}
+
+TEST(ScramTests, ConstructionAndMoveDoNotAllocate) {
+    const auto allocationsBefore = AllocationCounter::GetCount();
+    Sasl::Client::Scram mech;
+    Sasl::Client::Scram other(std::move(mech));
+    mech = std::move(other);
+    EXPECT_EQ(allocationsBefore, AllocationCounter::GetCount());
+}
+
+TEST(ScramTests, InitialResponseModeNever) {
+    Sasl::Client::Scram mech;
+    mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    auto profile = mech.GetRoundTripProfile();
+    EXPECT_TRUE(profile.sendsInitialResponse);
+    EXPECT_EQ(2, profile.roundTrips);
+    mech.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Never);
+    profile = mech.GetRoundTripProfile();
+    EXPECT_FALSE(profile.sendsInitialResponse);
+    EXPECT_EQ(3, profile.roundTrips);
+    EXPECT_EQ("", mech.GetInitialResponse());
+    EXPECT_EQ("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL", mech.Proceed(""));
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096")
+    );
+    EXPECT_EQ("", mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ="));
+    EXPECT_TRUE(mech.Succeeded());
+}
+
+TEST(ScramTests, ResetStartsNewExchangeWithNewNonce) {
+    Sasl::Client::Scram mech;
+    mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+    mech.SetCredentials("pencil", "user");
+    const auto first = mech.GetInitialResponse();
+    mech.Reset();
+    const auto second = mech.GetInitialResponse();
+    EXPECT_EQ(0, first.find("n,,n=user,r="));
+    EXPECT_EQ(0, second.find("n,,n=user,r="));
+    EXPECT_NE(first, second);
+}
+
+TEST(ScramTests, ResetKeepsPresetNonce) {
+    Sasl::Client::Scram mech;
+    mech.SetHashAlgorithm(Sasl::Client::Scram::HashAlgorithm::Sha1);
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_EQ("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL", mech.GetInitialResponse());
+        (void)mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096");
+        (void)mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ=");
+        EXPECT_TRUE(mech.Succeeded());
+        mech.Reset();
+        EXPECT_FALSE(mech.Succeeded());
+    }
+}
+
+TEST(ScramTests, KeyDerivationFromProfile) {
+    std::vector< uint8_t > derivedPassword;
+    std::vector< uint8_t > derivedSalt;
+    size_t derivedIterations = 0;
+    const auto profile = Sasl::Client::ScramProfile::Sha1()->WithKeyDerivation(
+        [&](
+            const uint8_t* password,
+            size_t passwordLength,
+            const uint8_t* salt,
+            size_t saltLength,
+            size_t iterations,
+            uint8_t* saltedPassword,
+            const std::function< bool() >& keepGoing
+        ){
+            derivedPassword.assign(password, password + passwordLength);
+            derivedSalt.assign(salt, salt + saltLength);
+            derivedIterations = iterations;
+            const auto result = Hash::Pbkdf2(
+                Hash::MakeHmacBytesToBytesFunction(Hash::Sha1, Hash::SHA1_BLOCK_SIZE),
+                160,
+                derivedPassword,
+                derivedSalt,
+                iterations,
+                20
+            );
+            (void)memcpy(saltedPassword, result.data(), result.size());
+            return true;
+        }
+    );
+    EXPECT_FALSE(Sasl::Client::ScramProfile::Sha1()->GetKeyDerivation());
+    EXPECT_TRUE(profile->GetKeyDerivation());
+    Sasl::Client::Scram mech;
+    mech.SetProfile(profile);
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    (void)mech.GetInitialResponse();
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096")
+    );
+    EXPECT_EQ(ByteVectorFromString("pencil"), derivedPassword);
+    EXPECT_EQ(ByteVectorFromString(Base64::Decode("QSXCR+Q6sek8bf92")), derivedSalt);
+    EXPECT_EQ(4096, derivedIterations);
+    EXPECT_EQ("", mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ="));
+    EXPECT_TRUE(mech.Succeeded());
+}
+
+TEST(ScramTests, KeyDerivationFailure) {
+    Sasl::Client::Scram mech;
+    mech.SetProfile(
+        Sasl::Client::ScramProfile::Sha1()->WithKeyDerivation(
+            [](
+                const uint8_t* password,
+                size_t passwordLength,
+                const uint8_t* salt,
+                size_t saltLength,
+                size_t iterations,
+                uint8_t* saltedPassword,
+                const std::function< bool() >& keepGoing
+            ){
+                return false;
+            }
+        )
+    );
+    mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    mech.SetCredentials("pencil", "user");
+    (void)mech.GetInitialResponse();
+    EXPECT_EQ("", mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096"));
+    EXPECT_TRUE(mech.Faulted());
+    EXPECT_EQ(
+        Sasl::Client::Scram::FaultReason::KeyDerivationFailed,
+        mech.GetFaultReason()
+    );
+}
@@ -0,0 +1,183 @@
+/**
+ * @file SnapshotTests.cpp
+ *
+ * This module contains the unit tests of taking snapshots of the
+ * client mechanisms' exchange state and restoring them.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <Sasl/Client/CramMd5.hpp>
+#include <Sasl/Client/Login.hpp>
+#include <Sasl/Client/OAuthBearer.hpp>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Client/Scram.hpp>
+#include <string>
+
+TEST(SnapshotTests, ScramMigratedBeforeChallengeWithCredentials) {
+    std::string snapshot;
+    {
+        Sasl::Client::Scram mech;
+        mech.SetProfile(Sasl::Client::ScramProfile::Sha1());
+        mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+        mech.SetCredentials("pencil", "user");
+        mech.Reset();
+        EXPECT_EQ("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL", mech.GetInitialResponse());
+        ASSERT_TRUE(mech.Snapshot(snapshot, Sasl::Client::SnapshotCredentials::Include));
+    }
+    Sasl::Client::Scram mech;
+    mech.SetProfile(Sasl::Client::ScramProfile::Sha1());
+    ASSERT_TRUE(mech.Restore(snapshot));
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096")
+    );
+    EXPECT_EQ("", mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ="));
+    EXPECT_TRUE(mech.Succeeded());
+    EXPECT_FALSE(mech.Faulted());
+}
+
+TEST(SnapshotTests, ScramSnapshotWithoutCredentials) {
+    Sasl::Client::Scram source;
+    source.SetProfile(Sasl::Client::ScramProfile::Sha1());
+    source.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    source.SetCredentials("pencil", "user");
+    source.Reset();
+    (void)source.GetInitialResponse();
+    std::string withoutCredentials;
+    std::string withCredentials;
+    ASSERT_TRUE(source.Snapshot(withoutCredentials));
+    ASSERT_TRUE(source.Snapshot(withCredentials, Sasl::Client::SnapshotCredentials::Include));
+    EXPECT_EQ(std::string::npos, withoutCredentials.find("pencil"));
+    EXPECT_NE(std::string::npos, withCredentials.find("pencil"));
+
+    // Without credentials, the password set on the target is used.
+    Sasl::Client::Scram target;
+    target.SetProfile(Sasl::Client::ScramProfile::Sha1());
+    target.SetCredentials("pencil", "someone else");
+    ASSERT_TRUE(target.Restore(withoutCredentials));
+    EXPECT_EQ(
+        "c=biws,r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,p=v0X8v3Bz2T0CJGbJQyF0X+HI4Ts=",
+        target.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096")
+    );
+
+    // Once the proof is sent, no credentials are needed to verify the
+    // server's signature.
+    std::string afterProof;
+    ASSERT_TRUE(target.Snapshot(afterProof));
+    Sasl::Client::Scram verifier;
+    verifier.SetProfile(Sasl::Client::ScramProfile::Sha1());
+    ASSERT_TRUE(verifier.Restore(afterProof));
+    EXPECT_EQ("", verifier.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ="));
+    EXPECT_TRUE(verifier.Succeeded());
+
+    // A restored exchange may be reset and used again, with a new nonce.
+    verifier.Reset();
+    const auto clientFirstMessage = verifier.GetInitialResponse();
+    EXPECT_EQ("n,,n=user,r=", clientFirstMessage.substr(0, 12));
+    EXPECT_NE("n,,n=user,r=fyko+d2lbbFgONRv9qkxdawL", clientFirstMessage);
+}
+
+TEST(SnapshotTests, BadSnapshotsRefused) {
+    Sasl::Client::Scram source;
+    source.SetProfile(Sasl::Client::ScramProfile::Sha1());
+    source.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+    source.SetCredentials("pencil", "user");
+    source.Reset();
+    (void)source.GetInitialResponse();
+    std::string snapshot;
+    ASSERT_TRUE(source.Snapshot(snapshot));
+
+    // A snapshot of a different mechanism, or of a different SCRAM
+    // hash function, is refused.
+    Sasl::Client::Plain plain;
+    EXPECT_FALSE(plain.Restore(snapshot));
+    Sasl::Client::Scram sha256;
+    sha256.SetProfile(Sasl::Client::ScramProfile::Sha256());
+    EXPECT_FALSE(sha256.Restore(snapshot));
+    Sasl::Client::Scram noProfile;
+    EXPECT_FALSE(noProfile.Restore(snapshot));
+    EXPECT_FALSE(noProfile.Snapshot(snapshot));
+
+    // A snapshot of another version of the format, or which is cut
+    // short or has extra bytes, is refused, leaving the target as it was.
+    Sasl::Client::Scram target;
+    target.SetProfile(Sasl::Client::ScramProfile::Sha1());
+    target.SetClientNonce("rOprNGfwEbeRWgbNEkqO");
+    target.SetCredentials("pencil", "user");
+    target.Reset();
+    auto badVersion = snapshot;
+    ++badVersion[0];
+    EXPECT_FALSE(target.Restore(badVersion));
+    EXPECT_FALSE(target.Restore(snapshot + '\0'));
+    for (size_t length = 0; length < snapshot.length(); ++length) {
+        EXPECT_FALSE(target.Restore(snapshot.substr(0, length))) << length;
+    }
+    EXPECT_EQ("n,,n=user,r=rOprNGfwEbeRWgbNEkqO", target.GetInitialResponse());
+}
+
+TEST(SnapshotTests, CramMd5CredentialsCarriedAsHmacStates) {
+    Sasl::Client::CramMd5 source;
+    source.SetCredentials("tanstaaftanstaaf", "tim");
+    EXPECT_EQ("", source.GetInitialResponse());
+    std::string snapshot;
+    ASSERT_TRUE(source.Snapshot(snapshot, Sasl::Client::SnapshotCredentials::Include));
+    EXPECT_EQ(std::string::npos, snapshot.find("tanstaaf"));
+    Sasl::Client::CramMd5 target;
+    ASSERT_TRUE(target.Restore(snapshot));
+    EXPECT_EQ(
+        "tim b913a602c7eda7a495b4e6e7334d3890",
+        target.Proceed("<1896.697170952@postoffice.reston.mci.net>")
+    );
+    ASSERT_TRUE(target.Snapshot(snapshot));
+    ASSERT_TRUE(source.Restore(snapshot));
+    EXPECT_EQ("", source.Proceed("<1896.697170952@postoffice.reston.mci.net>"));
+}
+
+TEST(SnapshotTests, LoginAndPlainMigrated) {
+    Sasl::Client::Login login;
+    login.SetCredentials("hunter2", "bob");
+    EXPECT_EQ("", login.GetInitialResponse());
+    EXPECT_EQ("bob", login.Proceed("Username:"));
+    std::string snapshot;
+    ASSERT_TRUE(login.Snapshot(snapshot, Sasl::Client::SnapshotCredentials::Include));
+    Sasl::Client::Login loginTarget;
+    ASSERT_TRUE(loginTarget.Restore(snapshot));
+    EXPECT_EQ("hunter2", loginTarget.Proceed("Password:"));
+    EXPECT_EQ("", loginTarget.Proceed(""));
+
+    Sasl::Client::Plain plain;
+    plain.SetCredentials("hunter2", "bob");
+    plain.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Never);
+    EXPECT_EQ("", plain.GetInitialResponse());
+    ASSERT_TRUE(plain.Snapshot(snapshot));
+    Sasl::Client::Plain plainTarget;
+    plainTarget.SetCredentials("hunter2", "alice");
+    ASSERT_TRUE(plainTarget.Restore(snapshot));
+    EXPECT_FALSE(plainTarget.GetRoundTripProfile().sendsInitialResponse);
+    EXPECT_EQ(std::string("\0alice\0hunter2", 14), plainTarget.Proceed(""));
+}
+
+TEST(SnapshotTests, OAuthBearerErrorChallengeAfterMigration) {
+    Sasl::Client::OAuthBearer source;
+    source.SetCredentials("token1", "bob");
+    source.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Never);
+    EXPECT_EQ("", source.GetInitialResponse());
+    std::string snapshot;
+    ASSERT_TRUE(source.Snapshot(snapshot, Sasl::Client::SnapshotCredentials::Include));
+
+    // The message carrying the token is restored, so no credentials
+    // are needed to carry on.
+    Sasl::Client::OAuthBearer target;
+    ASSERT_TRUE(target.Restore(snapshot));
+    EXPECT_EQ(
+        "n,a=bob,\x01" "auth=Bearer token1\x01\x01",
+        target.Proceed("")
+    );
+    ASSERT_TRUE(target.Snapshot(snapshot));
+    Sasl::Client::OAuthBearer acknowledger;
+    ASSERT_TRUE(acknowledger.Restore(snapshot));
+    EXPECT_EQ("\x01", acknowledger.Proceed("{\"status\":\"invalid_token\"}"));
+    EXPECT_EQ("{\"status\":\"invalid_token\"}", acknowledger.GetErrorChallenge());
+}
@@ -0,0 +1,82 @@
+/**
+ * @file XOAuth2Tests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Client::XOAuth2 class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "../AllocationCounter.hpp"
+
+#include <gtest/gtest.h>
+#include <Sasl/Client/XOAuth2.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(XOAuth2Tests, TokenInInitialResponse) {
+    Sasl::Client::XOAuth2 mech;
+    mech.SetCredentials("ya29.vF9dft4qmTc2Nvb3RlckBhdHRhdmlzdGEuY29tCg", "someuser@example.com");
+    EXPECT_EQ(
+        "user=someuser@example.com\x01"
+        "auth=Bearer ya29.vF9dft4qmTc2Nvb3RlckBhdHRhdmlzdGEuY29tCg\x01\x01",
+        mech.GetInitialResponse()
+    );
+    EXPECT_EQ("", mech.Proceed(""));
+}
+
+TEST(XOAuth2Tests, SharedCredentialsRefreshed) {
+    const auto credentials = Sasl::Client::BearerCredentials::Create("token1", "bob");
+    Sasl::Client::XOAuth2 mech;
+    mech.SetSharedCredentials(credentials);
+    EXPECT_EQ("user=bob\x01" "auth=Bearer token1\x01\x01", mech.GetInitialResponse());
+    credentials->Refresh("token2");
+    mech.Reset();
+    EXPECT_EQ("user=bob\x01" "auth=Bearer token2\x01\x01", mech.GetInitialResponse());
+}
+
+TEST(XOAuth2Tests, ErrorChallengeAcknowledgedWithEmptyResponse) {
+    const std::string errorChallenge = (
+        "{\"status\":\"401\",\"schemes\":\"bearer\",\"scope\":\"https://mail.google.com/\"}"
+    );
+    Sasl::Client::XOAuth2 mech;
+    mech.SetCredentials("token1", "bob");
+    (void)mech.GetInitialResponse();
+    EXPECT_EQ("", mech.Proceed(errorChallenge));
+    EXPECT_EQ(errorChallenge, mech.GetErrorChallenge());
+}
+
+TEST(XOAuth2Tests, DiagnosticsMaskToken) {
+    Sasl::Client::XOAuth2 mech;
+    std::vector< std::string > diagnosticMessages;
+    const auto unsubscribe = mech.SubscribeToDiagnostics(
+        [&diagnosticMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            diagnosticMessages.push_back(message);
+        }
+    );
+    mech.SetCredentials("token1", "bob");
+    mech.SetInitialResponseMode(Sasl::Client::InitialResponseMode::Never);
+    (void)mech.GetInitialResponse();
+    (void)mech.Proceed("");
+    EXPECT_EQ(
+        (std::vector< std::string >{
+            "C: AUTH XOAUTH2",
+            "C: AUTH XOAUTH2 user=bob\\1auth=Bearer *******\\1\\1",
+        }),
+        diagnosticMessages
+    );
+    unsubscribe();
+}
+
+TEST(XOAuth2Tests, ConstructionAndMoveDoNotAllocate) {
+    const auto allocationsBefore = AllocationCounter::GetCount();
+    Sasl::Client::XOAuth2 mech;
+    Sasl::Client::XOAuth2 other(std::move(mech));
+    mech = std::move(other);
+    EXPECT_EQ(allocationsBefore, AllocationCounter::GetCount());
+}
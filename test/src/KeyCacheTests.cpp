@@ -0,0 +1,163 @@
+/**
+ * @file KeyCacheTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::KeyCache::Store and Sasl::KeyCache::Daemon classes.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <Sasl/KeyCache.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+TEST(KeyCacheTests, FindInsertedDerivedKey) {
+    Sasl::KeyCache::Store store;
+    std::string derivedKey;
+    EXPECT_FALSE(store.Find("key", derivedKey));
+    store.Insert("key", "derived");
+    EXPECT_TRUE(store.Find("key", derivedKey));
+    EXPECT_EQ("derived", derivedKey);
+    store.Insert("key", "replaced");
+    EXPECT_TRUE(store.Find("key", derivedKey));
+    EXPECT_EQ("replaced", derivedKey);
+    const auto stats = store.GetStats();
+    EXPECT_EQ(1, stats.entries);
+    EXPECT_EQ(2, stats.hits);
+    EXPECT_EQ(1, stats.misses);
+    EXPECT_EQ(0, stats.evictions);
+}
+
+TEST(KeyCacheTests, EvictLeastRecentlyUsedToStayWithinBound) {
+    // Each of these entries takes 2 * 2 + 20 bytes, plus 128 bytes of
+    // estimated bookkeeping, so only two fit.
+    const std::string derivedKey(20, 'x');
+    Sasl::KeyCache::Store store(400);
+    store.Insert("k1", derivedKey);
+    store.Insert("k2", derivedKey);
+    std::string found;
+    EXPECT_TRUE(store.Find("k1", found));
+    store.Insert("k3", derivedKey);
+    EXPECT_TRUE(store.Find("k1", found));
+    EXPECT_FALSE(store.Find("k2", found));
+    EXPECT_TRUE(store.Find("k3", found));
+    const auto stats = store.GetStats();
+    EXPECT_EQ(2, stats.entries);
+    EXPECT_LE(stats.bytes, 400);
+    EXPECT_EQ(1, stats.evictions);
+}
+
+TEST(KeyCacheTests, IgnoreDerivedKeyLargerThanBound) {
+    Sasl::KeyCache::Store store(100);
+    store.Insert("key", "derived");
+    std::string derivedKey;
+    EXPECT_FALSE(store.Find("key", derivedKey));
+    EXPECT_EQ(0, store.GetStats().bytes);
+}
+
+#ifndef _WIN32
+TEST(KeyCacheTests, DaemonSocketPrivateAndRemovedWhenStopped) {
+    const auto socketPath = (
+        "/tmp/SaslKeyCacheTests-" + std::to_string(getpid()) + ".sock"
+    );
+    Sasl::KeyCache::Daemon daemon;
+    ASSERT_TRUE(daemon.Start(socketPath));
+    struct stat status;
+    ASSERT_EQ(0, stat(socketPath.c_str(), &status));
+    EXPECT_EQ(0, status.st_mode & (S_IRWXG | S_IRWXO));
+    daemon.Stop();
+    EXPECT_NE(0, stat(socketPath.c_str(), &status));
+}
+#endif
+
+#ifndef _WIN32
+TEST(KeyCacheTests, DaemonDoesNotReplaceFileOtherThanSocket) {
+    const auto path = (
+        "/tmp/SaslKeyCacheTests-" + std::to_string(getpid()) + ".file"
+    );
+    const auto file = fopen(path.c_str(), "w");
+    ASSERT_FALSE(file == NULL);
+    (void)fclose(file);
+    Sasl::KeyCache::Daemon daemon;
+    EXPECT_FALSE(daemon.Start(path));
+    struct stat status;
+    ASSERT_EQ(0, lstat(path.c_str(), &status));
+    EXPECT_TRUE(S_ISREG(status.st_mode));
+    (void)unlink(path.c_str());
+}
+
+TEST(KeyCacheTests, DaemonDoesNotTakeOverServedSocket) {
+    const auto socketPath = (
+        "/tmp/SaslKeyCacheTests-" + std::to_string(getpid()) + ".sock"
+    );
+    Sasl::KeyCache::Daemon first;
+    ASSERT_TRUE(first.Start(socketPath));
+    struct stat before;
+    ASSERT_EQ(0, lstat(socketPath.c_str(), &before));
+    Sasl::KeyCache::Daemon second;
+    EXPECT_FALSE(second.Start(socketPath));
+    struct stat after;
+    ASSERT_EQ(0, lstat(socketPath.c_str(), &after));
+    EXPECT_EQ(before.st_ino, after.st_ino);
+
+    // Once the first daemon stops, the second one can serve on the path.
+    first.Stop();
+    EXPECT_TRUE(second.Start(socketPath));
+    second.Stop();
+}
+
+TEST(KeyCacheTests, DaemonReplacesStaleSocket) {
+    const auto socketPath = (
+        "/tmp/SaslKeyCacheTests-" + std::to_string(getpid()) + ".sock"
+    );
+    (void)unlink(socketPath.c_str());
+    struct sockaddr_un address;
+    (void)memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    (void)memcpy(address.sun_path, socketPath.data(), socketPath.length());
+    const auto stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(stale, 0);
+    ASSERT_EQ(0, bind(stale, (const struct sockaddr*)&address, sizeof(address)));
+    (void)close(stale);
+    Sasl::KeyCache::Daemon daemon;
+    EXPECT_TRUE(daemon.Start(socketPath));
+    daemon.Stop();
+}
+#endif
+
+#ifndef _WIN32
+TEST(KeyCacheTests, RuntimeDirectoryMustBePrivate) {
+    const auto oldRuntimeDirectory = getenv("XDG_RUNTIME_DIR");
+    const std::string savedRuntimeDirectory = (
+        (oldRuntimeDirectory == NULL)
+        ? ""
+        : oldRuntimeDirectory
+    );
+    const auto directory = (
+        "/tmp/SaslKeyCacheTests-" + std::to_string(getpid()) + ".dir"
+    );
+    ASSERT_EQ(0, mkdir(directory.c_str(), S_IRWXU));
+    ASSERT_EQ(0, setenv("XDG_RUNTIME_DIR", directory.c_str(), 1));
+    EXPECT_EQ(directory, Sasl::KeyCache::GetRuntimeDirectory());
+    EXPECT_EQ(directory + "/SaslKeyCache.sock", Sasl::KeyCache::GetDefaultSocketPath());
+    ASSERT_EQ(0, chmod(directory.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH));
+    EXPECT_EQ("", Sasl::KeyCache::GetRuntimeDirectory());
+    EXPECT_EQ("", Sasl::KeyCache::GetDefaultSocketPath());
+    ASSERT_EQ(0, unsetenv("XDG_RUNTIME_DIR"));
+    EXPECT_EQ("", Sasl::KeyCache::GetRuntimeDirectory());
+    (void)rmdir(directory.c_str());
+    if (oldRuntimeDirectory != NULL) {
+        (void)setenv("XDG_RUNTIME_DIR", savedRuntimeDirectory.c_str(), 1);
+    }
+}
+#endif
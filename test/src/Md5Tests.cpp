@@ -0,0 +1,109 @@
+/**
+ * @file Md5Tests.cpp
+ *
+ * This module contains the unit tests of the MD5 hash function
+ * built into the Sasl library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <Sasl/Md5.hpp>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This holds one known answer test of the MD5 hash function.
+     */
+    struct Md5TestVector {
+        /**
+         * This is the message to hash.
+         */
+        std::string message;
+
+        /**
+         * This is the expected digest, in hexadecimal.
+         */
+        std::string digest;
+    };
+
+    /**
+     * These are the known answer tests of MD5 from RFC 1321 Appendix A.5.
+     */
+    const std::vector< Md5TestVector > MD5_TEST_VECTORS = {
+        {"", "d41d8cd98f00b204e9800998ecf8427e"},
+        {"a", "0cc175b9c0f1b6a831c399e269772661"},
+        {"abc", "900150983cd24fb0d6963f7d28e17f72"},
+        {"message digest", "f96b697d7cb7938d525a2f31aaf161d0"},
+        {"abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b"},
+        {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", "d174ab98d277d9f5a5611c2c9f419d9f"},
+        {"12345678901234567890123456789012345678901234567890123456789012345678901234567890", "57edf4a22be3c955ac49da2e2107b67a"},
+    };
+
+    /**
+     * Finish the given hash context and return its digest.
+     *
+     * @param[in,out] context
+     *     This is the hash context to finish.
+     *
+     * @return
+     *     The digest, in hexadecimal, is returned.
+     */
+    std::string HexDigest(Sasl::HashContext& context) {
+        uint8_t digest[Sasl::MD5_DIGEST_SIZE / 8];
+        context.Final(digest);
+        std::string hex;
+        for (auto octet: digest) {
+            char buffer[3];
+            (void)snprintf(buffer, sizeof(buffer), "%02x", octet);
+            hex += buffer;
+        }
+        return hex;
+    }
+
+}
+
+TEST(Md5Tests, KnownAnswers) {
+    for (const auto& testVector: MD5_TEST_VECTORS) {
+        const auto context = Sasl::MakeMd5Context();
+        context->Update(
+            (const uint8_t*)testVector.message.data(),
+            testVector.message.length()
+        );
+        EXPECT_EQ(testVector.digest, HexDigest(*context)) << testVector.message;
+    }
+}
+
+TEST(Md5Tests, UpdateInPiecesOfEveryLength) {
+    std::string message;
+    for (size_t i = 0; i < 300; ++i) {
+        message.push_back((char)i);
+    }
+    const auto referenceContext = Sasl::MakeMd5Context();
+    referenceContext->Update((const uint8_t*)message.data(), message.length());
+    const auto expectedDigest = HexDigest(*referenceContext);
+    for (size_t pieceLength = 1; pieceLength < 140; ++pieceLength) {
+        const auto context = Sasl::MakeMd5Context();
+        for (size_t i = 0; i < message.length(); i += pieceLength) {
+            const auto piece = message.substr(i, pieceLength);
+            context->Update((const uint8_t*)piece.data(), piece.length());
+        }
+        EXPECT_EQ(expectedDigest, HexDigest(*context)) << pieceLength;
+    }
+}
+
+TEST(Md5Tests, CloneAndCopyFrom) {
+    const auto context = Sasl::MakeMd5Context();
+    context->Update((const uint8_t*)"ab", 2);
+    const auto clone = context->Clone();
+    const auto other = Sasl::MakeMd5Context();
+    other->CopyFrom(*context);
+    for (const auto& copy: {clone.get(), other.get()}) {
+        copy->Update((const uint8_t*)"c", 1);
+        EXPECT_EQ("900150983cd24fb0d6963f7d28e17f72", HexDigest(*copy));
+    }
+}
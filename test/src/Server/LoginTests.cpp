@@ -0,0 +1,98 @@
+/**
+ * @file LoginTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Server::Login class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <Sasl/Client/Login.hpp>
+#include <Sasl/Server/Login.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * Make a verifier which knows only that the password of "bob"
+     * is "hunter2".
+     *
+     * @return
+     *     The verifier is returned.
+     */
+    std::shared_ptr< Sasl::Server::PasswordVerifier > MakeVerifier() {
+        const auto record = Sasl::Server::PasswordRecord::Derive(
+            "hunter2",
+            std::vector< uint8_t >{1, 2, 3, 4},
+            64
+        );
+        return std::make_shared< Sasl::Server::PasswordVerifier >(
+            [record](
+                const std::string& authenticationIdentity,
+                Sasl::Server::PasswordRecord& recordFound
+            ){
+                if (authenticationIdentity != "bob") {
+                    return false;
+                }
+                recordFound = record;
+                return true;
+            }
+        );
+    }
+
+}
+
+TEST(ServerLoginTests, UsernameAfterChallenge) {
+    Sasl::Server::Login mech(MakeVerifier());
+    EXPECT_EQ("Username:", mech.Proceed(""));
+    EXPECT_EQ("Password:", mech.Proceed("bob"));
+    EXPECT_FALSE(mech.Done());
+    EXPECT_EQ("", mech.Proceed("hunter2"));
+    EXPECT_TRUE(mech.Done());
+    EXPECT_TRUE(mech.Succeeded());
+    EXPECT_EQ("bob", mech.GetAuthenticationIdentity());
+    EXPECT_EQ("bob", mech.GetAuthorizationIdentity());
+}
+
+TEST(ServerLoginTests, UsernameInInitialResponse) {
+    Sasl::Server::Login mech(MakeVerifier());
+    EXPECT_EQ("Password:", mech.Proceed("bob"));
+    EXPECT_EQ("", mech.Proceed("hunter2"));
+    EXPECT_TRUE(mech.Succeeded());
+}
+
+TEST(ServerLoginTests, WrongPassword) {
+    Sasl::Server::Login mech(MakeVerifier());
+    (void)mech.Proceed("bob");
+    (void)mech.Proceed("hunter3");
+    EXPECT_TRUE(mech.Done());
+    EXPECT_FALSE(mech.Succeeded());
+    mech.Reset();
+    (void)mech.Proceed("bob");
+    (void)mech.Proceed("");
+    EXPECT_TRUE(mech.Done());
+    EXPECT_FALSE(mech.Succeeded());
+}
+
+TEST(ServerLoginTests, EmptyUsername) {
+    Sasl::Server::Login mech(MakeVerifier());
+    EXPECT_EQ("Username:", mech.Proceed(""));
+    (void)mech.Proceed("");
+    EXPECT_TRUE(mech.Done());
+    EXPECT_FALSE(mech.Succeeded());
+}
+
+TEST(ServerLoginTests, ExchangeWithClient) {
+    Sasl::Client::Login client;
+    client.SetCredentials("hunter2", "bob");
+    Sasl::Server::Login server(MakeVerifier());
+    auto response = client.GetInitialResponse();
+    while (!server.Done()) {
+        response = client.Proceed(server.Proceed(response));
+    }
+    EXPECT_TRUE(server.Succeeded());
+}
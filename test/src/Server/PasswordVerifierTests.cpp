@@ -0,0 +1,179 @@
+/**
+ * @file PasswordVerifierTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Server::PasswordVerifier class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <map>
+#include <Sasl/Server/PasswordVerifier.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of iterations used to derive the keys
+     * stored in the tests.
+     */
+    constexpr size_t ITERATIONS = 64;
+
+    /**
+     * This is a stand-in for a server's store of password records.
+     */
+    struct RecordStore {
+        /**
+         * These are the records, by user.
+         */
+        std::map< std::string, Sasl::Server::PasswordRecord > records;
+
+        /**
+         * Store the record for the given user's new password.
+         *
+         * @param[in] user
+         *     This is the user whose password to set.
+         *
+         * @param[in] password
+         *     This is the user's new password.
+         */
+        void SetPassword(const std::string& user, const std::string& password) {
+            records[user] = Sasl::Server::PasswordRecord::Derive(
+                password,
+                std::vector< uint8_t >(user.begin(), user.end()),
+                ITERATIONS
+            );
+        }
+
+        /**
+         * Return a function which looks up records in the store.
+         *
+         * @return
+         *     A function which looks up records in the store is returned.
+         */
+        Sasl::Server::PasswordVerifier::RecordLookupDelegate GetLookup() {
+            return [this](
+                const std::string& authenticationIdentity,
+                Sasl::Server::PasswordRecord& record
+            ){
+                const auto recordsEntry = records.find(authenticationIdentity);
+                if (recordsEntry == records.end()) {
+                    return false;
+                }
+                record = recordsEntry->second;
+                return true;
+            };
+        }
+    };
+
+}
+
+TEST(PasswordVerifierTests, DeriveKnownAnswers) {
+    // These are the PBKDF2-HMAC-SHA-256 test vectors of RFC 7914
+    // section 11, cut to the length of one digest.
+    const std::vector< uint8_t > salt{'s', 'a', 'l', 't'};
+    EXPECT_EQ(
+        (std::vector< uint8_t >{
+            0x12, 0x0f, 0xb6, 0xcf, 0xfc, 0xf8, 0xb3, 0x2c,
+            0x43, 0xe7, 0x22, 0x52, 0x56, 0xc4, 0xf8, 0x37,
+            0xa8, 0x65, 0x48, 0xc9, 0x2c, 0xcc, 0x35, 0x48,
+            0x08, 0x05, 0x98, 0x7c, 0xb7, 0x0b, 0xe1, 0x7b,
+        }),
+        Sasl::Server::PasswordRecord::Derive("password", salt, 1).derivedKey
+    );
+    EXPECT_EQ(
+        (std::vector< uint8_t >{
+            0xc5, 0xe4, 0x78, 0xd5, 0x92, 0x88, 0xc8, 0x41,
+            0xaa, 0x53, 0x0d, 0xb6, 0x84, 0x5c, 0x4c, 0x8d,
+            0x96, 0x28, 0x93, 0xa0, 0x01, 0xce, 0x4e, 0x11,
+            0xa4, 0x96, 0x38, 0x73, 0xaa, 0x98, 0x13, 0x4a,
+        }),
+        Sasl::Server::PasswordRecord::Derive("password", salt, 4096).derivedKey
+    );
+}
+
+TEST(PasswordVerifierTests, VerifyWithoutCache) {
+    RecordStore store;
+    store.SetPassword("bob", "hunter2");
+    Sasl::Server::PasswordVerifier verifier(store.GetLookup());
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    EXPECT_FALSE(verifier.Verify("bob", "hunter3", 7));
+    EXPECT_FALSE(verifier.Verify("bob", "hunter2", 6));
+    EXPECT_FALSE(verifier.Verify("alex", "hunter2", 7));
+    const auto statistics = verifier.GetStatistics();
+    EXPECT_EQ(5, statistics.verifications);
+    EXPECT_EQ(0, statistics.cacheHits);
+    EXPECT_EQ(5, statistics.derivations);
+}
+
+TEST(PasswordVerifierTests, CacheSkipsDerivationForRepeatedSuccess) {
+    RecordStore store;
+    store.SetPassword("bob", "hunter2");
+    store.SetPassword("alex", "PASSWORD");
+    Sasl::Server::PasswordVerifier verifier(store.GetLookup());
+    verifier.EnableCache(16, std::chrono::minutes(5));
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    EXPECT_FALSE(verifier.Verify("bob", "hunter3", 7));
+    EXPECT_FALSE(verifier.Verify("alex", "hunter2", 7));
+    EXPECT_TRUE(verifier.Verify("alex", "PASSWORD", 8));
+    const auto statistics = verifier.GetStatistics();
+    EXPECT_EQ(6, statistics.verifications);
+    EXPECT_EQ(2, statistics.cacheHits);
+    EXPECT_EQ(4, statistics.derivations);
+}
+
+TEST(PasswordVerifierTests, PasswordChangeInvalidatesCache) {
+    RecordStore store;
+    store.SetPassword("bob", "hunter2");
+    Sasl::Server::PasswordVerifier verifier(store.GetLookup());
+    verifier.EnableCache(16, std::chrono::minutes(5));
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    store.SetPassword("bob", "correct horse");
+    EXPECT_FALSE(verifier.Verify("bob", "hunter2", 7));
+    EXPECT_TRUE(verifier.Verify("bob", "correct horse", 13));
+    EXPECT_EQ(0, verifier.GetStatistics().cacheHits);
+}
+
+TEST(PasswordVerifierTests, CachedChecksExpire) {
+    RecordStore store;
+    store.SetPassword("bob", "hunter2");
+    Sasl::Server::PasswordVerifier verifier(store.GetLookup());
+    verifier.EnableCache(16, std::chrono::steady_clock::duration::zero());
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    EXPECT_EQ(0, verifier.GetStatistics().cacheHits);
+    EXPECT_EQ(2, verifier.GetStatistics().derivations);
+}
+
+TEST(PasswordVerifierTests, DisableCache) {
+    RecordStore store;
+    store.SetPassword("bob", "hunter2");
+    Sasl::Server::PasswordVerifier verifier(store.GetLookup());
+    verifier.EnableCache(16, std::chrono::minutes(5));
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    verifier.EnableCache(0, std::chrono::minutes(5));
+    EXPECT_TRUE(verifier.Verify("bob", "hunter2", 7));
+    EXPECT_EQ(0, verifier.GetStatistics().cacheHits);
+    EXPECT_EQ(2, verifier.GetStatistics().derivations);
+}
+
+TEST(PasswordVerifierTests, UnknownIdentityAndBrokenRecordStillDerive) {
+    RecordStore store;
+    store.SetPassword("bob", "hunter2");
+    store.records["alex"].salt = {'a'};
+    store.records["alex"].iterations = ITERATIONS;
+    Sasl::Server::PasswordVerifier verifier(store.GetLookup());
+    EXPECT_FALSE(verifier.Verify("carol", "hunter2", 7));
+    EXPECT_FALSE(verifier.Verify("alex", "hunter2", 7));
+    EXPECT_FALSE(verifier.Verify("bob", "hunter3", 7));
+    const auto statistics = verifier.GetStatistics();
+    EXPECT_EQ(3, statistics.verifications);
+    EXPECT_EQ(3, statistics.derivations);
+}
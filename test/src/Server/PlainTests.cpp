@@ -0,0 +1,132 @@
+/**
+ * @file PlainTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Sasl::Server::Plain class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <Sasl/Client/Plain.hpp>
+#include <Sasl/Server/Plain.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * Make a verifier which knows only that the password of "bob"
+     * is "hunter2".
+     *
+     * @return
+     *     The verifier is returned.
+     */
+    std::shared_ptr< Sasl::Server::PasswordVerifier > MakeVerifier() {
+        const auto record = Sasl::Server::PasswordRecord::Derive(
+            "hunter2",
+            std::vector< uint8_t >{1, 2, 3, 4},
+            64
+        );
+        return std::make_shared< Sasl::Server::PasswordVerifier >(
+            [record](
+                const std::string& authenticationIdentity,
+                Sasl::Server::PasswordRecord& recordFound
+            ){
+                if (authenticationIdentity != "bob") {
+                    return false;
+                }
+                recordFound = record;
+                return true;
+            }
+        );
+    }
+
+}
+
+TEST(ServerPlainTests, CredentialsInInitialResponse) {
+    Sasl::Server::Plain mech(MakeVerifier());
+    EXPECT_EQ("", mech.Proceed(std::string("\0bob\0hunter2", 12)));
+    EXPECT_TRUE(mech.Done());
+    EXPECT_TRUE(mech.Succeeded());
+    EXPECT_EQ("bob", mech.GetAuthenticationIdentity());
+    EXPECT_EQ("bob", mech.GetAuthorizationIdentity());
+}
+
+TEST(ServerPlainTests, CredentialsAfterEmptyChallenge) {
+    Sasl::Server::Plain mech(MakeVerifier());
+    EXPECT_EQ("", mech.Proceed(""));
+    EXPECT_FALSE(mech.Done());
+    EXPECT_EQ("", mech.Proceed(std::string("\0bob\0hunter2", 12)));
+    EXPECT_TRUE(mech.Done());
+    EXPECT_TRUE(mech.Succeeded());
+}
+
+TEST(ServerPlainTests, WrongPassword) {
+    Sasl::Server::Plain mech(MakeVerifier());
+    (void)mech.Proceed(std::string("\0bob\0hunter3", 12));
+    EXPECT_TRUE(mech.Done());
+    EXPECT_FALSE(mech.Succeeded());
+    mech.Reset();
+    (void)mech.Proceed(std::string("\0alex\0hunter2", 13));
+    EXPECT_TRUE(mech.Done());
+    EXPECT_FALSE(mech.Succeeded());
+}
+
+TEST(ServerPlainTests, MalformedMessages) {
+    Sasl::Server::Plain mech(MakeVerifier());
+    for (const auto& message: {
+        std::string("bob hunter2"),
+        std::string("\0bobhunter2", 11),
+        std::string("\0\0hunter2", 9),
+        std::string("\0bob\0", 5),
+        std::string("\0bob\0hunter2\0", 13),
+        std::string("", 0),
+    }) {
+        mech.Reset();
+        (void)mech.Proceed(message);
+        if (message.empty()) {
+            EXPECT_FALSE(mech.Done());
+            (void)mech.Proceed(message);
+        }
+        EXPECT_TRUE(mech.Done());
+        EXPECT_FALSE(mech.Succeeded());
+    }
+}
+
+TEST(ServerPlainTests, AuthorizationIdentity) {
+    Sasl::Server::Plain mech(MakeVerifier());
+    (void)mech.Proceed(std::string("bob\0bob\0hunter2", 15));
+    EXPECT_TRUE(mech.Succeeded());
+    mech.Reset();
+    (void)mech.Proceed(std::string("alex\0bob\0hunter2", 16));
+    EXPECT_FALSE(mech.Succeeded());
+    mech.SetAuthorizationDelegate(
+        [](
+            const std::string& authenticationIdentity,
+            const std::string& authorizationIdentity
+        ){
+            return (
+                (authenticationIdentity == "bob")
+                && (authorizationIdentity == "alex")
+            );
+        }
+    );
+    mech.Reset();
+    (void)mech.Proceed(std::string("alex\0bob\0hunter2", 16));
+    EXPECT_TRUE(mech.Succeeded());
+    EXPECT_EQ("bob", mech.GetAuthenticationIdentity());
+    EXPECT_EQ("alex", mech.GetAuthorizationIdentity());
+}
+
+TEST(ServerPlainTests, ExchangeWithClient) {
+    Sasl::Client::Plain client;
+    client.SetCredentials("hunter2", "bob");
+    Sasl::Server::Plain server(MakeVerifier());
+    const auto challenge = server.Proceed(client.GetInitialResponse());
+    EXPECT_TRUE(server.Done());
+    EXPECT_TRUE(server.Succeeded());
+    EXPECT_EQ("", challenge);
+}
@@ -0,0 +1,170 @@
+/**
+ * @file ShaTests.cpp
+ *
+ * This module contains the unit tests of the SHA hash functions
+ * built into the Sasl library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <Sasl/Sha.hpp>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This holds one known answer test of a hash function.
+     */
+    struct ShaTestVector {
+        /**
+         * This is the message to hash.
+         */
+        std::string message;
+
+        /**
+         * This is the number of times to repeat the message.
+         */
+        size_t repetitions;
+
+        /**
+         * This is the expected digest, in hexadecimal.
+         */
+        std::string digest;
+    };
+
+    /**
+     * These are known answer tests of SHA-1, from FIPS 180-2 Appendix A
+     * and the NIST Cryptographic Algorithm Validation Program.
+     */
+    const std::vector< ShaTestVector > SHA1_TEST_VECTORS = {
+        {"", 1, "da39a3ee5e6b4b0d3255bfef95601890afd80709"},
+        {"abc", 1, "a9993e364706816aba3e25717850c26c9cd0d89d"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1, "84983e441c3bd26ebaae4aa1f95129e5e54670f1"},
+        {"a", 1000000, "34aa973cd4c4daa4f61eeb2bdbad27316534016f"},
+    };
+
+    /**
+     * These are known answer tests of SHA-256, from FIPS 180-2 Appendix B
+     * and the NIST Cryptographic Algorithm Validation Program.
+     */
+    const std::vector< ShaTestVector > SHA256_TEST_VECTORS = {
+        {"", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {"abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+        {"a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+    };
+
+    /**
+     * Compute the digest of a test vector's message, using the given
+     * hash context.
+     *
+     * @param[in,out] context
+     *     This is the hash context to use.
+     *
+     * @param[in] testVector
+     *     This is the test vector whose message should be hashed.
+     *
+     * @param[in] digestLength
+     *     This is the length, in bytes, of the digest.
+     *
+     * @return
+     *     The digest, in hexadecimal, is returned.
+     */
+    std::string HexDigest(
+        Sasl::HashContext& context,
+        const ShaTestVector& testVector,
+        size_t digestLength
+    ) {
+        for (size_t i = 0; i < testVector.repetitions; ++i) {
+            context.Update(
+                (const uint8_t*)testVector.message.data(),
+                testVector.message.length()
+            );
+        }
+        std::vector< uint8_t > digest(digestLength);
+        context.Final(digest.data());
+        std::string hex;
+        for (auto octet: digest) {
+            char buffer[3];
+            (void)snprintf(buffer, sizeof(buffer), "%02x", octet);
+            hex += buffer;
+        }
+        return hex;
+    }
+
+    /**
+     * These are the implementations to test.
+     */
+    const std::vector< Sasl::ShaImplementation > IMPLEMENTATIONS = {
+        Sasl::ShaImplementation::Portable,
+        Sasl::ShaImplementation::ShaExtensions,
+    };
+
+}
+
+TEST(ShaTests, Sha1KnownAnswers) {
+    for (const auto implementation: IMPLEMENTATIONS) {
+        for (const auto& testVector: SHA1_TEST_VECTORS) {
+            const auto context = Sasl::MakeSha1Context(implementation);
+            EXPECT_EQ(
+                testVector.digest,
+                HexDigest(*context, testVector, Sasl::SHA1_DIGEST_SIZE / 8)
+            ) << "implementation: " << (int)implementation;
+        }
+    }
+}
+
+TEST(ShaTests, Sha256KnownAnswers) {
+    for (const auto implementation: IMPLEMENTATIONS) {
+        for (const auto& testVector: SHA256_TEST_VECTORS) {
+            const auto context = Sasl::MakeSha256Context(implementation);
+            EXPECT_EQ(
+                testVector.digest,
+                HexDigest(*context, testVector, Sasl::SHA256_DIGEST_SIZE / 8)
+            ) << "implementation: " << (int)implementation;
+        }
+    }
+}
+
+TEST(ShaTests, UpdateInPiecesOfEveryLength) {
+    std::string message;
+    for (size_t i = 0; i < 300; ++i) {
+        message.push_back((char)i);
+    }
+    for (const auto implementation: IMPLEMENTATIONS) {
+        const auto referenceContext = Sasl::MakeSha256Context(implementation);
+        const auto expectedDigest = HexDigest(*referenceContext, {message, 1, ""}, 32);
+        for (size_t pieceLength = 1; pieceLength < 140; ++pieceLength) {
+            const auto context = Sasl::MakeSha256Context(implementation);
+            for (size_t i = 0; i < message.length(); i += pieceLength) {
+                const auto piece = message.substr(i, pieceLength);
+                context->Update((const uint8_t*)piece.data(), piece.length());
+            }
+            EXPECT_EQ(expectedDigest, HexDigest(*context, {"", 0, ""}, 32)) << pieceLength;
+        }
+    }
+}
+
+TEST(ShaTests, CloneAndCopyFrom) {
+    const auto context = Sasl::MakeSha1Context();
+    context->Update((const uint8_t*)"ab", 2);
+    const auto clone = context->Clone();
+    const auto other = Sasl::MakeSha1Context();
+    other->CopyFrom(*context);
+    EXPECT_EQ(
+        "a9993e364706816aba3e25717850c26c9cd0d89d",
+        HexDigest(*context, {"c", 1, ""}, 20)
+    );
+    EXPECT_EQ(
+        "a9993e364706816aba3e25717850c26c9cd0d89d",
+        HexDigest(*clone, {"c", 1, ""}, 20)
+    );
+    EXPECT_EQ(
+        "a9993e364706816aba3e25717850c26c9cd0d89d",
+        HexDigest(*other, {"c", 1, ""}, 20)
+    );
+}
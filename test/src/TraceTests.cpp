@@ -0,0 +1,158 @@
+/**
+ * @file TraceTests.cpp
+ *
+ * This module contains the unit tests of the Sasl::Trace functions
+ * and classes.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <Sasl/Client/Scram.hpp>
+#include <Sasl/Trace.hpp>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the path of the trace file written by the tests.
+     */
+    const std::string TRACE_PATH = "TraceTests.json";
+
+    /**
+     * Read the lines of the trace file written by the tests,
+     * and delete the file.
+     *
+     * @return
+     *     The lines of the trace file are returned.
+     */
+    std::vector< std::string > ReadTrace() {
+        std::vector< std::string > lines;
+        const auto file = fopen(TRACE_PATH.c_str(), "r");
+        if (file == NULL) {
+            return lines;
+        }
+        std::string line;
+        for (;;) {
+            const auto c = fgetc(file);
+            if (c == EOF) {
+                break;
+            }
+            if (c == '\n') {
+                lines.push_back(line);
+                line.clear();
+            } else {
+                line += (char)c;
+            }
+        }
+        (void)fclose(file);
+        (void)remove(TRACE_PATH.c_str());
+        return lines;
+    }
+
+    /**
+     * Return the lines of the given trace which record a span
+     * with the given name.
+     *
+     * @param[in] lines
+     *     These are the lines of the trace.
+     *
+     * @param[in] name
+     *     This is the name of the span to find.
+     *
+     * @return
+     *     The lines recording a span with the given name are returned.
+     */
+    std::vector< std::string > FindSpans(
+        const std::vector< std::string >& lines,
+        const std::string& name
+    ) {
+        std::vector< std::string > spans;
+        const auto prefix = "{\"name\":\"" + name + "\",\"cat\":\"sasl\",\"ph\":\"X\"";
+        for (const auto& line: lines) {
+            if (line.compare(0, prefix.length(), prefix) == 0) {
+                spans.push_back(line);
+            }
+        }
+        return spans;
+    }
+
+}
+
+TEST(TraceTests, SpansOfExchangeStepsAndGaps) {
+    Sasl::Trace::Exchange exchange;
+    Sasl::Trace::Start();
+    {
+        Sasl::Trace::Span step("step 1", exchange);
+        Sasl::Trace::Span inner("inner \"quoted\"");
+    }
+    {
+        Sasl::Trace::Span outside("outside");
+    }
+    {
+        Sasl::Trace::Span step("step 2", exchange);
+    }
+    ASSERT_TRUE(Sasl::Trace::Stop(TRACE_PATH));
+    ASSERT_NE(0, exchange.id);
+    const auto exchangeTrack = "\"pid\":1,\"tid\":" + std::to_string(exchange.id) + ",";
+    const auto lines = ReadTrace();
+    ASSERT_FALSE(lines.empty());
+    EXPECT_EQ("{\"traceEvents\":[", lines[0]);
+    for (const auto& name: {"step 1", "inner \\\"quoted\\\"", "step 2", "waiting"}) {
+        const auto spans = FindSpans(lines, name);
+        ASSERT_EQ(1, spans.size()) << name;
+        EXPECT_NE(std::string::npos, spans[0].find(exchangeTrack)) << spans[0];
+    }
+    const auto outside = FindSpans(lines, "outside");
+    ASSERT_EQ(1, outside.size());
+    EXPECT_NE(std::string::npos, outside[0].find("\"pid\":2,")) << outside[0];
+
+    // Spans aren't recorded once recording stops.
+    {
+        Sasl::Trace::Span step("step 3", exchange);
+    }
+    Sasl::Trace::Start();
+    ASSERT_TRUE(Sasl::Trace::Stop(TRACE_PATH));
+    EXPECT_TRUE(FindSpans(ReadTrace(), "step 3").empty());
+}
+
+TEST(TraceTests, ScramExchangesOnSeparateTracks) {
+    Sasl::Trace::Start();
+    std::vector< std::thread > threads;
+    for (int i = 0; i < 2; ++i) {
+        threads.emplace_back([]{
+            Sasl::Client::Scram mech;
+            mech.SetProfile(Sasl::Client::ScramProfile::Sha1());
+            mech.SetClientNonce("fyko+d2lbbFgONRv9qkxdawL");
+            mech.SetCredentials("pencil", "user");
+            mech.Reset();
+            (void)mech.GetInitialResponse();
+            (void)mech.Proceed("r=fyko+d2lbbFgONRv9qkxdawL3rfcNHYJY1ZVvWVs7j,s=QSXCR+Q6sek8bf92,i=4096");
+            (void)mech.Proceed("v=rmF9pqV8S7suAoZWja4dJRkFsKQ=");
+            EXPECT_TRUE(mech.Succeeded());
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    ASSERT_TRUE(Sasl::Trace::Stop(TRACE_PATH));
+    const auto lines = ReadTrace();
+    const auto derivations = FindSpans(lines, "derive salted password");
+    ASSERT_EQ(2, derivations.size());
+    const auto track = [](const std::string& span){
+        const auto start = span.find("\"pid\"");
+        return span.substr(start, span.find(",\"ts\"") - start);
+    };
+    EXPECT_NE(track(derivations[0]), track(derivations[1]));
+    EXPECT_EQ(4, FindSpans(lines, "Scram::Proceed").size());
+    EXPECT_EQ(2, FindSpans(lines, "parse server-first-message").size());
+    EXPECT_EQ(2, FindSpans(lines, "verify server signature").size());
+
+    // Resetting the mechanism isn't a step of the exchange, so each
+    // exchange has three steps, with two gaps between them.
+    EXPECT_TRUE(FindSpans(lines, "Scram::Reset").empty());
+    EXPECT_EQ(4, FindSpans(lines, "waiting").size());
+}